@@ -309,6 +309,132 @@ namespace measure
 	using Duration = std::chrono::duration<double, std::micro>;
 }
 
+// throughput of the batched SoA kernels against a loop over the single-matrix `matrix3x4SIMD` functions
+namespace batch
+{
+	using namespace nbl;
+	using namespace core;
+
+	constexpr size_t POINT_CNT = 0x1ull<<22;
+	constexpr size_t MATRIX_CNT = 0x1ull<<18;
+	constexpr size_t REPEAT_CNT = 16ull;
+
+	template<class F>
+	static double measureMs(F&& f)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (size_t r=0ull; r<REPEAT_CNT; ++r)
+		{
+			const measure::TimePoint start = measure::Clock::now();
+			f();
+			const measure::Duration dt = measure::Clock::now()-start;
+			best = std::min(best,dt.count()*0.001);
+		}
+		return best;
+	}
+
+	static void report(const char* _what, const char* _impl, size_t _elements, double _ms)
+	{
+		printf("%-12s %-8s %8.3f ms %10.2f M/s\n",_what,_impl,_ms,double(_elements)/(_ms*1000.0));
+	}
+
+	static void run()
+	{
+		std::mt19937 mt(0x45u);
+		std::uniform_real_distribution<float> dist(-100.f,100.f);
+
+		core::vector<float> points(POINT_CNT*3ull), pointsOut(POINT_CNT*4ull);
+		for (auto& v : points)
+			v = dist(mt);
+		core::vector<float> boxes(POINT_CNT*6ull), boxesOut(POINT_CNT*6ull);
+		for (size_t n=0ull; n<POINT_CNT; ++n)
+		for (size_t c=0ull; c<3ull; ++c)
+		{
+			const float a = dist(mt), b = dist(mt);
+			boxes[c*POINT_CNT+n] = std::min(a,b);
+			boxes[(c+3ull)*POINT_CNT+n] = std::max(a,b);
+		}
+		core::vector<matrix3x4SIMD> matricesA(MATRIX_CNT), matricesB(MATRIX_CNT), matricesOut(MATRIX_CNT);
+		for (size_t n=0ull; n<MATRIX_CNT; ++n)
+		for (size_t c=0ull; c<12ull; ++c)
+		{
+			matricesA[n].pointer()[c] = dist(mt);
+			matricesB[n].pointer()[c] = dist(mt);
+		}
+		core::vector<float> soaA(MATRIX_CNT*12ull), soaB(MATRIX_CNT*12ull), soaOut(MATRIX_CNT*12ull);
+		core::vector<uint8_t> valid(MATRIX_CNT);
+		const auto viewA = matrixSIMDBatch::affine_matrices_t::fromContiguous(soaA.data(),MATRIX_CNT);
+		const auto viewB = matrixSIMDBatch::affine_matrices_t::fromContiguous(soaB.data(),MATRIX_CNT);
+		const auto viewOut = matrixSIMDBatch::affine_matrices_t::fromContiguous(soaOut.data(),MATRIX_CNT);
+		matrixSIMDBatch::toSoA(viewA,matricesA.data(),MATRIX_CNT);
+		matrixSIMDBatch::toSoA(viewB,matricesB.data(),MATRIX_CNT);
+
+		const matrix3x4SIMD mtx = matricesA[0];
+		const matrix4SIMD projMtx = matrix4SIMD::concatenateBFollowedByA(matrix4SIMD::buildProjectionMatrixPerspectiveFovRH(core::radians(60.f),16.f/9.f,0.1f,1000.f),matrix4SIMD(mtx));
+		const auto pointsIn = matrixSIMDBatch::points_t::fromContiguous(points.data(),POINT_CNT);
+		const auto pointsOut3 = matrixSIMDBatch::points_t::fromContiguous(pointsOut.data(),POINT_CNT);
+		const auto pointsOut4 = matrixSIMDBatch::homogeneous_points_t::fromContiguous(pointsOut.data(),POINT_CNT);
+		const auto boxesIn = matrixSIMDBatch::boxes_t::fromContiguous(boxes.data(),POINT_CNT);
+		const auto boxesOutView = matrixSIMDBatch::boxes_t::fromContiguous(boxesOut.data(),POINT_CNT);
+
+		// baselines
+		report("points","serial",POINT_CNT,measureMs([&]() {
+			for (size_t n=0ull; n<POINT_CNT; ++n)
+			{
+				vectorSIMDf v(points[n],points[POINT_CNT+n],points[2ull*POINT_CNT+n]);
+				mtx.transformVect(v);
+				for (size_t c=0ull; c<3ull; ++c)
+					pointsOut[c*POINT_CNT+n] = v[c];
+			}
+		}));
+		report("boxes","serial",POINT_CNT,measureMs([&]() {
+			for (size_t n=0ull; n<POINT_CNT; ++n)
+			{
+				aabbox3df box(boxes[n],boxes[POINT_CNT+n],boxes[2ull*POINT_CNT+n],boxes[3ull*POINT_CNT+n],boxes[4ull*POINT_CNT+n],boxes[5ull*POINT_CNT+n]);
+				box = transformBoxEx(box,mtx);
+				memcpy(boxesOut.data()+n*6ull,&box,sizeof(float)*6ull);
+			}
+		}));
+		report("concatenate","serial",MATRIX_CNT,measureMs([&]() {
+			for (size_t n=0ull; n<MATRIX_CNT; ++n)
+				matricesOut[n] = matrix3x4SIMD::concatenateBFollowedByA(matricesA[n],matricesB[n]);
+		}));
+		report("inverse","serial",MATRIX_CNT,measureMs([&]() {
+			for (size_t n=0ull; n<MATRIX_CNT; ++n)
+				valid[n] = matricesA[n].getInverse(matricesOut[n]);
+		}));
+
+		const char* isaNames[matrixSIMDBatch::EI_COUNT] = {"SSE","AVX2","AVX-512"};
+		for (uint32_t isa=matrixSIMDBatch::EI_SSE; isa<=matrixSIMDBatch::getSupportedISA(); ++isa)
+		{
+			matrixSIMDBatch::setISA(static_cast<matrixSIMDBatch::E_ISA>(isa));
+			const char* name = isaNames[isa];
+			report("points",name,POINT_CNT,measureMs([&]() {matrixSIMDBatch::transformPoints(mtx,pointsOut3,pointsIn,POINT_CNT);}));
+			report("normals",name,POINT_CNT,measureMs([&]() {matrixSIMDBatch::transformNormals(mtx,pointsOut3,pointsIn,POINT_CNT);}));
+			report("clip space",name,POINT_CNT,measureMs([&]() {matrixSIMDBatch::transformPoints(projMtx,pointsOut4,pointsIn,POINT_CNT);}));
+			report("boxes",name,POINT_CNT,measureMs([&]() {matrixSIMDBatch::transformBoxes(mtx,boxesOutView,boxesIn,POINT_CNT);}));
+			report("concatenate",name,MATRIX_CNT,measureMs([&]() {matrixSIMDBatch::concatenateBFollowedByA(viewOut,viewA,viewB,MATRIX_CNT);}));
+			report("inverse",name,MATRIX_CNT,measureMs([&]() {matrixSIMDBatch::getInverse(viewOut,valid.data(),viewA,MATRIX_CNT);}));
+		}
+		matrixSIMDBatch::setISA(matrixSIMDBatch::getSupportedISA());
+
+#if VERIFY
+		matrixSIMDBatch::concatenateBFollowedByA(viewOut,viewA,viewB,MATRIX_CNT);
+		matrixSIMDBatch::fromSoA(matricesOut.data(),viewOut,MATRIX_CNT);
+		for (size_t n=0ull; n<MATRIX_CNT; ++n)
+		{
+			const auto expected = matrix3x4SIMD::concatenateBFollowedByA(matricesA[n],matricesB[n]);
+			for (size_t c=0ull; c<12ull; ++c)
+			if (abs(expected.pointer()[c]-matricesOut[n].pointer()[c])>0.001f*(1.f+abs(expected.pointer()[c])))
+			{
+				printf("Batched concatenation doesn't match!\n");
+				return;
+			}
+		}
+#endif
+	}
+}
+
 template<typename T>
 static bool compare(T* _m1, T* _m2);
 template<typename T>
@@ -396,6 +522,9 @@ int main()
 #endif
 	free(data);
 
+	printf("\nbatched SoA kernels, widest supported: %s\n",nbl::core::matrixSIMDBatch::getSupportedISA()==nbl::core::matrixSIMDBatch::EI_AVX512 ? "AVX-512":(nbl::core::matrixSIMDBatch::getSupportedISA()==nbl::core::matrixSIMDBatch::EI_AVX2 ? "AVX2":"SSE"));
+	batch::run();
+
 	return 0;
 }
 
@@ -220,44 +220,20 @@ int main()
 	constexpr uint32_t MaxSamples = 1024u*1024u;
 	auto sampleSequence = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*MaxSamples*Renderer::MaxDimensions);
 	{
-		bool generateNewSamples = true;
-
-		io::IReadFile* cacheFile = device->getFileSystem()->createAndOpenFile("../../tmp/rtSamples.bin");
-		if (cacheFile)
-		{
-			if (cacheFile->getSize()>=sampleSequence->getSize()) // light validation
-			{
-				cacheFile->read(sampleSequence->getPointer(),sampleSequence->getSize());
-				generateNewSamples = false;
-			}
-			cacheFile->drop();
-		}
-
-		if (generateNewSamples)
-		{
-			/** TODO: redo the sampling
-			Locality Level 0: the 6 or 4 dimensions consumed for BSDF + NEE sampling
-			Locality Level 1: the N samples per dispatch which will be consumed in parallel
-			Locality Level 2: the k dimensions batches (where D=4k or 6k) consumed as we recurse deeper
-			Locality Level 3: the z sample batches (where T=zN) consumed as we progressively add samples
-			**/
-			constexpr uint32_t Channels = 3u;
-			static_assert(Renderer::MaxDimensions%Channels==0u,"We cannot have this!");
-			core::OwenSampler sampler(Renderer::MaxDimensions,0xdeadbeefu);
-
-			uint32_t (&out)[][Channels] = *reinterpret_cast<uint32_t(*)[][Channels]>(sampleSequence->getPointer());
-			for (auto realdim=0u; realdim<Renderer::MaxDimensions/Channels; realdim++)
-			for (auto c=0u; c<Channels; c++)
-			for (uint32_t i=0; i<MaxSamples; i++)
-				out[realdim*MaxSamples+i][c] = sampler.sample(realdim*Channels+c,i);
-
-			io::IWriteFile* cacheFile = device->getFileSystem()->createAndWriteFile("../../tmp/rtSamples.bin");
-			if (cacheFile)
-			{
-				cacheFile->write(sampleSequence->getPointer(),sampleSequence->getSize());
-				cacheFile->drop();
-			}
-		}
+		/** TODO: redo the sampling
+		Locality Level 0: the 6 or 4 dimensions consumed for BSDF + NEE sampling
+		Locality Level 1: the N samples per dispatch which will be consumed in parallel
+		Locality Level 2: the k dimensions batches (where D=4k or 6k) consumed as we recurse deeper
+		Locality Level 3: the z sample batches (where T=zN) consumed as we progressively add samples
+		**/
+		constexpr uint32_t Channels = 3u;
+		static_assert(Renderer::MaxDimensions%Channels==0u,"We cannot have this!");
+		// hashed scrambling needs no tables and generates in parallel, so it's fast enough not to need caching the samples on disk anymore
+		core::HashedOwenSampler sampler(Renderer::MaxDimensions,0xdeadbeefu);
+
+		auto out = reinterpret_cast<uint32_t*>(sampleSequence->getPointer());
+		for (auto realdim=0u; realdim<Renderer::MaxDimensions/Channels; realdim++)
+			sampler.generate(out+realdim*MaxSamples*Channels,realdim*Channels,Channels,0u,MaxSamples);
 	}
 
 	renderer->init(meshes, std::move(sampleSequence));
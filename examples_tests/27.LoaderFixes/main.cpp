@@ -77,6 +77,59 @@ int main()
 		device->getAssetManager()->writeAsset("IndustrialWriteTest.ply", wp);
 	}
 	#endif // WRITE_ASSETS
+
+	/*
+		Split the STL, a binary PLY copy of it and the cow OBJ into chunks out-of-core, and check that the chunks written add back up to the whole meshes
+	*/
+
+	{
+		auto* am = device->getAssetManager();
+		auto streamIntoChunks = [&](const std::string& path, const std::string& outputPrefix) -> uint64_t
+		{
+			auto source = asset::CStreamingMeshProcessor::createFileSource(am->getFileSystem(), path.c_str(), ".");
+			assert(source);
+
+			asset::CStreamingMeshProcessor::SParams streamingParams;
+			// small enough for the meshes to need several chunks
+			streamingParams.memoryBudget = 0x1ull << 21ull;
+			streamingParams.scratchDirectory = ".";
+			streamingParams.outputPrefix = outputPrefix;
+			const auto result = asset::CStreamingMeshProcessor::process(am, source.get(), streamingParams);
+			assert(result.success && result.chunks.size() > 1u);
+
+			uint64_t chunkTriangleCount = 0ull;
+			for (const auto& chunk : result.chunks)
+			{
+				assert(chunk.written);
+				chunkTriangleCount += chunk.triangleCount;
+
+				asset::IAssetLoader::SAssetLoadParams lp;
+				auto chunkBundle = am->getAsset(chunk.filename, lp);
+				assert(!chunkBundle.getContents().empty());
+				auto chunkMesh = asset::IAsset::castDown<asset::ICPUMesh>(chunkBundle.getContents().begin()[0]);
+
+				// degenerate triangles get dropped while optimizing
+				uint32_t polyCount = 0u;
+				asset::IMeshManipulator::getPolyCount(polyCount, chunkMesh.get());
+				assert(polyCount > 0u && polyCount <= chunk.triangleCount);
+			}
+			assert(chunkTriangleCount == result.triangleCount);
+
+			os::Printer::log("Out-of-core processing split " + std::to_string(result.triangleCount) + " triangles of " + path + " into " + std::to_string(result.chunks.size()) + " chunks", ELL_INFORMATION);
+			return result.triangleCount;
+		};
+
+		const uint64_t stlTriangleCount = streamIntoChunks("../../media/extrusionLogo_TEST_fixed.stl", "extrusionLogo_TEST_fixedChunk");
+		{
+			asset::IAssetWriter::SAssetWriteParams wp(cpuMeshStl.get(), asset::EWF_BINARY);
+			const bool written = am->writeAsset("extrusionLogo_TEST_fixedStreaming.ply", wp);
+			assert(written);
+		}
+		const uint64_t plyTriangleCount = streamIntoChunks("extrusionLogo_TEST_fixedStreaming.ply", "extrusionLogo_TEST_fixedPLYChunk");
+		assert(plyTriangleCount == stlTriangleCount);
+		const uint64_t objTriangleCount = streamIntoChunks("../../media/cow.obj", "cowChunk");
+		assert(objTriangleCount == 5144ull);
+	}
 	
 	/*
 		For the testing puposes we can safely assume all meshbuffers within mesh loaded from PLY & STL has same DS1 layout (used for camera-specific data)
@@ -1,10 +1,74 @@
 #define _IRR_STATIC_LIB_
 #include <nabla.h>
 #include "nbl/core/containers/LRUcache.h"
+#include "nbl/core/containers/ConcurrentLRUCache.h"
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
 
 using namespace nbl;
 using namespace nbl::core;
 
+// every thread does a mix of lookups and inserts over a skewed key distribution, so a few keys are hot
+template<class Cache>
+double benchmark(Cache& cache, const uint32_t threadCount, const uint32_t opsPerThread)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	core::vector<std::thread> threads;
+	for (uint32_t t=0u; t<threadCount; t++)
+	threads.emplace_back([&cache,t,opsPerThread]() -> void
+	{
+		std::mt19937 rng(t);
+		std::geometric_distribution<int> keyDistribution(0.001);
+		for (uint32_t i=0u; i<opsPerThread; i++)
+		{
+			const int key = keyDistribution(rng);
+			if (!cache.get(key))
+				cache.insert(key,key*2);
+		}
+	});
+	for (auto& thread : threads)
+		thread.join();
+	const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now()-start;
+	return double(threadCount)*double(opsPerThread)/elapsed.count();
+}
+
+// adapters so the benchmark can drive both caches the same way
+struct SingleMutexCache
+{
+	SingleMutexCache(const uint32_t capacity) : cache(capacity) {}
+
+	bool get(int key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return cache.get(key);
+	}
+	void insert(int key, int value)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		cache.insert(key,value);
+	}
+
+	std::mutex mutex;
+	LRUCache<int,int> cache;
+};
+struct ShardedCache
+{
+	ShardedCache(const uint32_t capacity) : cache(capacity) {}
+
+	bool get(int key)
+	{
+		int value;
+		return cache.get(key,value);
+	}
+	void insert(int key, int value) { cache.insert(key,value); }
+
+	ConcurrentLRUCache<int,int> cache;
+};
+
 int main()
 {
 	LRUCache<int, char> hugeCache(50000000u);
@@ -74,5 +138,63 @@ int main()
 	cache2.print();
 
 
+	// eviction callbacks
+	{
+		LRUCache<int,std::string> cache3(2u);
+		core::vector<int> evictedKeys;
+		auto recordEviction = [&evictedKeys](const int& key, std::string&& value) -> void { evictedKeys.push_back(key); };
+		cache3.insert(1,"one",recordEviction);
+		cache3.insert(2,"two",recordEviction);
+		cache3.get(1);
+		cache3.insert(3,"three",recordEviction);
+		assert(evictedKeys.size()==1u && evictedKeys[0]==2);
+		assert(cache3.getSize()==2u);
+		assert(cache3.evictLeastRecentlyUsed(recordEviction) && evictedKeys[1]==1);
+		assert(cache3.evictLeastRecentlyUsed(recordEviction) && evictedKeys[2]==3);
+		assert(!cache3.evictLeastRecentlyUsed(recordEviction));
+	}
+
+	// sharded cache, with a byte budget
+	{
+		std::atomic<uint32_t> evictionCount(0u);
+		ConcurrentLRUCache<int,std::string> concurrentCache(64u,1000ull,4u,[&evictionCount](const int&, std::string&&) -> void { evictionCount++; });
+		assert(concurrentCache.getShardCount()==4u);
+		for (int j=0; j<200; j++)
+			concurrentCache.insert(j,std::to_string(j),10ull);
+		assert(concurrentCache.getSize()<=64u);
+		assert(concurrentCache.getSize()+evictionCount==200u);
+
+		std::string value;
+		assert(concurrentCache.get(199,value) && value=="199");
+		assert(!concurrentCache.insert(1000,"too big",300ull)); // more than a shard's quarter of the budget
+		assert(concurrentCache.insert(1001,"big",200ull));
+		assert(concurrentCache.getByteSize()<=1000ull);
+		assert(concurrentCache.peek(1001,value) && value=="big");
+
+		concurrentCache.erase(1001);
+		assert(!concurrentCache.peek(1001,value));
+
+		const auto evictedBeforeClear = evictionCount.load();
+		const auto sizeBeforeClear = concurrentCache.getSize();
+		concurrentCache.clear();
+		assert(concurrentCache.getSize()==0u && concurrentCache.getByteSize()==0ull);
+		assert(evictionCount==evictedBeforeClear+sizeBeforeClear);
+	}
+
+	// contention
+	{
+		constexpr uint32_t Capacity = 4096u;
+		constexpr uint32_t OpsPerThread = 1000000u;
+		const uint32_t threadCount = core::max(std::thread::hardware_concurrency(),1u);
+
+		SingleMutexCache singleMutexCache(Capacity);
+		ShardedCache shardedCache(Capacity);
+		std::cout << threadCount << " threads, single mutex LRUCache: " << benchmark(singleMutexCache,threadCount,OpsPerThread) << " ops/s\n";
+		std::cout << threadCount << " threads, ConcurrentLRUCache: " << benchmark(shardedCache,threadCount,OpsPerThread) << " ops/s\n";
+		const auto statistics = shardedCache.cache.getStatistics();
+		std::cout << "ConcurrentLRUCache hit rate: " << double(statistics.hits)/double(statistics.hits+statistics.misses) << "\n";
+	}
+
+
 	return 0;
 }
@@ -301,15 +301,11 @@ int main()
 
 		auto sampleSequence = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*MaxDimensions*MaxSamples);
 		
-		core::OwenSampler sampler(MaxDimensions, 0xdeadbeefu);
+		core::HashedOwenSampler sampler(MaxDimensions, 0xdeadbeefu);
 		//core::SobolSampler sampler(MaxDimensions);
 
 		auto out = reinterpret_cast<uint32_t*>(sampleSequence->getPointer());
-		for (auto dim=0u; dim<MaxDimensions; dim++)
-		for (uint32_t i=0; i<MaxSamples; i++)
-		{
-			out[i*MaxDimensions+dim] = sampler.sample(dim,i);
-		}
+		sampler.generate(out, 0u, MaxDimensions, 0u, MaxSamples);
 		auto gpuSequenceBuffer = driver->createFilledDeviceLocalGPUBufferOnDedMem(sampleSequence->getSize(), sampleSequence->getPointer());
 		gpuSequenceBufferView = driver->createGPUBufferView(gpuSequenceBuffer.get(), asset::EF_R32G32B32_UINT);
 	}
@@ -30,6 +30,7 @@ using namespace video;
 constexpr bool EXCLUSIVE_SUM = true;
 constexpr auto MIPMAP_IMAGE_VIEW = 2u;		// feel free to change the mipmap
 constexpr auto MIPMAP_IMAGE = 0u;			// ordinary image used in the example has only 0-th mipmap
+constexpr bool BENCHMARK_LARGE_IMAGES = true; // times the filters on a synthetic 8K image before running the example
 
 /*
 	Discrete convolution for getting input image after SAT calculations
@@ -59,6 +60,95 @@ class CDiscreteConvolutionFilterKernel : public CFloatingPointSeparableImageFilt
 		}
 };
 
+/*
+	Times the SAT and a downsampling blit on a synthetic 8K image,
+	the blit gets run both with and without striped scratch writes.
+*/
+
+void benchmarkLargeImageFilters()
+{
+	constexpr uint32_t LARGE_EXTENT = 8192u;
+
+	auto createImage = [](E_FORMAT format, uint32_t extent) -> core::smart_refctd_ptr<ICPUImage>
+	{
+		ICPUImage::SCreationParams params = {};
+		params.type = IImage::ET_2D;
+		params.format = format;
+		params.extent = { extent,extent,1u };
+		params.mipLevels = 1u;
+		params.arrayLayers = 1u;
+		params.samples = IImage::ESCF_1_BIT;
+		auto image = ICPUImage::create(std::move(params));
+
+		auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+		auto& region = regions->front();
+		region = {};
+		region.imageSubresource.layerCount = 1u;
+		region.imageExtent = { extent,extent,1u };
+		auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(extent)*extent*asset::getTexelOrBlockBytesize(format));
+		image->setBufferAndRegions(std::move(buffer),regions);
+		return image;
+	};
+
+	auto inImage = createImage(EF_R8G8B8A8_UNORM,LARGE_EXTENT);
+	{
+		core::RandomSampler rng(0x45u);
+		auto* texels = reinterpret_cast<uint32_t*>(inImage->getBuffer()->getPointer());
+		for (size_t i=0u; i<size_t(LARGE_EXTENT)*LARGE_EXTENT; i++)
+			texels[i] = rng.nextSample();
+	}
+
+	auto timeIt = [](const char* name, auto&& f) -> void
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		const bool success = f();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-start).count();
+		os::Printer::log(std::string(name)+(success ? " took ":" failed after ")+std::to_string(elapsed)+" ms",ELL_INFORMATION);
+	};
+
+	{
+		using SUM_FILTER = CSummedAreaTableImageFilter<EXCLUSIVE_SUM>;
+		auto outImage = createImage(EF_R32G32B32A32_SFLOAT,LARGE_EXTENT);
+
+		SUM_FILTER::state_type state;
+		state.inImage = inImage.get();
+		state.outImage = outImage.get();
+		state.inOffset = { 0,0,0 };
+		state.inBaseLayer = 0;
+		state.outOffset = { 0,0,0 };
+		state.outBaseLayer = 0;
+		state.extent = { LARGE_EXTENT,LARGE_EXTENT,1u };
+		state.layerCount = 1u;
+		state.inMipLevel = 0u;
+		state.outMipLevel = 0u;
+		state.scratchMemoryByteSize = state.getRequiredScratchByteSize(state.inImage,state.extent);
+		state.scratchMemory = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(state.scratchMemoryByteSize,32));
+		timeIt("8K summed area table",[&]() {return SUM_FILTER::execute(&state);});
+		_NBL_ALIGNED_FREE(state.scratchMemory);
+	}
+
+	{
+		using BLIT_FILTER = CBlitImageFilter<false,false,DefaultSwizzle,IdentityDither,CTriangleImageFilterKernel>;
+		auto outImage = createImage(EF_R8G8B8A8_UNORM,LARGE_EXTENT/2u);
+
+		for (const bool striped : {false,true})
+		{
+			BLIT_FILTER::state_type state;
+			state.inOffsetBaseLayer = core::vectorSIMDu32();
+			state.inExtentLayerCount = core::vectorSIMDu32(LARGE_EXTENT,LARGE_EXTENT,1u,1u);
+			state.inImage = inImage.get();
+			state.outOffsetBaseLayer = core::vectorSIMDu32();
+			state.outExtentLayerCount = core::vectorSIMDu32(LARGE_EXTENT/2u,LARGE_EXTENT/2u,1u,1u);
+			state.outImage = outImage.get();
+			state.stripedScratchWrites = striped;
+			state.scratchMemoryByteSize = BLIT_FILTER::getRequiredScratchByteSize(&state);
+			state.scratchMemory = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(state.scratchMemoryByteSize,32));
+			timeIt(striped ? "8K->4K blit with striped scratch writes":"8K->4K blit with strided scratch writes",[&]() {return BLIT_FILTER::execute(&state);});
+			_NBL_ALIGNED_FREE(state.scratchMemory);
+		}
+	}
+}
+
 int main()
 {
 	nbl::SIrrlichtCreationParameters params;
@@ -75,6 +165,9 @@ int main()
 	if (!device)
 		return false;
 
+	if constexpr (BENCHMARK_LARGE_IMAGES)
+		benchmarkLargeImageFilters();
+
 	device->getCursorControl()->setVisible(false);
 	auto driver = device->getVideoDriver();
 	auto assetManager = device->getAssetManager();
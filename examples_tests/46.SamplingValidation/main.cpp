@@ -5,6 +5,7 @@
 #define _NBL_STATIC_LIB_
 #include <iostream>
 #include <cstdio>
+#include <chrono>
 #include <nabla.h>
 #include "nbl/ext/ScreenShot/ScreenShot.h"
 #include "nbl/ext/FullScreenTriangle/FullScreenTriangle.h"
@@ -95,8 +96,76 @@ private:
     float m_ax = 0.5f, m_ay = 0.5f;
 };
 
+// Checks the batched, hash scrambled sequence against per-sample evaluation and the (0,m,2)-net property, and compares its speed to the tree based `OwenSampler`
+bool validateSampleSequences()
+{
+    constexpr uint32_t Dimensions = 8u;
+    constexpr uint32_t SampleCount = 1u<<20u;
+    constexpr uint32_t Seed = 0xdeadbeefu;
+
+    core::vector<uint32_t> samples(Dimensions*SampleCount);
+    HashedOwenSampler hashedSampler(Dimensions,Seed);
+    auto start = std::chrono::high_resolution_clock::now();
+    hashedSampler.generate(samples.data(),0u,Dimensions,0u,SampleCount);
+    const std::chrono::duration<double,std::milli> hashedTime = std::chrono::high_resolution_clock::now()-start;
+
+    OwenSampler treeSampler(Dimensions,Seed);
+    uint32_t checksum = 0u;
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t d=0u; d<Dimensions; d++)
+    for (uint32_t i=0u; i<SampleCount; i++)
+        checksum ^= treeSampler.sample(d,i);
+    const std::chrono::duration<double,std::milli> treeTime = std::chrono::high_resolution_clock::now()-start;
+    std::cout << Dimensions << "x" << SampleCount << " samples, HashedOwenSampler::generate: " << hashedTime.count() << "ms, OwenSampler: " << treeTime.count() << "ms (" << checksum << ")\n";
+
+    bool success = true;
+    for (uint32_t i=0u; i<SampleCount; i++)
+    for (uint32_t d=0u; d<Dimensions; d++)
+    if (samples[i*Dimensions+d]!=hashedSampler.sample(d,i))
+    {
+        std::cout << "Batched sample " << i << " of dimension " << d << " differs from the single sample\n";
+        return false;
+    }
+
+    // Owen scrambling keeps Sobol's first two dimensions a (0,m,2)-net, so every elementary interval of area 2^-m holds exactly one of the first 2^m samples
+    for (uint32_t m=1u; m<=16u; m++)
+    for (uint32_t k=0u; k<=m; k++)
+    {
+        core::vector<uint32_t> counts(0x1u<<m,0u);
+        for (uint32_t i=0u; i<(0x1u<<m); i++)
+        {
+            const uint64_t x = uint64_t(samples[i*Dimensions])>>(32u-k);
+            const uint64_t y = uint64_t(samples[i*Dimensions+1u])>>(32u-(m-k));
+            counts[(x<<(m-k))|y]++;
+        }
+        if (std::find_if(counts.begin(),counts.end(),[](uint32_t count) {return count!=1u;})!=counts.end())
+        {
+            std::cout << "First " << (0x1u<<m) << " samples are not stratified in 2^" << k << "x2^" << m-k << " intervals\n";
+            success = false;
+        }
+    }
+
+    // and every dimension on its own is stratified over power of two sample counts
+    for (uint32_t d=0u; d<Dimensions; d++)
+    {
+        constexpr uint32_t m = 16u;
+        core::vector<uint32_t> counts(0x1u<<m,0u);
+        for (uint32_t i=0u; i<(0x1u<<m); i++)
+            counts[samples[i*Dimensions+d]>>(32u-m)]++;
+        if (std::find_if(counts.begin(),counts.end(),[](uint32_t count) {return count!=1u;})!=counts.end())
+        {
+            std::cout << "Dimension " << d << " is not stratified\n";
+            success = false;
+        }
+    }
+    return success;
+}
+
 int main()
 {
+    if (!validateSampleSequences())
+        return 2;
+
     // create device with full flexibility over creation parameters
     // you can add more parameters if desired, check nbl::SIrrlichtCreationParameters
     nbl::SIrrlichtCreationParameters params;
@@ -40,6 +40,9 @@ enum E_FILE_ARCHIVE_TYPE
 	//! A Tape ARchive
 	EFAT_TAR,
 
+	//! A Nabla PacK, page aligned entries with per-entry compression and a hashed table of contents
+	EFAT_NPK,
+
 	//! The type of this archive is unknown
 	EFAT_UNKNOWN
 };
@@ -64,6 +67,12 @@ public:
 	//! get the archive type
 	virtual E_FILE_ARCHIVE_TYPE getType() const { return EFAT_UNKNOWN; }
 
+	//! Whether createAndOpenFile only opens the files of getFileList() under their FullName
+	/** The file system then answers lookups from its own index of all mounted archives.
+	Archives which match names their own way (case insensitive, ignoring paths, generated on the fly)
+	must return false, they get asked directly on every lookup instead. */
+	virtual bool isIndexable() const { return true; }
+
 	//! An optionally used password string
 	/** This variable is publicly accessible from the interface in order to
 	avoid single access patterns to this place, and hence allow some more
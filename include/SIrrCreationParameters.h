@@ -44,6 +44,7 @@ namespace nbl
 			LoggingLevel(ELL_INFORMATION),
 #endif
 			AuxGLContexts(0),
+			AsyncLogging(false),
 			SDK_version_do_not_use(NABLA_SDK_VERSION)
 		{
 		}
@@ -72,6 +73,7 @@ namespace nbl
 			WindowId = other.WindowId;
 			LoggingLevel = other.LoggingLevel;
 			AuxGLContexts = other.AuxGLContexts;
+			AsyncLogging = other.AsyncLogging;
 			builtinResourceDirectoryPath = other.builtinResourceDirectoryPath;
 			return *this;
 		}
@@ -228,6 +230,10 @@ namespace nbl
 		//!
 		uint8_t AuxGLContexts;
 
+		//! Log through a `CAsyncLogger`, so threads logging don't wait on each other or the console.
+		/** The event receiver then gets log events on the logger's own thread, and `std::terminate` flushes the queued messages first. Default is false. */
+		bool AsyncLogging;
+
 		//! This variable tells us where the directory holding "nbl/builtin/" is if the resources are not embedded
 		/** For shipping products to end-users we recommend embedding the built-in resources to avoid a plethora of
 		"works on my machine" problems, as this method is not 100% cross platform, i.e. if the engine's headers'
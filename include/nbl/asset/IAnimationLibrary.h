@@ -8,6 +8,7 @@
 #include "nbl/macros.h"
 
 #include "nbl/core/core.h"
+#include "nbl/asset/format/decodePixels.h"
 #include "nbl/asset/utils/CQuantQuaternionCache.h"
 
 namespace nbl
@@ -26,17 +27,21 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 		using timestamp_t = uint32_t;
 		struct alignas(8) Keyframe
 		{
-				Keyframe() : scale(0ull) // TODO: initialize scale to 1.f
+				Keyframe() : scale(encodeScale(core::vectorSIMDf(1.f)))
 				{
 					translation[2] = translation[1] = translation[0] = 0.f;
 					quat = core::vectorSIMDu32(128u,128u,128u,255u); // should be (0,0,0,1) encoded
 				}
-				Keyframe(const core::vectorSIMDf& _scale, const core::quaternion& _quat, const CQuantQuaternionCache* quantCache, const core::vectorSIMDf& _translation)
+				Keyframe(const core::vectorSIMDf& _scale, const core::quaternion& _quat, CQuantQuaternionCache* quantCache, const core::vectorSIMDf& _translation)
 				{
-					std::copy(translation,_translation.pointer,3u);
-					quat = quantCache->quantize(_quat);
-					// TODO: encode to RGB18E7S3
-					//scale = ;
+					std::copy(_translation.pointer,_translation.pointer+3u,translation);
+					quat = quantCache->template quantize<EF_R8G8B8A8_SNORM>(_quat);
+					scale = encodeScale(_scale);
+				}
+
+				inline core::vectorSIMDf getTranslation() const
+				{
+					return core::vectorSIMDf(translation[0],translation[1],translation[2]);
 				}
 
 				inline core::quaternion getRotation() const
@@ -44,15 +49,63 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 					const void* _pix[4] = {&quat,nullptr,nullptr,nullptr};
 					double out[4];
 					decodePixels<EF_R8G8B8A8_SNORM,double>(_pix,out,0u,0u);
-					return reinterpret_cast<const core::quaternion&>(core::normalize(core::vectorSIMDf(out[0],out[1],out[2],out[3])));
+					const auto normalized = core::normalize(core::vectorSIMDf(out[0],out[1],out[2],out[3]));
+					return reinterpret_cast<const core::quaternion&>(normalized);
 				}
 
 				inline core::vectorSIMDf getScale() const
 				{
-					return core::vectorSIMDf(0.f/0.f); // TODO: decode from RGB18E7S3
+					return decodeScale(scale);
 				}
 
 			private:
+				// RGB18E7S3, same as `nbl_glsl_encodeRGB18E7S3` and `nbl_glsl_decodeRGB18E7S3`
+				_NBL_STATIC_INLINE_CONSTEXPR uint32_t ScaleMantissaBits = 18u;
+				_NBL_STATIC_INLINE_CONSTEXPR int32_t ScaleExpBias = 63;
+				_NBL_STATIC_INLINE_CONSTEXPR uint32_t ScaleExpOffset = ScaleMantissaBits*3u;
+				_NBL_STATIC_INLINE_CONSTEXPR uint64_t ScaleMantissaMask = (0x1ull<<ScaleMantissaBits)-1ull;
+
+				static inline uint64_t encodeScale(const core::vectorSIMDf& _scale)
+				{
+					constexpr int32_t maxExp = ScaleExpBias+1;
+					const double maxValue = std::ldexp(double(ScaleMantissaMask)/double(ScaleMantissaMask+1ull),maxExp);
+
+					double absValue[3];
+					uint64_t encoded = 0ull;
+					for (auto i=0u; i<3u; i++)
+					{
+						absValue[i] = core::min<double>(std::abs(_scale[i]),maxValue);
+						if (std::signbit(_scale[i]))
+							encoded |= 0x1ull<<(61u+i);
+					}
+					const double maxrgb = core::max(core::max(absValue[0],absValue[1]),absValue[2]);
+
+					int32_t sharedExp;
+					std::frexp(maxrgb,&sharedExp);
+					sharedExp = core::clamp(sharedExp,-ScaleExpBias,maxExp);
+					double factor = std::ldexp(1.0,int32_t(ScaleMantissaBits)-sharedExp);
+					if (uint64_t(maxrgb*factor+0.5)==(ScaleMantissaMask+1ull))
+					{
+						factor *= 0.5;
+						sharedExp++;
+					}
+
+					for (auto i=0u; i<3u; i++)
+						encoded |= uint64_t(absValue[i]*factor+0.5)<<(ScaleMantissaBits*i);
+					return encoded|(uint64_t(sharedExp+ScaleExpBias)<<ScaleExpOffset);
+				}
+				static inline core::vectorSIMDf decodeScale(uint64_t _encoded)
+				{
+					const int32_t exp = int32_t((_encoded>>ScaleExpOffset)&0x7full)-ScaleExpBias-int32_t(ScaleMantissaBits);
+					core::vectorSIMDf retval;
+					for (auto i=0u; i<3u; i++)
+					{
+						const float magnitude = std::ldexp(float((_encoded>>(ScaleMantissaBits*i))&ScaleMantissaMask),exp);
+						retval[i] = (_encoded>>(61u+i))&0x1ull ? (-magnitude):magnitude;
+					}
+					return retval;
+				}
+
 				float translation[3];
 				CQuantQuaternionCache::Vector8u4 quat;
 				uint64_t scale;
@@ -92,7 +145,7 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 				}
 				inline E_INTERPOLATION_MODE getInterpolationMode() const
 				{
-					return data[1]&EIM_MASK;
+					return static_cast<E_INTERPOLATION_MODE>(data[1]&EIM_MASK);
 				}
 
 			private:
@@ -115,6 +168,12 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 			return reinterpret_cast<const SBufferRange<const BufferType>&>(m_animationStorageRange);
 		}
 
+		//
+		inline uint32_t getKeyframeCount() const
+		{
+			return m_keyframeCount;
+		}
+
 		//
 		inline uint32_t getAnimationCapacity() const
 		{
@@ -19,6 +19,7 @@
 #include "nbl/asset/interchange/IAssetWriter.h"
 
 #include "nbl/asset/utils/IGLSLCompiler.h"
+#include "nbl/asset/utils/CShaderVariantCache.h"
 #include "nbl/asset/utils/IGeometryCreator.h"
 
 
@@ -123,6 +124,7 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         core::smart_refctd_ptr<IGeometryCreator> m_geometryCreator;
         core::smart_refctd_ptr<IMeshManipulator> m_meshManipulator;
         core::smart_refctd_ptr<IGLSLCompiler> m_glslCompiler;
+        core::smart_refctd_ptr<CShaderVariantCache> m_shaderVariantCache;
         // called as a part of constructor only
         void initializeMeshTools();
 
@@ -148,6 +150,8 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         const IGeometryCreator* getGeometryCreator() const;
         IMeshManipulator* getMeshManipulator();
         IGLSLCompiler* getGLSLCompiler() const { return m_glslCompiler.get(); }
+        //! Shared by the loaders which generate many permutations of the same shaders, resolves includes with `getGLSLCompiler()`
+        CShaderVariantCache* getShaderVariantCache() const { return m_shaderVariantCache.get(); }
 
     protected:
 		virtual ~IAssetManager()
@@ -241,16 +245,29 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
             if (!file)
                 return {};//return empty bundle
 
+            NBL_PROFILE_SCOPE_DETAIL("IAssetManager::getAsset","asset",filename.c_str());
+            auto tryLoader = [&](IAssetLoader* loader) -> bool
+            {
+                if (!loader->isALoadableFileFormat(file))
+                    return false;
+                NBL_PROFILE_SCOPE_DETAIL("IAssetLoader::loadAsset","asset",loader->getAssociatedFileExtensions()[0]);
+                bundle = loader->loadAsset(file, params, _override, _hierarchyLevel);
+                if (bundle.getContents().empty())
+                    return false;
+                NBL_PROFILE_COUNTER(EC_BYTES_DECODED,file->getSize());
+                return true;
+            };
+
             auto capableLoadersRng = m_loaders.perFileExt.findRange(getFileExt(filename.c_str()));
             // loaders associated with the file's extension tryout
             for (auto& loader : capableLoadersRng)
             {
-                if (loader.second->isALoadableFileFormat(file) && !(bundle = loader.second->loadAsset(file, params, _override, _hierarchyLevel)).getContents().empty())
+                if (tryLoader(loader.second))
                     break;
             }
             for (auto loaderItr = std::begin(m_loaders.vector); bundle.getContents().empty() && loaderItr != std::end(m_loaders.vector); ++loaderItr) // all loaders tryout
             {
-                if ((*loaderItr)->isALoadableFileFormat(file) && !(bundle = (*loaderItr)->loadAsset(file, params, _override, _hierarchyLevel)).getContents().empty())
+                if (tryLoader(loaderItr->get()))
                     break;
             }
 
@@ -12,6 +12,9 @@
 #include "nbl/asset/IImage.h"
 #include "nbl/asset/ICPUSampler.h"
 
+#include <atomic>
+#include <numeric>
+
 namespace nbl
 {
 namespace asset
@@ -35,6 +38,7 @@ class ICPUImage final : public IImage, public IAsset
             clone_common(cp.get());
 
             cp->regions = regions;
+            // region index gets rebuilt lazily by the clone
             cp->buffer = (_depth > 0u && buffer) ? core::smart_refctd_ptr_static_cast<ICPUBuffer>(buffer->clone(_depth-1u)) : buffer;
 
             return cp;
@@ -49,7 +53,10 @@ class ICPUImage final : public IImage, public IAsset
 				buffer->convertToDummyObject(referenceLevelsBelowToConvert-1u);
 
 			if (canBeConvertedToDummy())
+			{
 				regions = nullptr;
+				invalidateRegionIndex();
+			}
         }
 
 		_NBL_STATIC_INLINE_CONSTEXPR auto AssetType = ET_IMAGE;
@@ -90,29 +97,33 @@ class ICPUImage final : public IImage, public IAsset
 		}
 
 		// `texelCoord=(xTexelPos,yTexelPos,zTexelPos,imageLayer)`
+		/** Uses a per-mip uniform grid over the regions which gets built on first use and invalidated by `setBufferAndRegions`,
+		so the cost does not depend on the number of regions. Last matching region wins, same as the order of the copies.
+		*/
 		inline const IImage::SBufferCopy* getRegion(uint32_t mipLevel, const core::vectorSIMDu32& texelCoord) const
 		{
-			auto mip = getRegions(mipLevel);
-			auto found = std::find_if(std::reverse_iterator(mip.end()),std::reverse_iterator(mip.begin()),
-				[&texelCoord](const IImage::SBufferCopy& region)
-				{ // we can simdify this in the future
-					if (region.imageSubresource.baseArrayLayer>texelCoord.w)
-						return false;
-					if (texelCoord.w>=region.imageSubresource.baseArrayLayer+region.imageSubresource.layerCount)
-						return false;
+			if (!regions)
+				return nullptr;
 
-					bool retval = true;
-					for (auto i=0; i<3; i++)
-					{
-						const auto _min = (&region.imageOffset.x)[i];
-						const auto _max = _min+(&region.imageExtent.width)[i];
-						retval = retval && texelCoord[i]>=_min && texelCoord[i]<_max;
-					}
-					return retval;
-				}
-			);
-			if (found!=std::reverse_iterator(mip.begin()))
-				return &(*found);
+			const auto* index = getRegionIndex();
+			if (mipLevel>=index->mips.size())
+				return nullptr;
+			const auto& mip = index->mips[mipLevel];
+
+			uint32_t cell = 0u;
+			for (int32_t i=3; i>=0; i--)
+			{
+				const uint32_t cellCoord = texelCoord[i]/mip.cellSize[i];
+				if (cellCoord>=mip.cellCount[i])
+					return nullptr;
+				cell = cell*mip.cellCount[i]+cellCoord;
+			}
+			for (uint32_t i=mip.cellOffsets[cell]; i<mip.cellOffsets[cell+1u]; i++)
+			{
+				const auto* region = regions->begin()+mip.candidates[i];
+				if (regionContains(*region,texelCoord))
+					return region;
+			}
 			return nullptr;
 		}
 
@@ -157,6 +168,50 @@ class ICPUImage final : public IImage, public IAsset
 			return const_cast<typename std::decay<decltype(*this)>::type*>(this)->getTexelBlockData(mipLevel,inRegionCoord,outBlockCoord);
 		}
 
+		//! Contiguous texel blocks along X, from the block containing a texel until the end of its region's row
+		template<typename T>
+		struct STexelBlockRunBase
+		{
+			T* data = nullptr;
+			//! including the first one
+			uint32_t blockCount = 0u;
+			//! bytes between consecutive blocks
+			uint32_t blockByteSize = 0u;
+		};
+		using STexelBlockRun = STexelBlockRunBase<void>;
+		using SConstTexelBlockRun = STexelBlockRunBase<const void>;
+		//! Same as `getTexelBlockData` but returns the whole run, so filters only need to look up a region once per run of texels
+		/** When regions of the mip overlap a later region could cover any of the following texels, so the run is then just the one block. */
+		inline STexelBlockRun getTexelBlockRun(uint32_t mipLevel, const core::vectorSIMDu32& boundedTexelCoord, core::vectorSIMDu32& outBlockCoord)
+		{
+			assert(!isImmutable_debug());
+
+			const auto run = static_cast<const ICPUImage*>(this)->getTexelBlockRun(mipLevel,boundedTexelCoord,outBlockCoord);
+			return {const_cast<void*>(run.data),run.blockCount,run.blockByteSize};
+		}
+		inline SConstTexelBlockRun getTexelBlockRun(uint32_t mipLevel, const core::vectorSIMDu32& boundedTexelCoord, core::vectorSIMDu32& outBlockCoord) const
+		{
+			SConstTexelBlockRun retval;
+			const auto* region = getRegion(mipLevel,boundedTexelCoord);
+			if (!region)
+				return retval;
+
+			core::vectorSIMDu32 inRegionCoord(boundedTexelCoord);
+			inRegionCoord -= core::vectorSIMDu32(region->imageOffset.x,region->imageOffset.y,region->imageOffset.z,region->imageSubresource.baseArrayLayer);
+			const auto localXYZLayerOffset = inRegionCoord/info.getDimension();
+			outBlockCoord = inRegionCoord-localXYZLayerOffset*info.getDimension();
+			retval.data = reinterpret_cast<const uint8_t*>(buffer->getPointer())+region->getByteOffset(localXYZLayerOffset,region->getByteStrides(info));
+			if (getRegionIndex()->mips[mipLevel].overlapping)
+				retval.blockCount = 1u;
+			else
+			{
+				const uint32_t blockWidth = info.getDimension().x;
+				retval.blockCount = (region->imageExtent.width+blockWidth-1u)/blockWidth-inRegionCoord.x/blockWidth;
+			}
+			retval.blockByteSize = info.getBlockByteSize();
+			return retval;
+		}
+
 
 		//! regions will be copied and sorted
 		inline bool setBufferAndRegions(core::smart_refctd_ptr<ICPUBuffer>&& _buffer, const core::smart_refctd_dynamic_array<IImage::SBufferCopy>& _regions)
@@ -169,6 +224,7 @@ class ICPUImage final : public IImage, public IAsset
 			buffer = std::move(_buffer);
 			regions = _regions;
 			std::sort(regions->begin(),regions->end(),mip_order_t());
+			invalidateRegionIndex();
 			return true;
 		}
 
@@ -193,7 +249,11 @@ class ICPUImage final : public IImage, public IAsset
 			const bool restorable = willBeRestoredFrom(_other);
 
 			if (restorable)
+			{
 				std::swap(regions, other->regions);
+				invalidateRegionIndex();
+				other->invalidateRegionIndex();
+			}
 
 			if (_levelsBelow)
 				restoreFromDummy_impl_call(buffer.get(), other->buffer.get(), _levelsBelow - 1u);
@@ -209,7 +269,10 @@ class ICPUImage final : public IImage, public IAsset
 		{
 		}
 
-		virtual ~ICPUImage() = default;
+		virtual ~ICPUImage()
+		{
+			invalidateRegionIndex();
+		}
 		
 		
 		core::smart_refctd_ptr<asset::ICPUBuffer>				buffer;
@@ -223,6 +286,151 @@ class ICPUImage final : public IImage, public IAsset
 				return _a.imageSubresource.mipLevel < _b.imageSubresource.mipLevel;
 			}
 		};
+
+		static inline bool regionContains(const IImage::SBufferCopy& region, const core::vectorSIMDu32& texelCoord)
+		{
+			if (region.imageSubresource.baseArrayLayer>texelCoord.w)
+				return false;
+			if (texelCoord.w>=region.imageSubresource.baseArrayLayer+region.imageSubresource.layerCount)
+				return false;
+
+			bool retval = true;
+			for (auto i=0; i<3; i++)
+			{
+				const auto _min = (&region.imageOffset.x)[i];
+				const auto _max = _min+(&region.imageExtent.width)[i];
+				retval = retval && texelCoord[i]>=_min && texelCoord[i]<_max;
+			}
+			return retval;
+		}
+
+		//! uniform grid over (x,y,z,layer) of every mip, each cell lists the regions overlapping it from last to first
+		struct SRegionIndex
+		{
+			struct SMip
+			{
+				uint32_t cellSize[4] = {1u,1u,1u,1u};
+				uint32_t cellCount[4] = {0u,0u,0u,0u};
+				core::vector<uint32_t> cellOffsets = {0u};
+				//! indices into `regions`
+				core::vector<uint32_t> candidates;
+				//! whether any two regions of the mip cover a common texel
+				bool overlapping = false;
+			};
+			core::vector<SMip> mips;
+		};
+		inline const SRegionIndex* getRegionIndex() const
+		{
+			// many threads may want it at once, loser of the race throws away its copy
+			const auto* index = m_regionIndex.load(std::memory_order_acquire);
+			if (index)
+				return index;
+
+			auto* newIndex = buildRegionIndex();
+			const SRegionIndex* expected = nullptr;
+			if (m_regionIndex.compare_exchange_strong(expected,newIndex,std::memory_order_acq_rel))
+				return newIndex;
+			delete newIndex;
+			return expected;
+		}
+		inline SRegionIndex* buildRegionIndex() const
+		{
+			// keep the grid small relative to the region count
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxCellsPerRegion = 16u;
+
+			auto* index = new SRegionIndex();
+			index->mips.resize(params.mipLevels);
+			for (uint32_t mipLevel=0u; mipLevel<params.mipLevels; mipLevel++)
+			{
+				auto& mip = index->mips[mipLevel];
+				const auto mipRegions = getRegions(mipLevel);
+				const uint32_t regionCount = mipRegions.size();
+				if (!regionCount)
+					continue;
+
+				const auto mipSize = getMipSize(mipLevel);
+				const uint32_t extent[4] = {mipSize.x,mipSize.y,mipSize.z,params.arrayLayers};
+				// cells as big as an average region
+				uint64_t regionSizeSum[4] = {0ull,0ull,0ull,0ull};
+				for (const auto& region : mipRegions)
+				{
+					regionSizeSum[0] += region.imageExtent.width;
+					regionSizeSum[1] += region.imageExtent.height;
+					regionSizeSum[2] += region.imageExtent.depth;
+					regionSizeSum[3] += region.imageSubresource.layerCount;
+				}
+				uint64_t totalCells = 1ull;
+				for (auto i=0; i<4; i++)
+				{
+					mip.cellSize[i] = core::max<uint32_t>(regionSizeSum[i]/regionCount,1u);
+					mip.cellCount[i] = (extent[i]+mip.cellSize[i]-1u)/mip.cellSize[i];
+					totalCells *= mip.cellCount[i];
+				}
+				while (totalCells>uint64_t(regionCount)*MaxCellsPerRegion)
+				{
+					auto i = std::max_element(mip.cellCount,mip.cellCount+4)-mip.cellCount;
+					totalCells /= mip.cellCount[i];
+					mip.cellSize[i] *= 2u;
+					mip.cellCount[i] = (extent[i]+mip.cellSize[i]-1u)/mip.cellSize[i];
+					totalCells *= mip.cellCount[i];
+				}
+
+				// two passes, count then fill
+				auto forEachOverlappedCell = [&](const IImage::SBufferCopy& region, auto&& f) -> void
+				{
+					const uint32_t regionMin[4] = {region.imageOffset.x,region.imageOffset.y,region.imageOffset.z,region.imageSubresource.baseArrayLayer};
+					const uint32_t regionExtent[4] = {region.imageExtent.width,region.imageExtent.height,region.imageExtent.depth,region.imageSubresource.layerCount};
+					uint32_t cellMin[4],cellMax[4];
+					for (auto i=0; i<4; i++)
+					{
+						if (!regionExtent[i] || regionMin[i]>=extent[i])
+							return;
+						cellMin[i] = regionMin[i]/mip.cellSize[i];
+						cellMax[i] = core::min(regionMin[i]+regionExtent[i]-1u,extent[i]-1u)/mip.cellSize[i];
+					}
+					for (uint32_t w=cellMin[3]; w<=cellMax[3]; w++)
+					for (uint32_t z=cellMin[2]; z<=cellMax[2]; z++)
+					for (uint32_t y=cellMin[1]; y<=cellMax[1]; y++)
+					for (uint32_t x=cellMin[0]; x<=cellMax[0]; x++)
+						f(((w*mip.cellCount[2]+z)*mip.cellCount[1]+y)*mip.cellCount[0]+x);
+				};
+				mip.cellOffsets.assign(totalCells+1ull,0u);
+				for (const auto& region : mipRegions)
+					forEachOverlappedCell(region,[&](uint32_t cell) {mip.cellOffsets[cell+1u]++;});
+				std::inclusive_scan(mip.cellOffsets.begin(),mip.cellOffsets.end(),mip.cellOffsets.begin());
+				mip.candidates.resize(mip.cellOffsets.back());
+				core::vector<uint32_t> cursor(mip.cellOffsets.begin(),mip.cellOffsets.end()-1u);
+				for (auto it=std::reverse_iterator(mipRegions.end()); it!=std::reverse_iterator(mipRegions.begin()); it++)
+				{
+					const uint32_t regionID = &(*it)-regions->begin();
+					forEachOverlappedCell(*it,[&](uint32_t cell) {mip.candidates[cursor[cell]++] = regionID;});
+				}
+
+				// only regions sharing a cell can intersect
+				auto intersect = [](const IImage::SBufferCopy& a, const IImage::SBufferCopy& b) -> bool
+				{
+					const uint32_t aMin[4] = {a.imageOffset.x,a.imageOffset.y,a.imageOffset.z,a.imageSubresource.baseArrayLayer};
+					const uint32_t aExtent[4] = {a.imageExtent.width,a.imageExtent.height,a.imageExtent.depth,a.imageSubresource.layerCount};
+					const uint32_t bMin[4] = {b.imageOffset.x,b.imageOffset.y,b.imageOffset.z,b.imageSubresource.baseArrayLayer};
+					const uint32_t bExtent[4] = {b.imageExtent.width,b.imageExtent.height,b.imageExtent.depth,b.imageSubresource.layerCount};
+					for (auto i=0; i<4; i++)
+					if (aMin[i]>=bMin[i]+bExtent[i] || bMin[i]>=aMin[i]+aExtent[i])
+						return false;
+					return true;
+				};
+				for (uint64_t cell=0ull; cell<totalCells && !mip.overlapping; cell++)
+				for (uint32_t i=mip.cellOffsets[cell]; i<mip.cellOffsets[cell+1u] && !mip.overlapping; i++)
+				for (uint32_t j=i+1u; j<mip.cellOffsets[cell+1u] && !mip.overlapping; j++)
+					mip.overlapping = intersect(regions->begin()[mip.candidates[i]],regions->begin()[mip.candidates[j]]);
+			}
+			return index;
+		}
+		inline void invalidateRegionIndex()
+		{
+			delete m_regionIndex.exchange(nullptr,std::memory_order_acq_rel);
+		}
+
+		mutable std::atomic<const SRegionIndex*> m_regionIndex = nullptr;
 };
 
 } // end namespace video
@@ -5,6 +5,9 @@
 #ifndef __NBL_ASSET_I_CPU_MESH_H_INCLUDED__
 #define __NBL_ASSET_I_CPU_MESH_H_INCLUDED__
 
+#include <algorithm>
+#include <execution>
+
 #include "nbl/asset/IMesh.h"
 #include "nbl/asset/IAsset.h"
 #include "nbl/asset/ICPUMeshBuffer.h"
@@ -46,6 +49,21 @@ class ICPUMesh final : public IMesh<ICPUMeshBuffer>, public BlobSerializable, pu
 			return m_meshBuffers;
 		}
 
+		//! Calls `f(ICPUMeshBuffer*)` for every distinct meshbuffer concurrently on a worker pool
+		/** A meshbuffer which is in the mesh more than once still gets visited only once, so `f` may modify it. */
+		template<typename F>
+		inline void forEachMeshBufferParallel(F&& f)
+		{
+			assert(!isImmutable_debug());
+			core::vector<ICPUMeshBuffer*> meshbuffers;
+			meshbuffers.reserve(m_meshBuffers.size());
+			for (const auto& meshbuffer : m_meshBuffers)
+				meshbuffers.push_back(meshbuffer.get());
+			std::sort(meshbuffers.begin(),meshbuffers.end());
+			meshbuffers.erase(std::unique(meshbuffers.begin(),meshbuffers.end()),meshbuffers.end());
+			std::for_each(std::execution::par,meshbuffers.begin(),meshbuffers.end(),[&f](ICPUMeshBuffer* meshbuffer) -> void {f(meshbuffer);});
+		}
+
 		//!
 		inline const core::aabbox3df& getBoundingBox() const // needed so the compiler doesn't freak out
 		{
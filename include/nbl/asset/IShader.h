@@ -47,6 +47,24 @@ class IShader : public virtual core::IReferenceCounted
 			insertAfterVersionAndPragmaShaderStage(_glsl, insertion);
 		}
 
+		//! Inserts `#define name value` for every pair, an empty value just defines the name
+		static inline void insertGLSLDefines(std::string& _glsl, const std::pair<std::string,std::string>* _begin, const std::pair<std::string,std::string>* _end)
+		{
+			if (_begin==_end)
+				return;
+
+			std::string insertion = "\n";
+			for (auto it=_begin; it!=_end; it++)
+			{
+				insertion += "#define "+it->first;
+				if (!it->second.empty())
+					insertion += " "+it->second;
+				insertion += "\n";
+			}
+
+			insertAfterVersionAndPragmaShaderStage(_glsl, insertion);
+		}
+
 protected:
 	static inline std::string genGLSLExtensionDefines(const core::refctd_dynamic_array<std::string>* _exts)
 	{
@@ -46,6 +46,7 @@
 #include "nbl/asset/utils/IBuiltinIncludeLoader.h"
 #include "nbl/asset/utils/IGLSLCompiler.h"
 #include "nbl/asset/utils/CShaderIntrospector.h"
+#include "nbl/asset/utils/CShaderVariantCache.h"
 
 // pipelines
 
@@ -61,6 +62,7 @@
 
 // manipulation + reflection + introspection
 #include "nbl/asset/utils/IMeshManipulator.h"
+#include "nbl/asset/utils/CStreamingMeshProcessor.h"
 
 // baw files
 #include "nbl/asset/bawformat/CBAWFile.h"
@@ -62,6 +62,9 @@ currently only supports zip archives, though. */
 //! Define __NBL_COMPILE_WITH_TAR_ARCHIVE_LOADER_ if you want to open TAR archives
 #define __NBL_COMPILE_WITH_TAR_ARCHIVE_LOADER_
 
+//! Define __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_ if you want to open Nabla PacK archives
+#define __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
+
 #define _NBL_FORMAT_VERSION 3
 
 //! @see @ref CBlobsLoadingManager
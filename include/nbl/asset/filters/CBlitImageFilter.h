@@ -51,6 +51,7 @@ class CBlitImageFilterBase : public impl::CSwizzleableAndDitherableFilterBase<No
 				E_ALPHA_SEMANTIC					alphaSemantic = EAS_NONE_OR_PREMULTIPLIED;
 				double								alphaRefValue = 0.5; // only required to make sense if `alphaSemantic==EAS_REFERENCE_OR_COVERAGE`
 				uint32_t							alphaChannel = 3u; // index of the alpha channel (could be different cause of swizzles)
+				bool								stripedScratchWrites = true; // gather output lines in strips before writing them into the transposed scratch, much faster on large images
 		};
 
 	protected:
@@ -200,8 +201,10 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 		static inline uint32_t getRequiredScratchByteSize(const state_type* state)
 		{
 			// need to add the memory for ping pong buffers
-			uint32_t retval = getScratchOffset(state,true);
-			retval += CBlitImageFilterBase<value_type,Normalize,Clamp,Swizzle,Dither>::getRequiredScratchByteSize(state->alphaSemantic,state->outExtentLayerCount);
+			uint32_t retval = getStripScratchOffset(state);
+			// and the strip of lines
+			if (state->stripedScratchWrites)
+				retval += StripLineCount*core::max<uint32_t>(core::max<uint32_t>(state->outExtent.width,state->outExtent.height),state->outExtent.depth)*MaxChannels*sizeof(value_type);
 			return retval;
 		}
 
@@ -241,6 +244,7 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 
 		static inline bool execute(state_type* state)
 		{
+			NBL_PROFILE_SCOPE("CBlitImageFilter::execute","filter");
 			if (!validate(state))
 				return false;
 
@@ -252,6 +256,7 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 			const auto inFormat = inParams.format;
 			const auto outFormat = outParams.format;
 			const auto inBlockDims = asset::getBlockDimensions(inFormat);
+			const bool singleTexelBlocks = (inBlockDims==core::vector3du32_SIMD(1u,1u,1u)).xyzz().all();
 			const auto outBlockDims = asset::getBlockDimensions(outFormat);
 			const auto* const inData = reinterpret_cast<const uint8_t*>(inImg->getBuffer()->getPointer());
 			auto* const outData = reinterpret_cast<uint8_t*>(outImg->getBuffer()->getPointer());
@@ -274,6 +279,7 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 			const auto outExtentLayerCount = state->outExtentLayerCount;
 			const auto inLimit = inOffsetBaseLayer+inExtentLayerCount;
 			const auto outLimit = outOffsetBaseLayer+outExtentLayerCount;
+			NBL_PROFILE_COUNTER(EC_TEXELS_FILTERED,uint64_t(outExtent.width)*outExtent.height*outExtent.depth*layerCount);
 
 			const auto* const axisWraps = state->axisWraps;
 			const bool nonPremultBlendSemantic = state->alphaSemantic==CState::EAS_SEPARATE_BLEND;
@@ -307,6 +313,7 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 				reinterpret_cast<value_type*>(state->scratchMemory+getScratchOffset(state,false)),
 				reinterpret_cast<value_type*>(state->scratchMemory)
 			};
+			value_type* const stripStorage = reinterpret_cast<value_type*>(state->scratchMemory+getStripScratchOffset(state));
 			const core::vectorSIMDu32 intermediateStrides[3] = {
 				core::vectorSIMDu32(MaxChannels*intermediateExtent[0].y,MaxChannels,MaxChannels*intermediateExtent[0].x*intermediateExtent[0].y,0u),
 				core::vectorSIMDu32(MaxChannels*intermediateExtent[1].y*intermediateExtent[1].z,MaxChannels*intermediateExtent[1].z,MaxChannels,0u),
@@ -410,6 +417,22 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 					// x y z output along z
 					const int loopCoordID[2] = {axis!=IImage::ET_3D ? 2:0,axis!=IImage::ET_2D ? 1:0/*,axis*/};
 
+					// intermediate storage is transposed so that the next pass reads contiguous lines, which makes this pass write with a large stride,
+					// so consecutive lines get filtered into a strip first and then written out such that neighbouring lines end up in the same cache lines
+					const bool useStrips = state->stripedScratchWrites && (coverageSemantic||!lastPass) && intermediateStrides[axis][axis]!=MaxChannels;
+					const auto lineLength = outExtentLayerCount[axis];
+					auto flushStrip = [&](core::vectorSIMDi32 firstLineCoord, const uint32_t stripLineCount) -> void
+					{
+						const auto lineStride = intermediateStrides[axis][loopCoordID[1]];
+						for (auto& i=(firstLineCoord[axis]=0); i<lineLength; i++)
+						{
+							value_type* dst = intermediateStorage[axis]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),firstLineCoord)[0];
+							const value_type* src = stripStorage+i*MaxChannels;
+							for (uint32_t s=0u; s<stripLineCount; s++,dst+=lineStride,src+=lineLength*MaxChannels)
+								std::copy(src,src+MaxChannels,dst);
+						}
+					};
+
 					core::vectorSIMDi32 localTexCoord;
 					for (auto& k=(localTexCoord[loopCoordID[0]]=0); k<intermediateExtent[axis][loopCoordID[0]]; k++)
 					for (auto& j=(localTexCoord[loopCoordID[1]]=0); j<intermediateExtent[axis][loopCoordID[1]]; j++)
@@ -423,13 +446,26 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 						{
 							lineBuffer = intermediateStorage[1];
 							const auto windowEnd = inExtent.width+window_last.x;
+							// texels along a region's row are contiguous, only look the region up again when leaving the run,
+							// runs of images with overlapping regions are single blocks so the last region covering a texel still wins
+							ICPUImage::SConstTexelBlockRun run;
+							core::vectorSIMDu32 runTexelCoord;
 							for (auto& i=localTexCoord.x; i<windowEnd; i++)
 							{
 								core::vectorSIMDi32 globalTexelCoord(localTexCoord+windowMinCoord);
 
-								core::vectorSIMDu32 inBlockCoord;
-								const void* srcPix[] = { // multiple loads for texture boundaries aren't that bad
-									inImg->getTexelBlockData(inMipLevel,inImg->wrapTextureCoordinate(inMipLevel,globalTexelCoord,axisWraps),inBlockCoord),
+								core::vectorSIMDu32 inBlockCoord(0u,0u,0u,0u);
+								const auto wrappedTexelCoord = inImg->wrapTextureCoordinate(inMipLevel,globalTexelCoord,axisWraps);
+								if (singleTexelBlocks && run.blockCount>1u && (wrappedTexelCoord==runTexelCoord+core::vectorSIMDu32(1u,0u,0u,0u)).all())
+								{
+									run.data = reinterpret_cast<const uint8_t*>(run.data)+run.blockByteSize;
+									run.blockCount--;
+								}
+								else // multiple loads for texture boundaries aren't that bad
+									run = inImg->getTexelBlockRun(inMipLevel,wrappedTexelCoord,inBlockCoord);
+								runTexelCoord = wrappedTexelCoord;
+								const void* srcPix[] = {
+									run.data,
 									nullptr,
 									nullptr,
 									nullptr
@@ -457,11 +493,13 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 								}
 							}
 						}
+						const uint32_t stripLine = j%StripLineCount;
 						// TODO: this loop should probably get rewritten
 						for (auto& i=(localTexCoord[axis]=0); i<outExtentLayerCount[axis]; i++)
 						{
 							// get output pixel
-							auto* const value = intermediateStorage[axis]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),localTexCoord)[0];
+							auto* const value = useStrips ? (stripStorage+(stripLine*lineLength+i)*MaxChannels):
+								(intermediateStorage[axis]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),localTexCoord)[0]);
 							std::fill(value,value+MaxChannels,value_type(0));
 							// kernel load functor
 							auto load = [axis,&windowMinCoord,lineBuffer](value_type* windowSample, const core::vectorSIMDf& unused0, const core::vectorSIMDi32& globalTexelCoord, const IImageFilterKernel::UserData* userData) -> void
@@ -497,6 +535,12 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 								storeToTexel(value,outImg->getTexelBlockData(outMipLevel,localOutPos,dummy),localOutPos);
 							}
 						}
+						if (useStrips && (stripLine==StripLineCount-1u || j==intermediateExtent[axis][loopCoordID[1]]-1))
+						{
+							core::vectorSIMDi32 firstLineCoord(localTexCoord);
+							firstLineCoord[loopCoordID[1]] -= stripLine;
+							flushStrip(firstLineCoord,stripLine+1u);
+						}
 					}
 					// we'll only get here if we have to do coverage adjustment
 					if (coverageSemantic && lastPass)
@@ -514,6 +558,9 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 		}
 
 	private:
+		// enough lines to fill whole cache lines when written out transposed
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t StripLineCount = 16u;
+
 		// the blit filter will filter one axis at a time, hence necessitating "ping ponging" between two scratch buffers
 		static inline uint32_t getScratchOffset(const state_type* state, bool secondPong)
 		{
@@ -536,6 +583,11 @@ class CBlitImageFilter : public CImageFilter<CBlitImageFilter<Normalize,Clamp,Sw
 			// obviously we have multiple channels and each channel has a certain type for arithmetic
 			return texelCount*MaxChannels*sizeof(value_type);
 		}
+		// strip goes after the ping pong buffers and the coverage adjustment memory
+		static inline uint32_t getStripScratchOffset(const state_type* state)
+		{
+			return getScratchOffset(state,true)+CBlitImageFilterBase<value_type,Normalize,Clamp,Swizzle,Dither>::getRequiredScratchByteSize(state->alphaSemantic,state->outExtentLayerCount);
+		}
 };
 
 } // end namespace asset
@@ -258,92 +258,48 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 				}
 
 				{
-					auto getScratchPixel = [&](core::vector4di32_SIMD readBlockPos) -> decodeType*
+					/*
+						The table is separable, so instead of gathering 7 neighbours for every texel it gets computed
+						as a prefix sum along X, then Y, then Z. Every pass streams through the scratch in memory order,
+						the Y and Z passes add whole previous rows and slices which vectorizes and doesn't thrash the cache on large images.
+					*/
+					const size_t rowLength = size_t(state->extent.width) * currentChannelCount;
+					const size_t rowStride = scratchByteStrides[1] / sizeof(decodeType);
+					const size_t sliceStride = scratchByteStrides[2] / sizeof(decodeType);
+
+					auto addRow = [](decodeType* dst, const decodeType* src, const size_t count) -> void
 					{
-						const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(readBlockPos.x, readBlockPos.y, readBlockPos.z, 0), scratchByteStrides);
-						return reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
+						for (size_t i = 0u; i < count; ++i)
+							dst[i] += src[i];
 					};
 
-					auto sum = [&](core::vectorSIMDi32 readBlockPos) -> void
+					for (auto z = 0u; z < state->extent.depth; ++z)
 					{
-						decodeType* current = getScratchPixel(readBlockPos);
-
-						auto areAxisSafe = [&]()
-						{
-							const auto position = core::vectorSIMDi32(0u, 0u, 0u, 0u);
-
-							return core::vector4du32_SIMD
-							(
-								readBlockPos.x > position.x,
-								readBlockPos.y > position.y,
-								readBlockPos.z > position.z,
-								readBlockPos.w > position.w
-							);
-						};
-
-						auto addScratchPixelToCurrentOne = [&](const decodeType* values)
-						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] += values[i];
-						};
-						
-						auto substractScratchPixelFromCurrentOne = [&](const decodeType* values)
-						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] -= values[i];
-						};
-
-						const auto axisSafe = areAxisSafe();
-
-						if (axisSafe.z)
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 0, 1, 0)));					// add box x<=current_x && y<=current_y && z<current_z
-						if (axisSafe.y)
+						decodeType* slice = scratchMemory + z * sliceStride;
+						for (auto y = 0u; y < state->extent.height; ++y)
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 0, 0)));					// add box x<=current_x && y<current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 1, 0)));		// remove overlap box x<=current_x && y<current_y && z<current_z
+							decodeType* row = slice + y * rowStride;
+							for (size_t x = currentChannelCount; x < rowLength; ++x)
+								row[x] += row[x - currentChannelCount];
+							if (y)
+								addRow(row, row - rowStride, rowLength);
 						}
+						if (z)
+							addRow(slice, slice - sliceStride, sliceStride);
+					}
 
-						/*
-							Now I have the sum of all layers below me in the bound x<=current_x && y<=current_y && z<current_z and the current pixel.
-							Time to add the missing top layer pixels.
-						*/
-
-						if (axisSafe.x)
+					for (auto z = 0u; z < state->extent.depth; ++z)
+						for (auto y = 0u; y < state->extent.height; ++y)
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 0, 0)));					 // add box x<current_x && y<=current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 1, 0)));		 // remove overlap box x<current_x && y<=current_y && z<current_z
-							if (axisSafe.y)
-							{
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 0, 0)));		 // remove future overlap box x<current_x && y<current_y && z<=current_z
-								if (axisSafe.z)
-									addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 1, 0)));			 // add box x<current_x && y<current_y && z<current_z
-							}
+							const decodeType* row = scratchMemory + z * sliceStride + y * rowStride;
+							for (size_t x = 0u; x < rowLength; x += currentChannelCount)
+								for (auto i = 0u; i < currentChannelCount; ++i)
+								{
+									maxDecodeValues[i] = core::max(maxDecodeValues[i], row[x + i]);
+									minDecodeValues[i] = core::min(minDecodeValues[i], row[x + i]);
+								}
 						}
 
-						std::for_each(current, current + currentChannelCount,
-							[&](const decodeType& itrValue)
-							{
-								uint8_t offset = &itrValue - current;
-
-								if (maxDecodeValues[offset] < itrValue)
-									maxDecodeValues[offset] = itrValue;
-
-								if (minDecodeValues[offset] > itrValue)
-									minDecodeValues[offset] = itrValue;
-							}
-						);
-					};
-
-					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z)
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									sum(core::vectorSIMDu32(x, y, z));
-					}
-
 					auto normalizeScratch = [&](bool isSignedFormat)
 					{
 						core::vector3du32_SIMD localCoord;
@@ -1840,6 +1840,7 @@ namespace asset
             }
 
             inline const auto& getDimension() const { return dimension; }
+            inline uint32_t getBlockByteSize() const { return blockByteSize; }
 
         private:
             core::vector3du32_SIMD dimension;
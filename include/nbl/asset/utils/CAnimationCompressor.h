@@ -0,0 +1,173 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_ANIMATION_COMPRESSOR_H_INCLUDED__
+#define __NBL_ASSET_C_ANIMATION_COMPRESSOR_H_INCLUDED__
+
+#include "nbl/core/core.h"
+#include "nbl/asset/ICPUAnimationLibrary.h"
+#include "nbl/asset/ICPUSkeleton.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Lossy offline compressor for the keyframes of an ICPUAnimationLibrary.
+/** Keys which can be reconstructed by interpolating their neighbours within the error tolerance get removed,
+rotations get quantized to 32 bit smallest-three and translations and scales to 16 bit relative to the range of their animation,
+channels which are constant over a whole animation only get stored once.
+
+The error is measured in joint space on virtual vertices at `SParameters::shellDistance` from the joint origin (or further if the
+joint has descendants further away), if a skeleton is provided the tolerance of every joint is split across the longest
+chain of joints passing through it, so that the error accumulated down the hierarchy stays within tolerance.
+
+The result gets decompressed by `CAnimationSampler`.
+*/
+class CAnimationCompressor
+{
+		// private, undefined constructor
+		CAnimationCompressor() = delete;
+
+	public:
+		using timestamp_t = ICPUAnimationLibrary::timestamp_t;
+		using Animation = ICPUAnimationLibrary::Animation;
+
+		struct SCompressedAnimations
+		{
+			struct SAnimation
+			{
+				_NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidOffset = 0xffffffffu;
+
+				//! offset and count into `timestamps` and `rotations`
+				Animation animation;
+				//! offset into `translations` and `scales` in elements of 3 channels, `InvalidOffset` if constant
+				uint32_t translationOffset;
+				uint32_t scaleOffset;
+				float translationMin[3];
+				float translationExtent[3];
+				float scaleMin[3];
+				float scaleExtent[3];
+			};
+
+			_NBL_STATIC_INLINE_CONSTEXPR float RootTwo = 1.41421356237f;
+
+			//! smallest-three quaternion, 2 bits for the index of the dropped largest component, 10 bits for each of the others
+			static inline uint32_t encodeRotation(const core::vectorSIMDf& _quat);
+			static inline core::vectorSIMDf decodeRotation(uint32_t _encoded);
+			//! range-relative 16 bit per channel
+			static inline void encodeRangeRelative(uint16_t* _out, const core::vectorSIMDf& _value, const float* _min, const float* _extent);
+			static inline core::vectorSIMDf decodeRangeRelative(const uint16_t* _in, const float* _min, const float* _extent);
+
+			inline size_t getSize() const
+			{
+				return	animations.size()*sizeof(SAnimation)+timestamps.size()*sizeof(timestamp_t)+rotations.size()*sizeof(uint32_t)+
+						(translations.size()+scales.size())*sizeof(uint16_t);
+			}
+
+			core::vector<SAnimation> animations;
+			core::vector<timestamp_t> timestamps;
+			core::vector<uint32_t> rotations;
+			core::vector<uint16_t> translations;
+			core::vector<uint16_t> scales;
+		};
+
+		struct SParameters
+		{
+			//! maximum allowed error in joint space, in units of the translations
+			float tolerance = 0.0001f;
+			//! distance of the virtual vertices at which rotation and scale errors get measured
+			float shellDistance = 0.03f;
+			//! optional, enables hierarchical error propagation
+			const ICPUSkeleton* skeleton = nullptr;
+			//! one animation ID per joint of `skeleton`, joints driven by invalid IDs are considered static
+			const uint32_t* jointAnimationIDs = nullptr;
+		};
+
+		struct SReport
+		{
+			size_t originalSize = 0ull;
+			size_t compressedSize = 0ull;
+			uint32_t originalKeyframeCount = 0u;
+			uint32_t compressedKeyframeCount = 0u;
+			//! measured on the decompressed data at every original keyframe
+			float maxJointSpaceError = 0.f;
+			uint32_t maxErrorAnimationID = 0u;
+			//! kept keyframes whose quantization alone exceeds the tolerance of their animation
+			uint32_t keptOverTolerance = 0u;
+
+			inline float getCompressionRatio() const
+			{
+				return compressedSize ? float(originalSize)/float(compressedSize):0.f;
+			}
+		};
+
+		static SCompressedAnimations compress(const ICPUAnimationLibrary* _library, const SParameters& _params, SReport* _report=nullptr);
+};
+
+
+inline uint32_t CAnimationCompressor::SCompressedAnimations::encodeRotation(const core::vectorSIMDf& _quat)
+{
+	uint32_t largest = 0u;
+	for (uint32_t c=1u; c<4u; c++)
+	if (std::abs(_quat[c])>std::abs(_quat[largest]))
+		largest = c;
+	// q and -q are the same rotation, make the dropped component positive
+	const float sign = _quat[largest]<0.f ? -1.f:1.f;
+
+	uint32_t encoded = largest<<30u;
+	uint32_t shift = 20u;
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		if (c==largest)
+			continue;
+		// other components are within [-1/sqrt(2),1/sqrt(2)]
+		const float normalized = core::clamp(_quat[c]*sign*RootTwo*0.5f+0.5f,0.f,1.f);
+		encoded |= uint32_t(normalized*1023.f+0.5f)<<shift;
+		shift -= 10u;
+	}
+	return encoded;
+}
+
+inline core::vectorSIMDf CAnimationCompressor::SCompressedAnimations::decodeRotation(uint32_t _encoded)
+{
+	const uint32_t largest = _encoded>>30u;
+	core::vectorSIMDf retval;
+	float sumSq = 0.f;
+	uint32_t shift = 20u;
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		if (c==largest)
+			continue;
+		const float value = (float((_encoded>>shift)&0x3ffu)/1023.f*2.f-1.f)/RootTwo;
+		retval[c] = value;
+		sumSq += value*value;
+		shift -= 10u;
+	}
+	retval[largest] = core::sqrt(core::max(1.f-sumSq,0.f));
+	return retval;
+}
+
+inline void CAnimationCompressor::SCompressedAnimations::encodeRangeRelative(uint16_t* _out, const core::vectorSIMDf& _value, const float* _min, const float* _extent)
+{
+	for (uint32_t c=0u; c<3u; c++)
+	{
+		const float normalized = _extent[c]>0.f ? core::clamp((_value[c]-_min[c])/_extent[c],0.f,1.f):0.f;
+		_out[c] = uint16_t(normalized*65535.f+0.5f);
+	}
+}
+
+inline core::vectorSIMDf CAnimationCompressor::SCompressedAnimations::decodeRangeRelative(const uint16_t* _in, const float* _min, const float* _extent)
+{
+	return core::vectorSIMDf(
+		_min[0]+float(_in[0])/65535.f*_extent[0],
+		_min[1]+float(_in[1])/65535.f*_extent[1],
+		_min[2]+float(_in[2])/65535.f*_extent[2]
+	);
+}
+
+}
+}
+
+#endif
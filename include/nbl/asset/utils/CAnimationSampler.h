@@ -0,0 +1,143 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_ANIMATION_SAMPLER_H_INCLUDED__
+#define __NBL_ASSET_C_ANIMATION_SAMPLER_H_INCLUDED__
+
+#include "nbl/core/core.h"
+#include "nbl/asset/ICPUAnimationLibrary.h"
+#include "nbl/asset/ICPUSkeleton.h"
+#include "nbl/asset/utils/CAnimationCompressor.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! CPU counterpart of the keyframe sampling in `nbl/builtin/glsl/scene/keyframe.glsl`, for simulation and offline baking.
+/** All the keyframes of the library get decoded once into SoA "fat keyframes" at construction,
+so sampling is a binary search per sample followed by SIMD interpolation of 4 samples at a time.
+Everything is done in SoA form and split across threads, a sample is any (animation,time) pair.
+
+`EIM_NEAREST` animations behave like glTF's STEP (the previous keyframe is held until the next one),
+`EIM_CUBIC` has no tangents stored in `Keyframe` so it falls back to `EIM_LINEAR`.
+Sampling before the first or after the last keyframe clamps.
+*/
+class CAnimationSampler final : public core::IReferenceCounted
+{
+	public:
+		using timestamp_t = ICPUAnimationLibrary::timestamp_t;
+		using joint_id_t = ICPUSkeleton::joint_id_t;
+		using Animation = ICPUAnimationLibrary::Animation;
+
+		//! How rotations between two keyframes get interpolated
+		enum E_ROTATION_INTERPOLATION : uint32_t
+		{
+			//! normalized linear interpolation, cheapest, non-constant angular velocity
+			ERI_NLERP = 0u,
+			//! Kapoulkine's approximate slerp, same as `core::quaternion::flerp` and the GPU path
+			ERI_FLERP,
+			//! exact spherical interpolation
+			ERI_SLERP
+		};
+
+		//! SoA local space transforms (translation, rotation quaternion, scale), i.e. the result of sampling or a pose
+		struct STransforms
+		{
+			enum E_CHANNEL : uint32_t
+			{
+				EC_TRANSLATION_X = 0u,
+				EC_TRANSLATION_Y,
+				EC_TRANSLATION_Z,
+				EC_ROTATION_X,
+				EC_ROTATION_Y,
+				EC_ROTATION_Z,
+				EC_ROTATION_W,
+				EC_SCALE_X,
+				EC_SCALE_Y,
+				EC_SCALE_Z,
+				EC_COUNT
+			};
+
+			inline void resize(size_t _count)
+			{
+				count = _count;
+				storage.resize(_count*EC_COUNT);
+			}
+			inline float* getChannel(E_CHANNEL _channel) { return storage.data()+_channel*count; }
+			inline const float* getChannel(E_CHANNEL _channel) const { return storage.data()+_channel*count; }
+
+			size_t count = 0ull;
+			core::vector<float> storage;
+		};
+
+		//! Joints of a skeleton sorted by depth in the hierarchy, so that parents always get finished before their children.
+		struct SJointHierarchy
+		{
+			SJointHierarchy() = default;
+			SJointHierarchy(const ICPUSkeleton* _skeleton);
+
+			inline uint32_t getJointCount() const { return parentIDs.size(); }
+			inline uint32_t getLevelCount() const { return levelEnds.size(); }
+
+			core::vector<joint_id_t> parentIDs;
+			//! joint IDs sorted by depth
+			core::vector<joint_id_t> sortedJoints;
+			//! exclusive end of every depth level in `sortedJoints`
+			core::vector<uint32_t> levelEnds;
+		};
+
+		//! Decodes all keyframes of the library, the library can be dropped afterwards
+		CAnimationSampler(const ICPUAnimationLibrary* _library);
+		//! Decompresses the output of `CAnimationCompressor`
+		CAnimationSampler(const CAnimationCompressor::SCompressedAnimations& _compressed);
+
+		inline uint32_t getAnimationCount() const { return m_animations.size(); }
+		inline uint32_t getKeyframeCount() const { return m_timestamps.size(); }
+
+		//! Samples `_animationIDs[i]` at `_times[i]` into `_out[i]` for `_count` samples.
+		void sample(STransforms& _out, const uint32_t* _animationIDs, const timestamp_t* _times, size_t _count, E_ROTATION_INTERPOLATION _rotationMode=ERI_FLERP) const;
+		//! Same as above but all animations get sampled at the same time, i.e. one animation per joint of a skeleton
+		void sample(STransforms& _out, const uint32_t* _animationIDs, timestamp_t _time, size_t _count, E_ROTATION_INTERPOLATION _rotationMode=ERI_FLERP) const;
+
+		//! Weighted blend of `_poseCount` poses of the same size, rotations get nlerped in the hemisphere of the first pose.
+		/** Weights don't need to sum up to 1, they get normalized. */
+		static void blend(STransforms& _out, const STransforms* const* _poses, const float* _weights, uint32_t _poseCount);
+
+		//! Turns TRS into local affine matrices, same as `matrix3x4SIMD::setScaleRotationAndTranslation`
+		static void constructMatrices(core::matrixSIMDBatch::affine_matrices_t _out, const STransforms& _in);
+
+		//! Computes global joint transforms for `_instanceCount` instances of the same skeleton.
+		/** Both SoA views hold `_instanceCount*_hierarchy.getJointCount()` matrices, instance after instance in joint order.
+		Every level of the hierarchy gets concatenated in parallel across all instances with the batched matrix kernels.
+		Must not be done in-place.
+		*/
+		static void computeGlobalTransforms(core::matrixSIMDBatch::affine_matrices_t _global, core::matrixSIMDBatch::const_affine_matrices_t _local, const SJointHierarchy& _hierarchy, uint32_t _instanceCount=1u);
+
+	protected:
+		virtual ~CAnimationSampler() = default;
+
+		//! results of the timestamp search
+		struct SKeyframePair
+		{
+			uint32_t first;
+			uint32_t second;
+			float fraction;
+		};
+		inline SKeyframePair findKeyframes(uint32_t _animationID, timestamp_t _time) const;
+		void interpolate(STransforms& _out, const SKeyframePair* _pairs, size_t _begin, size_t _end, E_ROTATION_INTERPOLATION _rotationMode) const;
+
+		template<typename TimeAccessor>
+		void sample_impl(STransforms& _out, const uint32_t* _animationIDs, TimeAccessor _time, size_t _count, E_ROTATION_INTERPOLATION _rotationMode) const;
+
+		core::vector<Animation> m_animations;
+		core::vector<timestamp_t> m_timestamps;
+		//! decoded keyframes
+		STransforms m_keyframes;
+};
+
+}
+}
+
+#endif
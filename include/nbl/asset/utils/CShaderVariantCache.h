@@ -0,0 +1,161 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_SHADER_VARIANT_CACHE_H_INCLUDED__
+#define __NBL_ASSET_C_SHADER_VARIANT_CACHE_H_INCLUDED__
+
+#include <mutex>
+
+#include "nbl/asset/ICPUSpecializedShader.h"
+#include "nbl/asset/utils/IGLSLCompiler.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Hands out one shared shader per unique permutation of a GLSL template and its `#define`s
+/**
+Define sets get canonicalized (sorted by name, the last definition of a name wins), so the order they come in doesn't matter.
+A permutation seen before gets its shader back straight away, a new one gets its includes resolved by the `IGLSLCompiler` (if there is one)
+and looked up by that preprocessed source, so different templates or define sets which end up as the same code still share a shader.
+The shaders handed out contain the template with the defines inserted, not the preprocessed source.
+Specialized shaders are shared when both the unspecialized shader and the whole `SInfo` (apart from the file path hint) match.
+Only the most recently used permutations are kept, a template, source or specialized shader gets forgotten once no permutation left uses it.
+
+Thread-safe, the preprocessing happens outside the lock. The shaders are shared, so don't modify them or convert them to dummies while the cache is in use.
+*/
+class CShaderVariantCache : public core::IReferenceCounted
+{
+	public:
+		using define_t = std::pair<std::string,std::string>;
+
+		struct SStatistics
+		{
+			//! `getShader` calls, including the ones `getSpecializedShader` makes
+			uint64_t requests = 0ull;
+			//! same template, defines, stage and origin as an earlier request
+			uint64_t permutationHits = 0ull;
+			//! new permutation, but preprocessed to the source of an existing shader
+			uint64_t sourceHits = 0ull;
+			uint64_t specializedRequests = 0ull;
+			uint64_t specializedHits = 0ull;
+			//! permutations forgotten to stay within the capacity
+			uint64_t evictions = 0ull;
+			uint32_t uniqueShaders = 0u;
+			uint32_t uniqueSpecializedShaders = 0u;
+
+			inline double getHitRate() const
+			{
+				return requests ? double(permutationHits+sourceHits)/double(requests):0.0;
+			}
+			inline double getSpecializedHitRate() const
+			{
+				return specializedRequests ? double(specializedHits)/double(specializedRequests):0.0;
+			}
+		};
+
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t DefaultMaxPermutations = 1024u;
+
+		//! Without a compiler only identical permutations (after canonicalization) get shared
+		CShaderVariantCache(core::smart_refctd_ptr<IGLSLCompiler>&& _compiler=nullptr, uint32_t _maxPermutations=DefaultMaxPermutations)
+			: m_compiler(std::move(_compiler)), m_permutations(core::max(_maxPermutations,2u)) {}
+
+		//! Sorts by name and drops all but the last definition of every name
+		static void canonicalizeDefines(core::vector<define_t>& _defines);
+
+		//! An empty define value only defines the name, returns nullptr if the includes can't be resolved
+		core::smart_refctd_ptr<ICPUShader> getShader(const std::string& _glslTemplate, const define_t* _definesBegin, const define_t* _definesEnd, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath=nullptr);
+
+		//! The origin path for includes is `_info.m_filePathHint`
+		core::smart_refctd_ptr<ICPUSpecializedShader> getSpecializedShader(const std::string& _glslTemplate, const define_t* _definesBegin, const define_t* _definesEnd, ISpecializedShader::SInfo&& _info);
+
+		SStatistics getStatistics() const;
+
+		//! Drops all the shaders, leaves the statistics alone
+		void clear();
+
+	protected:
+		~CShaderVariantCache() = default;
+
+	private:
+		struct SPermutationKey
+		{
+			uint32_t templateID;
+			ISpecializedShader::E_SHADER_STAGE stage;
+			//! canonical defines, every name and value terminated by a '\0'
+			std::string defines;
+			std::string originFilepath;
+
+			inline bool operator==(const SPermutationKey& other) const
+			{
+				return templateID==other.templateID && stage==other.stage && defines==other.defines && originFilepath==other.originFilepath;
+			}
+		};
+		struct SPermutationKeyHash
+		{
+			inline size_t operator()(const SPermutationKey& key) const
+			{
+				size_t retval = std::hash<std::string>()(key.defines);
+				retval ^= std::hash<std::string>()(key.originFilepath)+0x9e3779b9ull+(retval<<6)+(retval>>2);
+				return retval^((static_cast<size_t>(key.templateID)<<8ull)|static_cast<size_t>(key.stage));
+			}
+		};
+		//! relative includes in the shader handed out get resolved from the origin, so it has to match too
+		struct SSourceKey
+		{
+			std::string preprocessed;
+			std::string originFilepath;
+
+			inline bool operator==(const SSourceKey& other) const
+			{
+				return preprocessed==other.preprocessed && originFilepath==other.originFilepath;
+			}
+		};
+		struct SSourceKeyHash
+		{
+			inline size_t operator()(const SSourceKey& key) const
+			{
+				return std::hash<std::string>()(key.preprocessed)^(std::hash<std::string>()(key.originFilepath)<<1ull);
+			}
+		};
+		//! `permutationCount` is how many of the cached permutations use it
+		struct STemplate
+		{
+			uint32_t id;
+			uint32_t permutationCount;
+		};
+		struct SSource
+		{
+			core::smart_refctd_ptr<ICPUShader> shader;
+			uint32_t permutationCount;
+		};
+		struct SPermutation
+		{
+			core::smart_refctd_ptr<ICPUShader> shader;
+			//! keys of `m_templates` and `m_sources`, the nodes of unordered maps don't move
+			const std::string* glslTemplate = nullptr;
+			const SSourceKey* source = nullptr;
+		};
+
+		//! forgets what only the evicted permutation used, needs `m_mutex`
+		void onPermutationEvicted(const SPermutationKey& _key, SPermutation&& _permutation);
+
+		core::smart_refctd_ptr<IGLSLCompiler> m_compiler;
+
+		mutable std::mutex m_mutex;
+		//! the templates are usually long and shared by many permutations, so they only get stored once
+		core::unordered_map<std::string,STemplate> m_templates;
+		uint32_t m_nextTemplateID = 0u;
+		core::LRUCache<SPermutationKey,SPermutation,SPermutationKeyHash> m_permutations;
+		core::unordered_map<SSourceKey,SSource,SSourceKeyHash> m_sources;
+		//! an entry for every shader in `m_sources`, gets dropped together with it
+		core::unordered_map<const ICPUShader*,core::map<ISpecializedShader::SInfo,core::smart_refctd_ptr<ICPUSpecializedShader>>> m_specialized;
+		SStatistics m_stats;
+};
+
+}
+}
+
+#endif
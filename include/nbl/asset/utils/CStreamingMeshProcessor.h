@@ -0,0 +1,278 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_STREAMING_MESH_PROCESSOR_H_INCLUDED__
+#define __NBL_ASSET_C_STREAMING_MESH_PROCESSOR_H_INCLUDED__
+
+#include <memory>
+
+#include "IFileSystem.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+class IAssetManager;
+
+//! Welds, generates normals for, optimizes and quantizes meshes which don't fit in memory, by splitting them into spatial chunks on disk
+/**
+The triangles get streamed from an `ITriangleSource` twice, first to find the bounds, then to bin them by centroid into a grid of chunk files in the scratch directory.
+Binary STL, binary PLY and OBJ files have sources which never hold the whole mesh, see `createFileSource`.
+Every chunk also gets a halo of all the neighbouring triangles which could share a vertex with it, so that the smooth normals on both sides of a chunk boundary
+come out the same, the halo gets dropped right after. Then every chunk goes through `IMeshManipulator::createOptimizedMeshBuffer` and gets written out as its own file.
+Positions are never moved, so the chunks stay watertight along their boundaries.
+
+The chunks get processed in parallel waves, biggest first, each wave only takes as many as fit into `SParams::memoryBudget` by a conservative per triangle estimate.
+*/
+class CStreamingMeshProcessor
+{
+	public:
+		//! Where the triangles come from, each is 3 positions of 3 floats
+		class ITriangleSource
+		{
+			public:
+				virtual ~ITriangleSource() = default;
+
+				//! Goes back to the first triangle, the source gets read twice
+				virtual bool reset() = 0;
+				//! Writes out up to `maxTriangles`, returns how many, 0 once there are no more
+				virtual uint32_t read(float* outPositions, uint32_t maxTriangles) = 0;
+				//! Called once all the triangles are binned, so caches and read buffers can be freed before the chunks get processed
+				virtual void release() {}
+		};
+
+		//! Bytes of vertex positions and read buffers the indexed file sources keep in memory by default
+		_NBL_STATIC_INLINE_CONSTEXPR size_t DefaultSourceCacheByteSize = 0x1ull<<26ull;
+
+		//! Reads a binary STL file a batch at a time, so it's never loaded whole
+		class CBinarySTLSource final : public ITriangleSource
+		{
+			public:
+				CBinarySTLSource(core::smart_refctd_ptr<io::IReadFile>&& _file);
+
+				//! false for ASCII or truncated files
+				inline bool isValid() const { return m_triangleCount!=0u; }
+
+				bool reset() override;
+				uint32_t read(float* outPositions, uint32_t maxTriangles) override;
+				void release() override;
+
+			private:
+				core::smart_refctd_ptr<io::IReadFile> m_file;
+				uint32_t m_triangleCount = 0u;
+				uint32_t m_trianglesRead = 0u;
+				core::vector<uint8_t> m_scratch;
+		};
+
+	private:
+		//! Reads a file sequentially through a buffer, keeps a zero byte after the valid data so text can be parsed in place
+		class CBufferedReader
+		{
+			public:
+				void init(io::IReadFile* _file, const size_t _offset, const size_t _bufferSize);
+				//! Tries to have at least `_bytes` in the buffer, returns how many there are, fewer only at the end of the file
+				size_t ensure(const size_t _bytes);
+				inline const uint8_t* data() const { return m_buffer.data()+m_begin; }
+				inline void consume(const size_t _bytes) { m_begin += _bytes; }
+				//! Line without its end, false at the end of the file, stays valid until the next call
+				bool readLine(const char*& outBegin, const char*& outEnd);
+				//! File offset of `data()`
+				inline size_t tell() const { return m_fileOffset-(m_end-m_begin); }
+				void release();
+
+			private:
+				io::IReadFile* m_file = nullptr;
+				//! of the first byte after the buffered data
+				size_t m_fileOffset = 0ull;
+				size_t m_bufferSize = 0ull;
+				core::vector<uint8_t> m_buffer;
+				size_t m_begin = 0ull;
+				size_t m_end = 0ull;
+		};
+		//! Positions of the vertex records of a file, read a page of records at a time and kept in a bounded least recently used cache
+		/** Faces of scans and remeshed surfaces reference vertices which are close in the file, so only a few pages are ever needed at once. */
+		class CPositionPageCache
+		{
+			public:
+				struct SLayout
+				{
+					//! of the first vertex record
+					size_t offset = 0ull;
+					uint32_t vertexCount = 0u;
+					uint32_t stride = sizeof(float)*3u;
+					uint32_t componentOffsets[3] = {0u,sizeof(float),sizeof(float)*2u};
+					//! components are float otherwise
+					bool doublePrecision = false;
+					bool bigEndian = false;
+				};
+				_NBL_STATIC_INLINE_CONSTEXPR uint32_t VerticesPerPage = 0x1u<<12u;
+
+				void init(io::IReadFile* _file, const SLayout& _layout, const size_t _byteBudget);
+				//! false if the vertex is out of range or its page can't be read
+				bool get(const uint32_t _vertex, float* _outPosition);
+				void release();
+
+			private:
+				_NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidPage = ~0u;
+
+				io::IReadFile* m_file = nullptr;
+				SLayout m_layout;
+				uint32_t m_slotCount = 0u;
+				core::vector<float> m_positions;
+				core::vector<uint32_t> m_slotPages;
+				core::vector<uint64_t> m_slotLastUse;
+				core::unordered_map<uint32_t,uint32_t> m_pageSlots;
+				core::vector<uint8_t> m_scratch;
+				uint64_t m_useCounter = 0ull;
+				//! consecutive corners mostly hit the same page, that one skips the map
+				uint32_t m_lastSlot = 0u;
+		};
+
+	public:
+		//! Reads the faces of a binary PLY file sequentially and looks their vertices up through a `CPositionPageCache`, so it's never loaded whole
+		/** Polygons get split into fans. */
+		class CBinaryPLYSource final : public ITriangleSource
+		{
+			public:
+				CBinaryPLYSource(core::smart_refctd_ptr<io::IReadFile>&& _file, const size_t _cacheByteSize=DefaultSourceCacheByteSize);
+
+				//! false for ASCII files, positions which aren't float or double, and list properties in front of the faces
+				inline bool isValid() const { return m_faceCount!=0u; }
+
+				bool reset() override;
+				uint32_t read(float* outPositions, uint32_t maxTriangles) override;
+				void release() override;
+
+			private:
+				struct SFaceProperty
+				{
+					//! of the list count for lists
+					uint8_t size;
+					//! 0 if not a list
+					uint8_t itemSize;
+					bool isVertexIndices;
+				};
+
+				bool readFace();
+
+				core::smart_refctd_ptr<io::IReadFile> m_file;
+				size_t m_cacheByteSize;
+				CPositionPageCache::SLayout m_vertexLayout;
+				core::vector<SFaceProperty> m_faceProperties;
+				size_t m_faceOffset = 0ull;
+				uint32_t m_faceCount = 0u;
+				uint32_t m_facesRead = 0u;
+
+				CBufferedReader m_reader;
+				CPositionPageCache m_positions;
+				//! corners of the last face read, and which of its fan's triangles comes next
+				core::vector<uint32_t> m_polygon;
+				uint32_t m_nextFanTriangle = 0u;
+		};
+		//! Reads the faces of an OBJ file sequentially and looks their vertices up through a `CPositionPageCache`, so it's never loaded whole
+		/** The positions get copied into a binary scratch file first, everything but `v` and `f` gets ignored. Polygons get split into fans. */
+		class COBJSource final : public ITriangleSource
+		{
+			public:
+				COBJSource(io::IFileSystem* _fs, core::smart_refctd_ptr<io::IReadFile>&& _file, const std::string& _scratchFilename, const size_t _cacheByteSize=DefaultSourceCacheByteSize);
+				//! removes the scratch file
+				~COBJSource();
+
+				//! false if there are no positions or the scratch file can't be written
+				inline bool isValid() const { return bool(m_positionsFile); }
+
+				bool reset() override;
+				uint32_t read(float* outPositions, uint32_t maxTriangles) override;
+				void release() override;
+
+			private:
+				//! false on malformed faces and indices out of range
+				bool parseFace(const char* begin, const char* end);
+
+				core::smart_refctd_ptr<io::IReadFile> m_file;
+				core::smart_refctd_ptr<io::IReadFile> m_positionsFile;
+				std::string m_scratchFilename;
+				size_t m_cacheByteSize;
+				uint32_t m_vertexCount = 0u;
+				//! positions before the current line, for relative indices
+				uint32_t m_verticesSeen = 0u;
+
+				CBufferedReader m_reader;
+				CPositionPageCache m_positions;
+				//! corners of the last face read, and which of its fan's triangles comes next
+				core::vector<uint32_t> m_polygon;
+				uint32_t m_nextFanTriangle = 0u;
+		};
+		//! For formats which don't have a streaming reader, hands out the triangles of an already loaded triangle list, strip or fan
+		/** Still spares the several full copies of the mesh which `IMeshManipulator` would make, the mesh can be dropped as soon as `process` is done binning.
+		Memory isn't bounded by the budget with this one, the whole mesh has to be loaded. */
+		class CMeshBufferSource final : public ITriangleSource
+		{
+			public:
+				CMeshBufferSource(core::smart_refctd_ptr<const ICPUMeshBuffer>&& _meshbuffer);
+
+				bool reset() override;
+				uint32_t read(float* outPositions, uint32_t maxTriangles) override;
+				void release() override;
+
+			private:
+				core::smart_refctd_ptr<const ICPUMeshBuffer> m_meshbuffer;
+				uint32_t m_triangleCount = 0u;
+				uint32_t m_triangleIx = 0u;
+		};
+
+		//! Picks the streaming source by the extension of `_filename`, .stl, .ply or .obj
+		/** Returns nullptr for other extensions and files the sources can't stream (ASCII STL and PLY), those have to go through a `CMeshBufferSource`.
+		`_scratchDirectory` gets the positions of OBJ files. */
+		static std::unique_ptr<ITriangleSource> createFileSource(io::IFileSystem* _fs, const io::path& _filename, const std::string& _scratchDirectory, const size_t _cacheByteSize=DefaultSourceCacheByteSize);
+
+		struct SParams
+		{
+			//! Bytes which the chunks being processed and the binning write buffers may use at once, a single chunk bigger than that still gets processed, alone
+			/** The write buffers take a quarter of it, so a file source's cache of up to half of it keeps the binning within the budget too. */
+			size_t memoryBudget = 0x1ull<<30ull;
+			//! Gets the intermediate chunk files, which are deleted once the chunks are done
+			std::string scratchDirectory;
+			//! The chunk meshes get written to `<outputPrefix><chunk index><outputExtension>`
+			std::string outputPrefix;
+			//! Picks the asset writer, the chunks get written binary if it can
+			/** The BAW writer is only compiled with `OLD_SHADERS` until the format catches up with the new pipelines, so `.baw` output fails until then. */
+			std::string outputExtension = ".ply";
+			//! Vertices get split along edges sharper than this, in radians
+			float hardEdgeAngle = core::PI<float>()/4.f;
+			//! Per vertex attribute (position is 0, normal is 3), nullptr uses the defaults with `EEM_ANGLES` for the normals
+			const IMeshManipulator::SErrorMetric* errorMetrics = nullptr;
+		};
+		struct SChunk
+		{
+			std::string filename;
+			core::aabbox3df bounds;
+			//! not counting the halo
+			uint32_t triangleCount = 0u;
+			bool written = false;
+		};
+		struct SResult
+		{
+			//! Only the non-empty ones, in grid order
+			core::vector<SChunk> chunks;
+			uint64_t triangleCount = 0ull;
+			//! Highest estimated footprint of the chunks which were in flight at once
+			size_t peakMemoryEstimate = 0ull;
+			bool success = false;
+		};
+
+		//! Estimate of what processing a triangle costs in all the copies `IMeshManipulator` makes
+		_NBL_STATIC_INLINE_CONSTEXPR size_t EstimatedBytesPerTriangle = 768ull;
+		//! How many triangles get read from the source at once
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t SourceBatchTriangles = 0x1u<<14u;
+
+		static SResult process(IAssetManager* _assetManager, ITriangleSource* _source, const SParams& _params);
+};
+
+}
+}
+
+#endif
@@ -6,6 +6,7 @@
 #define __NBL_ASSET_I_BUILTIN_INCLUDE_LOADER_H_INCLUDED__
 
 #include <functional>
+#include <mutex>
 #include <regex>
 
 
@@ -21,25 +22,71 @@ class IBuiltinIncludeLoader : public core::IReferenceCounted
 	protected:
 		using HandleFunc_t = std::function<std::string(const std::string&)>;
 
+		//! Only gets called once, the first time an include gets requested, the patterns get tried in order
 		virtual core::vector<std::pair<std::regex, HandleFunc_t>> getBuiltinNamesToFunctionMapping() const = 0;
+		//! Names which don't need a pattern, looked up in a hash map before any pattern gets tried
+		virtual core::vector<std::pair<std::string, HandleFunc_t>> getBuiltinExactNamesToFunctionMapping() const { return {}; }
 
 	public:
 		virtual ~IBuiltinIncludeLoader() = default;
 
 		//! @param _name must be path relative to /nbl/builtin/
+		/** Every generated source gets remembered, so every name only ever gets generated once (until `clearCache`).
+		Misses don't get remembered, the file backing a name might only show up later. */
 		virtual std::string getBuiltinInclude(const std::string& _name) const
 		{
-			core::vector<std::pair<std::regex, HandleFunc_t>> builtinNames = getBuiltinNamesToFunctionMapping();
+			{
+				std::lock_guard<std::mutex> lock(m_sourcesMutex);
+				auto found = m_sources.find(_name);
+				if (found!=m_sources.end())
+					return found->second;
+			}
 
-			for (const auto& pattern : builtinNames)
-				if (std::regex_match(_name, pattern.first))
-					return pattern.second(_name);
+			std::call_once(m_mappingsBuilt,[this]() -> void
+			{
+				for (auto& exact : getBuiltinExactNamesToFunctionMapping())
+					m_exactNames.emplace(std::move(exact.first),std::move(exact.second));
+				m_patterns = getBuiltinNamesToFunctionMapping();
+			});
 
-			return {};
+			// two threads missing the same name at once will both generate it, which is cheaper than making one wait
+			std::string source;
+			auto exact = m_exactNames.find(_name);
+			if (exact!=m_exactNames.end())
+				source = exact->second(_name);
+			else
+			for (const auto& pattern : m_patterns)
+			if (std::regex_match(_name, pattern.first))
+			{
+				source = pattern.second(_name);
+				break;
+			}
+
+			if (!source.empty())
+			{
+				std::lock_guard<std::mutex> lock(m_sourcesMutex);
+				m_sources.emplace(_name,source);
+			}
+			return source;
+		}
+
+		//! Forgets the generated sources, for when the ones read from disk changed
+		inline void clearCache()
+		{
+			std::lock_guard<std::mutex> lock(m_sourcesMutex);
+			m_sources.clear();
 		}
 
 		//! @returns Path relative to /nbl/builtin/
 		virtual const char* getVirtualDirectoryName() const = 0;
+
+	private:
+		mutable std::once_flag m_mappingsBuilt;
+		mutable core::unordered_map<std::string, HandleFunc_t> m_exactNames;
+		mutable core::vector<std::pair<std::regex, HandleFunc_t>> m_patterns;
+
+		mutable std::mutex m_sourcesMutex;
+		mutable core::unordered_map<std::string, std::string> m_sources;
 };
 
 }
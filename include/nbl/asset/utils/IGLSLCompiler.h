@@ -5,6 +5,8 @@
 #ifndef __NBL_ASSET_I_GLSL_COMPILER_H_INCLUDED__
 #define __NBL_ASSET_I_GLSL_COMPILER_H_INCLUDED__
 
+#include <chrono>
+
 #include "nbl/core/core.h"
 #include "nbl/system/system.h"
 
@@ -27,17 +29,53 @@ class COpenGLDriver;
 namespace asset
 {
 
+class CShaderIntrospector;
+
 //! Will be derivative of IShaderGenerator, but we have to establish interface first
 class IGLSLCompiler final : public core::IReferenceCounted
 {
 		core::smart_refctd_ptr<IIncludeHandler> m_inclHandler;
 		const io::IFileSystem* m_fs;
 
+		struct SResolvedIncludesKey
+		{
+			std::string glslCode;
+			std::string originFilepath;
+			ISpecializedShader::E_SHADER_STAGE stage;
+			uint32_t maxSelfInclusionCnt;
+
+			inline bool operator==(const SResolvedIncludesKey& other) const
+			{
+				return stage==other.stage && maxSelfInclusionCnt==other.maxSelfInclusionCnt && originFilepath==other.originFilepath && glslCode==other.glslCode;
+			}
+		};
+		struct SResolvedIncludesKeyHash
+		{
+			inline size_t operator()(const SResolvedIncludesKey& key) const
+			{
+				size_t retval = std::hash<std::string>()(key.glslCode);
+				retval ^= std::hash<std::string>()(key.originFilepath)+0x9e3779b9ull+(retval<<6)+(retval>>2);
+				return retval^((static_cast<size_t>(key.stage)<<32ull)|key.maxSelfInclusionCnt);
+			}
+		};
+		struct SResolvedIncludes
+		{
+			std::string glslCode;
+			//! of the include handler at the time
+			uint32_t builtinIncludeLoadersRevision;
+		};
+		//! only sources which didn't include anything from the filesystem, because that may change behind our back
+		mutable core::ConcurrentLRUCache<SResolvedIncludesKey,SResolvedIncludes,SResolvedIncludesKeyHash> m_resolvedIncludesCache;
+
 	protected:
 		friend class video::COpenGLDriver;
 		core::smart_refctd_ptr<ICPUBuffer> compileSPIRVFromGLSL(const char* _glslCode, ISpecializedShader::E_SHADER_STAGE _stage, const char* _entryPoint, const char* _compilationId, bool _genDebugInfo = true, std::string* _outAssembly = nullptr) const;
 
 	public:
+		//! Upper bounds on how much `resolveIncludeDirectives` remembers
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t ResolvedIncludesCacheCapacity = 0x1u<<12u;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t ResolvedIncludesCacheByteCapacity = 64ull*1024ull*1024ull;
+
 		IGLSLCompiler(io::IFileSystem* _fs);
 
 		IIncludeHandler* getIncludeHandler() { return m_inclHandler.get(); }
@@ -80,11 +118,55 @@ class IGLSLCompiler final : public core::IReferenceCounted
 		@param _originFilepath Path to not necesarilly existing file whose directory will be base for relative (""-type) top-level #include's resolution.
 			If _originFilepath is non-path-like string (e.g. "whatever" - no slashes), the base directory is assumed to be "." (working directory of your executable). It's important for it to be unique.
 
+		The results get cached by source, stage, origin and max self-inclusion count, unless a file from the filesystem got included.
+
 		@returns Shader containing logically same GLSL code as input but with #include directives resolved.
 		*/
 		core::smart_refctd_ptr<ICPUShader> resolveIncludeDirectives(std::string&& glslCode, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath, uint32_t _maxSelfInclusionCnt = 4u) const;
 
 		core::smart_refctd_ptr<ICPUShader> resolveIncludeDirectives(io::IReadFile* _sourcefile, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath, uint32_t _maxSelfInclusionCnt = 4u) const;
+
+		struct SBatchInput
+		{
+			std::string glslCode;
+			ISpecializedShader::E_SHADER_STAGE stage = ISpecializedShader::ESS_UNKNOWN;
+			std::string entryPoint = "main";
+			//! Also the origin path for relative includes
+			std::string compilationId;
+			//! Get inserted right after `#version` (and `#pragma shader_stage`), in order
+			core::vector<std::pair<std::string,std::string>> defines;
+			bool genDebugInfo = true;
+		};
+		struct SBatchTimings
+		{
+			//! Summed over all the shaders (which get processed concurrently), so these can add up to more than `total`
+			std::chrono::nanoseconds preprocess = std::chrono::nanoseconds::zero();
+			std::chrono::nanoseconds compile = std::chrono::nanoseconds::zero();
+			std::chrono::nanoseconds optimize = std::chrono::nanoseconds::zero();
+			std::chrono::nanoseconds introspect = std::chrono::nanoseconds::zero();
+			//! Wall clock time of the whole batch
+			std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+			uint32_t inputCount = 0u;
+			//! How many shaders actually got compiled after deduplicating identical inputs
+			uint32_t uniqueCount = 0u;
+		};
+		/**
+		Resolves includes, compiles and optionally optimizes all the inputs concurrently on a worker pool.
+		Identical inputs only get compiled once and share the returned shader.
+
+		@param _introspector Optional, every distinct shader gets introspected (and cached in it) afterwards, on the calling thread.
+		@param _outTimings Optional, filled with the time every stage took.
+
+		@returns Shaders containing SPIR-V bytecode in the order of the inputs, nullptr for the ones which failed.
+		*/
+		core::vector<core::smart_refctd_ptr<ICPUShader>> createSPIRVFromGLSLBatch(const SBatchInput* _begin, const SBatchInput* _end, const ISPIRVOptimizer* _opt = nullptr, CShaderIntrospector* _introspector = nullptr, SBatchTimings* _outTimings = nullptr) const;
+
+		//! Forgets every source `resolveIncludeDirectives` resolved and every builtin include generated so far, needed if builtin includes read from disk changed
+		inline void clearResolvedIncludesCache()
+		{
+			m_resolvedIncludesCache.clear();
+			m_inclHandler->clearBuiltinIncludeLoaderCaches();
+		}
 };
 
 }
@@ -5,6 +5,8 @@
 #ifndef __NBL_ASSET_I_INCLUDE_HANDLER_H_INCLUDED__
 #define __NBL_ASSET_I_INCLUDE_HANDLER_H_INCLUDED__
 
+#include <atomic>
+
 #include "nbl/core/IReferenceCounted.h"
 #include "nbl/asset/utils/IBuiltinIncludeLoader.h"
 
@@ -31,6 +33,14 @@ class IIncludeHandler : public core::IReferenceCounted
 		virtual std::string getIncludeRelative(const std::string& _path, const std::string& _workingDirectory) const = 0;
 
 		virtual void addBuiltinIncludeLoader(core::smart_refctd_ptr<IBuiltinIncludeLoader>&& _inclLoader) = 0;
+		//! Calls `IBuiltinIncludeLoader::clearCache` on every builtin include loader
+		virtual void clearBuiltinIncludeLoaderCaches() = 0;
+
+		//! Changes whenever a builtin include loader gets added, so anything caching resolved builtin includes can tell its results went stale
+		inline uint32_t getBuiltinIncludeLoadersRevision() const { return m_builtinIncludeLoadersRevision.load(); }
+
+	protected:
+		std::atomic<uint32_t> m_builtinIncludeLoadersRevision = 0u;
 };
 
 }
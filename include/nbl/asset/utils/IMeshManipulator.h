@@ -6,7 +6,9 @@
 #define __NBL_ASSET_I_MESH_MANIPULATOR_H_INCLUDED__
 
 #include <array>
+#include <execution>
 #include <functional>
+#include <numeric>
 
 #include "nbl/core/core.h"
 #include "vector3d.h"
@@ -322,14 +324,8 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				const uint32_t indexCount = meshbuffer->getIndexCount();
 				if (indexPtr)
 				{
-					for (uint32_t j=0ull; j<indexCount; j++)
-					{
-						uint32_t index = static_cast<uint32_t>(indexPtr[j]);
-						if (index>vertexCount)
-							vertexCount = index;
-					}
 					if (indexCount)
-						vertexCount++;
+						vertexCount = findMaxIndex(indexPtr,indexCount)+1u;
 				}
 				else
 					vertexCount = indexCount;
@@ -365,6 +361,27 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				return aabb;
 			
 			const bool computeJointAABBs = outJointAABBs&&meshbuffer->isSkinned();
+			// without joints every position ends up in the one box, most formats have a fast path
+			if (!computeJointAABBs)
+			{
+				const void* indices = meshbuffer->getIndices();
+				bool bounded;
+				switch (meshbuffer->getIndexType())
+				{
+					case EIT_32BIT:
+						bounded = boundFloatPositions(aabb,meshbuffer,reinterpret_cast<const uint32_t*>(indices));
+						break;
+					case EIT_16BIT:
+						bounded = boundFloatPositions(aabb,meshbuffer,reinterpret_cast<const uint16_t*>(indices));
+						break;
+					default:
+						bounded = boundFloatPositions(aabb,meshbuffer,static_cast<const uint32_t*>(nullptr));
+						break;
+				}
+				if (bounded)
+					return aabb;
+			}
+
 			const auto* skeleton = meshbuffer->getSkeleton();
 			if (computeJointAABBs)
 			for (auto i=0u; i<meshbuffer->getSkeleton()->getJointCount(); i++)
@@ -468,6 +485,22 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 					return dot(v0.parentTriangleFaceNormal,v1.parentTriangleFaceNormal)[0] > cosOf45Deg;
 				});
 
+		//! Returns a vertex comparator for `calculateSmoothNormals` which only smooths across faces meeting at less than `hardEdgeAngle` radians.
+		static inline VxCmpFunction createHardEdgeComparator(float hardEdgeAngle)
+		{
+			const float cosThreshold = std::cos(hardEdgeAngle);
+			return [cosThreshold](const IMeshManipulator::SSNGVertexData& v0, const IMeshManipulator::SSNGVertexData& v1, ICPUMeshBuffer* buffer)
+			{
+				return dot(v0.parentTriangleFaceNormal,v1.parentTriangleFaceNormal)[0] > cosThreshold;
+			};
+		}
+
+		//! Calculates smooth normals for any triangle list (indexed or not), vertices are split along edges sharper than `hardEdgeAngle` radians.
+		/** The meshbuffer gets unwelded, smoothed with `createHardEdgeComparator` and welded back,
+		so only the vertices lying on hard edges end up duplicated. The input is never modified.
+		\return A new meshbuffer or nullptr if the input is not a triangle list or has no normal attribute. */
+		static core::smart_refctd_ptr<ICPUMeshBuffer> calculateSmoothNormalsWithHardEdges(ICPUMeshBuffer* inbuffer, float hardEdgeAngle, float epsilon = 1.525e-5f, uint32_t normalAttrID = 3u);
+
 		//! Creates a copy of a mesh with vertices welded
 		/** \param mesh Input mesh
         \param errMetrics Array of size EVAI_COUNT. Describes error metric for each vertex attribute (used if attribute is of floating point or normalized type).
@@ -479,6 +512,73 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 		/**@return A new meshbuffer or NULL if an error occured. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createOptimizedMeshBuffer(const ICPUMeshBuffer* inbuffer, const SErrorMetric* _errMetric);
 
+		//! Post-transform vertex cache and overdraw efficiency of a triangle list.
+		struct SIndexBufferStatistics
+		{
+			float acmr = 0.f; //!< Average Cache Miss Ratio, transformed vertices per triangle (3 is the worst, ~0.5 is attainable on regular meshes)
+			float atvr = 0.f; //!< Average Transformed Vertex Ratio, transformed vertices per referenced vertex (1 is optimal)
+			float overdraw = 0.f; //!< Fragments shaded per covered pixel, averaged over backface culled orthographic views along the 6 axis directions (1 is optimal)
+		};
+		//! Simulates a FIFO post-transform cache of `cacheSize` entries and rasterizes the mesh in submission order to measure its efficiency.
+		/** Meant for verifying the quality of `optimizeIndexBufferClustered` versus the serial `createOptimizedMeshBuffer` path. */
+		static SIndexBufferStatistics calculateIndexBufferStatistics(const ICPUMeshBuffer* meshbuffer, uint32_t cacheSize = 16u);
+
+		//! Reorders the triangles of an indexed triangle list in-place to improve vertex cache efficiency and reduce overdraw, scales to meshes with many millions of triangles.
+		/**
+		Triangles are sorted along a Morton curve of their centroids and cut into spatially coherent clusters of `trianglesPerCluster`,
+		each cluster is optimized on a worker thread (Forsyth's algorithm followed by overdraw sorting) and the clusters are stitched back
+		together ordered by their potential to occlude the rest of the mesh.
+		The serial path optimizes across the whole mesh so it will be slightly better, use `calculateIndexBufferStatistics` to compare.
+		@param meshbuffer Meshbuffer with a 16 or 32bit index buffer and triangle list topology, left unchanged otherwise.
+		@param trianglesPerCluster Target amount of triangles per cluster, the last one can be smaller.
+		@param overdrawThreshold How much the overdraw optimizer can degrade vertex cache efficiency (1.05 = up to 5%) to reduce overdraw.
+		*/
+		static void optimizeIndexBufferClustered(ICPUMeshBuffer* meshbuffer, uint32_t trianglesPerCluster = 0x1u<<16u, float overdrawThreshold = 1.05f);
+
+		//! Parameters of `createLoDChain`
+		struct SLoDChainParams
+		{
+			//! Fraction of the input's triangles every level should keep, in decreasing order, each level gets made by simplifying the previous one further
+			core::vector<float> triangleRatios = {0.5f,0.25f,0.125f,0.0625f};
+			//! No collapse moving the surface further than this (in object space units) happens, so levels can come out with more triangles than asked for
+			float maxError = FLT_MAX;
+			//! Vertices on open boundaries of the mesh don't move at all, otherwise they can only slide along the boundary
+			bool lockBorders = false;
+			//! All levels index the input's vertex buffers, otherwise every level gets compacted buffers with only the vertices it uses
+			bool shareVertexBuffers = true;
+			//! Per vertex attribute (position is ignored), vertices at the same position with any attribute differing by more than this form a seam which the simplification keeps intact, nullptr uses the defaults
+			const SErrorMetric* errorMetrics = nullptr;
+		};
+		//! One level of detail made by `createLoDChain`
+		struct SLoD
+		{
+			core::smart_refctd_ptr<ICPUMeshBuffer> meshbuffer;
+			//! Upper bound on how far (in object space units) the simplified surface strays from the input, as estimated by the quadrics
+			float error = 0.f;
+			uint32_t triangleCount = 0u;
+		};
+		//! Builds progressively coarser levels of detail of a triangle mesh by quadric error metric edge collapse.
+		/**
+		Vertices never move, edges only collapse onto one of their existing vertices, which lets all the levels share the input's vertex buffers and only have their own index buffers.
+		Vertices at exactly the same position are merged if their attributes match within `SLoDChainParams::errorMetrics` and otherwise form a seam (UV or normal discontinuity),
+		which only collapses along itself with both of its sides at once, so neither gets torn open.
+		The quadrics and collapse costs are computed in parallel, the collapses happen in passes of non-adjacent edges picked in order of increasing error.
+		@param inbuffer Meshbuffer with a triangle list, strip or fan topology, indexed or not. The levels are always indexed triangle lists.
+		@returns One element per entry of `params.triangleRatios`, or less if the simplification stops making progress (because of `maxError`, locked vertices or seams), doesn't contain the input itself.
+		*/
+		static core::vector<SLoD> createLoDChain(const ICPUMeshBuffer* inbuffer, const SLoDChainParams& params);
+		//! One level of detail of a whole mesh
+		struct SMeshLoD
+		{
+			core::smart_refctd_ptr<ICPUMesh> mesh;
+			//! largest error of its meshbuffers
+			float error = 0.f;
+		};
+		//! Runs `createLoDChain` on all meshbuffers of a mesh in parallel.
+		/** Meshbuffers whose chain ended early contribute their last level (or themselves) to the remaining levels, so every level has all the meshbuffers.
+		The chain ends when none of the meshbuffers could be simplified further. */
+		static core::vector<SMeshLoD> createLoDChain(const ICPUMesh* mesh, const SLoDChainParams& params);
+
 		//! Requantizes vertex attributes to the smallest possible types taking into account values of the attribute under consideration. A brand new vertex buffer is created and attributes are going to be interleaved in single buffer.
 		/**
 			The function tests type's range and precision loss after eventual requantization. The latter is performed in one of several possible methods specified
@@ -500,6 +600,8 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 			// analyse
 			uint32_t iotaLength = 0u;
 			uint32_t patchVertexCount = 0u;
+			// pipelines can be shared between meshbuffers, so all the primitive types get remembered before changing any
+			core::vector<std::pair<ICPUMeshBuffer*,E_PRIMITIVE_TOPOLOGY>> meshbuffers;
 			for (auto it=_begin; it!=_end; it++)
 			{
 				auto& cpumb = *it;
@@ -507,6 +609,7 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				assert(cpumb->isMutable());
 
 				const auto& params = cpumb->getPipeline()->getPrimitiveAssemblyParams();
+				meshbuffers.emplace_back(&(*cpumb),params.primitiveType);
 				switch (params.primitiveType)
 				{
 					case EPT_POINT_LIST:
@@ -550,15 +653,19 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				auto ptr = reinterpret_cast<uint32_t*>(iotaUint32Buffer->getPointer());
 				std::iota(ptr,ptr+iotaLength,0u);
 			}
-			// modify
-			for (auto it=_begin; it!=_end; it++)
+			// a meshbuffer listed twice must only be converted once, a second conversion would race the first and treat its output as the old topology
+			std::sort(meshbuffers.begin(),meshbuffers.end(),[](const auto& lhs, const auto& rhs) -> bool {return lhs.first<rhs.first;});
+			meshbuffers.erase(std::unique(meshbuffers.begin(),meshbuffers.end(),[](const auto& lhs, const auto& rhs) -> bool {return lhs.first==rhs.first;}),meshbuffers.end());
+			// modify, every meshbuffer on its own
+			core::vector<uint32_t> meshbufferIxs(meshbuffers.size());
+			std::iota(meshbufferIxs.begin(),meshbufferIxs.end(),0u);
+			std::for_each(std::execution::par,meshbufferIxs.begin(),meshbufferIxs.end(),[&](const uint32_t i) -> void
 			{
-				auto& cpumb = *it;
+				ICPUMeshBuffer* cpumb = meshbuffers[i].first;
 
 				const auto indexType = cpumb->getIndexType();
 				auto indexCount = cpumb->getIndexCount();
 
-				auto& params = cpumb->getPipeline()->getPrimitiveAssemblyParams();
 				core::smart_refctd_ptr<ICPUBuffer> newIndexBuffer;
 
 				void* correctlyOffsetIndexBufferPtr;
@@ -568,7 +675,7 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 					correctlyOffsetIndexBufferPtr = iotaUint32Buffer->getPointer();
 				else
 					correctlyOffsetIndexBufferPtr = cpumb->getIndices();
-				switch (params.primitiveType)
+				switch (meshbuffers[i].second)
 				{
 					case EPT_LINE_STRIP:
 						assert(_newPrimitiveType==EPT_LINE_LIST);
@@ -606,8 +713,9 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 					cpumb->setIndexCount(indexCount);
 				}
 				cpumb->setIndexType(outIndexType);
-				params.primitiveType = _newPrimitiveType;
-			}
+			});
+			for (auto& meshbuffer : meshbuffers)
+				meshbuffer.first->getPipeline()->getPrimitiveAssemblyParams().primitiveType = _newPrimitiveType;
 		}
 
 		//! Get amount of polygons in mesh.
@@ -652,10 +760,123 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 			mesh->setBoundingBox(calculateBoundingBox(mesh));
 		}
 
+		//! Recalculates the cached bounding boxes of all the meshbuffers in parallel, then the mesh's
+		static inline void recalculateBoundingBoxes(ICPUMesh* mesh)
+		{
+			mesh->forEachMeshBufferParallel([](ICPUMeshBuffer* meshbuffer) -> void {recalculateBoundingBox(meshbuffer);});
+			recalculateBoundingBox(mesh);
+		}
+
 
 		//!
 		virtual CQuantNormalCache* getQuantNormalCache() = 0;
 		virtual CQuantQuaternionCache* getQuantQuaternionCache() = 0;
+
+	protected:
+		//! Largest of the `count` indices
+		template<typename IndexType>
+		static inline uint32_t findMaxIndex(const IndexType* indices, const uint32_t count)
+		{
+			static_assert(std::is_same_v<IndexType,uint16_t>||std::is_same_v<IndexType,uint32_t>);
+
+			uint32_t retval = 0u;
+			uint32_t j = 0u;
+			#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+			// a few independent accumulators so the loads aren't waiting on each other's max
+			constexpr uint32_t IndicesPerVector = 16u/sizeof(IndexType);
+			constexpr uint32_t Accumulators = 4u;
+			if (count>=IndicesPerVector*Accumulators)
+			{
+				__m128i maxima[Accumulators];
+				for (uint32_t k=0u; k<Accumulators; k++)
+					maxima[k] = _mm_setzero_si128();
+				for (; j+IndicesPerVector*Accumulators<=count; j+=IndicesPerVector*Accumulators)
+				for (uint32_t k=0u; k<Accumulators; k++)
+				{
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices+j+k*IndicesPerVector));
+					if constexpr (std::is_same_v<IndexType,uint16_t>)
+						maxima[k] = _mm_max_epu16(maxima[k],v);
+					else
+						maxima[k] = _mm_max_epu32(maxima[k],v);
+				}
+				for (uint32_t k=1u; k<Accumulators; k++)
+				{
+					if constexpr (std::is_same_v<IndexType,uint16_t>)
+						maxima[0] = _mm_max_epu16(maxima[0],maxima[k]);
+					else
+						maxima[0] = _mm_max_epu32(maxima[0],maxima[k]);
+				}
+				alignas(16) IndexType lanes[IndicesPerVector];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes),maxima[0]);
+				retval = *std::max_element(lanes,lanes+IndicesPerVector);
+			}
+			#endif
+			for (; j<count; j++)
+			if (indices[j]>retval)
+				retval = indices[j];
+			return retval;
+		}
+
+		//! Bounds the positions of all the vertices referenced by the meshbuffer without going through `getPosition`, `indices` can be null
+		/** Only handles 32bit float positions with 3 or 4 components, returns false and leaves `aabb` alone for anything else. */
+		template<typename IndexType>
+		static inline bool boundFloatPositions(core::aabbox3df& aabb, const ICPUMeshBuffer* meshbuffer, const IndexType* indices)
+		{
+			const auto posAttrId = meshbuffer->getPositionAttributeIx();
+			const E_FORMAT format = meshbuffer->getAttribFormat(posAttrId);
+			if (format!=EF_R32G32B32_SFLOAT && format!=EF_R32G32B32A32_SFLOAT)
+				return false;
+			const size_t stride = meshbuffer->getAttribStride(posAttrId);
+			const uint8_t* positions = meshbuffer->getAttribPointer(posAttrId);
+			if (!positions || stride==0ull)
+				return false;
+
+			const ICPUBuffer* buffer = meshbuffer->getAttribBoundBuffer(posAttrId).buffer.get();
+			const size_t bytesLeft = reinterpret_cast<const uint8_t*>(buffer->getPointer())+buffer->getSize()-positions;
+			// vertices past the end of the buffer come out as the origin, same as with `getPosition`
+			const size_t vertexCount = bytesLeft>=sizeof(float)*3ull ? (bytesLeft-sizeof(float)*3ull)/stride+1ull:0ull;
+
+			const uint32_t indexCount = meshbuffer->getIndexCount();
+			#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+			// the 4th float of a vertex can only be loaded along with the rest if that doesn't read past the buffer
+			const size_t wholeLoadCount = bytesLeft>=sizeof(float)*4ull ? (bytesLeft-sizeof(float)*4ull)/stride+1ull:0ull;
+			__m128 minimum = _mm_set1_ps(FLT_MAX);
+			__m128 maximum = _mm_set1_ps(-FLT_MAX);
+			for (uint32_t j=0u; j<indexCount; j++)
+			{
+				const size_t ix = indices ? indices[j]:j;
+				const float* pos = reinterpret_cast<const float*>(positions+ix*stride);
+				__m128 v;
+				if (ix<wholeLoadCount)
+					v = _mm_loadu_ps(pos);
+				else if (ix<vertexCount)
+					v = _mm_setr_ps(pos[0],pos[1],pos[2],pos[2]);
+				else
+					v = _mm_setzero_ps();
+				// the second operand gets returned if either is NaN, so the accumulators never pick one up
+				minimum = _mm_min_ps(v,minimum);
+				maximum = _mm_max_ps(v,maximum);
+			}
+			alignas(16) float lanes[8];
+			_mm_store_ps(lanes,minimum);
+			_mm_store_ps(lanes+4,maximum);
+			aabb.MinEdge.set(lanes[0],lanes[1],lanes[2]);
+			aabb.MaxEdge.set(lanes[4],lanes[5],lanes[6]);
+			#else
+			for (uint32_t j=0u; j<indexCount; j++)
+			{
+				const size_t ix = indices ? indices[j]:j;
+				if (ix<vertexCount)
+				{
+					const float* pos = reinterpret_cast<const float*>(positions+ix*stride);
+					aabb.addInternalPoint(pos[0],pos[1],pos[2]);
+				}
+				else
+					aabb.addInternalPoint(0.f,0.f,0.f);
+			}
+			#endif
+			return true;
+		}
 };
 
 } // end namespace scene
@@ -0,0 +1,233 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_CONCURRENT_LRU_CACHE_H_INCLUDED__
+#define __NBL_CORE_CONCURRENT_LRU_CACHE_H_INCLUDED__
+
+#include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/math/intutil.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace nbl
+{
+namespace core
+{
+
+// Thread-safe Key-Value Least Recently Used cache
+// Keys get spread over independently locked shards, each being an `LRUCache` with an equal part of the capacity,
+// so the eviction order is only least recently used within a shard.
+// Optionally bounded by the sum of byte sizes given with the values, on top of the element count.
+template<typename Key, typename Value, typename MapHash=std::hash<Key>, typename MapEquals=std::equal_to<Key> >
+class ConcurrentLRUCache
+{
+	public:
+		//called after the shard's lock got released, from whichever thread caused the eviction
+		using eviction_callback_t = std::function<void(const Key&,Value&&)>;
+
+		struct SStatistics
+		{
+			uint64_t hits = 0ull;
+			uint64_t misses = 0ull;
+			uint64_t evictions = 0ull;
+		};
+
+		//`capacity` and `byteCapacity` get split evenly between the shards, a `byteCapacity` of 0 means only the element count is limited
+		//`shardCount` gets rounded up to a power of two, 0 picks one from the amount of hardware threads
+		inline ConcurrentLRUCache(const uint32_t capacity, const size_t byteCapacity=0ull, uint32_t shardCount=0u, eviction_callback_t&& evictionCallback=nullptr, MapHash&& _hash=MapHash(), MapEquals&& _equals=MapEquals()) :
+			m_evictionCallback(std::move(evictionCallback)), m_hash(std::move(_hash))
+		{
+			if (shardCount==0u)
+				shardCount = core::max(std::thread::hardware_concurrency(),1u)*4u;
+			shardCount = core::roundUpToPoT(shardCount);
+			m_shardShift = 64u-core::findLSB(shardCount);
+
+			const uint32_t shardCapacity = core::max((capacity+shardCount-1u)/shardCount,2u);
+			const size_t shardByteCapacity = byteCapacity ? core::max<size_t>(byteCapacity/shardCount,1ull):~0ull;
+			m_shards.reserve(shardCount);
+			for (uint32_t i=0u; i<shardCount; i++)
+				m_shards.push_back(std::make_unique<Shard>(shardCapacity,shardByteCapacity,MapHash(m_hash),MapEquals(_equals)));
+		}
+
+		//insert an element into the cache, or update an existing one with the same key
+		//returns false and doesn't insert if `byteSize` is more than a single shard may hold
+		template<typename K, typename V>
+		inline bool insert(K&& k, V&& v, const size_t byteSize=0ull)
+		{
+			Shard& shard = getShard(k);
+			core::vector<std::pair<Key,Value>> evicted;
+			{
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				if (byteSize>shard.byteCapacity)
+					return false;
+
+				if (const auto* existing=shard.cache.peek(k))
+					shard.byteSize -= existing->byteSize;
+				shard.byteSize += byteSize;
+
+				auto evict = [&shard,&evicted](const Key& key, SEntry&& entry) -> void
+				{
+					shard.byteSize -= entry.byteSize;
+					evicted.emplace_back(key,std::move(entry.value));
+				};
+				shard.cache.insert(std::forward<K>(k),SEntry{std::forward<V>(v),byteSize},evict);
+				// the new element is the most recently used and fits on its own, so it never gets evicted here
+				while (shard.byteSize>shard.byteCapacity)
+					shard.cache.evictLeastRecentlyUsed(evict);
+				shard.evictions += evicted.size();
+			}
+			if (m_evictionCallback)
+			for (auto& element : evicted)
+				m_evictionCallback(element.first,std::move(element.second));
+			return true;
+		}
+
+		//copy the value at an associated Key into `outValue` and mark it as most recently used, returns false if Key is not contained within cache
+		inline bool get(const Key& key, Value& outValue)
+		{
+			return apply(key,[&outValue](Value& value) -> void {outValue = value;});
+		}
+
+		//same as `get` but does not alter the value use order
+		inline bool peek(const Key& key, Value& outValue) const
+		{
+			const Shard& shard = getShard(key);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			const SEntry* entry = shard.cache.peek(key);
+			if (!entry)
+				return false;
+			outValue = entry->value;
+			return true;
+		}
+
+		//run `func(Value&)` on the value at an associated Key while the shard is locked, avoids copying the value out
+		//the value gets marked as most recently used, returns false and doesn't run `func` if Key is not contained within cache
+		template<typename F>
+		inline bool apply(const Key& key, F&& func)
+		{
+			Shard& shard = getShard(key);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			SEntry* entry = shard.cache.get(key);
+			if (!entry)
+			{
+				shard.misses++;
+				return false;
+			}
+			shard.hits++;
+			func(entry->value);
+			return true;
+		}
+
+		//remove element at key if present, without calling the eviction callback
+		inline void erase(const Key& key)
+		{
+			Shard& shard = getShard(key);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			if (const auto* existing=shard.cache.peek(key))
+			{
+				shard.byteSize -= existing->byteSize;
+				shard.cache.erase(key);
+			}
+		}
+
+		//evict everything, the eviction callback gets called for every element
+		inline void clear()
+		{
+			for (auto& shard : m_shards)
+			{
+				core::vector<std::pair<Key,Value>> evicted;
+				{
+					std::lock_guard<std::mutex> lock(shard->mutex);
+					while (shard->cache.evictLeastRecentlyUsed([&evicted](const Key& key, SEntry&& entry) -> void {evicted.emplace_back(key,std::move(entry.value));})) {}
+					shard->byteSize = 0ull;
+					shard->evictions += evicted.size();
+				}
+				if (m_evictionCallback)
+				for (auto& element : evicted)
+					m_evictionCallback(element.first,std::move(element.second));
+			}
+		}
+
+		//both only a snapshot when other threads are using the cache
+		inline size_t getSize() const
+		{
+			size_t retval = 0ull;
+			for (const auto& shard : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				retval += shard->cache.getSize();
+			}
+			return retval;
+		}
+		inline size_t getByteSize() const
+		{
+			size_t retval = 0ull;
+			for (const auto& shard : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				retval += shard->byteSize;
+			}
+			return retval;
+		}
+
+		inline SStatistics getStatistics() const
+		{
+			SStatistics retval;
+			for (const auto& shard : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				retval.hits += shard->hits;
+				retval.misses += shard->misses;
+				retval.evictions += shard->evictions;
+			}
+			return retval;
+		}
+
+		inline uint32_t getShardCount() const { return m_shards.size(); }
+
+	private:
+		struct SEntry
+		{
+			Value value;
+			size_t byteSize;
+		};
+		// own cache lines so threads working on neighbouring shards don't contend
+		struct alignas(64) Shard
+		{
+			Shard(const uint32_t capacity, const size_t _byteCapacity, MapHash&& _hash, MapEquals&& _equals) :
+				cache(capacity,std::move(_hash),std::move(_equals)), byteCapacity(_byteCapacity) {}
+
+			mutable std::mutex mutex;
+			LRUCache<Key,SEntry,MapHash,MapEquals> cache;
+			const size_t byteCapacity;
+			size_t byteSize = 0ull;
+			uint64_t hits = 0ull;
+			uint64_t misses = 0ull;
+			uint64_t evictions = 0ull;
+		};
+
+		// the shards' maps bucket by the low bits of the hash, so pick the shard with the high bits of a remixed hash
+		inline uint32_t getShardIndex(const Key& key) const
+		{
+			if (m_shardShift==64u)
+				return 0u;
+			const uint64_t hash = static_cast<uint64_t>(m_hash(key))*0x9E3779B97F4A7C15ull;
+			return static_cast<uint32_t>(hash>>m_shardShift);
+		}
+		inline Shard& getShard(const Key& key) { return *m_shards[getShardIndex(key)]; }
+		inline const Shard& getShard(const Key& key) const { return *m_shards[getShardIndex(key)]; }
+
+		eviction_callback_t m_evictionCallback;
+		MapHash m_hash;
+		uint32_t m_shardShift;
+		core::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+
+}	//namespace core
+}		//namespace nbl
+#endif
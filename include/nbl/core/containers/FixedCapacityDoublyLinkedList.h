@@ -102,12 +102,7 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 			if (m_back == invalid_iterator)
 				return;
 
-			auto backNode = getBack();
-			if (backNode->prev != invalid_iterator)
-				get(backNode->prev)->next = invalid_iterator;
-			uint32_t temp = m_back;
-			m_back = backNode->prev;
-			common_delete(temp);
+			erase(m_back);
 		}
 
 		//add new item to the list. This function does not make space to store the new node. in case the list is full, popBack() needs to be called beforehand
@@ -145,11 +140,11 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		{
 			if (m_begin == nodeAddr || nodeAddr == invalid_iterator)
 				return;
-			
-			getBegin()->prev = nodeAddr;
 
 			auto node = get(nodeAddr);
 			common_detach(node);
+			// node wasn't the only one, so the list still has a front
+			getBegin()->prev = nodeAddr;
 			node->next = m_begin;
 			node->prev = invalid_iterator;
 			m_begin = nodeAddr;
@@ -210,8 +205,12 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		{
 			if (node->next != invalid_iterator)
 				get(node->next)->prev = node->prev;
+			else
+				m_back = node->prev;
 			if (node->prev != invalid_iterator)
 				get(node->prev)->next = node->next;
+			else
+				m_begin = node->next;
 		}
 };
 
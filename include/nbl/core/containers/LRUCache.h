@@ -103,8 +103,19 @@ class LRUCache : private impl::LRUCacheBase<Key,Value,MapHash,MapEquals>
 			return success ? (*iterator):invalid_iterator;
 		}
 
-		template<typename K,typename V>
-		inline void common_insert(K&& k, V&& v)
+		//the callback gets the key and value of the least recently used element right before it's removed
+		template<typename EvictionCallback>
+		inline void common_evict(EvictionCallback&& evictionCallback)
+		{
+			const auto nodeAddr = m_list.getLastAddress();
+			m_shortcut_map.erase(nodeAddr);
+			auto& data = m_list.get(nodeAddr)->data;
+			evictionCallback(data.first,std::move(data.second));
+			m_list.popBack();
+		}
+
+		template<typename K,typename V,typename EvictionCallback>
+		inline void common_insert(K&& k, V&& v, EvictionCallback&& evictionCallback)
 		{
 			bool success;
 			shortcut_iterator_t iterator = common_find(k,success);
@@ -118,10 +129,7 @@ class LRUCache : private impl::LRUCacheBase<Key,Value,MapHash,MapEquals>
 			{
 				const bool overflow = m_shortcut_map.size()>=m_list.getCapacity();
 				if (overflow)
-				{
-					m_shortcut_map.erase(m_list.getLastAddress());
-					m_list.popBack();
-				}
+					common_evict(std::forward<EvictionCallback>(evictionCallback));
 				m_list.pushFront(std::make_pair(std::forward<K>(k),std::forward<V>(v)));
 				m_shortcut_map.insert(m_list.getFirstAddress());
 			}
@@ -152,10 +160,30 @@ class LRUCache : private impl::LRUCacheBase<Key,Value,MapHash,MapEquals>
 	#endif // _NBL_DEBUG
 
 		//insert an element into the cache, or update an existing one with the same key
-		inline void insert(Key&& k, Value&& v) { common_insert(std::move(k), std::move(v)); }
-		inline void insert(Key&& k, const Value& v) { common_insert(std::move(k), v); }
-		inline void insert(const Key& k, Value&& v) { common_insert(k, std::move(v)); }
-		inline void insert(const Key& k, const Value& v) { common_insert(k, v); }
+		inline void insert(Key&& k, Value&& v) { common_insert(std::move(k), std::move(v), [](const Key&, Value&&) -> void {}); }
+		inline void insert(Key&& k, const Value& v) { common_insert(std::move(k), v, [](const Key&, Value&&) -> void {}); }
+		inline void insert(const Key& k, Value&& v) { common_insert(k, std::move(v), [](const Key&, Value&&) -> void {}); }
+		inline void insert(const Key& k, const Value& v) { common_insert(k, v, [](const Key&, Value&&) -> void {}); }
+
+		//same as above, but if the cache is full `evictionCallback(const Key&, Value&&)` gets called with the element which gets removed to make space
+		template<typename K, typename V, typename EvictionCallback>
+		inline void insert(K&& k, V&& v, EvictionCallback&& evictionCallback)
+		{
+			common_insert(std::forward<K>(k), std::forward<V>(v), std::forward<EvictionCallback>(evictionCallback));
+		}
+
+		//remove the least recently used element, passing it to `evictionCallback(const Key&, Value&&)` first, returns false if the cache is empty
+		template<typename EvictionCallback>
+		inline bool evictLeastRecentlyUsed(EvictionCallback&& evictionCallback)
+		{
+			if (m_shortcut_map.empty())
+				return false;
+			common_evict(std::forward<EvictionCallback>(evictionCallback));
+			return true;
+		}
+
+		inline uint32_t getSize() const { return m_shortcut_map.size(); }
+		inline uint32_t getCapacity() const { return m_list.getCapacity(); }
 
 		//get the value from cache at an associated Key, or nullptr if Key is not contained within cache. Marks the returned value as most recently used
 		inline Value* get(const Key& key)
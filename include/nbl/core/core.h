@@ -36,6 +36,7 @@
 #include "nbl/core/containers/refctd_dynamic_array.h"
 #include "nbl/core/containers/FixedCapacityDoublyLinkedList.h"
 #include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/containers/ConcurrentLRUCache.h"
 // math
 #include "nbl/core/math/intutil.h"
 #include "nbl/core/math/floatutil.tcc"
@@ -51,9 +52,12 @@
 #include "nbl/core/sampling/RandomSampler.h"
 #include "nbl/core/sampling/SobolSampler.h"
 #include "nbl/core/sampling/OwenSampler.h"
+#include "nbl/core/sampling/HashedOwenSampler.h"
 // parallel
 #include "nbl/core/parallel/IThreadBound.h"
 #include "nbl/core/parallel/unlock_guard.h"
+// profiling
+#include "nbl/core/profiling/CProfiler.h"
 // string
 #include "nbl/core/string/stringutil.h"
 #include "nbl/core/string/UniqueStringLiteralType.h"
@@ -70,5 +74,6 @@
 // implementations
 #include "matrix3x4SIMD_impl.h"
 #include "matrix4SIMD_impl.h"
+#include "nbl/core/math/matrixSIMDBatch.h"
 
 #endif
\ No newline at end of file
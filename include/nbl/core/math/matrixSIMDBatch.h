@@ -0,0 +1,108 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_MATRIX_SIMD_BATCH_H_INCLUDED__
+#define __NBL_CORE_MATRIX_SIMD_BATCH_H_INCLUDED__
+
+#include "matrix4SIMD.h"
+
+namespace nbl
+{
+namespace core
+{
+
+//! Non-owning Structure-of-Arrays view over N elements, component `c` of element `n` lives at `comp[c][n]`
+template<typename T, uint32_t ComponentCount>
+struct SoAView
+{
+	_NBL_STATIC_INLINE_CONSTEXPR uint32_t Components = ComponentCount;
+
+	T* comp[ComponentCount];
+
+	//! all components in one allocation, one after the other with a stride of `_elementCount`
+	static inline SoAView fromContiguous(T* _base, size_t _elementCount)
+	{
+		SoAView retval;
+		for (uint32_t c=0u; c<ComponentCount; c++)
+			retval.comp[c] = _base+c*_elementCount;
+		return retval;
+	}
+
+	inline operator SoAView<const T,ComponentCount>() const
+	{
+		SoAView<const T,ComponentCount> retval;
+		for (uint32_t c=0u; c<ComponentCount; c++)
+			retval.comp[c] = comp[c];
+		return retval;
+	}
+};
+
+//! Batched counterparts of the `matrix3x4SIMD` and `matrix4SIMD` operations, working on many vectors or matrices at once.
+/** All inputs and outputs are SoA so that every SIMD lane processes a different element, the kernels are
+dispatched at runtime to the widest instruction set the CPU supports (SSE, AVX2+FMA or AVX-512F).
+Matrices in SoA form keep the row-major component order of their AoS counterparts, so component `4*row+column`.
+Outputs may alias inputs of the same kind exactly (in-place operation), but must not partially overlap them.
+*/
+class matrixSIMDBatch
+{
+		// private, undefined constructor
+		matrixSIMDBatch() = delete;
+
+	public:
+		enum E_ISA : uint32_t
+		{
+			EI_SSE = 0u,
+			EI_AVX2,
+			EI_AVX512,
+			EI_COUNT
+		};
+
+		using points_t = SoAView<float,3u>;
+		using const_points_t = SoAView<const float,3u>;
+		using homogeneous_points_t = SoAView<float,4u>;
+		//! min x,y,z then max x,y,z
+		using boxes_t = SoAView<float,6u>;
+		using const_boxes_t = SoAView<const float,6u>;
+		using affine_matrices_t = SoAView<float,12u>;
+		using const_affine_matrices_t = SoAView<const float,12u>;
+		using matrices_t = SoAView<float,16u>;
+		using const_matrices_t = SoAView<const float,16u>;
+
+		//! widest instruction set available on this CPU and OS
+		static E_ISA getSupportedISA();
+		//! instruction set the batched functions are currently dispatched to
+		static E_ISA getISA();
+		//! lets you force a narrower instruction set (i.e. for benchmarking), gets clamped to `getSupportedISA()`
+		static E_ISA setISA(E_ISA _isa);
+
+		//! `_out[n] = _mtx*vec4(_in[n],1)`, same as `matrix3x4SIMD::transformVect`
+		static void transformPoints(const matrix3x4SIMD& _mtx, points_t _out, const_points_t _in, size_t _count);
+		//! Transforms normals by the inverse transpose of the upper 3x3 of `_mtx`, optionally renormalizing them.
+		/** Singular matrices fall back to the transposed cofactor matrix, which still gives correct directions. */
+		static void transformNormals(const matrix3x4SIMD& _mtx, points_t _out, const_points_t _in, size_t _count, bool _renormalize=true);
+		//! Same as `transformBoxEx` for every box
+		static void transformBoxes(const matrix3x4SIMD& _mtx, boxes_t _out, const_boxes_t _in, size_t _count);
+		//! `_out[n] = _mtx*vec4(_in[n],1)` without the homogeneous divide, i.e. for clip-space frustum culling
+		static void transformPoints(const matrix4SIMD& _mtx, homogeneous_points_t _out, const_points_t _in, size_t _count);
+
+		//! `_out[n] = matrix3x4SIMD::concatenateBFollowedByA(_a[n],_b[n])`
+		static void concatenateBFollowedByA(affine_matrices_t _out, const_affine_matrices_t _a, const_affine_matrices_t _b, size_t _count);
+		//! `_out[n] = matrix4SIMD::concatenateBFollowedByA(_a[n],_b[n])`
+		static void concatenateBFollowedByA(matrices_t _out, const_matrices_t _a, const_matrices_t _b, size_t _count);
+
+		//! Inverts `_count` affine matrices like `matrix3x4SIMD::getInverse`, returns the number of successfully inverted ones.
+		/** Singular matrices get written out as all zeroes, `_valid` (optional) receives 1 or 0 per matrix. */
+		static size_t getInverse(affine_matrices_t _out, uint8_t* _valid, const_affine_matrices_t _in, size_t _count);
+
+		//! AoS <-> SoA conversions
+		static void toSoA(affine_matrices_t _out, const matrix3x4SIMD* _in, size_t _count);
+		static void fromSoA(matrix3x4SIMD* _out, const_affine_matrices_t _in, size_t _count);
+		static void toSoA(matrices_t _out, const matrix4SIMD* _in, size_t _count);
+		static void fromSoA(matrix4SIMD* _out, const_matrices_t _in, size_t _count);
+};
+
+}
+}
+
+#endif
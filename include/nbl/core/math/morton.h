@@ -71,6 +71,17 @@ namespace impl
 
         return x;
     }
+
+    //! Puts bits on every third position filling gaps with 0s, only the lowest 10 bits of `x` are kept
+    inline uint32_t separate_bits_3d(uint32_t x)
+    {
+        x &= 0x3ffu;
+        x = (x | (x << 16)) & 0x030000FFu;
+        x = (x | (x << 8)) & 0x0300F00Fu;
+        x = (x | (x << 4)) & 0x030C30C3u;
+        x = (x | (x << 2)) & 0x09249249u;
+        return x;
+    }
 }
 
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
@@ -81,6 +92,9 @@ T morton2d_decode_y(T _morton) { return impl::morton2d_decode<T,bitDepth>(_morto
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
 T morton2d_encode(T x, T y) { return impl::separate_bits_2d<T,bitDepth>(x) | (impl::separate_bits_2d<T,bitDepth>(y)<<1); }
 
+//! 10 bits per coordinate
+inline uint32_t morton3d_encode(uint32_t x, uint32_t y, uint32_t z) { return impl::separate_bits_3d(x) | (impl::separate_bits_3d(y)<<1) | (impl::separate_bits_3d(z)<<2); }
+
 }}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,197 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_C_PROFILER_H_INCLUDED__
+#define __NBL_CORE_C_PROFILER_H_INCLUDED__
+
+#include "nbl/core/compile_config.h"
+#include "nbl/core/Types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace nbl
+{
+namespace core
+{
+namespace profiling
+{
+
+//! Engine-wide counters, they only ever grow until `CProfiler::reset`
+enum E_COUNTER : uint32_t
+{
+	//! size of the files asset loaders successfully loaded assets from
+	EC_BYTES_DECODED = 0u,
+	//! output texels written by image filters
+	EC_TEXELS_FILTERED,
+	//! LZ4 or LZMA compressed blobs and archive entries
+	EC_BLOBS_DECOMPRESSED,
+	EC_COUNT
+};
+
+struct SEvent
+{
+	enum E_TYPE : uint32_t
+	{
+		ET_SCOPE = 0u,
+		//! `end` holds the counter value after the addition
+		ET_COUNTER
+	};
+	_NBL_STATIC_INLINE_CONSTEXPR size_t MaxDetailLength = 55ull;
+
+	//! must be string literals, they don't get copied
+	const char* name;
+	const char* category;
+	//! nanoseconds since the profiler got created
+	uint64_t begin;
+	uint64_t end;
+	E_TYPE type;
+	//! free form argument, only the tail is kept if it's longer since that is the informative part of file paths
+	char detail[MaxDetailLength+1ull];
+};
+
+//! Collects timed scopes and counter samples from all threads
+/** Every thread records into its own ring buffer without taking locks or allocating (after its first event),
+once a ring is full the oldest events of that thread get overwritten.
+Exporting can happen while other threads keep recording, but events overwritten during the export get dropped.
+Don't use directly, use the `NBL_PROFILE_*` macros so it all compiles out without `_NBL_ENABLE_PROFILING_`. */
+class CProfiler
+{
+	public:
+		//! Per thread, must be a power of two
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t EventsPerThread = 0x1u<<14u;
+
+		static CProfiler& get();
+
+		inline bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+		//! Counters keep counting while disabled, only the events stop being recorded
+		inline void setEnabled(bool _enabled) { enabled.store(_enabled,std::memory_order_relaxed); }
+
+		inline uint64_t now() const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+		}
+
+		//! Appends to the calling thread's ring
+		void record(const SEvent& _event);
+
+		inline uint64_t addToCounter(E_COUNTER _counter, uint64_t _value)
+		{
+			const uint64_t total = counters[_counter].fetch_add(_value,std::memory_order_relaxed)+_value;
+			if (isEnabled())
+			{
+				SEvent sample;
+				sample.name = getCounterName(_counter);
+				sample.category = "counter";
+				sample.begin = now();
+				sample.end = total;
+				sample.type = SEvent::ET_COUNTER;
+				sample.detail[0] = 0;
+				record(sample);
+			}
+			return total;
+		}
+		inline uint64_t getCounter(E_COUNTER _counter) const { return counters[_counter].load(std::memory_order_relaxed); }
+
+		static const char* getCounterName(E_COUNTER _counter);
+
+		//! Shows up as the thread's name in the trace, `_name` must be a string literal
+		void setThreadName(const char* _name);
+
+		//! Drops all recorded events and zeroes the counters
+		void reset();
+
+		//! Chrome's trace event JSON format, which chrome://tracing and Perfetto both open
+		void writeChromeTrace(std::ostream& _out) const;
+		bool writeChromeTrace(const std::string& _filename) const;
+
+	private:
+		class CThreadBuffer;
+
+		CProfiler();
+		~CProfiler();
+		CProfiler(const CProfiler&) = delete;
+		CProfiler& operator=(const CProfiler&) = delete;
+
+		CThreadBuffer* getThreadBuffer();
+
+		const std::chrono::steady_clock::time_point start;
+		std::atomic_bool enabled;
+		std::atomic<uint64_t> counters[EC_COUNT];
+
+		//! only taken when a thread records its first event and when exporting
+		mutable std::mutex buffersMutex;
+		//! never shrinks, so events of threads which already exited can still be exported
+		core::vector<std::unique_ptr<CThreadBuffer>> buffers;
+};
+
+//! RAII timed scope, records nothing while the profiler is disabled
+class CScope
+{
+	public:
+		inline CScope(const char* _name, const char* _category, const char* _detail=nullptr)
+		{
+			CProfiler& profiler = CProfiler::get();
+			if (!profiler.isEnabled())
+			{
+				event.name = nullptr;
+				return;
+			}
+
+			event.name = _name;
+			event.category = _category;
+			event.type = SEvent::ET_SCOPE;
+			size_t detailLen = _detail ? strlen(_detail):0ull;
+			if (detailLen > SEvent::MaxDetailLength)
+			{
+				_detail += detailLen-SEvent::MaxDetailLength;
+				detailLen = SEvent::MaxDetailLength;
+			}
+			if (detailLen)
+				memcpy(event.detail,_detail,detailLen);
+			event.detail[detailLen] = 0;
+			event.begin = profiler.now();
+		}
+		inline ~CScope()
+		{
+			if (!event.name)
+				return;
+
+			CProfiler& profiler = CProfiler::get();
+			event.end = profiler.now();
+			profiler.record(event);
+		}
+
+		CScope(const CScope&) = delete;
+		CScope& operator=(const CScope&) = delete;
+
+	private:
+		SEvent event;
+};
+
+} // end namespace profiling
+} // end namespace core
+} // end namespace nbl
+
+#define _NBL_PROFILE_CONCAT_IMPL(X,Y) X##Y
+#define _NBL_PROFILE_CONCAT(X,Y) _NBL_PROFILE_CONCAT_IMPL(X,Y)
+
+#ifdef _NBL_ENABLE_PROFILING_
+	//! `NAME` and `CATEGORY` must be string literals, `DETAIL` can be any C string
+	#define NBL_PROFILE_SCOPE(NAME,CATEGORY) ::nbl::core::profiling::CScope _NBL_PROFILE_CONCAT(_nbl_profile_scope_,__LINE__)(NAME,CATEGORY)
+	#define NBL_PROFILE_SCOPE_DETAIL(NAME,CATEGORY,DETAIL) ::nbl::core::profiling::CScope _NBL_PROFILE_CONCAT(_nbl_profile_scope_,__LINE__)(NAME,CATEGORY,DETAIL)
+	//! `COUNTER` is an `E_COUNTER` enumerator without the namespace
+	#define NBL_PROFILE_COUNTER(COUNTER,VALUE) ::nbl::core::profiling::CProfiler::get().addToCounter(::nbl::core::profiling::COUNTER,VALUE)
+#else
+	#define NBL_PROFILE_SCOPE(NAME,CATEGORY)
+	#define NBL_PROFILE_SCOPE_DETAIL(NAME,CATEGORY,DETAIL)
+	#define NBL_PROFILE_COUNTER(COUNTER,VALUE) ((void)0)
+#endif
+
+#endif
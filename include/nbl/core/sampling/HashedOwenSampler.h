@@ -0,0 +1,138 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_HASHED_OWEN_SAMPLER_H_
+#define __NBL_CORE_HASHED_OWEN_SAMPLER_H_
+
+#include "nbl/core/sampling/SobolSampler.h"
+
+namespace nbl
+{
+namespace core
+{
+
+	//! Owen scrambled sequence which hashes the bits of every sample instead of looking the flips up in a random tree like `OwenSampler`
+	/** Uses the Laine-Karras permutation on the bit-reversed value (with the constants from Burley's "Practical Hash-based Owen Scrambling"),
+	in which every bit only gets flipped depending on the seed and the bits above it, that's exactly a nested uniform scramble.
+	So no tables, no limit on the sample count and dimensions can be sampled in any order.
+	The values differ from an `OwenSampler` with the same seed. */
+	template<class SequenceSampler=SobolSampler>
+	class HashedOwenSampler : protected SequenceSampler
+	{
+	public:
+		HashedOwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions), seed(_seed)
+		{
+		}
+
+		//
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
+		{
+			return scramble(SequenceSampler::sample(dim,sampleNum),getDimensionSeed(dim));
+		}
+
+		//! Same layout as `SobolSampler::generate`, the scrambling is done right after every row is generated, in SIMD across dimensions
+		inline void generate(uint32_t* out, uint32_t firstDim, uint32_t dimCount, uint32_t firstSample, uint32_t sampleCount) const
+		{
+			core::vector<uint32_t> seeds(dimCount);
+			for (uint32_t d=0u; d<dimCount; d++)
+				seeds[d] = getDimensionSeed(firstDim+d);
+
+			SequenceSampler::generate_impl(out,firstDim,dimCount,firstSample,sampleCount,[&seeds,dimCount](uint32_t* row) -> void
+			{
+				uint32_t d = 0u;
+				#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+				for (; d+4u<=dimCount; d+=4u)
+				{
+					const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row+d));
+					const __m128i dimSeeds = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seeds.data()+d));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(row+d),scramble(value,dimSeeds));
+				}
+				#endif
+				for (; d<dimCount; d++)
+					row[d] = scramble(row[d],seeds[d]);
+			});
+		}
+
+		//! Nested uniform scramble of all 32 bits of `value`
+		static inline uint32_t scramble(uint32_t value, uint32_t _seed)
+		{
+			return reverseBits(laineKarrasPermutation(reverseBits(value),_seed));
+		}
+
+		#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		static inline __m128i scramble(__m128i value, __m128i _seed)
+		{
+			return reverseBits(laineKarrasPermutation(reverseBits(value),_seed));
+		}
+		#endif
+
+		//! Dimensions get decorrelated by scrambling each with a different seed
+		inline uint32_t getDimensionSeed(uint32_t dim) const
+		{
+			return hash(seed^hash(dim));
+		}
+
+	protected:
+		// carries only ever propagate towards the top bits, which are the bottom bits of the un-reversed value
+		static inline uint32_t laineKarrasPermutation(uint32_t x, uint32_t _seed)
+		{
+			x += _seed;
+			x ^= x*0x6c50b47cu;
+			x ^= x*0xb82f1e52u;
+			x ^= x*0xc7afe638u;
+			x ^= x*0x8d22f6e6u;
+			return x;
+		}
+
+		static inline uint32_t reverseBits(uint32_t x)
+		{
+			x = ((x>>1u)&0x55555555u)|((x&0x55555555u)<<1u);
+			x = ((x>>2u)&0x33333333u)|((x&0x33333333u)<<2u);
+			x = ((x>>4u)&0x0f0f0f0fu)|((x&0x0f0f0f0fu)<<4u);
+			x = ((x>>8u)&0x00ff00ffu)|((x&0x00ff00ffu)<<8u);
+			return (x>>16u)|(x<<16u);
+		}
+
+		#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		static inline __m128i laineKarrasPermutation(__m128i x, __m128i _seed)
+		{
+			x = _mm_add_epi32(x,_seed);
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0x6c50b47cu)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0xb82f1e52u)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0xc7afe638u)));
+			x = _mm_xor_si128(x,_mm_mullo_epi32(x,_mm_set1_epi32(0x8d22f6e6u)));
+			return x;
+		}
+
+		// reverse the nibbles with a lookup, swap them within the bytes, then reverse the bytes
+		static inline __m128i reverseBits(__m128i x)
+		{
+			const __m128i nibbleReverse = _mm_setr_epi8(0x0,0x8,0x4,0xc,0x2,0xa,0x6,0xe,0x1,0x9,0x5,0xd,0x3,0xb,0x7,0xf);
+			const __m128i lowNibbles = _mm_set1_epi8(0x0f);
+			const __m128i lo = _mm_shuffle_epi8(nibbleReverse,_mm_and_si128(x,lowNibbles));
+			const __m128i hi = _mm_shuffle_epi8(nibbleReverse,_mm_and_si128(_mm_srli_epi16(x,4),lowNibbles));
+			x = _mm_or_si128(_mm_slli_epi16(lo,4),hi);
+			return _mm_shuffle_epi8(x,_mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12));
+		}
+		#endif
+
+		// "lowbias32" integer hash by Chris Wellons
+		static inline uint32_t hash(uint32_t x)
+		{
+			x ^= x>>16u;
+			x *= 0x7feb352du;
+			x ^= x>>15u;
+			x *= 0x846ca68bu;
+			x ^= x>>16u;
+			return x;
+		}
+
+		uint32_t seed;
+	};
+
+
+}
+}
+
+#endif
@@ -14,6 +14,7 @@ namespace core
 {
 
 	//! TODO: make the tree sampler/generator configurable and let RandomSampler be default
+	//! Every new dimension rebuilds a 64MB tree, prefer `HashedOwenSampler` which needs no tables
 	template<class SequenceSampler=SobolSampler>
 	class OwenSampler : protected SequenceSampler
 	{
@@ -7,6 +7,10 @@
 
 #include "nbl/core/Types.h"
 
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
 namespace nbl
 {
 namespace core
@@ -78,8 +82,8 @@ class SobolSampler
 			_NBL_ALIGNED_FREE(directions);
 		}
 		
-		// Idea for optimization, do PoT samples per pass, then can precompute most of the `retval`
-		inline uint32_t sample(uint32_t dim, uint32_t sampleNum)
+		// prefer `generate` when you need many consecutive samples
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
 		{
 			#ifdef _DEBUG
 				assert(dim<dimensions);
@@ -93,7 +97,74 @@ class SobolSampler
 			return retval;
 		}
 
+		//! Fills `out[(i-firstSample)*dimCount+d]` with `sample(firstDim+d,i)` for all `i` in `[firstSample,firstSample+sampleCount)`
+		/** Threads split the samples into contiguous chunks and walk them in order, going from sample `i` to `i+1` only flips bits `0` to `findLSB(i+1)`
+		of the index, so every sample is the previous one XORed with a prefix XOR of the direction numbers (one XOR per dimension, SIMD across dimensions).
+		Unlike the classic Gray code construction this keeps the samples in their natural order. */
+		inline void generate(uint32_t* out, uint32_t firstDim, uint32_t dimCount, uint32_t firstSample, uint32_t sampleCount) const
+		{
+			generate_impl(out,firstDim,dimCount,firstSample,sampleCount,[](uint32_t* row) -> void {});
+		}
+
 	protected:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t GENERATE_CHUNK_SIZE = 0x1u<<12u;
+
+		//! `rowFunc(uint32_t*)` gets to modify every output row of `dimCount` values right after it has been written, possibly from many threads at once
+		template<typename RowFunc>
+		inline void generate_impl(uint32_t* out, uint32_t firstDim, uint32_t dimCount, uint32_t firstSample, uint32_t sampleCount, RowFunc&& rowFunc) const
+		{
+			assert(firstDim+dimCount<=dimensions);
+			assert(uint64_t(firstSample)+sampleCount<=(0x1ull<<SOBOL_BITS));
+			if (!dimCount || !sampleCount)
+				return;
+
+			auto vectors = *reinterpret_cast<const uint32_t(*)[][SOBOL_BITS]>(directions);
+			// laid out bit-major so the dimensions of one row are contiguous
+			core::vector<uint32_t> deltas(SOBOL_BITS*dimCount);
+			for (uint32_t d=0u; d<dimCount; d++)
+			{
+				uint32_t delta = 0u;
+				for (uint32_t i=0u; i<SOBOL_BITS; i++)
+					deltas[i*dimCount+d] = (delta ^= vectors[firstDim+d][i]);
+			}
+
+			core::vector<uint32_t> chunks((sampleCount-1u)/GENERATE_CHUNK_SIZE+1u);
+			std::iota(chunks.begin(),chunks.end(),0u);
+			std::for_each(std::execution::par,chunks.begin(),chunks.end(),[&](const uint32_t chunk) -> void
+			{
+				const uint32_t chunkOffset = chunk*GENERATE_CHUNK_SIZE;
+				const uint32_t chunkSize = core::min(sampleCount-chunkOffset,GENERATE_CHUNK_SIZE);
+
+				core::vector<uint32_t> state(dimCount);
+				for (uint32_t d=0u; d<dimCount; d++)
+					state[d] = sample(firstDim+d,firstSample+chunkOffset);
+
+				uint32_t* row = out+size_t(chunkOffset)*dimCount;
+				for (uint32_t i=0u; i<chunkSize; i++,row+=dimCount)
+				{
+					const bool last = i+1u==chunkSize;
+					const uint32_t* delta = last ? nullptr:(deltas.data()+core::findLSB(firstSample+chunkOffset+i+1u)*dimCount);
+					uint32_t d = 0u;
+					#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+					for (; d+4u<=dimCount; d+=4u)
+					{
+						const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data()+d));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(row+d),current);
+						if (!last)
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(state.data()+d),_mm_xor_si128(current,_mm_loadu_si128(reinterpret_cast<const __m128i*>(delta+d))));
+					}
+					#endif
+					for (; d<dimCount; d++)
+					{
+						row[d] = state[d];
+						if (!last)
+							state[d] ^= delta[d];
+					}
+					rowFunc(row);
+				}
+			});
+		}
+
 		typedef struct SobolDirectionNumbers {
 			uint32_t d, s, a;
 			uint32_t m[SOBOL_BITS];
@@ -37,16 +37,25 @@ class CMitsubaLoader : public asset::IRenderpassIndependentPipelineLoader
 
 	protected:
 		io::IFileSystem* m_filesystem;
+		//! not registered with the asset manager, decodes only the meshes shapes reference and caches them across loads
+		core::smart_refctd_ptr<CSerializedLoader> m_serializedLoader;
 
 		//! Destructor
 		virtual ~CMitsubaLoader() = default;
 
 		static core::smart_refctd_ptr<asset::ICPUPipelineLayout> createPipelineLayout(asset::IAssetManager* _manager, asset::ICPUVirtualTexture* _vt);
 
-		//
-		core::vector<SContext::shape_ass_type>	getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
-		core::vector<SContext::shape_ass_type>	loadShapeGroup(SContext& ctx, uint32_t hierarchyLevel, const CElementShape::ShapeGroup* shapegroup, const core::matrix3x4SIMD& relTform);
-		SContext::shape_ass_type				loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape, const core::matrix3x4SIMD& relTform);
+		//! flattens instances of shapegroups into the basic shapes they place, in the order `loadAsset` will add the instances in
+		static void								gatherShapeInstances(core::vector<SContext::SShapeInstance>& out, CElementShape* shape, uint32_t topLevelIx);
+		static void								gatherShapeGroup(core::vector<SContext::SShapeInstance>& out, const CElementShape::ShapeGroup* shapegroup, const core::matrix3x4SIMD& relTform, uint32_t topLevelIx);
+		//! loads every model, `.serialized` file and bitmap the shapes and their BSDFs reference into `ctx.prefetched` on the worker pool
+		void									prefetchFiles(SContext& ctx, uint32_t hierarchyLevel, const core::vector<SContext::SShapeInstance>& instances);
+		asset::SAssetBundle						loadSerializedMeshes(SContext& ctx, uint32_t hierarchyLevel, const std::string& filename, const core::vector<uint32_t>& meshIndices);
+		//! creates the meshes of all the distinct shapes on the worker pool, into `ctx.shapeCache`
+		void									loadShapes(SContext& ctx, uint32_t hierarchyLevel, const core::vector<SContext::SShapeInstance>& instances);
+		SContext::shape_ass_type				loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape);
+		//! compiles the shape's BSDF if it hasn't been yet, so the order this gets called in decides the order of the material compiler's IR
+		void									addInstance(SContext& ctx, const SContext::SShapeInstance& instance, const SContext::shape_ass_type& mesh);
 		
 		SContext::tex_ass_type					cacheTexture(SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* texture, bool _restore = false);
 
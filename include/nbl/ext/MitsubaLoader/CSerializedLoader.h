@@ -22,8 +22,15 @@ class CSerializedLoader final : public asset::IRenderpassIndependentPipelineLoad
 		inline ~CSerializedLoader() {}
 
 	public:
+		//! Upper bound on the size of the buffers of meshes `loadMeshes` keeps decoded
+		_NBL_STATIC_INLINE_CONSTEXPR size_t DefaultMeshCacheByteCapacity = 1024ull*1024ull*1024ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MeshCacheCapacity = 0x1u<<16u;
+		//! Compressed meshes get read in batches of about this size, then inflated in parallel
+		_NBL_STATIC_INLINE_CONSTEXPR size_t CompressedBatchSize = 256ull*1024ull*1024ull;
+
 		//! Constructor
-		CSerializedLoader(asset::IAssetManager* _manager) : IRenderpassIndependentPipelineLoader(_manager) {}
+		CSerializedLoader(asset::IAssetManager* _manager, const size_t _meshCacheByteCapacity=DefaultMeshCacheByteCapacity) :
+			IRenderpassIndependentPipelineLoader(_manager), m_meshCache(MeshCacheCapacity,_meshCacheByteCapacity) {}
 
 		inline bool isALoadableFileFormat(io::IReadFile* _file) const override
 		{
@@ -48,6 +55,17 @@ class CSerializedLoader final : public asset::IRenderpassIndependentPipelineLoad
 		//! creates/loads an animated mesh from the file.
 		asset::SAssetBundle loadAsset(io::IReadFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
+		//! Only decodes the meshes at `_meshIndices`, the file's offset table is all that gets read up front
+		/** Meant for Mitsuba shapes, which reference single meshes of (possibly huge) files via `shapeIndex`.
+		Meshes get inflated in parallel and are kept in a cache shared by all calls, keyed by file name and mesh index, so shapes sharing a file only decode each mesh once.
+		Every call returns its own copies of the cached meshes, so they can be modified freely.
+		Like with `loadAsset` meshes which fail to decode are skipped, the `CMitsubaSerializedMetadata::CMesh::m_id` tells which index every returned mesh is.
+		The bundle doesn't go into the asset manager's cache. */
+		asset::SAssetBundle loadMeshes(io::IReadFile* _file, const core::SRange<const uint32_t>& _meshIndices, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u);
+
+		//! Drops all meshes cached by `loadMeshes`
+		inline void clearMeshCache() { m_meshCache.clear(); }
+
 	private:
 
 		struct FileHeader
@@ -68,6 +86,51 @@ class CSerializedLoader final : public asset::IRenderpassIndependentPipelineLoad
 			uint32_t meshCount;
 			core::smart_refctd_dynamic_array<uint64_t> meshOffsets;
 		};
+		//! resolved before decoding in parallel, since looking assets up in the manager isn't thread safe
+		struct SDefaultAssets
+		{
+			//! for debug vertex colors, UVs and normals
+			core::smart_refctd_ptr<asset::ICPUSpecializedShader> vertexShaders[3];
+			core::smart_refctd_ptr<asset::ICPUSpecializedShader> fragmentShaders[3];
+			core::smart_refctd_ptr<asset::ICPUPipelineLayout> pipelineLayout;
+		};
+		struct SDecodedMesh
+		{
+			core::smart_refctd_ptr<asset::ICPUMesh> mesh;
+			std::string name;
+			uint32_t index;
+		};
+		struct SMeshCacheKey
+		{
+			std::string filename;
+			//! so a file which changed on disk doesn't hit stale entries
+			size_t fileSize;
+			uint32_t meshIndex;
+
+			inline bool operator==(const SMeshCacheKey& other) const
+			{
+				return meshIndex==other.meshIndex && fileSize==other.fileSize && filename==other.filename;
+			}
+		};
+		struct SMeshCacheKeyHash
+		{
+			inline size_t operator()(const SMeshCacheKey& key) const
+			{
+				return std::hash<std::string>()(key.filename)^(size_t(key.meshIndex)*0x9E3779B97F4A7C15ull)^key.fileSize;
+			}
+		};
+
+		//! reads the header and the table of mesh offsets at the end of the file
+		bool readOffsetTable(SContext& ctx) const;
+		SDefaultAssets findDefaultAssets(SContext& ctx, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel) const;
+		//! reads the compressed meshes in batches of `CompressedBatchSize`, then inflates and builds a batch in parallel, failed meshes have a null `mesh`
+		core::vector<SDecodedMesh> decodeMeshes(SContext& ctx, const core::vector<uint32_t>& meshIndices, const SDefaultAssets& defaults) const;
+		SDecodedMesh decodeMesh(const uint8_t* compressed, const size_t compressedSize, const uint32_t meshIndex, const SDefaultAssets& defaults) const;
+		//! cached meshes never leave the cache, callers get their own meshbuffers, pipelines and buffer since the Mitsuba loader alters those in place
+		static SDecodedMesh copyDecodedMesh(const SDecodedMesh& decoded);
+		asset::SAssetBundle createBundle(const core::vector<SDecodedMesh>& decoded) const;
+
+		core::ConcurrentLRUCache<SMeshCacheKey,SDecodedMesh,SMeshCacheKeyHash> m_meshCache;
 };
 
 
@@ -6,6 +6,8 @@
 #define __C_MITSUBA_LOADER_CONTEXT_H_INCLUDED__
 
 
+#include <mutex>
+
 #include "nbl/asset/ICPUMesh.h"
 #include "nbl/asset/utils/IGeometryCreator.h"
 #include "nbl/asset/material_compiler/CMaterialCompilerGLSLRasterBackend.h"
@@ -46,7 +48,44 @@ namespace MitsubaLoader
 		//core::map<const CElementShape::ShapeGroup*, group_ass_type> groupCache;
 		//
 		using shape_ass_type = core::smart_refctd_ptr<asset::ICPUMesh>;
-		core::map<const CElementShape*, shape_ass_type> shapeCache;
+		//! filled by the shape loading tasks concurrently, shapes which failed to load never get inserted
+		class CShapeCache
+		{
+			public:
+				inline shape_ass_type find(const CElementShape* shape) const
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					auto found = map.find(shape);
+					return found!=map.end() ? found->second:nullptr;
+				}
+				inline void insert(const CElementShape* shape, shape_ass_type&& mesh)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					map.emplace(shape,std::move(mesh));
+				}
+
+			private:
+				mutable std::mutex mutex;
+				core::unordered_map<const CElementShape*, shape_ass_type> map;
+		};
+		CShapeCache shapeCache;
+		//! a basic shape placed in the scene either on its own or as a child of an instanced shapegroup, in the order the scene lists them
+		struct SShapeInstance
+		{
+			CElementShape* shape;
+			core::matrix3x4SIMD relTform;
+			//! the top level shape (the shape itself or the instance) in `ParserManager::shapegroups`, the mesh gets named after the first one
+			uint32_t topLevelIx;
+		};
+		//! files which shapes and materials need, loaded up front on the worker pool, keyed by the filename as in the scene
+		//! nothing gets inserted once the shapes and materials start being processed, so they're only ever read concurrently
+		struct SPrefetchedFiles
+		{
+			core::unordered_map<std::string, asset::SAssetBundle> models;
+			//! only the meshes of a `.serialized` file which some shape references
+			core::unordered_map<std::string, asset::SAssetBundle> serialized;
+			core::unordered_map<std::string, asset::SAssetBundle> bitmaps;
+		} prefetched;
 		//image, sampler
 		using tex_ass_type = std::tuple<core::smart_refctd_ptr<asset::ICPUImageView>, core::smart_refctd_ptr<asset::ICPUSampler>>;
 
@@ -106,6 +106,7 @@ class IGPUObjectFromAssetConverter
         std::enable_if_t<!impl::is_const_iterator_v<iterator_type>, created_gpu_object_array<AssetType>>
         getGPUObjectsFromAssets(iterator_type _begin, iterator_type _end, const SParams& _params = {})
 		{
+			NBL_PROFILE_SCOPE("IGPUObjectFromAssetConverter::getGPUObjectsFromAssets","video");
 			const auto assetCount = _end-_begin;
 			auto res = core::make_refctd_dynamic_array<created_gpu_object_array<AssetType> >(assetCount);
 
@@ -0,0 +1,306 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+#include "CAsyncLogger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace nbl
+{
+
+namespace
+{
+
+std::atomic<uint64_t> nextLoggerId(1ull);
+
+void flushGlobalLogger()
+{
+	if (auto asyncLogger = dynamic_cast<CAsyncLogger*>(os::Printer::Logger))
+		asyncLogger->flushFromCrashHandler();
+}
+
+std::terminate_handler previousTerminateHandler = nullptr;
+
+}
+
+
+CAsyncLogger::CAsyncLogger(core::smart_refctd_ptr<CLogger>&& sink)
+	: Sink(std::move(sink)), LogLevel(Sink->getLogLevel()), NextSequence(0ull), Id(nextLoggerId++),
+	LastRepeatsReport(std::chrono::steady_clock::now()), Quit(false), SinkIdle(false), SinkThread(&CAsyncLogger::sinkThreadMain,this)
+{
+	#ifdef _NBL_DEBUG
+	setDebugName("CAsyncLogger");
+	#endif
+}
+
+CAsyncLogger::~CAsyncLogger()
+{
+	Quit.store(true);
+	WakeCondition.notify_one();
+	SinkThread.join();
+
+	std::lock_guard<std::mutex> lock(SinkMutex);
+	drain();
+	reportRepeats(true);
+}
+
+void CAsyncLogger::setLogLevel(ELOG_LEVEL ll)
+{
+	LogLevel.store(ll,std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(SinkMutex);
+	Sink->setLogLevel(ll);
+}
+
+void CAsyncLogger::log(const std::string& text, ELOG_LEVEL ll)
+{
+	push(ll,text,static_cast<const std::string*>(nullptr));
+}
+
+void CAsyncLogger::log(const std::wstring& text, ELOG_LEVEL ll)
+{
+	push(ll,text,static_cast<const std::string*>(nullptr));
+}
+
+void CAsyncLogger::log(const std::string& text, const std::string& hint, ELOG_LEVEL ll)
+{
+	push(ll,text,&hint);
+}
+
+void CAsyncLogger::log(const std::string& text, const std::wstring& hint, ELOG_LEVEL ll)
+{
+	push(ll,text,&hint);
+}
+
+void CAsyncLogger::log(const std::wstring& text, const std::wstring& hint, ELOG_LEVEL ll)
+{
+	push(ll,text,&hint);
+}
+
+void CAsyncLogger::flush()
+{
+	std::lock_guard<std::mutex> lock(SinkMutex);
+	drain();
+	reportRepeats(false);
+}
+
+void CAsyncLogger::flushFromCrashHandler()
+{
+	// the sink thread might be the one which crashed while holding the lock, so only wait a bit for it
+	std::unique_lock<std::mutex> lock(SinkMutex,std::defer_lock);
+	for (uint32_t i=0u; i<100u && !lock.try_lock(); i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	// draining without the lock would race whoever holds it, losing the queued records is the lesser evil
+	if (!lock.owns_lock())
+		return;
+	drain();
+	reportRepeats(true);
+}
+
+void CAsyncLogger::installCrashHandlers()
+{
+	static std::once_flag installed;
+	std::call_once(installed,[]() -> void
+	{
+		previousTerminateHandler = std::set_terminate([]() -> void
+		{
+			flushGlobalLogger();
+			if (previousTerminateHandler)
+				previousTerminateHandler();
+			std::abort();
+		});
+	});
+}
+
+void CAsyncLogger::setReceiver(IEventReceiver* r)
+{
+	std::lock_guard<std::mutex> lock(SinkMutex);
+	Sink->setReceiver(r);
+}
+
+
+template<typename T1, typename T2>
+void CAsyncLogger::push(ELOG_LEVEL ll, const std::basic_string<T1>& text, const std::basic_string<T2>* hint)
+{
+	if (ll < getLogLevel())
+		return;
+
+	SRing* ring = getThreadRing();
+	const uint64_t head = ring->head.load(std::memory_order_relaxed);
+	// full, wait for the sink thread to catch up
+	while (head-ring->tail.load(std::memory_order_acquire) >= RecordsPerThread)
+	{
+		WakeCondition.notify_one();
+		std::this_thread::yield();
+	}
+
+	SRecord& record = ring->records[head&(RecordsPerThread-1u)];
+	record.level = ll;
+	record.textLength = text.size();
+	record.hintLength = hint ? hint->size():SRecord::NoHint;
+	bool storedInline = false;
+	if constexpr (std::is_same_v<T1,char> && std::is_same_v<T2,char>)
+	if (text.size()+(hint ? hint->size():0ull) <= SRecord::InlineCapacity)
+	{
+		memcpy(record.inlineData,text.data(),text.size());
+		if (hint)
+			memcpy(record.inlineData+text.size(),hint->data(),hint->size());
+		storedInline = true;
+	}
+	if (!storedInline)
+	{
+		record.deferred = std::make_unique<SRecord::SDeferred>();
+		if constexpr (std::is_same_v<T1,char>)
+			record.deferred->text = text;
+		else
+			record.deferred->wideText = text;
+		if (hint)
+		{
+			if constexpr (std::is_same_v<T2,char>)
+				record.deferred->hint = *hint;
+			else
+				record.deferred->wideHint = *hint;
+		}
+	}
+	record.sequence = NextSequence.fetch_add(1ull,std::memory_order_relaxed);
+	ring->head.store(head+1ull,std::memory_order_release);
+
+	if (SinkIdle.load(std::memory_order_relaxed) && SinkIdle.exchange(false))
+		WakeCondition.notify_one();
+}
+
+CAsyncLogger::SRing* CAsyncLogger::getThreadRing()
+{
+	struct SThreadRing
+	{
+		uint64_t loggerId = 0ull;
+		std::shared_ptr<SRing> ring;
+	};
+	static thread_local SThreadRing cached;
+	if (cached.loggerId != Id)
+	{
+		auto ring = std::make_shared<SRing>();
+		{
+			std::lock_guard<std::mutex> lock(RingsMutex);
+			Rings.push_back(ring);
+		}
+		cached.loggerId = Id;
+		cached.ring = std::move(ring);
+	}
+	return cached.ring.get();
+}
+
+void CAsyncLogger::drain()
+{
+	{
+		std::lock_guard<std::mutex> lock(RingsMutex);
+		for (auto it=Rings.begin(); it!=Rings.end();)
+		{
+			// checked before reading `head`, if nobody else holds the ring anymore then nothing can get pushed after
+			const bool orphaned = it->use_count()==1;
+
+			SRing* ring = it->get();
+			const uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+			for (; tail<head; tail++)
+				Batch.push_back(std::move(ring->records[tail&(RecordsPerThread-1u)]));
+			ring->tail.store(tail,std::memory_order_release);
+
+			if (orphaned)
+				it = Rings.erase(it);
+			else
+				it++;
+		}
+	}
+
+	// a thread's records are in order already, this only interleaves the threads' records published by now
+	std::sort(Batch.begin(),Batch.end(),[](const SRecord& lhs, const SRecord& rhs) -> bool {return lhs.sequence<rhs.sequence;});
+	for (auto& record : Batch)
+		write(record);
+	Batch.clear();
+
+	if (std::chrono::steady_clock::now()-LastRepeatsReport >= RateLimitWindow)
+		reportRepeats(false);
+}
+
+void CAsyncLogger::write(SRecord& record)
+{
+	std::string message;
+	if (record.deferred)
+	{
+		auto& deferred = *record.deferred;
+		message = deferred.wideText.empty() ? std::move(deferred.text):core::WStringToUTF8String(deferred.wideText);
+		if (record.hintLength != SRecord::NoHint)
+		{
+			message += ": ";
+			message += deferred.wideHint.empty() ? deferred.hint:core::WStringToUTF8String(deferred.wideHint);
+		}
+		record.deferred = nullptr;
+	}
+	else
+	{
+		message.assign(record.inlineData,record.textLength);
+		if (record.hintLength != SRecord::NoHint)
+		{
+			message += ": ";
+			message.append(record.inlineData+record.textLength,record.hintLength);
+		}
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	auto& repeats = Repeats[message];
+	if (repeats.count==0u || now-repeats.windowStart >= RateLimitWindow)
+	{
+		if (repeats.suppressed)
+			Sink->log("Suppressed "+std::to_string(repeats.suppressed)+" repeats of: "+message,repeats.level);
+		repeats.windowStart = now;
+		repeats.count = 0u;
+		repeats.suppressed = 0u;
+		repeats.level = record.level;
+	}
+	if (++repeats.count > MaxRepeatsPerWindow)
+	{
+		repeats.suppressed++;
+		return;
+	}
+	Sink->log(message,record.level);
+}
+
+void CAsyncLogger::reportRepeats(bool _all)
+{
+	const auto now = std::chrono::steady_clock::now();
+	for (auto it=Repeats.begin(); it!=Repeats.end();)
+	{
+		if (_all || now-it->second.windowStart >= RateLimitWindow)
+		{
+			if (it->second.suppressed)
+				Sink->log("Suppressed "+std::to_string(it->second.suppressed)+" repeats of: "+it->first,it->second.level);
+			it = Repeats.erase(it);
+		}
+		else
+			it++;
+	}
+	LastRepeatsReport = now;
+}
+
+void CAsyncLogger::sinkThreadMain()
+{
+	while (!Quit.load())
+	{
+		{
+			std::unique_lock<std::mutex> lock(WakeMutex);
+			SinkIdle.store(true,std::memory_order_relaxed);
+			// a wakeup racing with going to sleep only costs a `SinkPollInterval` of latency
+			WakeCondition.wait_for(lock,SinkPollInterval,[this]() -> bool {return !SinkIdle.load(std::memory_order_relaxed) || Quit.load();});
+			SinkIdle.store(false,std::memory_order_relaxed);
+		}
+		std::lock_guard<std::mutex> lock(SinkMutex);
+		drain();
+	}
+}
+
+
+} // end namespace nbl
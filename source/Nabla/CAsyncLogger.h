@@ -0,0 +1,161 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_ASYNC_LOGGER_H_INCLUDED__
+#define __NBL_C_ASYNC_LOGGER_H_INCLUDED__
+
+#include "CLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace nbl
+{
+
+//! Logger which hands messages over to a background thread writing them out through a `CLogger`
+/** Every logging thread gets its own single producer ring of records, so logging never takes a lock (apart from a thread's first message)
+and never waits for the console, only once its ring is full. The sink thread joins hints and converts wide strings,
+writes the records of every thread in the order they were logged, and rate limits identical messages.
+Records of different threads are only ordered among the ones picked up by the same drain, one logged earlier on another
+thread can still show up after them if it got published late.
+The `CLogger`'s event receiver gets called from the sink thread.
+*/
+class CAsyncLogger : public ILogger
+{
+	public:
+		//! Per logging thread, must be a power of two
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t RecordsPerThread = 0x1u<<10u;
+		//! Identical messages past this many within `RateLimitWindow` only get counted, then reported once the window is over
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxRepeatsPerWindow = 8u;
+		_NBL_STATIC_INLINE_CONSTEXPR std::chrono::milliseconds RateLimitWindow = std::chrono::milliseconds(1000);
+		//! How long the sink thread sleeps when nobody wakes it up
+		_NBL_STATIC_INLINE_CONSTEXPR std::chrono::milliseconds SinkPollInterval = std::chrono::milliseconds(20);
+
+		CAsyncLogger(core::smart_refctd_ptr<CLogger>&& sink);
+
+		//! Returns the current set log level.
+		virtual ELOG_LEVEL getLogLevel() const override { return LogLevel.load(std::memory_order_relaxed); }
+
+		//! Sets a new log level, messages below it get dropped before being queued.
+		virtual void setLogLevel(ELOG_LEVEL ll) override;
+
+		//! Queues a text for the log
+		virtual void log(const std::string& text, ELOG_LEVEL ll=ELL_INFORMATION) override;
+
+		//! Queues a text for the log
+		virtual void log(const std::wstring& text, ELOG_LEVEL ll=ELL_INFORMATION) override;
+
+		//! Queues a text for the log
+		virtual void log(const std::string& text, const std::string& hint, ELOG_LEVEL ll=ELL_INFORMATION) override;
+
+		//! Queues a text for the log
+		virtual void log(const std::string& text, const std::wstring& hint, ELOG_LEVEL ll=ELL_INFORMATION) override;
+
+		//! Queues a text for the log
+		virtual void log(const std::wstring& text, const std::wstring& hint, ELOG_LEVEL ll=ELL_INFORMATION) override;
+
+		//! Blocks until everything queued before the call, from any thread, got written out
+		void flush();
+
+		//! Writes out everything still queued, gives up if the sink mutex doesn't become free within about 100ms
+		/** Meant for terminate handlers, where the sink thread may be stuck or the one which crashed.
+		Takes locks and allocates, so it is not async-signal-safe and must not be called from a signal handler. */
+		void flushFromCrashHandler();
+
+		//! Makes `std::terminate` flush `os::Printer::Logger` if it is a `CAsyncLogger`, then call the previous terminate handler
+		/** Fatal signals are deliberately left alone, see `flushFromCrashHandler`. The device installs it when it creates a `CAsyncLogger`. */
+		static void installCrashHandlers();
+
+		//! Sets a new event receiver for the sink
+		void setReceiver(IEventReceiver* r);
+
+		inline CLogger* getSink() { return Sink.get(); }
+
+	protected:
+		//! Writes out whatever is left
+		virtual ~CAsyncLogger();
+
+	private:
+		//! Formatting is left to the sink thread, short narrow messages get stored inline to avoid allocating
+		struct SRecord
+		{
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t InlineCapacity = 192u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t NoHint = 0xffffffffu;
+
+			//! anything which is wide or doesn't fit inline
+			struct SDeferred
+			{
+				std::string text, hint;
+				std::wstring wideText, wideHint;
+			};
+
+			uint64_t sequence;
+			ELOG_LEVEL level;
+			uint32_t textLength;
+			uint32_t hintLength;
+			char inlineData[InlineCapacity];
+			std::unique_ptr<SDeferred> deferred;
+		};
+		//! Single producer, single consumer
+		struct SRing
+		{
+			SRing() : records(RecordsPerThread), head(0ull), tail(0ull) {}
+
+			core::vector<SRecord> records;
+			//! only written by the owning thread
+			std::atomic<uint64_t> head;
+			//! only written while holding `SinkMutex`
+			std::atomic<uint64_t> tail;
+		};
+		struct SRepeats
+		{
+			std::chrono::steady_clock::time_point windowStart;
+			uint32_t count = 0u;
+			uint32_t suppressed = 0u;
+			ELOG_LEVEL level = ELL_INFORMATION;
+		};
+
+		template<typename T1, typename T2>
+		void push(ELOG_LEVEL ll, const std::basic_string<T1>& text, const std::basic_string<T2>* hint);
+
+		SRing* getThreadRing();
+
+		//! Moves the records out of all rings and writes them, needs `SinkMutex`
+		void drain();
+		//! Applies the rate limit, needs `SinkMutex`
+		void write(SRecord& record);
+		//! Reports suppressed repeats of messages whose window is over (all of them if `_all`), needs `SinkMutex`
+		void reportRepeats(bool _all);
+
+		void sinkThreadMain();
+
+		core::smart_refctd_ptr<CLogger> Sink;
+		std::atomic<ELOG_LEVEL> LogLevel;
+		//! orders the records of one drain across threads
+		std::atomic<uint64_t> NextSequence;
+		//! tells the thread local ring caches of different loggers apart
+		const uint64_t Id;
+
+		std::mutex RingsMutex;
+		core::vector<std::shared_ptr<SRing>> Rings;
+
+		std::mutex SinkMutex;
+		core::vector<SRecord> Batch;
+		core::unordered_map<std::string,SRepeats> Repeats;
+		std::chrono::steady_clock::time_point LastRepeatsReport;
+
+		std::atomic_bool Quit;
+		std::atomic_bool SinkIdle;
+		std::mutex WakeMutex;
+		std::condition_variable WakeCondition;
+		std::thread SinkThread;
+};
+
+} // end namespace
+
+#endif
@@ -11,6 +11,7 @@
 #include "CMountPointReader.h"
 #include "CPakReader.h"
 #include "CTarReader.h"
+#include "CNpkReader.h"
 #include "CFileList.h"
 #include "stdio.h"
 #include "os.h"
@@ -61,6 +62,10 @@ CFileSystem::CFileSystem(std::string&& _builtinResourceDirectory) : IFileSystem(
 	ArchiveLoader.push_back(new CArchiveLoaderTAR(this));
 #endif
 
+#ifdef __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
+	ArchiveLoader.push_back(new CArchiveLoaderNPK(this));
+#endif
+
 #ifdef __NBL_COMPILE_WITH_MOUNT_ARCHIVE_LOADER_
 	ArchiveLoader.push_back(new CArchiveLoaderMount(this));
 #endif
@@ -93,15 +98,28 @@ CFileSystem::~CFileSystem()
 IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 {
 	IReadFile* file = 0;
-	uint32_t i;
 
-	for (i=0; i< FileArchives.size(); ++i)
+	io::path fullName;
+	uint32_t priority = FileArchives.size();
+	IFileArchive* archive = findInArchiveIndex(filename,&fullName,&priority);
+
+	// only archives which opted out of the index and take precedence over the indexed one get asked directly
+	for (auto i : UnindexedArchives)
 	{
+		if (i>priority)
+			break;
 		file = FileArchives[i]->createAndOpenFile(filename);
 		if (file)
 			return file;
 	}
 
+	if (archive)
+	{
+		file = archive->createAndOpenFile(fullName);
+		if (file)
+			return file;
+	}
+
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
     file = new CReadFile(getAbsolutePath(filename));
@@ -192,6 +210,8 @@ bool CFileSystem::moveFileArchive(uint32_t sourceIndex, int32_t relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+	if (r)
+		rebuildArchiveIndex();
 	return r;
 }
 
@@ -288,6 +308,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, E_FILE_ARCHIVE_TYPE a
 	if (archive)
 	{
 		FileArchives.push_back(archive);
+		indexFileArchive(FileArchives.size()-1u);
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -392,6 +413,7 @@ bool CFileSystem::addFileArchive(IReadFile* file, E_FILE_ARCHIVE_TYPE archiveTyp
 		if (archive)
 		{
 			FileArchives.push_back(archive);
+			indexFileArchive(FileArchives.size()-1u);
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -417,6 +439,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 			return false;
 	}
 	FileArchives.push_back(archive);
+	indexFileArchive(FileArchives.size()-1u);
 	return true;
 }
 
@@ -430,6 +453,7 @@ bool CFileSystem::removeFileArchive(uint32_t index)
 	    auto it = FileArchives.begin()+index;
 		(*it)->drop();
 		FileArchives.erase(it);
+		rebuildArchiveIndex();
 		ret = true;
 	}
 
@@ -477,6 +501,59 @@ IFileArchive* CFileSystem::getFileArchive(uint32_t index)
 }
 
 
+std::string CFileSystem::normalizeArchivePath(const io::path& filename)
+{
+	return flattenFilename(filename).c_str();
+}
+
+
+void CFileSystem::indexFileArchive(uint32_t priority)
+{
+	IFileArchive* archive = FileArchives[priority];
+	if (!archive->isIndexable())
+	{
+		UnindexedArchives.push_back(priority);
+		return;
+	}
+
+	const IFileList* list = archive->getFileList();
+	if (list)
+	for (const auto& entry : list->getFiles())
+	{
+		if (entry.IsDirectory)
+			continue;
+		// archives are searched in order, so an earlier one providing the file wins
+		ArchiveIndex.emplace(normalizeArchivePath(entry.FullName),SIndexedFile{archive,entry.FullName,priority});
+	}
+}
+
+
+void CFileSystem::rebuildArchiveIndex()
+{
+	ArchiveIndex.clear();
+	UnindexedArchives.clear();
+	for (uint32_t i=0u; i<FileArchives.size(); i++)
+		indexFileArchive(i);
+}
+
+
+IFileArchive* CFileSystem::findInArchiveIndex(const io::path& filename, io::path* outFullName, uint32_t* outPriority) const
+{
+	if (ArchiveIndex.empty())
+		return nullptr;
+
+	auto found = ArchiveIndex.find(normalizeArchivePath(filename));
+	if (found == ArchiveIndex.end())
+		return nullptr;
+
+	if (outFullName)
+		*outFullName = found->second.fullName;
+	if (outPriority)
+		*outPriority = found->second.priority;
+	return found->second.archive;
+}
+
+
 //! Returns the string of the current working directory
 const io::path& CFileSystem::getWorkingDirectory()
 {
@@ -856,10 +933,12 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path)
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
-	for (uint32_t i=0; i < FileArchives.size(); ++i)
+	if (findInArchiveIndex(filename))
+		return true;
+	for (auto i : UnindexedArchives)
 	{
-        auto _list = FileArchives[i]->getFileList();
-        auto files = _list->getFiles();
+		auto _list = FileArchives[i]->getFileList();
+		auto files = _list->getFiles();
 		if (_list->findFile(files.begin(),files.end(),filename)!=files.end())
 			return true;
 	}
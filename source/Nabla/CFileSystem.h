@@ -128,6 +128,26 @@ class CFileSystem : public IFileSystem
         core::vector<IArchiveLoader*> ArchiveLoader;
         //! currently attached Archives
         core::vector<IFileArchive*> FileArchives;
+
+        //! Forward slashes, "./" and "../" resolved, without trailing slash, case is kept so files differing only by it stay apart
+        static std::string normalizeArchivePath(const io::path& filename);
+        //! Adds the files of `FileArchives[priority]` which are not already provided by an archive with higher priority
+        void indexFileArchive(uint32_t priority);
+        //! Needed whenever the priority of already indexed archives changes or one gets removed
+        void rebuildArchiveIndex();
+        //! Returns nullptr if no indexed archive lists the file, the name under which the archive knows the file goes into `outFullName` and its position in `FileArchives` into `outPriority`
+        IFileArchive* findInArchiveIndex(const io::path& filename, io::path* outFullName=nullptr, uint32_t* outPriority=nullptr) const;
+
+        struct SIndexedFile
+        {
+            IFileArchive* archive;
+            io::path fullName;
+            uint32_t priority;
+        };
+        //! Normalized path to the highest priority archive providing the file, authoritative for all indexable archives
+        core::unordered_map<std::string,SIndexedFile> ArchiveIndex;
+        //! Positions in `FileArchives` of the archives which opted out of the index, ascending
+        core::vector<uint32_t> UnindexedArchives;
 };
 
 
@@ -5,6 +5,7 @@
 
 #include "os.h"
 #include "CLogger.h"
+#include "CAsyncLogger.h"
 #include "IFileSystem.h"
 #include "CFileSystem.h"
 
@@ -22,7 +23,7 @@ namespace nbl
 CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 : IrrlichtDevice(), VideoDriver(0), SceneManager(0),
 	Timer(0), CursorControl(0), UserReceiver(params.EventReceiver),
-	Logger(0), Operator(0),
+	Logger(0), AsyncLogger(0), Operator(0),
 	InputReceivingSceneManager(0),
 	CreationParams(params), Close(false)
 {
@@ -30,17 +31,31 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 	if (os::Printer::Logger)
 	{
 		os::Printer::Logger->grab();
-		Logger = (CLogger*)os::Printer::Logger;
-		Logger->setReceiver(UserReceiver);
+		AsyncLogger = dynamic_cast<CAsyncLogger*>(os::Printer::Logger);
+		if (AsyncLogger)
+		{
+			Logger = AsyncLogger->getSink();
+			AsyncLogger->setReceiver(UserReceiver);
+		}
+		else
+		{
+			Logger = (CLogger*)os::Printer::Logger;
+			Logger->setReceiver(UserReceiver);
+		}
 	}
 	else
 	{
 		Logger = new CLogger(UserReceiver);
-		os::Printer::Logger = Logger;
+		// the async logger takes over our reference to the sink
+		if (CreationParams.AsyncLogging)
+		{
+			AsyncLogger = new CAsyncLogger(core::smart_refctd_ptr<CLogger>(Logger,core::dont_grab));
+			CAsyncLogger::installCrashHandlers();
+		}
 	}
-	Logger->setLogLevel(CreationParams.LoggingLevel);
+	getLogger()->setLogLevel(CreationParams.LoggingLevel);
 
-	os::Printer::Logger = Logger;
+	os::Printer::Logger = getLogger();
 
 	FileSystem = core::make_smart_refctd_ptr<io::CFileSystem>(std::string(CreationParams.builtinResourceDirectoryPath));
 
@@ -60,7 +75,7 @@ CIrrDeviceStub::~CIrrDeviceStub()
 	if (Timer)
 		Timer->drop();
 
-	if (Logger->drop())
+	if (getLogger()->drop())
 		os::Printer::Logger = 0;
 }
 
@@ -180,7 +195,10 @@ bool CIrrDeviceStub::postEventFromUser(const SEvent& event)
 void CIrrDeviceStub::setEventReceiver(IEventReceiver* receiver)
 {
 	UserReceiver = receiver;
-	Logger->setReceiver(receiver);
+	if (AsyncLogger)
+		AsyncLogger->setReceiver(receiver);
+	else
+		Logger->setReceiver(receiver);
 }
 
 
@@ -194,6 +212,8 @@ IEventReceiver* CIrrDeviceStub::getEventReceiver()
 //! \return Returns a pointer to the logger.
 ILogger* CIrrDeviceStub::getLogger()
 {
+	if (AsyncLogger)
+		return AsyncLogger;
 	return Logger;
 }
 
@@ -23,6 +23,7 @@ namespace nbl
 	// lots of prototypes:
 	class ILogger;
 	class CLogger;
+	class CAsyncLogger;
 
 	namespace scene
 	{
@@ -120,6 +121,8 @@ namespace nbl
             gui::ICursorControl* CursorControl;
             IEventReceiver* UserReceiver;
             CLogger* Logger;
+            //! set if logging goes through `Logger` asynchronously, then this is what the device holds a reference to
+            CAsyncLogger* AsyncLogger;
             IOSOperator* Operator;
             core::smart_refctd_ptr<io::IFileSystem> FileSystem;
             scene::ISceneManager* InputReceivingSceneManager;
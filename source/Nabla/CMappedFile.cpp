@@ -0,0 +1,86 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CMappedFile.h"
+
+#if defined(_NBL_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif (defined(_NBL_POSIX_API_) || defined(_NBL_OSX_PLATFORM_))
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace nbl
+{
+namespace io
+{
+
+
+core::smart_refctd_ptr<CMappedFile> CMappedFile::create(const io::path& fileName)
+{
+	if (fileName.size() == 0)
+		return nullptr;
+
+	uint8_t* data = nullptr;
+	size_t size = 0ull;
+#if defined(_NBL_WINDOWS_API_)
+	#if defined(_NBL_WCHAR_FILESYSTEM)
+	HANDLE file = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	#else
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	#endif
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		size = static_cast<size_t>(fileSize.QuadPart);
+		// PAGE_WRITECOPY + FILE_MAP_COPY is the equivalent of a MAP_PRIVATE mapping
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (mapping)
+		{
+			data = reinterpret_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+			// the view keeps the mapping object alive
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#elif (defined(_NBL_POSIX_API_) || defined(_NBL_OSX_PLATFORM_))
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		size = static_cast<size_t>(fileStat.st_size);
+		void* ptr = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (ptr != MAP_FAILED)
+			data = reinterpret_cast<uint8_t*>(ptr);
+	}
+	// the mapping keeps its own reference to the file
+	close(fd);
+#endif
+	if (!data)
+		return nullptr;
+
+	return core::smart_refctd_ptr<CMappedFile>(new CMappedFile(fileName, data, size), core::dont_grab);
+}
+
+CMappedFile::~CMappedFile()
+{
+#if defined(_NBL_WINDOWS_API_)
+	UnmapViewOfFile(Data);
+#elif (defined(_NBL_POSIX_API_) || defined(_NBL_OSX_PLATFORM_))
+	munmap(Data, Size);
+#endif
+}
+
+
+} // end namespace io
+} // end namespace nbl
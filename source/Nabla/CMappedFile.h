@@ -0,0 +1,66 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_MAPPED_FILE_H_INCLUDED__
+#define __NBL_C_MAPPED_FILE_H_INCLUDED__
+
+#include "nbl/core/core.h"
+#include "path.h"
+
+namespace nbl
+{
+namespace io
+{
+
+	/*!
+		Private (copy-on-write) memory mapping of a whole file from disk.
+
+		Pages only get read in when first touched and are shared with the OS file cache until written to,
+		writing to the mapping never modifies the file.
+	*/
+	class CMappedFile : public core::IReferenceCounted
+	{
+		protected:
+			virtual ~CMappedFile();
+
+		public:
+			//! Returns nullptr if the file doesn't exist, is empty or cannot be mapped
+			static core::smart_refctd_ptr<CMappedFile> create(const io::path& fileName);
+
+			//! Offsets into the file which are multiples of this get a pointer aligned to at least this much
+			_NBL_STATIC_INLINE_CONSTEXPR size_t MinPageSize = 4096ull;
+
+			inline const uint8_t* getPointer() const { return Data; }
+			//! Writes trigger a private copy of the touched pages
+			inline uint8_t* getPointer() { return Data; }
+
+			inline size_t getSize() const { return Size; }
+
+			inline const io::path& getFileName() const { return Filename; }
+
+		private:
+			CMappedFile(const io::path& fileName, uint8_t* data, size_t size) : Filename(fileName), Data(data), Size(size) {}
+
+			io::path Filename;
+			uint8_t* Data;
+			size_t Size;
+	};
+
+	//! Lets objects which take custom allocators point into a mapping and keep it alive, deallocation only drops the reference
+	/** For `asset::CCustomAllocatorCPUBuffer` and `io::CCustomAllocatorMemoryReadFile` constructed with `core::adopt_memory`. */
+	struct mapped_file_allocator
+	{
+		using value_type = uint8_t;
+		using pointer = uint8_t*;
+
+		pointer allocate(size_t) { assert(false); return nullptr; }
+		void deallocate(pointer, size_t) { mapping = nullptr; }
+
+		core::smart_refctd_ptr<CMappedFile> mapping;
+	};
+
+} // end namespace io
+} // end namespace nbl
+
+#endif
@@ -0,0 +1,314 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CNpkReader.h"
+
+#ifdef __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
+
+#include "os.h"
+#include "CLimitReadFile.h"
+#include "CMemoryFile.h"
+#include "CReadFile.h"
+
+#include "lz4/lib/lz4.h"
+#undef Bool
+#include "lzma/C/LzmaDec.h"
+
+namespace nbl
+{
+namespace io
+{
+
+namespace
+{
+
+struct LzmaMemMngmnt
+{
+        static void *alloc(ISzAllocPtr, size_t _size) { return _NBL_ALIGNED_MALLOC(_size,_NBL_SIMD_ALIGNMENT); }
+        static void release(ISzAllocPtr, void* _addr) { _NBL_ALIGNED_FREE(_addr); }
+    private:
+        LzmaMemMngmnt() {}
+};
+
+//! `IReadFile::read` takes 32 bit sizes
+inline bool readFully(IReadFile* file, void* data, size_t size)
+{
+	uint8_t* out = reinterpret_cast<uint8_t*>(data);
+	while (size)
+	{
+		const uint32_t chunk = core::min<size_t>(size, 0x1u<<30u);
+		if (file->read(out, chunk) != int32_t(chunk))
+			return false;
+		out += chunk;
+		size -= chunk;
+	}
+	return true;
+}
+
+} // end namespace
+
+//! Constructor
+CArchiveLoaderNPK::CArchiveLoaderNPK(io::IFileSystem* fs)
+: FileSystem(fs)
+{
+#ifdef _NBL_DEBUG
+	setDebugName("CArchiveLoaderNPK");
+#endif
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+bool CArchiveLoaderNPK::isALoadableFileFormat(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "npk");
+}
+
+//! Check to see if the loader can create archives of this type.
+bool CArchiveLoaderNPK::isALoadableFileFormat(E_FILE_ARCHIVE_TYPE fileType) const
+{
+	return fileType == EFAT_NPK;
+}
+
+//! Creates an archive from the filename
+/** \param file File handle to check.
+\return Pointer to newly created archive, or 0 upon error. */
+IFileArchive* CArchiveLoaderNPK::createArchive(const io::path& filename) const
+{
+	IFileArchive *archive = 0;
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+
+	if (file)
+	{
+		archive = createArchive(file);
+		file->drop();
+	}
+
+	return archive;
+}
+
+//! creates/loads an archive from the file.
+//! \return Pointer to the created archive. Returns 0 if loading failed.
+IFileArchive* CArchiveLoaderNPK::createArchive(io::IReadFile* file) const
+{
+	if (!file)
+		return 0;
+
+	file->seek(0u);
+	CNpkReader* archive = new CNpkReader(file);
+	if (!archive->isValid())
+	{
+		archive->drop();
+		return 0;
+	}
+	return archive;
+}
+
+
+//! Check if the file might be loaded by this class
+/** Check might look into the file.
+\param file File handle to check.
+\return True if file seems to be loadable. */
+bool CArchiveLoaderNPK::isALoadableFileFormat(io::IReadFile* file) const
+{
+	SNPKFileHeader header;
+
+	const size_t prevPos = file->getPos();
+	file->seek(0u);
+	const bool readHeader = file->read(&header, sizeof(header)) == sizeof(header);
+	file->seek(prevPos);
+
+	return readHeader && isNPKHeaderValid(header);
+}
+
+
+/*!
+	NPK Reader
+*/
+CNpkReader::CNpkReader(IReadFile* file) : CFileList(file ? file->getFileName() : io::path("")), File(file)
+{
+#ifdef _NBL_DEBUG
+	setDebugName("CNpkReader");
+#endif
+
+	if (File)
+	{
+		File->grab();
+		if (scanTableOfContents() && dynamic_cast<CReadFile*>(File))
+		{
+			Mapping = CMappedFile::create(File->getFileName());
+			if (Mapping && Mapping->getSize() != File->getSize())
+				Mapping = nullptr;
+		}
+	}
+}
+
+
+CNpkReader::~CNpkReader()
+{
+	if (File)
+		File->drop();
+}
+
+
+const IFileList* CNpkReader::getFileList() const
+{
+	return this;
+}
+
+bool CNpkReader::scanTableOfContents()
+{
+	SNPKFileHeader header;
+
+	// Read and validate the header
+	if (File->read(&header, sizeof(header)) != sizeof(header) || !isNPKHeaderValid(header))
+		return false;
+
+	const uint64_t entriesSize = uint64_t(header.entryCount)*sizeof(SNPKFileEntry);
+	const uint64_t bucketsSize = uint64_t(header.bucketCount)*sizeof(uint32_t);
+	const uint64_t fileSize = File->getSize();
+	if (header.tocSize > fileSize || header.tocOffset > fileSize-header.tocSize || entriesSize+bucketsSize > header.tocSize)
+		return false;
+
+	core::vector<SNPKFileEntry> entries(header.entryCount);
+	core::vector<uint32_t> buckets(header.bucketCount);
+	core::vector<char> names(header.tocSize-entriesSize-bucketsSize);
+	File->seek(header.tocOffset);
+	if (!readFully(File, entries.data(), entriesSize) || !readFully(File, buckets.data(), bucketsSize) || !readFully(File, names.data(), names.size()))
+		return false;
+
+	for (auto bucket : buckets)
+	if (bucket != SNPKFileHeader::InvalidEntry && bucket >= header.entryCount)
+		return false;
+
+	Files.reserve(header.entryCount);
+	for (uint32_t i=0u; i<header.entryCount; i++)
+	{
+		const auto& entry = entries[i];
+		if (entry.codec >= SNPKFileEntry::EC_COUNT || uint64_t(entry.nameOffset)+entry.nameLength > names.size() || entry.storedSize > header.tocOffset || entry.offset > header.tocOffset-entry.storedSize)
+		{
+			Files.clear();
+			return false;
+		}
+
+		SFileListEntry listEntry;
+		listEntry.FullName = io::path(names.data()+entry.nameOffset, entry.nameLength);
+		listEntry.Name = listEntry.FullName;
+		core::deletePathFromFilename(listEntry.Name);
+		listEntry.ID = i;
+		// the list only has 32 bits for these, the table of contents is what actually gets used
+		listEntry.Offset = static_cast<uint32_t>(core::min<uint64_t>(entry.offset, 0xffffffffull));
+		listEntry.Size = static_cast<uint32_t>(core::min<uint64_t>(entry.size, 0xffffffffull));
+		listEntry.IsDirectory = false;
+		Files.push_back(std::move(listEntry));
+	}
+	// one sort instead of sorted insertion per item, archives can have hundreds of thousands of entries
+	std::sort(Files.begin(), Files.end());
+
+	Entries = std::move(entries);
+	Buckets = std::move(buckets);
+	Names = std::move(names);
+	return true;
+}
+
+
+uint32_t CNpkReader::findEntry(const io::path& filename) const
+{
+	if (Buckets.empty())
+		return SNPKFileHeader::InvalidEntry;
+
+	const io::path normalized = IFileSystem::flattenFilename(filename);
+	const uint64_t hash = hashNPKPath(normalized);
+	const uint32_t mask = Buckets.size()-1u;
+	for (uint32_t i=0u, bucket=hash&mask; i<=mask; i++, bucket=(bucket+1u)&mask)
+	{
+		const uint32_t entryIx = Buckets[bucket];
+		if (entryIx == SNPKFileHeader::InvalidEntry)
+			break;
+
+		const auto& entry = Entries[entryIx];
+		if (entry.pathHash == hash && entry.nameLength == normalized.size() && io::path(Names.data()+entry.nameOffset, entry.nameLength).equals_ignore_case(normalized))
+			return entryIx;
+	}
+	return SNPKFileHeader::InvalidEntry;
+}
+
+
+IReadFile* CNpkReader::openEntry(uint32_t entryIx)
+{
+	const auto& entry = Entries[entryIx];
+	const io::path name(Names.data()+entry.nameOffset, entry.nameLength);
+	const uint8_t* mapped = Mapping ? (Mapping->getPointer()+entry.offset) : nullptr;
+
+	if (entry.codec == SNPKFileEntry::EC_RAW || entry.size == 0ull)
+	{
+		if (mapped)
+			return new CCustomAllocatorMemoryReadFile<mapped_file_allocator>(const_cast<uint8_t*>(mapped), entry.size, name, core::adopt_memory, mapped_file_allocator{Mapping});
+		return new CLimitReadFile(File, entry.offset, entry.size, name);
+	}
+
+	// compressed entries get decompressed whole
+	const uint8_t* stored = mapped;
+	void* storedCopy = nullptr;
+	if (!stored)
+	{
+		storedCopy = _NBL_ALIGNED_MALLOC(entry.storedSize, _NBL_SIMD_ALIGNMENT);
+		File->seek(entry.offset);
+		if (!readFully(File, storedCopy, entry.storedSize))
+		{
+			_NBL_ALIGNED_FREE(storedCopy);
+			return 0;
+		}
+		stored = reinterpret_cast<const uint8_t*>(storedCopy);
+	}
+
+	NBL_PROFILE_SCOPE_DETAIL("CNpkReader::decompress","io",name.c_str());
+	core::allocator<uint8_t> alloc;
+	uint8_t* data = alloc.allocate(entry.size);
+	bool success = false;
+	switch (entry.codec)
+	{
+		case SNPKFileEntry::EC_LZ4:
+			success = LZ4_decompress_safe(reinterpret_cast<const char*>(stored), reinterpret_cast<char*>(data), entry.storedSize, entry.size) == int(entry.size);
+			break;
+		case SNPKFileEntry::EC_LZMA:
+			if (entry.storedSize > LZMA_PROPS_SIZE)
+			{
+				ISzAlloc lzmaAlloc{&LzmaMemMngmnt::alloc, &LzmaMemMngmnt::release};
+				SizeT dstSize = entry.size;
+				SizeT srcSize = entry.storedSize-LZMA_PROPS_SIZE;
+				ELzmaStatus status;
+				success = LzmaDecode(data, &dstSize, stored+LZMA_PROPS_SIZE, &srcSize, stored, LZMA_PROPS_SIZE, LZMA_FINISH_ANY, &status, &lzmaAlloc) == SZ_OK && dstSize == entry.size;
+			}
+			break;
+		default:
+			break;
+	}
+	if (storedCopy)
+		_NBL_ALIGNED_FREE(storedCopy);
+
+	if (!success)
+	{
+		os::Printer::log("Could not decompress", name.c_str(), ELL_ERROR);
+		alloc.deallocate(data, entry.size);
+		return 0;
+	}
+	NBL_PROFILE_COUNTER(EC_BLOBS_DECOMPRESSED,1u);
+	return new CMemoryReadFile(data, entry.size, name, core::adopt_memory);
+}
+
+
+//! opens a file by file name
+IReadFile* CNpkReader::createAndOpenFile(const io::path& filename)
+{
+	const uint32_t entryIx = findEntry(filename);
+	if (entryIx != SNPKFileHeader::InvalidEntry)
+		return openEntry(entryIx);
+
+	return 0;
+}
+
+} // end namespace io
+} // end namespace nbl
+
+#endif // __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
@@ -0,0 +1,179 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_NPK_READER_H_INCLUDED__
+#define __NBL_C_NPK_READER_H_INCLUDED__
+
+#include "nbl/asset/compile_config.h"
+
+#include "nbl/core/IReferenceCounted.h"
+#include "nbl/core/xxHash256.h"
+#include "IReadFile.h"
+#include "IFileSystem.h"
+#include "CFileList.h"
+#include "CMappedFile.h"
+
+namespace nbl
+{
+namespace io
+{
+#include "nbl/nblpack.h"
+	//! Nabla PacK layout:
+	/** The header, then the entries' data each starting at a multiple of `EntryAlignment` so they can be used straight
+	out of a file mapping, then the table of contents which is `SNPKFileEntry[entryCount]`, followed by `uint32_t[bucketCount]`
+	hash buckets (open addressing with linear probing, `InvalidEntry` marks an empty bucket) and finally the entry names.
+	*/
+	struct SNPKFileHeader
+	{
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t CurrentVersion = 1u;
+		_NBL_STATIC_INLINE_CONSTEXPR uint64_t EntryAlignment = 4096ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidEntry = 0xffffffffu;
+
+		// Don't change the order of these fields! They must match the order stored on disk.
+		char tag[4];
+		uint32_t version;
+		uint32_t entryCount;
+		//! always a power of two
+		uint32_t bucketCount;
+		uint64_t tocOffset;
+		uint64_t tocSize;
+	} PACK_STRUCT;
+
+	//! An entry in the NPK file's table of contents.
+	struct SNPKFileEntry
+	{
+		enum E_CODEC : uint32_t
+		{
+			EC_RAW = 0,
+			EC_LZ4,
+			//! LZMA properties precede the stream
+			EC_LZMA,
+			EC_COUNT
+		};
+
+		// Don't change the order of these fields! They must match the order stored on disk.
+		//! @see @ref hashNPKPath
+		uint64_t pathHash;
+		//! absolute, multiple of `SNPKFileHeader::EntryAlignment`
+		uint64_t offset;
+		uint64_t storedSize;
+		uint64_t size;
+		//! into the names at the end of the table of contents
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		E_CODEC codec;
+		uint32_t padding;
+	} PACK_STRUCT;
+#include "nbl/nblunpack.h"
+
+	//! Both the reader and the writer need to agree on this, `_normalizedPath` needs to use forward slashes only
+	inline uint64_t hashNPKPath(io::path _normalizedPath)
+	{
+		_normalizedPath.make_lower();
+		uint64_t hash[4];
+		core::XXHash_256(_normalizedPath.c_str(), _normalizedPath.size(), hash);
+		return hash[0];
+	}
+
+	inline bool isNPKHeaderValid(const SNPKFileHeader& header)
+	{
+		return	header.tag[0] == 'N' && header.tag[1] == 'P' && header.tag[2] == 'A' && header.tag[3] == 'K' &&
+				header.version == SNPKFileHeader::CurrentVersion && core::isPoT(header.bucketCount) && header.bucketCount > header.entryCount;
+	}
+
+#ifdef __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
+	//! Archiveloader capable of loading NPK Archives
+	class CArchiveLoaderNPK : public IArchiveLoader
+	{
+	public:
+
+		//! Constructor
+		CArchiveLoaderNPK(io::IFileSystem* fs);
+
+		//! returns true if the file maybe is able to be loaded by this class
+		//! based on the file extension (e.g. ".zip")
+		virtual bool isALoadableFileFormat(const io::path& filename) const;
+
+		//! Check if the file might be loaded by this class
+		/** Check might look into the file.
+		\param file File handle to check.
+		\return True if file seems to be loadable. */
+		virtual bool isALoadableFileFormat(io::IReadFile* file) const;
+
+		//! Check to see if the loader can create archives of this type.
+		/** Check based on the archive type.
+		\param fileType The archive type to check.
+		\return True if the archile loader supports this type, false if not */
+		virtual bool isALoadableFileFormat(E_FILE_ARCHIVE_TYPE fileType) const;
+
+		//! Creates an archive from the filename
+		/** \param file File handle to check.
+		\return Pointer to newly created archive, or 0 upon error. */
+		virtual IFileArchive* createArchive(const io::path& filename) const;
+
+		//! creates/loads an archive from the file.
+		//! \return Pointer to the created archive. Returns 0 if loading failed.
+		virtual io::IFileArchive* createArchive(io::IReadFile* file) const;
+
+		//! Returns the type of archive created by this loader
+		virtual E_FILE_ARCHIVE_TYPE getType() const { return EFAT_NPK; }
+
+	private:
+		io::IFileSystem* FileSystem;
+	};
+
+
+	//! reads from npk
+	/** Archives which are plain files on disk get memory mapped, then uncompressed entries are served straight from the mapping. */
+	class CNpkReader : public virtual IFileArchive, virtual CFileList
+	{
+    protected:
+		virtual ~CNpkReader();
+
+	public:
+		CNpkReader(IReadFile* file);
+
+		// file archive methods
+
+		//! return the id of the file Archive
+		virtual const io::path& getArchiveName() const
+		{
+			return File->getFileName();
+		}
+
+		//! opens a file by file name
+		virtual IReadFile* createAndOpenFile(const io::path& filename);
+
+		//! returns the list of files
+		virtual const IFileList* getFileList() const;
+
+		//! get the class Type
+		virtual E_FILE_ARCHIVE_TYPE getType() const { return EFAT_NPK; }
+
+		//! false if the table of contents could not be read
+		inline bool isValid() const { return !Buckets.empty(); }
+
+	private:
+		//! reads the table of contents, returns false if the archive is invalid
+		bool scanTableOfContents();
+
+		//! O(1) on average, returns `SNPKFileHeader::InvalidEntry` if not found
+		uint32_t findEntry(const io::path& filename) const;
+
+		IReadFile* openEntry(uint32_t entryIx);
+
+		IReadFile* File;
+		core::smart_refctd_ptr<CMappedFile> Mapping;
+
+		core::vector<SNPKFileEntry> Entries;
+		core::vector<uint32_t> Buckets;
+		core::vector<char> Names;
+	};
+#endif // __NBL_COMPILE_WITH_NPK_ARCHIVE_LOADER_
+
+} // end namespace io
+} // end namespace nbl
+
+#endif
+
@@ -0,0 +1,310 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CNpkWriter.h"
+
+#include "os.h"
+
+#include <execution>
+#include <cstring>
+
+#include "lz4/lib/lz4.h"
+#include "lz4/lib/lz4hc.h"
+#undef Bool
+#include "lzma/C/LzmaEnc.h"
+
+namespace nbl
+{
+namespace io
+{
+
+namespace
+{
+
+struct LzmaMemMngmnt
+{
+        static void *alloc(ISzAllocPtr, size_t _size) { return _NBL_ALIGNED_MALLOC(_size,_NBL_SIMD_ALIGNMENT); }
+        static void release(ISzAllocPtr, void* _addr) { _NBL_ALIGNED_FREE(_addr); }
+    private:
+        LzmaMemMngmnt() {}
+};
+
+//! `IReadFile::read` takes 32 bit sizes
+inline bool readFully(IReadFile* file, void* data, size_t size)
+{
+	uint8_t* out = reinterpret_cast<uint8_t*>(data);
+	while (size)
+	{
+		const uint32_t chunk = core::min<size_t>(size, 0x1u<<30u);
+		if (file->read(out, chunk) != int32_t(chunk))
+			return false;
+		out += chunk;
+		size -= chunk;
+	}
+	return true;
+}
+
+} // end namespace
+
+
+bool CNpkWriter::write(IFileSystem* _fs, IWriteFile* _file, const core::vector<SInput>& _inputs, const SParameters& _params, SReport* _outReport)
+{
+	if (!_fs || !_file)
+		return false;
+
+	// flatten the names and drop the ones which would be ambiguous for the case insensitive lookup
+	core::vector<io::path> names;
+	core::vector<const SInput*> inputs;
+	{
+		core::unordered_set<std::string> uniqueNames;
+		names.reserve(_inputs.size());
+		inputs.reserve(_inputs.size());
+		for (const auto& input : _inputs)
+		{
+			io::path name = IFileSystem::flattenFilename(input.name);
+			io::path lowerName = name;
+			lowerName.make_lower();
+			if (name.size() == 0u || !uniqueNames.insert(lowerName.c_str()).second)
+			{
+				os::Printer::log("NPK Writer: Skipping entry with an empty or duplicate name", input.name.c_str(), ELL_WARNING);
+				continue;
+			}
+			names.push_back(std::move(name));
+			inputs.push_back(&input);
+		}
+	}
+	if (inputs.size() >= SNPKFileHeader::InvalidEntry/2u)
+	{
+		os::Printer::log("NPK Writer: Too many entries", _file->getFileName().c_str(), ELL_ERROR);
+		return false;
+	}
+
+	SNPKFileHeader header;
+	memset(&header, 0, sizeof(header));
+	// the tag only gets written at the very end, so an interrupted write never leaves a valid looking archive
+	if (!_file->seek(0ull) || !writeAligned(_file, &header, sizeof(header)))
+		return false;
+
+	SReport report;
+	core::vector<SNPKFileEntry> entries(inputs.size());
+	bool success = true;
+	for (size_t batchBegin=0ull; batchBegin<inputs.size();)
+	{
+		// read the batch sequentially, disks don't like concurrent reads
+		core::vector<SJob> jobs;
+		size_t batchSize = 0ull;
+		for (size_t i=batchBegin; i<inputs.size() && (jobs.empty() || batchSize<_params.memoryBudget); i++)
+		{
+			SJob job;
+			job.input = inputs[i];
+			IReadFile* file = _fs->createAndOpenFile(job.input->sourcePath);
+			if (file)
+			{
+				job.size = file->getSize();
+				job.data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(core::max<size_t>(job.size,1ull),_NBL_SIMD_ALIGNMENT));
+				if (!readFully(file, job.data, job.size))
+				{
+					_NBL_ALIGNED_FREE(job.data);
+					job.data = nullptr;
+				}
+				file->drop();
+			}
+			if (!job.data)
+			{
+				os::Printer::log("NPK Writer: Could not read", job.input->sourcePath.c_str(), ELL_ERROR);
+				success = false;
+			}
+			batchSize += job.size;
+			jobs.push_back(job);
+		}
+
+		auto compressJob = [&_params](SJob& job) -> void
+		{
+			if (job.data)
+				compress(job, _params);
+		};
+		if (_params.parallel)
+			std::for_each(std::execution::par, jobs.begin(), jobs.end(), compressJob);
+		else
+			std::for_each(jobs.begin(), jobs.end(), compressJob);
+
+		for (size_t j=0ull; j<jobs.size(); j++)
+		{
+			auto& job = jobs[j];
+			auto& entry = entries[batchBegin+j];
+			entry.offset = _file->getPos();
+			entry.size = job.size;
+			entry.storedSize = job.storedSize;
+			entry.codec = job.codec;
+			if (success && !writeAligned(_file, job.stored, job.storedSize))
+			{
+				os::Printer::log("NPK Writer: Could not write", _file->getFileName().c_str(), ELL_ERROR);
+				success = false;
+			}
+
+			report.inputSize += job.size;
+			report.storedSize += job.storedSize;
+			report.codecCounts[job.codec]++;
+			if (job.stored != job.data)
+				_NBL_ALIGNED_FREE(job.stored);
+			if (job.data)
+				_NBL_ALIGNED_FREE(job.data);
+		}
+		batchBegin += jobs.size();
+	}
+	if (!success)
+		return false;
+
+	// table of contents
+	header.entryCount = entries.size();
+	header.bucketCount = core::roundUpToPoT<uint32_t>(header.entryCount*2u+1u);
+	core::vector<uint32_t> buckets(header.bucketCount, SNPKFileHeader::InvalidEntry);
+	core::vector<char> nameData;
+	const uint32_t mask = header.bucketCount-1u;
+	for (uint32_t i=0u; i<header.entryCount; i++)
+	{
+		auto& entry = entries[i];
+		const auto& name = names[i];
+		if (nameData.size()+name.size() > 0xffffffffull)
+		{
+			os::Printer::log("NPK Writer: Entry names too long", _file->getFileName().c_str(), ELL_ERROR);
+			return false;
+		}
+		entry.pathHash = hashNPKPath(name);
+		entry.nameOffset = nameData.size();
+		entry.nameLength = name.size();
+		nameData.insert(nameData.end(), name.c_str(), name.c_str()+name.size());
+
+		uint32_t bucket = entry.pathHash&mask;
+		while (buckets[bucket] != SNPKFileHeader::InvalidEntry)
+			bucket = (bucket+1u)&mask;
+		buckets[bucket] = i;
+	}
+
+	header.tocOffset = _file->getPos();
+	const size_t entriesSize = sizeof(SNPKFileEntry)*entries.size();
+	const size_t bucketsSize = sizeof(uint32_t)*buckets.size();
+	header.tocSize = entriesSize+bucketsSize+nameData.size();
+	core::vector<uint8_t> toc(header.tocSize);
+	memcpy(toc.data(), entries.data(), entriesSize);
+	memcpy(toc.data()+entriesSize, buckets.data(), bucketsSize);
+	if (nameData.size())
+		memcpy(toc.data()+entriesSize+bucketsSize, nameData.data(), nameData.size());
+	if (!writeAligned(_file, toc.data(), toc.size()))
+		return false;
+
+	header.tag[0] = 'N';
+	header.tag[1] = 'P';
+	header.tag[2] = 'A';
+	header.tag[3] = 'K';
+	header.version = SNPKFileHeader::CurrentVersion;
+	if (!_file->seek(0ull) || _file->write(&header, sizeof(header)) != int32_t(sizeof(header)))
+		return false;
+
+	report.entryCount = header.entryCount;
+	if (_outReport)
+		*_outReport = report;
+	return true;
+}
+
+
+void CNpkWriter::compress(SJob& _job, const SParameters& _params)
+{
+	_job.stored = _job.data;
+	_job.storedSize = _job.size;
+	_job.codec = SNPKFileEntry::EC_RAW;
+	if (_job.size == 0ull || _job.input->codec == ECS_RAW)
+		return;
+
+	uint8_t* out = nullptr;
+	size_t outSize = 0ull;
+	if (_job.input->codec == ECS_LZMA)
+		out = compressWithLzma(_job.data, _job.size, outSize);
+	else
+		out = compressWithLz4(_job.data, _job.size, outSize);
+	if (!out)
+		return;
+
+	const float minRatio = _job.input->codec == ECS_AUTO ? _params.minCompressionRatio : 1.f;
+	if (outSize >= _job.size || double(_job.size) < double(outSize)*minRatio)
+	{
+		_NBL_ALIGNED_FREE(out);
+		return;
+	}
+	_job.stored = out;
+	_job.storedSize = outSize;
+	_job.codec = _job.input->codec == ECS_LZMA ? SNPKFileEntry::EC_LZMA : SNPKFileEntry::EC_LZ4;
+}
+
+uint8_t* CNpkWriter::compressWithLz4(const uint8_t* _input, size_t _inputSize, size_t& _outComprSize)
+{
+	if (_inputSize > LZ4_MAX_INPUT_SIZE)
+		return nullptr;
+
+	const int bound = LZ4_compressBound(_inputSize);
+	uint8_t* data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(bound,_NBL_SIMD_ALIGNMENT));
+	const int compressedSize = LZ4_compress_HC(reinterpret_cast<const char*>(_input), reinterpret_cast<char*>(data), _inputSize, bound, LZ4HC_CLEVEL_DEFAULT);
+	if (compressedSize <= 0)
+	{
+		_NBL_ALIGNED_FREE(data);
+		return nullptr;
+	}
+	_outComprSize = compressedSize;
+	return data;
+}
+
+uint8_t* CNpkWriter::compressWithLzma(const uint8_t* _input, size_t _inputSize, size_t& _outComprSize)
+{
+	ISzAlloc alloc{&LzmaMemMngmnt::alloc, &LzmaMemMngmnt::release};
+	SizeT propsSize = LZMA_PROPS_SIZE;
+
+	// same settings as the BAW writer, but the dictionary is capped since many entries get compressed at once
+	CLzmaEncProps props;
+	LzmaEncProps_Init(&props);
+	props.dictSize = core::roundUpToPoT<uint32_t>(core::min<size_t>(_inputSize, 0x1ull<<24ull));
+	props.level = 5; // compression level [0;9]
+	props.algo = 0; // fast algo: a little worse compression, a little less loading time
+	props.lp = 2; // 2^2==sizeof(float)
+
+	// incompressible data can grow, anything which doesn't fit gets stored raw anyway
+	const SizeT heapSize = _inputSize + LZMA_PROPS_SIZE;
+	uint8_t* data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(heapSize,_NBL_SIMD_ALIGNMENT));
+	SizeT destSize = heapSize-LZMA_PROPS_SIZE;
+
+	const SRes res = LzmaEncode(data+LZMA_PROPS_SIZE, &destSize, _input, _inputSize, &props, data, &propsSize, props.writeEndMark, NULL, &alloc, &alloc);
+	if (res != SZ_OK || propsSize != LZMA_PROPS_SIZE)
+	{
+		_NBL_ALIGNED_FREE(data);
+		return nullptr;
+	}
+	_outComprSize = destSize + LZMA_PROPS_SIZE;
+	return data;
+}
+
+
+bool CNpkWriter::writeAligned(IWriteFile* _file, const void* _data, size_t _size)
+{
+	const uint8_t* in = reinterpret_cast<const uint8_t*>(_data);
+	for (size_t left=_size; left;)
+	{
+		const uint32_t chunk = core::min<size_t>(left, 0x1u<<30u);
+		if (_file->write(in, chunk) != int32_t(chunk))
+			return false;
+		in += chunk;
+		left -= chunk;
+	}
+
+	const size_t end = _file->getPos();
+	const size_t padding = core::alignUp(end, SNPKFileHeader::EntryAlignment)-end;
+	if (padding)
+	{
+		const uint8_t zeros[SNPKFileHeader::EntryAlignment] = {};
+		if (_file->write(zeros, padding) != int32_t(padding))
+			return false;
+	}
+	return true;
+}
+
+} // end namespace io
+} // end namespace nbl
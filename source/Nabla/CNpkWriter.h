@@ -0,0 +1,90 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_C_NPK_WRITER_H_INCLUDED__
+#define __NBL_C_NPK_WRITER_H_INCLUDED__
+
+#include "IWriteFile.h"
+#include "IFileSystem.h"
+#include "CNpkReader.h"
+
+namespace nbl
+{
+namespace io
+{
+
+	//! Packs files into a Nabla PacK archive, @see SNPKFileHeader for the layout
+	/** Inputs are read in batches bounded by `SParameters::memoryBudget`, each batch gets compressed on all hardware threads
+	and then written out in the order of the inputs, so the same inputs always produce the same archive. */
+	class CNpkWriter
+	{
+		public:
+			enum E_CODEC_SELECTION : uint32_t
+			{
+				ECS_RAW = SNPKFileEntry::EC_RAW,
+				ECS_LZ4 = SNPKFileEntry::EC_LZ4,
+				ECS_LZMA = SNPKFileEntry::EC_LZMA,
+				//! LZ4-HC unless it does not save at least `SParameters::minCompressionRatio`, then stored raw
+				ECS_AUTO
+			};
+
+			struct SInput
+			{
+				//! path of the entry inside the archive, gets flattened
+				io::path name;
+				//! file to pack, opened through the file system
+				io::path sourcePath;
+				E_CODEC_SELECTION codec = ECS_AUTO;
+			};
+
+			struct SParameters
+			{
+				bool parallel = true;
+				//! `ECS_AUTO` stores entries raw unless `size/storedSize` reaches this
+				float minCompressionRatio = 1.1f;
+				//! upper bound on the uncompressed bytes held in memory at once, a single larger input still gets processed on its own
+				size_t memoryBudget = 0x1ull<<29ull;
+			};
+
+			struct SReport
+			{
+				uint32_t entryCount = 0u;
+				uint64_t inputSize = 0ull;
+				uint64_t storedSize = 0ull;
+				uint32_t codecCounts[SNPKFileEntry::EC_COUNT] = {};
+			};
+
+			//! Returns false if any input could not be read or the archive could not be written
+			/** Inputs whose flattened names only differ by case are ambiguous, all but the first get skipped with a warning. */
+			static bool write(IFileSystem* _fs, IWriteFile* _file, const core::vector<SInput>& _inputs, const SParameters& _params, SReport* _outReport = nullptr);
+			static inline bool write(IFileSystem* _fs, IWriteFile* _file, const core::vector<SInput>& _inputs)
+			{
+				return write(_fs,_file,_inputs,SParameters());
+			}
+
+		private:
+			struct SJob
+			{
+				const SInput* input = nullptr;
+				uint8_t* data = nullptr;
+				size_t size = 0ull;
+				//! aliases `data` when stored raw
+				uint8_t* stored = nullptr;
+				size_t storedSize = 0ull;
+				SNPKFileEntry::E_CODEC codec = SNPKFileEntry::EC_RAW;
+			};
+
+			//! fills `stored`, `storedSize` and `codec`, safe to call for different jobs in parallel
+			static void compress(SJob& _job, const SParameters& _params);
+			static uint8_t* compressWithLz4(const uint8_t* _input, size_t _inputSize, size_t& _outComprSize);
+			static uint8_t* compressWithLzma(const uint8_t* _input, size_t _inputSize, size_t& _outComprSize);
+
+			//! writes in chunks `IWriteFile::write` can take and pads with zeros up to `SNPKFileHeader::EntryAlignment`
+			static bool writeAligned(IWriteFile* _file, const void* _data, size_t _size);
+	};
+
+} // end namespace io
+} // end namespace nbl
+
+#endif
@@ -510,6 +510,19 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 #endif
 	}
 #endif
+	// big entries get decompressed as they're read, so opening them neither blocks nor needs the whole entry in memory
+	if (!decrypted && e.header.DataDescriptor.UncompressedSize >= MinStreamedEntrySize &&
+		(actualCompressionMethod == 8 || actualCompressionMethod == 12 || actualCompressionMethod == 14))
+	{
+		auto compressedData = new CLimitReadFile(File, e.Offset, e.header.DataDescriptor.CompressedSize, found->FullName);
+		auto streamed = new CZipStreamingReadFile(compressedData, actualCompressionMethod, e.header.DataDescriptor.UncompressedSize, found->FullName);
+		compressedData->drop();
+		if (streamed->isOpen())
+			return streamed;
+		// unsupported method, the whole-buffer path below will report it
+		streamed->drop();
+	}
+
 	switch(actualCompressionMethod)
 	{
 	case 0: // no compression
@@ -771,6 +784,398 @@ namespace
 }
 #endif
 
+
+// -----------------------------------------------------------------------------
+// streaming decompression of zip entries
+// -----------------------------------------------------------------------------
+
+struct CZipStreamingReadFile::SDecoder
+{
+	_NBL_STATIC_INLINE_CONSTEXPR uint32_t InputChunkSize = 0x1u<<16u;
+
+	SDecoder(uint16_t _method) : method(_method) {}
+	~SDecoder()
+	{
+		end();
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		for (auto& restartPoint : restartPoints)
+			inflateEnd(&restartPoint->stream);
+#endif
+	}
+
+	inline bool supportsRestartPoints() const
+	{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		return method == 8;
+#else
+		return false;
+#endif
+	}
+
+	//! (re)starts decompressing from the beginning of the entry, restart points are kept
+	bool start(IReadFile* compressed)
+	{
+		end();
+		compressed->seek(0u);
+		inputBegin = input;
+		inputAvail = 0u;
+		inputRead = 0u;
+		finished = false;
+		switch (method)
+		{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+			case 8:
+				memset(&zstream, 0, sizeof(zstream));
+				// wbits < 0 indicates no zlib header inside the data.
+				active = inflateInit2(&zstream, -MAX_WBITS) == Z_OK;
+				break;
+#endif
+#ifdef _NBL_COMPILE_WITH_BZIP2_
+			case 12:
+				memset(&bzstream, 0, sizeof(bzstream));
+				active = BZ2_bzDecompressInit(&bzstream, 0, 0) == BZ_OK;
+				break;
+#endif
+#ifdef _NBL_COMPILE_WITH_LZMA_
+			case 14:
+			{
+				// 2 bytes of version and 2 bytes of properties size precede the properties and the stream
+				uint8_t header[4];
+				if (compressed->read(header, 4) != 4)
+					break;
+				const uint32_t propSize = (header[3]<<8u)+header[2];
+				if (propSize > LZMA_PROPS_SIZE || compressed->read(lzmaProps, propSize) != int32_t(propSize))
+					break;
+				inputRead = 4u+propSize;
+				LzmaDec_Construct(&lzma);
+				active = LzmaDec_Allocate(&lzma, lzmaProps, propSize, &lzmaAlloc) == SZ_OK;
+				if (active)
+					LzmaDec_Init(&lzma);
+				break;
+			}
+#endif
+			default:
+				break;
+		}
+		return active;
+	}
+
+	void end()
+	{
+		if (!active)
+			return;
+		switch (method)
+		{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+			case 8:
+				inflateEnd(&zstream);
+				break;
+#endif
+#ifdef _NBL_COMPILE_WITH_BZIP2_
+			case 12:
+				BZ2_bzDecompressEnd(&bzstream);
+				break;
+#endif
+#ifdef _NBL_COMPILE_WITH_LZMA_
+			case 14:
+				LzmaDec_Free(&lzma, &lzmaAlloc);
+				break;
+#endif
+			default:
+				break;
+		}
+		active = false;
+	}
+
+	//! returns less than `size` only at the end of the stream or on error
+	uint32_t decode(IReadFile* compressed, uint8_t* out, uint32_t size)
+	{
+		uint32_t produced = 0u;
+		while (active && !finished && produced < size)
+		{
+			if (!inputAvail)
+			{
+				const int32_t got = compressed->read(input, InputChunkSize);
+				inputBegin = input;
+				inputAvail = got > 0 ? uint32_t(got) : 0u;
+				inputRead += inputAvail;
+			}
+
+			uint32_t consumed = 0u;
+			uint32_t made = 0u;
+			bool ok = false;
+			switch (method)
+			{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+				case 8:
+				{
+					zstream.next_in = inputBegin;
+					zstream.avail_in = inputAvail;
+					zstream.next_out = out+produced;
+					zstream.avail_out = size-produced;
+					const int err = inflate(&zstream, Z_NO_FLUSH);
+					consumed = inputAvail-zstream.avail_in;
+					made = size-produced-zstream.avail_out;
+					finished = err == Z_STREAM_END;
+					ok = err == Z_OK || err == Z_STREAM_END || err == Z_BUF_ERROR;
+					break;
+				}
+#endif
+#ifdef _NBL_COMPILE_WITH_BZIP2_
+				case 12:
+				{
+					bzstream.next_in = reinterpret_cast<char*>(inputBegin);
+					bzstream.avail_in = inputAvail;
+					bzstream.next_out = reinterpret_cast<char*>(out+produced);
+					bzstream.avail_out = size-produced;
+					const int err = BZ2_bzDecompress(&bzstream);
+					consumed = inputAvail-bzstream.avail_in;
+					made = size-produced-bzstream.avail_out;
+					finished = err == BZ_STREAM_END;
+					ok = err == BZ_OK || err == BZ_STREAM_END;
+					break;
+				}
+#endif
+#ifdef _NBL_COMPILE_WITH_LZMA_
+				case 14:
+				{
+					SizeT outLen = size-produced;
+					SizeT inLen = inputAvail;
+					ELzmaStatus status;
+					const SRes res = LzmaDec_DecodeToBuf(&lzma, out+produced, &outLen, inputBegin, &inLen, LZMA_FINISH_ANY, &status);
+					consumed = inLen;
+					made = outLen;
+					finished = status == LZMA_STATUS_FINISHED_WITH_MARK;
+					ok = res == SZ_OK;
+					break;
+				}
+#endif
+				default:
+					break;
+			}
+			inputBegin += consumed;
+			inputAvail -= consumed;
+			produced += made;
+			// corrupt or truncated data
+			if (!ok || (!consumed && !made))
+				break;
+		}
+		return produced;
+	}
+
+	//! only for deflate, needs to be called at increasing output positions
+	void addRestartPoint(size_t outputPos)
+	{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		if (!active || (!restartPoints.empty() && restartPoints.back()->outputPos >= outputPos))
+			return;
+
+		auto restartPoint = std::make_unique<SRestartPoint>();
+		restartPoint->outputPos = outputPos;
+		restartPoint->inputPos = inputRead-inputAvail;
+		if (inflateCopy(&restartPoint->stream, &zstream) == Z_OK)
+			restartPoints.push_back(std::move(restartPoint));
+#endif
+	}
+
+	//! moves to the closest restart point at or before `target`, returns the output position it corresponds to
+	size_t restore(IReadFile* compressed, size_t target)
+	{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+		auto found = std::upper_bound(restartPoints.begin(), restartPoints.end(), target, [](size_t pos, const auto& restartPoint) {return pos < restartPoint->outputPos; });
+		if (found != restartPoints.begin())
+		{
+			const SRestartPoint& restartPoint = **(found-1);
+			end();
+			// the copy gets its own window and state, the restart point stays usable
+			active = inflateCopy(&zstream, const_cast<z_stream*>(&restartPoint.stream)) == Z_OK;
+			if (active)
+			{
+				compressed->seek(restartPoint.inputPos);
+				inputBegin = input;
+				inputAvail = 0u;
+				inputRead = restartPoint.inputPos;
+				finished = false;
+				return restartPoint.outputPos;
+			}
+		}
+#endif
+		start(compressed);
+		return 0u;
+	}
+
+	const uint16_t method;
+	bool active = false;
+	bool finished = false;
+
+	uint8_t input[InputChunkSize];
+	uint8_t* inputBegin = input;
+	uint32_t inputAvail = 0u;
+	//! bytes of the compressed data read so far, including the ones still in `input`
+	size_t inputRead = 0u;
+
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+	z_stream zstream;
+	//! zlib streams point back at themselves, so they cannot be moved around
+	struct SRestartPoint
+	{
+		size_t outputPos;
+		size_t inputPos;
+		z_stream stream;
+	};
+	core::vector<std::unique_ptr<SRestartPoint>> restartPoints;
+#endif
+#ifdef _NBL_COMPILE_WITH_BZIP2_
+	bz_stream bzstream;
+#endif
+#ifdef _NBL_COMPILE_WITH_LZMA_
+	CLzmaDec lzma;
+	uint8_t lzmaProps[LZMA_PROPS_SIZE];
+#endif
+};
+
+
+CZipStreamingReadFile::CZipStreamingReadFile(IReadFile* compressedData, uint16_t compressionMethod, size_t uncompressedSize, const io::path& fileName)
+	: Filename(fileName), CompressedData(compressedData), Decoder(nullptr), UncompressedSize(uncompressedSize), Pos(0u), DecodedPos(0u), History(nullptr), HistoryFill(0u)
+{
+	#ifdef _NBL_DEBUG
+	setDebugName("CZipStreamingReadFile");
+	#endif
+
+	CompressedData->grab();
+
+	Decoder = new SDecoder(compressionMethod);
+	if (!Decoder->start(CompressedData))
+	{
+		delete Decoder;
+		Decoder = nullptr;
+		return;
+	}
+	History = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(HistorySize,_NBL_SIMD_ALIGNMENT));
+}
+
+
+CZipStreamingReadFile::~CZipStreamingReadFile()
+{
+	if (Decoder)
+		delete Decoder;
+	if (History)
+		_NBL_ALIGNED_FREE(History);
+	CompressedData->drop();
+}
+
+
+//! returns how much was read
+int32_t CZipStreamingReadFile::read(void* buffer, uint32_t sizeToRead)
+{
+	if (!Decoder || Pos >= UncompressedSize)
+		return 0;
+	sizeToRead = core::min<size_t>(sizeToRead, UncompressedSize-Pos);
+
+	uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+	uint32_t done = 0u;
+	if (Pos < DecodedPos)
+	{
+		if (DecodedPos-Pos <= HistoryFill)
+		{
+			done = core::min<size_t>(sizeToRead, DecodedPos-Pos);
+			copyFromHistory(Pos, out, done);
+			Pos += done;
+		}
+		else if (!rewind(Pos))
+			return 0;
+	}
+
+	if (done < sizeToRead)
+	{
+		// decompress and throw away whatever got seeked over
+		uint8_t skipped[0x1u<<14u];
+		while (DecodedPos < Pos)
+		{
+			const uint32_t toSkip = core::min<size_t>(Pos-DecodedPos, sizeof(skipped));
+			if (decodeForward(skipped, toSkip) != toSkip)
+				return done;
+		}
+
+		const uint32_t decoded = decodeForward(out+done, sizeToRead-done);
+		Pos += decoded;
+		done += decoded;
+	}
+	return done;
+}
+
+
+//! changes position in file, returns true if successful
+bool CZipStreamingReadFile::seek(const size_t& finalPos, bool relativeMovement)
+{
+	const size_t newPos = relativeMovement ? (Pos+finalPos):finalPos;
+	if (newPos > UncompressedSize)
+		return false;
+
+	Pos = newPos;
+	return true;
+}
+
+
+uint32_t CZipStreamingReadFile::decodeForward(uint8_t* out, uint32_t size)
+{
+	uint32_t produced = 0u;
+	while (produced < size)
+	{
+		uint32_t chunk = size-produced;
+		// stop exactly at the boundaries so that restart points land on them
+		if (Decoder->supportsRestartPoints())
+			chunk = core::min<size_t>(chunk, (DecodedPos/RestartInterval+1u)*RestartInterval-DecodedPos);
+
+		const uint32_t decoded = Decoder->decode(CompressedData, out+produced, chunk);
+		appendHistory(out+produced, decoded);
+		DecodedPos += decoded;
+		produced += decoded;
+
+		if (decoded && DecodedPos%RestartInterval == 0u && Decoder->supportsRestartPoints())
+			Decoder->addRestartPoint(DecodedPos);
+		if (decoded < chunk)
+			break;
+	}
+	return produced;
+}
+
+
+bool CZipStreamingReadFile::rewind(size_t pos)
+{
+	HistoryFill = 0u;
+	DecodedPos = Decoder->restore(CompressedData, pos);
+	return Decoder->active;
+}
+
+
+void CZipStreamingReadFile::appendHistory(const uint8_t* data, uint32_t size)
+{
+	size_t pos = DecodedPos;
+	// only the tail can stay
+	if (size > HistorySize)
+	{
+		data += size-HistorySize;
+		pos += size-HistorySize;
+		size = HistorySize;
+	}
+
+	const size_t offset = pos%HistorySize;
+	const size_t first = core::min<size_t>(size, HistorySize-offset);
+	memcpy(History+offset, data, first);
+	memcpy(History, data+first, size-first);
+	HistoryFill = core::min<size_t>(HistoryFill+size, HistorySize);
+}
+
+
+void CZipStreamingReadFile::copyFromHistory(size_t pos, uint8_t* out, uint32_t size) const
+{
+	const size_t offset = pos%HistorySize;
+	const size_t first = core::min<size_t>(size, HistorySize-offset);
+	memcpy(out, History+offset, first);
+	memcpy(out+first, History, size-first);
+}
+
 } // end namespace io
 } // end namespace nbl
 
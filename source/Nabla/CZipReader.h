@@ -135,6 +135,63 @@ namespace io
 		SZIPFileHeader header;
 	};
 
+	//! Decompresses a deflated, bzip2 or LZMA zip entry as it gets read instead of all of it up front
+	/** Deflate streams get a restart point every `RestartInterval` bytes of output, so seeking backwards resumes
+	from the closest one instead of from the start of the entry, which is what the other methods have to do.
+	The last `HistorySize` bytes decompressed are kept, so short backwards seeks (like re-reading a header) are free. */
+	class CZipStreamingReadFile : public IReadFile
+	{
+        protected:
+            virtual ~CZipStreamingReadFile();
+
+        public:
+            //! `compressedData` needs to start at the first byte of compressed data and end with it, `compressionMethod` is the zip method number
+            CZipStreamingReadFile(IReadFile* compressedData, uint16_t compressionMethod, size_t uncompressedSize, const io::path& fileName);
+
+            //! returns how much was read
+            virtual int32_t read(void* buffer, uint32_t sizeToRead) override;
+
+            //! changes position in file, returns true if successful, actual decompression is deferred until `read`
+            virtual bool seek(const size_t& finalPos, bool relativeMovement = false) override;
+
+            //! returns size of file
+            virtual size_t getSize() const override { return UncompressedSize; }
+
+            //! returns where in the file we are.
+            virtual size_t getPos() const override { return Pos; }
+
+            //! returns name of file
+            virtual const io::path& getFileName() const override { return Filename; }
+
+            //! false if the compression method is not supported or the decompressor could not be initialized
+            inline bool isOpen() const { return Decoder!=nullptr; }
+
+            _NBL_STATIC_INLINE_CONSTEXPR size_t RestartInterval = 0x1ull<<22u;
+            _NBL_STATIC_INLINE_CONSTEXPR size_t HistorySize = 0x1ull<<16u;
+
+        private:
+            struct SDecoder;
+
+            //! decompresses at the current decoder position, returns less than `size` only at the end of the stream or on error
+            uint32_t decodeForward(uint8_t* out, uint32_t size);
+            //! moves the decoder to the closest restart point at or before `pos`
+            bool rewind(size_t pos);
+            void appendHistory(const uint8_t* data, uint32_t size);
+            void copyFromHistory(size_t pos, uint8_t* out, uint32_t size) const;
+
+            io::path Filename;
+            IReadFile* CompressedData;
+            SDecoder* Decoder;
+            size_t UncompressedSize;
+            //! position the user is at
+            size_t Pos;
+            //! how much got decompressed so far
+            size_t DecodedPos;
+            //! ring buffer of the last `HistoryFill` bytes before `DecodedPos`
+            uint8_t* History;
+            size_t HistoryFill;
+	};
+
 	//! Archiveloader capable of loading ZIP Archives
 	class CArchiveLoaderZIP : public IArchiveLoader
 	{
@@ -207,6 +264,9 @@ namespace io
 
             bool scanCentralDirectoryHeader();
 
+            //! Compressed entries smaller than this get decompressed whole on open, bigger ones as they get read
+            _NBL_STATIC_INLINE_CONSTEXPR uint32_t MinStreamedEntrySize = 0x1u<<20u;
+
             IReadFile* File;
 
             // holds extended info about files
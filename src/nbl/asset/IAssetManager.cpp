@@ -113,6 +113,7 @@ void IAssetManager::initializeMeshTools()
 	m_meshManipulator = core::make_smart_refctd_ptr<CMeshManipulator>();
     m_geometryCreator = core::make_smart_refctd_ptr<CGeometryCreator>(m_meshManipulator.get());
 	m_glslCompiler = core::make_smart_refctd_ptr<IGLSLCompiler>(m_fileSystem.get());
+	m_shaderVariantCache = core::make_smart_refctd_ptr<CShaderVariantCache>(core::smart_refctd_ptr<IGLSLCompiler>(m_glslCompiler));
 }
 
 const IGeometryCreator* IAssetManager::getGeometryCreator() const
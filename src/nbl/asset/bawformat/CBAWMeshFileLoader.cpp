@@ -369,13 +369,17 @@ bool CBAWMeshFileLoader::decompressLzma(void* _dst, size_t _dstSize, const void*
 	const SRes res = LzmaDecode((Byte*)_dst, &dstSize, (const Byte*)(_src)+LZMA_PROPS_SIZE, &srcSize, (const Byte*)_src, LZMA_PROPS_SIZE, LZMA_FINISH_ANY, &status, &alloc);
 	if (res != SZ_OK)
 		return false;
+	NBL_PROFILE_COUNTER(EC_BLOBS_DECOMPRESSED,1u);
 	return true;
 }
 
 bool CBAWMeshFileLoader::decompressLz4(void * _dst, size_t _dstSize, const void * _src, size_t _srcSize) const
 {
 	int res = LZ4_decompress_safe((const char*)_src, (char*)_dst, _srcSize, _dstSize);
-	return res >= 0;
+	if (res < 0)
+		return false;
+	NBL_PROFILE_COUNTER(EC_BLOBS_DECOMPRESSED,1u);
+	return true;
 }
 
 }} // nbl::scene
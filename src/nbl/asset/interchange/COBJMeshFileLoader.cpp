@@ -484,12 +484,9 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 
     auto mesh = core::make_smart_refctd_ptr<ICPUMesh>();
     for (auto& submesh : submeshes)
-    {
-		IMeshManipulator::recalculateBoundingBox(submesh.get());
         mesh->getMeshBufferVector().emplace_back(std::move(submesh));
-    }
 
-	IMeshManipulator::recalculateBoundingBox(mesh.get());
+	IMeshManipulator::recalculateBoundingBoxes(mesh.get());
 	if (mesh->getMeshBuffers().empty())
         return {};
     
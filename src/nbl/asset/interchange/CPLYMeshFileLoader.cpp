@@ -5,6 +5,10 @@
 
 
 #include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <execution>
+#include <future>
 
 #include "BuildConfigOptions.h"
 
@@ -404,7 +408,13 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 						}			
 					}
 
-					// loop through vertex properties
+					if (ctx.IsBinaryFile && plyVertexElement.IsFixedWidth)
+					{
+						if (!readVerticesBulk(ctx, plyVertexElement, attributes, _params))
+							os::Printer::log("PLY file ended before all the vertices were read", ctx.inner.mainFile->getFileName().c_str(), ELL_WARNING);
+						hasNormals &= bool(attributes[ET_NORM].buffer);
+					}
+					else // loop through vertex properties
 					for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
 						hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
 				}
@@ -413,9 +423,15 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(io::IReadFile* _file, const as
 					const size_t indicesCount = ctx.ElementList[i]->Count;
 
 					// read faces
+					if (!ctx.IsBinaryFile || !readFacesBulk(ctx, *ctx.ElementList[i], indices))
 					for (uint32_t j=0; j < indicesCount; ++j)
 						readFace(ctx, *ctx.ElementList[i], indices);
 				}
+				else if (ctx.IsBinaryFile && ctx.ElementList[i]->IsFixedWidth)
+				{
+					// skip these elements
+					seekData(ctx, getDataOffset(ctx)+size_t(ctx.ElementList[i]->Count)*ctx.ElementList[i]->KnownSize);
+				}
 				else
 				{
 					// skip these elements
@@ -705,6 +721,341 @@ void CPLYMeshFileLoader::skipProperty(SContext& _ctx, const SPLYProperty &Proper
 }
 
 
+template<typename T, bool Swap>
+static inline T loadPLYValue(const uint8_t* src)
+{
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, src, sizeof(T));
+	if constexpr (Swap && sizeof(T) > 1u)
+		std::reverse(bytes, bytes + sizeof(T));
+	T retval;
+	memcpy(&retval, bytes, sizeof(T));
+	return retval;
+}
+
+template<typename T, bool Swap>
+static inline void decodePLYColumn(const uint8_t* src, uint32_t srcStride, float* dst, uint32_t dstStride, size_t count, float scale)
+{
+	for (size_t i = 0u; i < count; ++i)
+		dst[i * dstStride] = float(loadPLYValue<T, Swap>(src + i * srcStride)) * scale;
+}
+
+//! calls `f` with a value of the type the property is stored as, signed unless `_unsigned`
+template<class F>
+static inline bool dispatchPLYType(E_PLY_PROPERTY_TYPE type, bool _unsigned, F&& f)
+{
+	switch (type)
+	{
+		case EPLYPT_INT8:
+			_unsigned ? f(uint8_t()) : f(int8_t());
+			return true;
+		case EPLYPT_INT16:
+			_unsigned ? f(uint16_t()) : f(int16_t());
+			return true;
+		case EPLYPT_INT32:
+			_unsigned ? f(uint32_t()) : f(int32_t());
+			return true;
+		case EPLYPT_FLOAT32:
+			f(float());
+			return true;
+		case EPLYPT_FLOAT64:
+			f(double());
+			return true;
+		default:
+			return false;
+	}
+}
+
+auto CPLYMeshFileLoader::compileVertexPlan(const SPLYElement& _element, bool _rightHanded) -> SVertexPlan
+{
+	SVertexPlan plan;
+	for (const auto& property : _element.Properties)
+	{
+		const auto& name = property.Name;
+
+		int32_t attribute = -1;
+		uint8_t component = 0u;
+		bool negate = false;
+		if (name == "x" || name == "y" || name == "z")
+		{
+			attribute = ET_POS;
+			component = name[0] - 'x';
+			negate = _rightHanded && component == 0u;
+		}
+		else if (name == "nx" || name == "ny" || name == "nz")
+		{
+			attribute = ET_NORM;
+			component = name[1] - 'x';
+			negate = _rightHanded && component == 0u;
+		}
+		// there isn't a single convention for the UV, some softwares like Blender or Assimp use "st" instead of "uv"
+		else if (name == "u" || name == "s")
+			attribute = ET_UV;
+		else if (name == "v" || name == "t")
+		{
+			attribute = ET_UV;
+			component = 1u;
+		}
+		else if (name == "red" || name == "green" || name == "blue" || name == "alpha")
+		{
+			attribute = ET_COL;
+			component = name == "red" ? 0u : (name == "green" ? 1u : (name == "blue" ? 2u : 3u));
+		}
+
+		if (attribute >= 0)
+		{
+			const bool normalize = attribute == ET_COL && !property.isFloat();
+			auto* last = plan.runs.empty() ? nullptr : &plan.runs.back();
+			if (last && last->attribute == attribute && last->type == property.Type && last->normalize == normalize && last->componentCount < 4u &&
+				last->firstComponent + last->componentCount == component && last->srcOffset + last->componentCount * property.size() == plan.stride)
+			{
+				last->negateMask |= uint8_t(negate) << last->componentCount;
+				last->componentCount++;
+			}
+			else
+				plan.runs.push_back({ plan.stride, property.Type, static_cast<E_TYPE>(attribute), component, 1u, normalize, uint8_t(negate) });
+			plan.writtenComponents[attribute] |= 0x1u << component;
+		}
+		plan.stride += property.size();
+	}
+	return plan;
+}
+
+void CPLYMeshFileLoader::decodeVertexRun(const SVertexRun& _run, const uint8_t* _src, uint32_t _srcStride, float* _dst, uint32_t _dstStride, size_t _count, bool _swap)
+{
+	_src += _run.srcOffset;
+	_dst += _run.firstComponent;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	// the common layouts get a whole run per load, the staging chunks are padded so the loads can go past the last vertex
+	auto storeComponents = [&](float* dst, __m128 value) -> void
+	{
+		switch (_run.componentCount)
+		{
+			case 4u:
+				_mm_storeu_ps(dst, value);
+				break;
+			case 3u:
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst), value);
+				_mm_store_ss(dst + 2u, _mm_movehl_ps(value, value));
+				break;
+			case 2u:
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst), value);
+				break;
+			default:
+				_mm_store_ss(dst, value);
+				break;
+		}
+	};
+	if (_run.type == EPLYPT_FLOAT32)
+	{
+		const __m128i byteswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		const __m128 negate = _mm_castsi128_ps(_mm_setr_epi32(
+			_run.negateMask & 0x1u ? 0x80000000 : 0, _run.negateMask & 0x2u ? 0x80000000 : 0,
+			_run.negateMask & 0x4u ? 0x80000000 : 0, _run.negateMask & 0x8u ? 0x80000000 : 0
+		));
+		for (size_t i = 0u; i < _count; ++i)
+		{
+			__m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i * _srcStride));
+			if (_swap)
+				raw = _mm_shuffle_epi8(raw, byteswap);
+			storeComponents(_dst + i * _dstStride, _mm_xor_ps(_mm_castsi128_ps(raw), negate));
+		}
+		return;
+	}
+	if (_run.type == EPLYPT_INT8 && _run.normalize)
+	{
+		const __m128 scale = _mm_set1_ps(1.f / 255.f);
+		for (size_t i = 0u; i < _count; ++i)
+		{
+			int32_t raw;
+			memcpy(&raw, _src + i * _srcStride, sizeof(raw));
+			storeComponents(_dst + i * _dstStride, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(raw))), scale));
+		}
+		return;
+	}
+#endif
+	const uint32_t typeSize = SPLYProperty::getTypeSize(_run.type);
+	for (uint32_t c = 0u; c < _run.componentCount; ++c)
+	{
+		const float scale = (_run.normalize ? 1.f / 255.f : 1.f) * ((_run.negateMask >> c) & 0x1u ? -1.f : 1.f);
+		dispatchPLYType(_run.type, _run.normalize, [&](auto type) -> void
+		{
+			using type_t = decltype(type);
+			if (_swap)
+				decodePLYColumn<type_t, true>(_src + c * typeSize, _srcStride, _dst + c, _dstStride, _count, scale);
+			else
+				decodePLYColumn<type_t, false>(_src + c * typeSize, _srcStride, _dst + c, _dstStride, _count, scale);
+		});
+	}
+}
+
+size_t CPLYMeshFileLoader::getDataOffset(const SContext& _ctx) const
+{
+	return _ctx.inner.mainFile->getPos() - size_t(_ctx.EndPointer - _ctx.StartPointer);
+}
+
+void CPLYMeshFileLoader::seekData(SContext& _ctx, size_t _offset)
+{
+	_ctx.inner.mainFile->seek(_offset);
+	_ctx.StartPointer = _ctx.Buffer;
+	_ctx.EndPointer = _ctx.Buffer;
+	_ctx.EndOfFile = false;
+}
+
+template<class F>
+bool CPLYMeshFileLoader::streamRecords(SContext& _ctx, size_t _count, uint32_t _stride, F&& _decode)
+{
+	// whatever is still in the buffer gets read again straight from the file
+	seekData(_ctx, getDataOffset(_ctx));
+	if (!_count || !_stride)
+		return true;
+
+	io::IReadFile* file = _ctx.inner.mainFile;
+	const size_t chunkRecords = core::max<size_t>(BULK_CHUNK_SIZE / _stride, 1ull);
+	// padded for the SIMD loads
+	core::vector<uint8_t> staging[2];
+	for (auto& chunk : staging)
+		chunk.resize(chunkRecords * _stride + 16u);
+	auto readChunk = [file, _stride](uint8_t* dst, size_t records) -> bool
+	{
+		const size_t bytes = records * _stride;
+		const int32_t bytesRead = core::max(file->read(dst, bytes), 0);
+		if (size_t(bytesRead) == bytes)
+			return true;
+		memset(dst + bytesRead, 0, bytes - bytesRead);
+		return false;
+	};
+
+	bool complete = readChunk(staging[0].data(), core::min(chunkRecords, _count));
+	uint32_t current = 0u;
+	for (size_t first = 0u; first < _count;)
+	{
+		const size_t records = core::min(chunkRecords, _count - first);
+		const size_t nextRecords = core::min(chunkRecords, _count - first - records);
+		std::future<bool> nextChunk;
+		if (nextRecords)
+			nextChunk = std::async(std::launch::async, readChunk, staging[current ^ 1u].data(), nextRecords);
+		const bool keepGoing = _decode(static_cast<const uint8_t*>(staging[current].data()), first, records);
+		if (nextRecords)
+			complete = nextChunk.get() && complete;
+		if (!keepGoing)
+			return false;
+		first += records;
+		current ^= 1u;
+	}
+	return complete;
+}
+
+bool CPLYMeshFileLoader::readVerticesBulk(SContext& _ctx, const SPLYElement& _element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const IAssetLoader::SAssetLoadParams& _params)
+{
+	const SVertexPlan plan = compileVertexPlan(_element, _params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES);
+
+	constexpr uint32_t componentCount[4] = { 3u, 4u, 2u, 3u };
+	float* outData[4] = {};
+	for (uint32_t attribute = 0u; attribute < 4u; ++attribute)
+	if (outAttributes[attribute].buffer)
+		outData[attribute] = reinterpret_cast<float*>(outAttributes[attribute].buffer->getPointer());
+
+	const bool swap = _ctx.IsWrongEndian;
+	return streamRecords(_ctx, _element.Count, plan.stride, [&](const uint8_t* chunk, size_t firstVertex, size_t vertexCount) -> bool
+	{
+		core::vector<uint32_t> blocks((vertexCount + BULK_BLOCK_ELEMENTS - 1u) / BULK_BLOCK_ELEMENTS);
+		std::iota(blocks.begin(), blocks.end(), 0u);
+		std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](const uint32_t block)
+		{
+			const size_t begin = size_t(block) * BULK_BLOCK_ELEMENTS;
+			const size_t count = core::min<size_t>(BULK_BLOCK_ELEMENTS, vertexCount - begin);
+			for (const auto& run : plan.runs)
+				decodeVertexRun(run, chunk + begin * plan.stride, plan.stride, outData[run.attribute] + (firstVertex + begin) * componentCount[run.attribute], componentCount[run.attribute], count, swap);
+
+			// components without a property, colors are opaque unless there's an alpha
+			for (uint32_t attribute = 0u; attribute < 4u; ++attribute)
+			for (uint32_t c = 0u; outData[attribute] && c < componentCount[attribute]; ++c)
+			if (!((plan.writtenComponents[attribute] >> c) & 0x1u))
+			{
+				const float value = attribute == ET_COL && c == 3u ? 1.f : 0.f;
+				float* dst = outData[attribute] + (firstVertex + begin) * componentCount[attribute] + c;
+				for (size_t i = 0u; i < count; ++i)
+					dst[i * componentCount[attribute]] = value;
+			}
+		});
+		return true;
+	});
+}
+
+bool CPLYMeshFileLoader::readFacesBulk(SContext& _ctx, const SPLYElement& _element, core::vector<uint32_t>& _outIndices)
+{
+	// the layout is only fixed if every face is a triangle, which gets checked while decoding
+	const SPLYProperty* indexList = nullptr;
+	uint32_t listOffset = 0u;
+	uint32_t stride = 0u;
+	for (const auto& property : _element.Properties)
+	{
+		if (property.Type == EPLYPT_LIST)
+		{
+			if (indexList || (property.Name != "vertex_indices" && property.Name != "vertex_index"))
+				return false;
+			indexList = &property;
+			listOffset = stride;
+			stride += SPLYProperty::getTypeSize(property.Data.List.CountType) + 3u * SPLYProperty::getTypeSize(property.Data.List.ItemType);
+		}
+		else
+			stride += property.size();
+	}
+	auto isIntegral = [](E_PLY_PROPERTY_TYPE type) -> bool {return type == EPLYPT_INT8 || type == EPLYPT_INT16 || type == EPLYPT_INT32;};
+	if (!indexList || !isIntegral(indexList->Data.List.CountType) || !isIntegral(indexList->Data.List.ItemType))
+		return false;
+
+	const size_t elementOffset = getDataOffset(_ctx);
+	const size_t firstIndex = _outIndices.size();
+	_outIndices.resize(firstIndex + size_t(_element.Count) * 3u);
+
+	const uint32_t itemOffset = listOffset + SPLYProperty::getTypeSize(indexList->Data.List.CountType);
+	const uint32_t itemSize = SPLYProperty::getTypeSize(indexList->Data.List.ItemType);
+	const bool swap = _ctx.IsWrongEndian;
+	std::atomic<bool> allTriangles = true;
+	streamRecords(_ctx, _element.Count, stride, [&](const uint8_t* chunk, size_t firstFace, size_t faceCount) -> bool
+	{
+		core::vector<uint32_t> blocks((faceCount + BULK_BLOCK_ELEMENTS - 1u) / BULK_BLOCK_ELEMENTS);
+		std::iota(blocks.begin(), blocks.end(), 0u);
+		std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](const uint32_t block)
+		{
+			const size_t begin = size_t(block) * BULK_BLOCK_ELEMENTS;
+			const size_t end = core::min<size_t>(begin + BULK_BLOCK_ELEMENTS, faceCount);
+			dispatchPLYType(indexList->Data.List.CountType, true, [&](auto countType) -> void
+			{
+				dispatchPLYType(indexList->Data.List.ItemType, true, [&](auto itemType) -> void
+				{
+					using count_t = decltype(countType);
+					using item_t = decltype(itemType);
+					uint32_t* out = _outIndices.data() + firstIndex + (firstFace + begin) * 3u;
+					for (size_t f = begin; f < end; ++f, out += 3u)
+					{
+						const uint8_t* face = chunk + f * stride;
+						const uint32_t count = swap ? loadPLYValue<count_t, true>(face + listOffset) : loadPLYValue<count_t, false>(face + listOffset);
+						if (count != 3u)
+						{
+							allTriangles = false;
+							return;
+						}
+						for (uint32_t k = 0u; k < 3u; ++k)
+							out[k] = swap ? loadPLYValue<item_t, true>(face + itemOffset + k * itemSize) : loadPLYValue<item_t, false>(face + itemOffset + k * itemSize);
+					}
+				});
+			});
+		});
+		return allTriangles;
+	});
+
+	if (!allTriangles)
+	{
+		_outIndices.resize(firstIndex);
+		seekData(_ctx, elementOffset);
+		return false;
+	}
+	return true;
+}
+
 bool CPLYMeshFileLoader::allocateBuffer(SContext& _ctx)
 {
 	// Destroy the element list if it exists
@@ -107,9 +107,9 @@ private:
 		} Data PACK_STRUCT;
 		#include "nbl/nblunpack.h"
 
-		inline uint32_t size() const
+		static inline uint32_t getTypeSize(E_PLY_PROPERTY_TYPE type)
 		{
-			switch(Type)
+			switch(type)
 			{
 			case EPLYPT_INT8:
 				return 1;
@@ -126,6 +126,10 @@ private:
 				return 0;
 			}
 		}
+		inline uint32_t size() const
+		{
+			return getTypeSize(Type);
+		}
 
 		inline bool isFloat() const
 		{
@@ -199,6 +203,47 @@ private:
 	uint32_t getInt(SContext& _ctx, E_PLY_PROPERTY_TYPE t);
 	void moveForward(SContext& _ctx, uint32_t bytes);
 
+	//! Binary elements get decoded in bulk, the properties are compiled into runs once and then whole chunks of elements get decoded in parallel
+	struct SVertexRun
+	{
+		//! from the start of the vertex
+		uint32_t srcOffset;
+		E_PLY_PROPERTY_TYPE type;
+		E_TYPE attribute;
+		uint8_t firstComponent;
+		//! consecutive properties of the same type going to consecutive components of the attribute, up to 4
+		uint8_t componentCount;
+		//! integer colors get divided by 255
+		bool normalize;
+		//! bit per component, flips the handedness
+		uint8_t negateMask;
+	};
+	struct SVertexPlan
+	{
+		uint32_t stride = 0u;
+		core::vector<SVertexRun> runs;
+		//! bit per component of every attribute which some property writes
+		uint8_t writtenComponents[4] = {};
+	};
+	//! bytes read from the file at once, while the previous chunk gets decoded
+	_NBL_STATIC_INLINE_CONSTEXPR size_t BULK_CHUNK_SIZE = 0x1ull<<26ull;
+	//! elements decoded by a single task
+	_NBL_STATIC_INLINE_CONSTEXPR uint32_t BULK_BLOCK_ELEMENTS = 0x1u<<12u;
+
+	static SVertexPlan compileVertexPlan(const SPLYElement& _element, bool _rightHanded);
+	static void decodeVertexRun(const SVertexRun& _run, const uint8_t* _src, uint32_t _srcStride, float* _dst, uint32_t _dstStride, size_t _count, bool _swap);
+	//! false if the file ended before all the vertices, the rest is zero
+	bool readVerticesBulk(SContext& _ctx, const SPLYElement& _element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const IAssetLoader::SAssetLoadParams& _params);
+	//! only does faces which are all triangles, returns false and rewinds to the start of the element otherwise
+	bool readFacesBulk(SContext& _ctx, const SPLYElement& _element, core::vector<uint32_t>& _outIndices);
+	//! reads `_count` records of `_stride` bytes from the current position a chunk at a time, `_decode(chunk,firstRecord,recordCount)` can return false to stop early
+	template<class F>
+	bool streamRecords(SContext& _ctx, size_t _count, uint32_t _stride, F&& _decode);
+	//! offset in the file of the next byte the per element readers would read
+	size_t getDataOffset(const SContext& _ctx) const;
+	//! empties the buffer, so the per element readers continue from `_offset`
+	void seekData(SContext& _ctx, size_t _offset);
+
 	bool genVertBuffersForMBuffer(
 		ICPUMeshBuffer* _mbuf,
 		const asset::SBufferBinding<asset::ICPUBuffer> attributes[4],
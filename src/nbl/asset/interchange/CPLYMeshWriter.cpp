@@ -119,7 +119,9 @@ bool CPLYMeshWriter::writeAsset(io::IWriteFile* _file, const SAssetWriteParams&
         auto indexCount = rawCopyMeshBuffer->getIndexCount();
 
         indices = _NBL_ALIGNED_MALLOC(indexCount * sizeof(uint32_t), _NBL_SIMD_ALIGNMENT);
-        memcpy(indices, rawCopyMeshBuffer->getIndices(), indexCount * sizeof(uint32_t));
+        // 16 bit index buffers are only half as big
+        if (doesItUseIndexBufferBinding)
+            memcpy(indices, rawCopyMeshBuffer->getIndices(), indexCount * (rawCopyMeshBuffer->getIndexType() == asset::EIT_16BIT ? sizeof(uint16_t) : sizeof(uint32_t)));
         
         IMeshManipulator::getPolyCount(faceCount, rawCopyMeshBuffer);
         vertexCount = IMeshManipulator::upperBoundVertexID(rawCopyMeshBuffer);
@@ -1147,6 +1147,7 @@ std::string CMaterialCompilerGLSLBackendCommon::genPreprocDefinitions(const resu
 
 auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, bool _computeGenChoiceStream) -> result_t
 {
+	NBL_PROFILE_SCOPE("CMaterialCompilerGLSLBackendCommon::compile","material_compiler");
 	result_t res;
 	res.noNormPrecompStream = true;
 	res.noPrefetchStream = true;
@@ -0,0 +1,366 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+
+#include "nbl/asset/utils/CAnimationCompressor.h"
+#include "nbl/asset/utils/CAnimationSampler.h"
+
+#include <execution>
+#include <numeric>
+
+#include "os.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+namespace
+{
+
+struct STRS
+{
+	core::vectorSIMDf translation;
+	core::vectorSIMDf rotation;
+	core::vectorSIMDf scale;
+};
+
+inline core::matrix3x4SIMD constructMatrix(const STRS& _trs)
+{
+	core::matrix3x4SIMD retval;
+	retval.setScaleRotationAndTranslation(_trs.scale,reinterpret_cast<const core::quaternion&>(_trs.rotation),_trs.translation);
+	return retval;
+}
+
+// max displacement of the joint origin and the virtual vertices on its shell
+inline float jointSpaceError(const STRS& _exact, const STRS& _approx, float _shellDistance)
+{
+	const auto exact = constructMatrix(_exact);
+	const auto approx = constructMatrix(_approx);
+
+	float maxError = core::length(exact.getTranslation3D()-approx.getTranslation3D())[0];
+	for (uint32_t axis=0u; axis<3u; axis++)
+	{
+		core::vectorSIMDf vertex(0.f,0.f,0.f,1.f);
+		vertex.pointer[axis] = _shellDistance;
+		core::vectorSIMDf exactVertex,approxVertex;
+		exact.transformVect(exactVertex,vertex);
+		approx.transformVect(approxVertex,vertex);
+		maxError = core::max(maxError,core::length(exactVertex-approxVertex)[0]);
+	}
+	return maxError;
+}
+
+// must match `CAnimationSampler` with `ERI_FLERP`
+inline STRS interpolate(const STRS& _a, const STRS& _b, float _fraction)
+{
+	STRS retval;
+	retval.translation = core::mix(_a.translation,_b.translation,core::vectorSIMDf(_fraction));
+	retval.scale = core::mix(_a.scale,_b.scale,core::vectorSIMDf(_fraction));
+	const auto rotation = core::quaternion::flerp(reinterpret_cast<const core::quaternion&>(_a.rotation),reinterpret_cast<const core::quaternion&>(_b.rotation),_fraction);
+	retval.rotation = core::normalize(reinterpret_cast<const core::vectorSIMDf&>(rotation));
+	return retval;
+}
+
+struct SCompressedAnimation
+{
+	CAnimationCompressor::SCompressedAnimations::SAnimation header;
+	core::vector<CAnimationCompressor::timestamp_t> timestamps;
+	core::vector<uint32_t> rotations;
+	core::vector<uint16_t> translations;
+	core::vector<uint16_t> scales;
+	//! error of the kept keys themselves, the key reduction only bounds the removed ones
+	float maxKeptError = 0.f;
+	uint32_t keptOverTolerance = 0u;
+};
+
+}
+
+
+CAnimationCompressor::SCompressedAnimations CAnimationCompressor::compress(const ICPUAnimationLibrary* _library, const SParameters& _params, SReport* _report)
+{
+	using SAnimation = SCompressedAnimations::SAnimation;
+
+	const uint32_t animationCount = _library->getAnimationStorageRange().buffer ? _library->getAnimationCapacity():0u;
+	const uint32_t keyframeCount = _library->getKeyframeCount();
+
+	// per animation error budget
+	core::vector<float> tolerances(animationCount,_params.tolerance);
+	core::vector<float> shellDistances(animationCount,_params.shellDistance);
+	if (_params.skeleton && _params.jointAnimationIDs)
+	{
+		const CAnimationSampler::SJointHierarchy hierarchy(_params.skeleton);
+		const uint32_t jointCount = hierarchy.getJointCount();
+
+		// bind pose positions of the joints, parents get done first
+		core::vector<core::matrix3x4SIMD> globalDefault(jointCount);
+		core::vector<uint32_t> depth(jointCount,0u);
+		for (uint32_t level=0u; level<hierarchy.getLevelCount(); level++)
+		for (uint32_t i=level ? hierarchy.levelEnds[level-1u]:0u; i<hierarchy.levelEnds[level]; i++)
+		{
+			const auto joint = hierarchy.sortedJoints[i];
+			const auto parent = hierarchy.parentIDs[joint];
+			const auto& local = _params.skeleton->getDefaultTransformMatrix(joint);
+			globalDefault[joint] = parent!=ICPUSkeleton::invalid_joint_id ? core::matrix3x4SIMD::concatenateBFollowedByA(globalDefault[parent],local):local;
+			depth[joint] = level;
+		}
+
+		// furthest descendant and longest chain below every joint, children get done first
+		core::vector<float> reach(jointCount,0.f);
+		core::vector<uint32_t> height(jointCount,0u);
+		for (auto it=hierarchy.sortedJoints.rbegin(); it!=hierarchy.sortedJoints.rend(); it++)
+		{
+			const auto joint = *it;
+			const auto parent = hierarchy.parentIDs[joint];
+			if (parent==ICPUSkeleton::invalid_joint_id)
+				continue;
+			const float boneLength = core::length(globalDefault[joint].getTranslation3D()-globalDefault[parent].getTranslation3D())[0];
+			reach[parent] = core::max(reach[parent],boneLength+reach[joint]);
+			height[parent] = core::max(height[parent],height[joint]+1u);
+		}
+
+		for (uint32_t j=0u; j<jointCount; j++)
+		{
+			const uint32_t animationID = _params.jointAnimationIDs[j];
+			if (animationID>=animationCount)
+				continue;
+			// errors of all joints on the longest chain through this one add up at its end
+			const uint32_t chainLength = depth[j]+height[j]+1u;
+			tolerances[animationID] = core::min(tolerances[animationID],_params.tolerance/float(chainLength));
+			shellDistances[animationID] = core::max(shellDistances[animationID],reach[j]);
+		}
+	}
+
+	// decode the original keys once
+	core::vector<STRS> keyframes(keyframeCount);
+	{
+		core::vector<uint32_t> indices(keyframeCount);
+		std::iota(indices.begin(),indices.end(),0u);
+		std::for_each(std::execution::par,indices.begin(),indices.end(),[&](const uint32_t k)
+		{
+			const auto& keyframe = _library->getKeyframe(k);
+			const auto rotation = keyframe.getRotation();
+			keyframes[k] = {keyframe.getTranslation(),reinterpret_cast<const core::vectorSIMDf&>(rotation),keyframe.getScale()};
+		});
+	}
+
+	// animations sharing the same keyframes get compressed once
+	core::vector<uint32_t> uniqueAnimations;
+	core::vector<uint32_t> animationRemap(animationCount);
+	{
+		core::unordered_map<uint64_t,uint32_t> rangeToUnique;
+		for (uint32_t a=0u; a<animationCount; a++)
+		{
+			const auto& animation = _library->getAnimation(a);
+			uint32_t count = animation.getKeyframeCount();
+			if (animation.getKeyframeOffset()+count>keyframeCount)
+				count = 0u;
+			const uint64_t key = (uint64_t(animation.getKeyframeOffset())<<32ull)|count|animation.getInterpolationMode();
+			auto found = rangeToUnique.find(key);
+			if (found==rangeToUnique.end())
+			{
+				found = rangeToUnique.emplace(key,uniqueAnimations.size()).first;
+				uniqueAnimations.push_back(a);
+			}
+			else
+			{
+				// the shared range has to satisfy the strictest of the joints driven by it
+				const uint32_t first = uniqueAnimations[found->second];
+				tolerances[first] = core::min(tolerances[first],tolerances[a]);
+				shellDistances[first] = core::max(shellDistances[first],shellDistances[a]);
+			}
+			animationRemap[a] = found->second;
+		}
+	}
+
+	core::vector<SCompressedAnimation> compressed(uniqueAnimations.size());
+	core::vector<uint32_t> uniqueIDs(uniqueAnimations.size());
+	std::iota(uniqueIDs.begin(),uniqueIDs.end(),0u);
+	std::for_each(std::execution::par,uniqueIDs.begin(),uniqueIDs.end(),[&](const uint32_t u)
+	{
+		auto& out = compressed[u];
+		const uint32_t a = uniqueAnimations[u];
+		const auto& animation = _library->getAnimation(a);
+		const auto mode = animation.getInterpolationMode();
+		const uint32_t offset = animation.getKeyframeOffset();
+		const uint32_t count = offset+animation.getKeyframeCount()<=keyframeCount ? animation.getKeyframeCount():0u;
+		const STRS* keys = keyframes.data()+offset;
+		const timestamp_t* timestamps = &_library->getTimestamp(0u)+offset;
+		const float tolerance = tolerances[a];
+		const float shellDistance = shellDistances[a];
+
+		// ranges
+		auto& header = out.header;
+		auto computeRange = [&](const core::vectorSIMDf STRS::* member, float* minOut, float* extentOut) -> bool
+		{
+			core::vectorSIMDf minV(FLT_MAX),maxV(-FLT_MAX);
+			for (uint32_t k=0u; k<count; k++)
+			{
+				minV = core::min(minV,keys[k].*member);
+				maxV = core::max(maxV,keys[k].*member);
+			}
+			bool constant = true;
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				minOut[c] = count ? minV[c]:0.f;
+				extentOut[c] = count ? (maxV[c]-minV[c]):0.f;
+				constant = constant && extentOut[c]<=FLT_EPSILON*core::max(std::abs(minOut[c]),1.f);
+			}
+			if (constant)
+				std::fill_n(extentOut,3u,0.f);
+			return constant;
+		};
+		const bool constantTranslation = computeRange(&STRS::translation,header.translationMin,header.translationExtent);
+		const bool constantScale = computeRange(&STRS::scale,header.scaleMin,header.scaleExtent);
+
+		// what the decompressor will see
+		core::vector<STRS> quantized(count);
+		core::vector<uint32_t> encodedRotations(count);
+		core::vector<uint16_t> encodedTranslations(count*3u), encodedScales(count*3u);
+		for (uint32_t k=0u; k<count; k++)
+		{
+			encodedRotations[k] = SCompressedAnimations::encodeRotation(keys[k].rotation);
+			SCompressedAnimations::encodeRangeRelative(encodedTranslations.data()+k*3u,keys[k].translation,header.translationMin,header.translationExtent);
+			SCompressedAnimations::encodeRangeRelative(encodedScales.data()+k*3u,keys[k].scale,header.scaleMin,header.scaleExtent);
+			quantized[k].rotation = SCompressedAnimations::decodeRotation(encodedRotations[k]);
+			quantized[k].translation = SCompressedAnimations::decodeRangeRelative(encodedTranslations.data()+k*3u,header.translationMin,header.translationExtent);
+			quantized[k].scale = SCompressedAnimations::decodeRangeRelative(encodedScales.data()+k*3u,header.scaleMin,header.scaleExtent);
+		}
+
+		// greedy key reduction, every removed key must be reproduced by what the sampler would do with the kept ones
+		core::vector<uint32_t> kept;
+		if (count)
+			kept.push_back(0u);
+		if (mode==Animation::EIM_NEAREST)
+		{
+			for (uint32_t k=1u; k<count; k++)
+			if (jointSpaceError(keys[k],quantized[kept.back()],shellDistance)>tolerance)
+				kept.push_back(k);
+		}
+		else
+		{
+			auto spanIsRedundant = [&](uint32_t anchor, uint32_t end) -> bool
+			{
+				const float duration = float(timestamps[end]-timestamps[anchor]);
+				for (uint32_t k=anchor+1u; k<end; k++)
+				{
+					const float fraction = duration>0.f ? float(timestamps[k]-timestamps[anchor])/duration:0.f;
+					if (jointSpaceError(keys[k],interpolate(quantized[anchor],quantized[end],fraction),shellDistance)>tolerance)
+						return false;
+				}
+				return true;
+			};
+			uint32_t anchor = 0u;
+			for (uint32_t end=2u; end<count; end++)
+			if (!spanIsRedundant(anchor,end))
+			{
+				anchor = end-1u;
+				kept.push_back(anchor);
+			}
+			if (count>1u)
+				kept.push_back(count-1u);
+		}
+
+		// quantization alone can exceed the tolerance if the range of the animation is too large for 16 bits
+		for (const auto k : kept)
+		{
+			const float error = jointSpaceError(keys[k],quantized[k],shellDistance);
+			out.maxKeptError = core::max(out.maxKeptError,error);
+			if (error>tolerance)
+				out.keptOverTolerance++;
+		}
+
+		header.translationOffset = constantTranslation ? SAnimation::InvalidOffset:0u;
+		header.scaleOffset = constantScale ? SAnimation::InvalidOffset:0u;
+		for (const auto k : kept)
+		{
+			out.timestamps.push_back(timestamps[k]);
+			out.rotations.push_back(encodedRotations[k]);
+			if (!constantTranslation)
+				out.translations.insert(out.translations.end(),encodedTranslations.data()+k*3u,encodedTranslations.data()+k*3u+3u);
+			if (!constantScale)
+				out.scales.insert(out.scales.end(),encodedScales.data()+k*3u,encodedScales.data()+k*3u+3u);
+		}
+		header.animation = Animation(0u,kept.size(),mode);
+	});
+
+	// stitch together
+	SCompressedAnimations retval;
+	core::vector<SAnimation> uniqueHeaders(compressed.size());
+	for (uint32_t u=0u; u<compressed.size(); u++)
+	{
+		auto& anim = compressed[u];
+		auto& header = uniqueHeaders[u];
+		header = anim.header;
+		header.animation = Animation(retval.timestamps.size(),anim.header.animation.getKeyframeCount(),anim.header.animation.getInterpolationMode());
+		if (header.translationOffset!=SAnimation::InvalidOffset)
+			header.translationOffset = retval.translations.size()/3u;
+		if (header.scaleOffset!=SAnimation::InvalidOffset)
+			header.scaleOffset = retval.scales.size()/3u;
+		retval.timestamps.insert(retval.timestamps.end(),anim.timestamps.begin(),anim.timestamps.end());
+		retval.rotations.insert(retval.rotations.end(),anim.rotations.begin(),anim.rotations.end());
+		retval.translations.insert(retval.translations.end(),anim.translations.begin(),anim.translations.end());
+		retval.scales.insert(retval.scales.end(),anim.scales.begin(),anim.scales.end());
+	}
+	uint32_t keptOverTolerance = 0u;
+	for (uint32_t u=0u; u<compressed.size(); u++)
+	if (compressed[u].keptOverTolerance)
+	{
+		keptOverTolerance += compressed[u].keptOverTolerance;
+		os::Printer::log(
+			"Animation compression: quantized keyframes of animation "+std::to_string(uniqueAnimations[u])+" exceed the error tolerance "+std::to_string(tolerances[uniqueAnimations[u]])+
+			", max error "+std::to_string(compressed[u].maxKeptError),ELL_WARNING
+		);
+	}
+	retval.animations.resize(animationCount);
+	for (uint32_t a=0u; a<animationCount; a++)
+		retval.animations[a] = uniqueHeaders[animationRemap[a]];
+
+	if (_report)
+	{
+		_report->originalSize = size_t(keyframeCount)*(sizeof(ICPUAnimationLibrary::Keyframe)+sizeof(timestamp_t))+size_t(animationCount)*sizeof(Animation);
+		_report->compressedSize = retval.getSize();
+		_report->originalKeyframeCount = keyframeCount;
+		_report->compressedKeyframeCount = retval.timestamps.size();
+		_report->maxJointSpaceError = 0.f;
+		_report->maxErrorAnimationID = 0u;
+		_report->keptOverTolerance = keptOverTolerance;
+
+		// measure the real thing, sample the decompressed animations at every original key
+		auto sampler = core::make_smart_refctd_ptr<CAnimationSampler>(retval);
+		for (const auto a : uniqueAnimations)
+		{
+			const auto& animation = _library->getAnimation(a);
+			const uint32_t offset = animation.getKeyframeOffset();
+			const uint32_t count = offset+animation.getKeyframeCount()<=keyframeCount ? animation.getKeyframeCount():0u;
+			if (!count)
+				continue;
+
+			const core::vector<uint32_t> animationIDs(count,a);
+			CAnimationSampler::STransforms sampled;
+			sampler->sample(sampled,animationIDs.data(),&_library->getTimestamp(0u)+offset,count);
+			for (uint32_t k=0u; k<count; k++)
+			{
+				using E_CHANNEL = CAnimationSampler::STransforms::E_CHANNEL;
+				auto get = [&](uint32_t channel) {return sampled.getChannel(static_cast<E_CHANNEL>(channel))[k];};
+				STRS decompressed;
+				decompressed.translation = core::vectorSIMDf(get(E_CHANNEL::EC_TRANSLATION_X),get(E_CHANNEL::EC_TRANSLATION_Y),get(E_CHANNEL::EC_TRANSLATION_Z));
+				decompressed.rotation = core::vectorSIMDf(get(E_CHANNEL::EC_ROTATION_X),get(E_CHANNEL::EC_ROTATION_Y),get(E_CHANNEL::EC_ROTATION_Z),get(E_CHANNEL::EC_ROTATION_W));
+				decompressed.scale = core::vectorSIMDf(get(E_CHANNEL::EC_SCALE_X),get(E_CHANNEL::EC_SCALE_Y),get(E_CHANNEL::EC_SCALE_Z));
+				const float error = jointSpaceError(keyframes[offset+k],decompressed,shellDistances[a]);
+				if (error>_report->maxJointSpaceError)
+				{
+					_report->maxJointSpaceError = error;
+					_report->maxErrorAnimationID = a;
+				}
+			}
+		}
+	}
+
+	return retval;
+}
+
+}
+}
@@ -0,0 +1,515 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+
+#include "nbl/asset/utils/CAnimationSampler.h"
+
+#include <execution>
+#include <numeric>
+
+namespace nbl
+{
+namespace asset
+{
+
+// how many samples/joints a single thread processes in one go
+_NBL_STATIC_INLINE_CONSTEXPR size_t SAMPLER_BATCH_SIZE = 1024ull;
+
+template<typename F>
+static inline void forEachBatch(size_t _count, size_t _batchSize, F&& _f)
+{
+	const size_t batchCount = (_count+_batchSize-1ull)/_batchSize;
+	if (batchCount<2ull)
+	{
+		if (_count)
+			_f(0ull,_count);
+		return;
+	}
+
+	core::vector<size_t> batches(batchCount);
+	std::iota(batches.begin(),batches.end(),0ull);
+	std::for_each(std::execution::par,batches.begin(),batches.end(),[&](const size_t batch)
+	{
+		const size_t begin = batch*_batchSize;
+		_f(begin,core::min(begin+_batchSize,_count));
+	});
+}
+
+
+CAnimationSampler::SJointHierarchy::SJointHierarchy(const ICPUSkeleton* _skeleton)
+{
+	const uint32_t jointCount = _skeleton->getJointCount();
+	parentIDs.resize(jointCount);
+	for (uint32_t j=0u; j<jointCount; j++)
+	{
+		const auto parentID = _skeleton->getParentJointID(j);
+		parentIDs[j] = parentID<jointCount ? parentID:ICPUSkeleton::invalid_joint_id;
+	}
+
+	// parents are not guaranteed to come before their children
+	constexpr uint32_t UnknownDepth = ~0u;
+	core::vector<uint32_t> depth(jointCount,UnknownDepth);
+	core::vector<joint_id_t> stack;
+	uint32_t maxDepth = 0u;
+	for (uint32_t j=0u; j<jointCount; j++)
+	{
+		joint_id_t joint = j;
+		while (depth[joint]==UnknownDepth)
+		{
+			const auto parentID = parentIDs[joint];
+			if (parentID==ICPUSkeleton::invalid_joint_id)
+			{
+				depth[joint] = 0u;
+				break;
+			}
+			stack.push_back(joint);
+			joint = parentID;
+			// a cycle can't be resolved
+			assert(stack.size()<=jointCount);
+		}
+		while (!stack.empty())
+		{
+			const auto child = stack.back();
+			stack.pop_back();
+			depth[child] = depth[parentIDs[child]]+1u;
+		}
+		maxDepth = core::max(maxDepth,depth[j]);
+	}
+
+	// counting sort by depth
+	levelEnds.resize(jointCount ? (maxDepth+1u):0u,0u);
+	for (uint32_t j=0u; j<jointCount; j++)
+		levelEnds[depth[j]]++;
+	std::inclusive_scan(levelEnds.begin(),levelEnds.end(),levelEnds.begin());
+	sortedJoints.resize(jointCount);
+	core::vector<uint32_t> levelOffsets(levelEnds.size(),0u);
+	for (uint32_t l=1u; l<levelEnds.size(); l++)
+		levelOffsets[l] = levelEnds[l-1u];
+	for (uint32_t j=0u; j<jointCount; j++)
+		sortedJoints[levelOffsets[depth[j]]++] = j;
+}
+
+
+CAnimationSampler::CAnimationSampler(const ICPUAnimationLibrary* _library)
+{
+	const uint32_t animationCount = _library->getAnimationStorageRange().buffer ? _library->getAnimationCapacity():0u;
+	m_animations.resize(animationCount);
+	for (uint32_t a=0u; a<animationCount; a++)
+		m_animations[a] = _library->getAnimation(a);
+
+	const uint32_t keyframeCount = _library->getKeyframeCount();
+	m_timestamps.resize(keyframeCount);
+	// one extra identity keyframe at the end for invalid animations
+	m_keyframes.resize(keyframeCount+1u);
+
+	forEachBatch(keyframeCount,SAMPLER_BATCH_SIZE,[&](size_t _begin, size_t _end)
+	{
+		for (size_t k=_begin; k<_end; k++)
+		{
+			m_timestamps[k] = _library->getTimestamp(k);
+
+			const auto& keyframe = _library->getKeyframe(k);
+			const auto translation = keyframe.getTranslation();
+			const auto quat = keyframe.getRotation();
+			const auto& rotation = reinterpret_cast<const core::vectorSIMDf&>(quat);
+			const auto scale = keyframe.getScale();
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_TRANSLATION_X+c))[k] = translation[c];
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_SCALE_X+c))[k] = scale[c];
+			}
+			for (uint32_t c=0u; c<4u; c++)
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_ROTATION_X+c))[k] = rotation[c];
+		}
+	});
+
+	const float identity[STransforms::EC_COUNT] = {0.f,0.f,0.f, 0.f,0.f,0.f,1.f, 1.f,1.f,1.f};
+	for (uint32_t c=0u; c<STransforms::EC_COUNT; c++)
+		m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(c))[keyframeCount] = identity[c];
+}
+
+CAnimationSampler::CAnimationSampler(const CAnimationCompressor::SCompressedAnimations& _compressed)
+{
+	using SAnimation = CAnimationCompressor::SCompressedAnimations::SAnimation;
+
+	m_animations.resize(_compressed.animations.size());
+	for (uint32_t a=0u; a<m_animations.size(); a++)
+		m_animations[a] = _compressed.animations[a].animation;
+
+	const uint32_t keyframeCount = _compressed.timestamps.size();
+	m_timestamps = _compressed.timestamps;
+	m_keyframes.resize(keyframeCount+1u);
+
+	// animations may share keyframes, but then they share the ranges too, so every keyframe gets decoded once with the header of its first user
+	core::vector<uint32_t> keyframeOwners(keyframeCount,SAnimation::InvalidOffset);
+	for (uint32_t a=0u; a<m_animations.size(); a++)
+	{
+		const auto& animation = m_animations[a];
+		const uint32_t offset = animation.getKeyframeOffset();
+		const uint32_t count = animation.getKeyframeCount();
+		if (offset+count>keyframeCount)
+			continue;
+		for (uint32_t k=offset; k<offset+count; k++)
+		if (keyframeOwners[k]==SAnimation::InvalidOffset)
+			keyframeOwners[k] = a;
+	}
+
+	forEachBatch(keyframeCount,SAMPLER_BATCH_SIZE,[&](size_t _begin, size_t _end)
+	{
+		for (size_t keyframe=_begin; keyframe<_end; keyframe++)
+		{
+			const uint32_t a = keyframeOwners[keyframe];
+			if (a==SAnimation::InvalidOffset)
+				continue;
+			const auto& header = _compressed.animations[a];
+			const uint32_t k = keyframe-header.animation.getKeyframeOffset();
+			const auto translation = header.translationOffset!=SAnimation::InvalidOffset ?
+				CAnimationCompressor::SCompressedAnimations::decodeRangeRelative(_compressed.translations.data()+(header.translationOffset+k)*3u,header.translationMin,header.translationExtent):
+				core::vectorSIMDf(header.translationMin[0],header.translationMin[1],header.translationMin[2]);
+			const auto scale = header.scaleOffset!=SAnimation::InvalidOffset ?
+				CAnimationCompressor::SCompressedAnimations::decodeRangeRelative(_compressed.scales.data()+(header.scaleOffset+k)*3u,header.scaleMin,header.scaleExtent):
+				core::vectorSIMDf(header.scaleMin[0],header.scaleMin[1],header.scaleMin[2]);
+			const auto rotation = CAnimationCompressor::SCompressedAnimations::decodeRotation(_compressed.rotations[keyframe]);
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_TRANSLATION_X+c))[keyframe] = translation[c];
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_SCALE_X+c))[keyframe] = scale[c];
+			}
+			for (uint32_t c=0u; c<4u; c++)
+				m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(STransforms::EC_ROTATION_X+c))[keyframe] = rotation[c];
+		}
+	});
+
+	const float identity[STransforms::EC_COUNT] = {0.f,0.f,0.f, 0.f,0.f,0.f,1.f, 1.f,1.f,1.f};
+	for (uint32_t c=0u; c<STransforms::EC_COUNT; c++)
+		m_keyframes.getChannel(static_cast<STransforms::E_CHANNEL>(c))[keyframeCount] = identity[c];
+}
+
+
+inline CAnimationSampler::SKeyframePair CAnimationSampler::findKeyframes(uint32_t _animationID, timestamp_t _time) const
+{
+	const uint32_t identityKeyframe = m_timestamps.size();
+	if (_animationID>=m_animations.size())
+		return {identityKeyframe,identityKeyframe,0.f};
+
+	const auto& animation = m_animations[_animationID];
+	const uint32_t count = animation.getKeyframeCount();
+	const uint32_t offset = animation.getKeyframeOffset();
+	if (count==0u || offset+count>identityKeyframe)
+		return {identityKeyframe,identityKeyframe,0.f};
+
+	// branchless binary search for the last keyframe at or before `_time`
+	const timestamp_t* timestamps = m_timestamps.data()+offset;
+	uint32_t first = 0u;
+	for (uint32_t len=count; len>1u;)
+	{
+		const uint32_t half = len>>1u;
+		first = timestamps[first+half]<=_time ? (first+half):first;
+		len -= half;
+	}
+	const uint32_t second = core::min(first+1u,count-1u);
+
+	float fraction = 0.f;
+	if (animation.getInterpolationMode()!=Animation::EIM_NEAREST && second!=first && _time>timestamps[first])
+		fraction = core::min(float(_time-timestamps[first])/float(timestamps[second]-timestamps[first]),1.f);
+	return {offset+first,offset+second,fraction};
+}
+
+void CAnimationSampler::interpolate(STransforms& _out, const SKeyframePair* _pairs, size_t _begin, size_t _end, E_ROTATION_INTERPOLATION _rotationMode) const
+{
+	using E_CHANNEL = STransforms::E_CHANNEL;
+	auto getLane = [&](E_CHANNEL channel, const uint32_t (&keyframes)[4]) -> core::vectorSIMDf
+	{
+		const float* data = m_keyframes.getChannel(channel);
+		return core::vectorSIMDf(data[keyframes[0]],data[keyframes[1]],data[keyframes[2]],data[keyframes[3]]);
+	};
+
+	const core::vectorSIMDf zero(0.f);
+	const core::vectorSIMDf one(1.f);
+	for (size_t i=_begin; i<_end; i+=4ull)
+	{
+		// the last group is padded by repeating the last sample
+		uint32_t firstKeys[4], secondKeys[4];
+		core::vectorSIMDf fraction;
+		const uint32_t validLanes = core::min<size_t>(_end-i,4ull);
+		for (uint32_t l=0u; l<4u; l++)
+		{
+			const auto& pair = _pairs[i-_begin+core::min(l,validLanes-1u)];
+			firstKeys[l] = pair.first;
+			secondKeys[l] = pair.second;
+			fraction.pointer[l] = pair.fraction;
+		}
+
+		core::vectorSIMDf result[STransforms::EC_COUNT];
+		// translation and scale
+		for (uint32_t c : {STransforms::EC_TRANSLATION_X,STransforms::EC_TRANSLATION_Y,STransforms::EC_TRANSLATION_Z,STransforms::EC_SCALE_X,STransforms::EC_SCALE_Y,STransforms::EC_SCALE_Z})
+			result[c] = core::mix(getLane(static_cast<E_CHANNEL>(c),firstKeys),getLane(static_cast<E_CHANNEL>(c),secondKeys),fraction);
+
+		// rotation, 4 quaternions at once
+		{
+			core::vectorSIMDf q0[4], q1[4];
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				q0[c] = getLane(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c),firstKeys);
+				q1[c] = getLane(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c),secondKeys);
+			}
+			core::vectorSIMDf cosAngle = q0[0]*q1[0]+q0[1]*q1[1]+q0[2]*q1[2]+q0[3]*q1[3];
+			// take the short way around
+			const auto wrongDoubleCover = cosAngle<zero;
+			for (uint32_t c=0u; c<4u; c++)
+				q1[c] = core::mix(q1[c],-q1[c],wrongDoubleCover);
+			cosAngle = core::abs(cosAngle);
+
+			core::vectorSIMDf w0 = one-fraction, w1 = fraction;
+			switch (_rotationMode)
+			{
+				case ERI_FLERP:
+				{
+					const core::vectorSIMDf A = core::vectorSIMDf(1.0904f)+cosAngle*(core::vectorSIMDf(-3.2452f)+cosAngle*(core::vectorSIMDf(3.55645f)-cosAngle*1.43519f));
+					const core::vectorSIMDf B = core::vectorSIMDf(0.848013f)+cosAngle*(core::vectorSIMDf(-1.06021f)+cosAngle*0.215638f);
+					const core::vectorSIMDf halfOff = fraction-core::vectorSIMDf(0.5f);
+					const core::vectorSIMDf k = A*halfOff*halfOff+B;
+					w1 = fraction+fraction*halfOff*(fraction-one)*k;
+					w0 = one-w1;
+					break;
+				}
+				case ERI_SLERP:
+					for (uint32_t l=0u; l<4u; l++)
+					{
+						const float cosA = cosAngle.pointer[l];
+						// almost parallel, lerp is accurate enough and avoids dividing by ~0
+						if (cosA>0.95f)
+							continue;
+						const float angle = acosf(cosA);
+						const float rcpSinA = 1.f/sinf(angle);
+						const float t = fraction.pointer[l];
+						w0.pointer[l] = sinf((1.f-t)*angle)*rcpSinA;
+						w1.pointer[l] = sinf(t*angle)*rcpSinA;
+					}
+					break;
+				default:
+					break;
+			}
+
+			core::vectorSIMDf lenSq = zero;
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				result[STransforms::EC_ROTATION_X+c] = q0[c]*w0+q1[c]*w1;
+				lenSq += result[STransforms::EC_ROTATION_X+c]*result[STransforms::EC_ROTATION_X+c];
+			}
+			const core::vectorSIMDf rcpLen = core::mix(one,one/core::sqrt(lenSq),lenSq>zero);
+			for (uint32_t c=0u; c<4u; c++)
+				result[STransforms::EC_ROTATION_X+c] *= rcpLen;
+		}
+
+		for (uint32_t c=0u; c<STransforms::EC_COUNT; c++)
+		{
+			float* out = _out.getChannel(static_cast<E_CHANNEL>(c))+i;
+			for (uint32_t l=0u; l<validLanes; l++)
+				out[l] = result[c].pointer[l];
+		}
+	}
+}
+
+template<typename TimeAccessor>
+void CAnimationSampler::sample_impl(STransforms& _out, const uint32_t* _animationIDs, TimeAccessor _time, size_t _count, E_ROTATION_INTERPOLATION _rotationMode) const
+{
+	_out.resize(_count);
+	forEachBatch(_count,SAMPLER_BATCH_SIZE,[&](size_t _begin, size_t _end)
+	{
+		SKeyframePair pairs[SAMPLER_BATCH_SIZE];
+		for (size_t i=_begin; i<_end; i++)
+			pairs[i-_begin] = findKeyframes(_animationIDs[i],_time(i));
+		interpolate(_out,pairs,_begin,_end,_rotationMode);
+	});
+}
+
+void CAnimationSampler::sample(STransforms& _out, const uint32_t* _animationIDs, const timestamp_t* _times, size_t _count, E_ROTATION_INTERPOLATION _rotationMode) const
+{
+	sample_impl(_out,_animationIDs,[_times](size_t i) {return _times[i];},_count,_rotationMode);
+}
+
+void CAnimationSampler::sample(STransforms& _out, const uint32_t* _animationIDs, timestamp_t _time, size_t _count, E_ROTATION_INTERPOLATION _rotationMode) const
+{
+	sample_impl(_out,_animationIDs,[_time](size_t i) {return _time;},_count,_rotationMode);
+}
+
+
+void CAnimationSampler::blend(STransforms& _out, const STransforms* const* _poses, const float* _weights, uint32_t _poseCount)
+{
+	if (_poseCount==0u)
+		return;
+	const size_t count = _poses[0]->count;
+	for (uint32_t p=1u; p<_poseCount; p++)
+	{
+		assert(_poses[p]->count==count);
+		// must not alias, we read the first pose while writing
+		assert(_poses[p]!=&_out);
+	}
+	assert(_poses[0]!=&_out);
+	_out.resize(count);
+
+	float weightSum = 0.f;
+	for (uint32_t p=0u; p<_poseCount; p++)
+		weightSum += _weights[p];
+	const float rcpWeightSum = weightSum!=0.f ? (1.f/weightSum):0.f;
+
+	using E_CHANNEL = STransforms::E_CHANNEL;
+	forEachBatch(count,SAMPLER_BATCH_SIZE,[&](size_t _begin, size_t _end)
+	{
+		for (uint32_t c=0u; c<STransforms::EC_COUNT; c++)
+			std::fill_n(_out.getChannel(static_cast<E_CHANNEL>(c))+_begin,_end-_begin,0.f);
+
+		const float* refRotation[4];
+		for (uint32_t c=0u; c<4u; c++)
+			refRotation[c] = _poses[0]->getChannel(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c));
+		for (uint32_t p=0u; p<_poseCount; p++)
+		{
+			const float weight = _weights[p]*rcpWeightSum;
+			for (uint32_t c : {STransforms::EC_TRANSLATION_X,STransforms::EC_TRANSLATION_Y,STransforms::EC_TRANSLATION_Z,STransforms::EC_SCALE_X,STransforms::EC_SCALE_Y,STransforms::EC_SCALE_Z})
+			{
+				const float* in = _poses[p]->getChannel(static_cast<E_CHANNEL>(c));
+				float* out = _out.getChannel(static_cast<E_CHANNEL>(c));
+				for (size_t i=_begin; i<_end; i++)
+					out[i] += in[i]*weight;
+			}
+
+			const float* rotation[4];
+			float* outRotation[4];
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				rotation[c] = _poses[p]->getChannel(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c));
+				outRotation[c] = _out.getChannel(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c));
+			}
+			for (size_t i=_begin; i<_end; i++)
+			{
+				const float dot = rotation[0][i]*refRotation[0][i]+rotation[1][i]*refRotation[1][i]+rotation[2][i]*refRotation[2][i]+rotation[3][i]*refRotation[3][i];
+				const float signedWeight = dot<0.f ? (-weight):weight;
+				for (uint32_t c=0u; c<4u; c++)
+					outRotation[c][i] += rotation[c][i]*signedWeight;
+			}
+		}
+
+		float* outRotation[4];
+		for (uint32_t c=0u; c<4u; c++)
+			outRotation[c] = _out.getChannel(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c));
+		for (size_t i=_begin; i<_end; i++)
+		{
+			const float lenSq = outRotation[0][i]*outRotation[0][i]+outRotation[1][i]*outRotation[1][i]+outRotation[2][i]*outRotation[2][i]+outRotation[3][i]*outRotation[3][i];
+			if (lenSq>0.f)
+			{
+				const float rcpLen = 1.f/core::sqrt(lenSq);
+				for (uint32_t c=0u; c<4u; c++)
+					outRotation[c][i] *= rcpLen;
+			}
+			else
+			{
+				outRotation[0][i] = outRotation[1][i] = outRotation[2][i] = 0.f;
+				outRotation[3][i] = 1.f;
+			}
+		}
+	});
+}
+
+void CAnimationSampler::constructMatrices(core::matrixSIMDBatch::affine_matrices_t _out, const STransforms& _in)
+{
+	using E_CHANNEL = STransforms::E_CHANNEL;
+	forEachBatch(_in.count,SAMPLER_BATCH_SIZE,[&](size_t _begin, size_t _end)
+	{
+		const float* t[3]; const float* q[4]; const float* s[3];
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			t[c] = _in.getChannel(static_cast<E_CHANNEL>(STransforms::EC_TRANSLATION_X+c));
+			s[c] = _in.getChannel(static_cast<E_CHANNEL>(STransforms::EC_SCALE_X+c));
+		}
+		for (uint32_t c=0u; c<4u; c++)
+			q[c] = _in.getChannel(static_cast<E_CHANNEL>(STransforms::EC_ROTATION_X+c));
+
+		float* const* m = _out.comp;
+		for (size_t i=_begin; i<_end; i++)
+		{
+			const float x = q[0][i], y = q[1][i], z = q[2][i], w = q[3][i];
+			const float sx = s[0][i], sy = s[1][i], sz = s[2][i];
+			// rotation matrix with columns scaled, rows get the translation
+			m[0][i] = (1.f-2.f*(y*y+z*z))*sx;
+			m[1][i] = 2.f*(x*y-z*w)*sy;
+			m[2][i] = 2.f*(x*z+y*w)*sz;
+			m[3][i] = t[0][i];
+			m[4][i] = 2.f*(x*y+z*w)*sx;
+			m[5][i] = (1.f-2.f*(x*x+z*z))*sy;
+			m[6][i] = 2.f*(y*z-x*w)*sz;
+			m[7][i] = t[1][i];
+			m[8][i] = 2.f*(x*z-y*w)*sx;
+			m[9][i] = 2.f*(y*z+x*w)*sy;
+			m[10][i] = (1.f-2.f*(x*x+y*y))*sz;
+			m[11][i] = t[2][i];
+		}
+	});
+}
+
+void CAnimationSampler::computeGlobalTransforms(core::matrixSIMDBatch::affine_matrices_t _global, core::matrixSIMDBatch::const_affine_matrices_t _local, const SJointHierarchy& _hierarchy, uint32_t _instanceCount)
+{
+	constexpr uint32_t ComponentCount = core::matrixSIMDBatch::affine_matrices_t::Components;
+	constexpr size_t ConcatBatchSize = 256ull;
+
+	const uint32_t jointCount = _hierarchy.getJointCount();
+	for (uint32_t level=0u; level<_hierarchy.getLevelCount(); level++)
+	{
+		const uint32_t levelBegin = level ? _hierarchy.levelEnds[level-1u]:0u;
+		const uint32_t levelSize = _hierarchy.levelEnds[level]-levelBegin;
+		const size_t itemCount = size_t(levelSize)*_instanceCount;
+		forEachBatch(itemCount,ConcatBatchSize,[&](size_t _begin, size_t _end)
+		{
+			// returns the index of the joint's matrix and its parent's
+			auto getMatrixIndices = [&](size_t item) -> std::pair<size_t,size_t>
+			{
+				const size_t instanceOffset = (item/levelSize)*jointCount;
+				const joint_id_t joint = _hierarchy.sortedJoints[levelBegin+item%levelSize];
+				return {instanceOffset+joint,instanceOffset+_hierarchy.parentIDs[joint]};
+			};
+
+			// roots are their own global transforms
+			if (level==0u)
+			{
+				for (size_t item=_begin; item<_end; item++)
+				{
+					const size_t ix = getMatrixIndices(item).first;
+					for (uint32_t c=0u; c<ComponentCount; c++)
+						_global.comp[c][ix] = _local.comp[c][ix];
+				}
+				return;
+			}
+
+			// gather into contiguous SoA, concatenate in one go, scatter back
+			float scratch[3u][ComponentCount][ConcatBatchSize];
+			core::matrixSIMDBatch::affine_matrices_t parentView,localView,outView;
+			for (uint32_t c=0u; c<ComponentCount; c++)
+			{
+				parentView.comp[c] = scratch[0][c];
+				localView.comp[c] = scratch[1][c];
+				outView.comp[c] = scratch[2][c];
+			}
+			size_t indices[ConcatBatchSize];
+			for (size_t item=_begin; item<_end; item++)
+			{
+				const auto [ix,parentIx] = getMatrixIndices(item);
+				indices[item-_begin] = ix;
+				for (uint32_t c=0u; c<ComponentCount; c++)
+				{
+					parentView.comp[c][item-_begin] = _global.comp[c][parentIx];
+					localView.comp[c][item-_begin] = _local.comp[c][ix];
+				}
+			}
+			const size_t batchCount = _end-_begin;
+			core::matrixSIMDBatch::concatenateBFollowedByA(outView,parentView,localView,batchCount);
+			for (size_t i=0ull; i<batchCount; i++)
+			for (uint32_t c=0u; c<ComponentCount; c++)
+				_global.comp[c][indices[i]] = outView.comp[c][i];
+		});
+	}
+}
+
+}
+}
@@ -44,6 +44,13 @@ class CBuiltinIncluder : public IIncluder
             m_loaders.insert(std::string(IIncludeHandler::BUILTIN_PREFIX) + _loader->getVirtualDirectoryName(), _loader.get());
         }
 
+        void clearLoaderCaches()
+        {
+            m_default->clearCache();
+            for (auto& loader : m_loaders)
+                loader.second->clearCache();
+        }
+
     protected:
         std::string getInclude_internal(const std::string& _path) const override
         {
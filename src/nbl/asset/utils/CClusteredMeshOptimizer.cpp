@@ -0,0 +1,328 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+#include "nbl/core/math/morton.h"
+
+#include "CClusteredMeshOptimizer.h"
+
+#include <execution>
+#include <numeric>
+#include <functional>
+
+#include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
+#include "COverdrawMeshOptimizer.h"
+#include "os.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+struct MortonKeyAccessor
+{
+	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = 30ull;
+
+	template<auto bit_offset, auto radix_mask, class SortKey>
+	inline decltype(radix_mask) operator()(const SortKey& item) const
+	{
+		return static_cast<decltype(radix_mask)>(item.morton>>static_cast<uint32_t>(bit_offset))&radix_mask;
+	}
+};
+
+core::vector<core::vectorSIMDf> CClusteredMeshOptimizer::gatherPositions(const ICPUMeshBuffer* _meshbuffer, uint32_t _vertexCount)
+{
+	core::vector<core::vectorSIMDf> positions(_vertexCount);
+	const uint32_t posAttr = _meshbuffer->getPositionAttributeIx();
+	std::for_each(std::execution::par_unseq,positions.begin(),positions.end(),[&](core::vectorSIMDf& pos)
+	{
+		_meshbuffer->getAttribute(pos,posAttr,std::distance(positions.data(),&pos));
+		pos.w = 0.f;
+	});
+	return positions;
+}
+
+core::vector<uint32_t> CClusteredMeshOptimizer::gatherIndices(const ICPUMeshBuffer* _meshbuffer)
+{
+	const uint32_t idxCount = _meshbuffer->getIndexCount();
+	core::vector<uint32_t> indices(idxCount);
+	const void* const src = _meshbuffer->getIndices();
+	switch (_meshbuffer->getIndexType())
+	{
+		case EIT_16BIT:
+			std::copy_n(reinterpret_cast<const uint16_t*>(src),idxCount,indices.data());
+			break;
+		case EIT_32BIT:
+			std::copy_n(reinterpret_cast<const uint32_t*>(src),idxCount,indices.data());
+			break;
+		default:
+			std::iota(indices.begin(),indices.end(),0u);
+			break;
+	}
+	return indices;
+}
+
+void CClusteredMeshOptimizer::optimize(ICPUMeshBuffer* _meshbuffer, uint32_t _trianglesPerCluster, float _threshold)
+{
+	if (!_meshbuffer || !_meshbuffer->getPipeline())
+		return;
+
+	const E_INDEX_TYPE indexType = _meshbuffer->getIndexType();
+	void* const outIndices = _meshbuffer->getIndices();
+	if (indexType==EIT_UNKNOWN || !outIndices || _meshbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType!=EPT_TRIANGLE_LIST)
+	{
+#ifdef _NBL_DEBUG
+		os::Printer::log("Clustered mesh optimization: not an indexed triangle list -- mesh buffer left unchanged.");
+#endif
+		return;
+	}
+
+	const uint32_t triangleCount = _meshbuffer->getIndexCount()/3u;
+	if (triangleCount==0u)
+		return;
+	_trianglesPerCluster = core::max(_trianglesPerCluster,1u);
+
+	const auto indices = gatherIndices(_meshbuffer);
+	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_meshbuffer);
+	const auto positions = gatherPositions(_meshbuffer,vertexCount);
+
+	// order triangles along a Morton curve of their centroids
+	core::vector<SortKey> sortKeys(size_t(triangleCount)*2u);
+	{
+		core::vectorSIMDf boundsMin(FLT_MAX),boundsMax(-FLT_MAX);
+		for (const auto& pos : positions)
+		{
+			boundsMin = core::min(boundsMin,pos);
+			boundsMax = core::max(boundsMax,pos);
+		}
+		const core::vectorSIMDf extent = boundsMax-boundsMin;
+		const core::vectorSIMDf scale(
+			extent.x>0.f ? 1023.f/extent.x:0.f,
+			extent.y>0.f ? 1023.f/extent.y:0.f,
+			extent.z>0.f ? 1023.f/extent.z:0.f,
+			0.f
+		);
+
+		std::for_each(std::execution::par_unseq,sortKeys.begin(),sortKeys.begin()+triangleCount,[&](SortKey& key)
+		{
+			key.triangle = std::distance(sortKeys.data(),&key);
+			const uint32_t* tri = indices.data()+key.triangle*3u;
+			const core::vectorSIMDf centroid = (positions[tri[0]]+positions[tri[1]]+positions[tri[2]])*(1.f/3.f);
+			const core::vectorSIMDf quantized = (centroid-boundsMin)*scale+core::vectorSIMDf(0.5f);
+			key.morton = core::morton3d_encode(static_cast<uint32_t>(quantized.x),static_cast<uint32_t>(quantized.y),static_cast<uint32_t>(quantized.z));
+		});
+	}
+	const SortKey* sorted = core::radix_sort(sortKeys.data(),sortKeys.data()+triangleCount,triangleCount,MortonKeyAccessor());
+
+	core::vectorSIMDf meshCentroid;
+	for (const auto index : indices)
+		meshCentroid += positions[index];
+	meshCentroid /= float(indices.size());
+
+	// optimize every cluster on its own
+	const uint32_t clusterCount = (triangleCount-1u)/_trianglesPerCluster+1u;
+	core::vector<uint32_t> clusteredIndices(size_t(triangleCount)*3u);
+	core::vector<ClusterSortData> clusterSortData(clusterCount);
+	std::for_each(std::execution::par,clusterSortData.begin(),clusterSortData.end(),[&](ClusterSortData& sortData)
+	{
+		const uint32_t cluster = std::distance(clusterSortData.data(),&sortData);
+		const uint32_t firstTriangle = cluster*_trianglesPerCluster;
+		const uint32_t clusterTriangles = core::min(triangleCount-firstTriangle,_trianglesPerCluster);
+		const uint32_t clusterIndexCount = clusterTriangles*3u;
+
+		// renumber the vertices locally, so the per-vertex state of the optimizers is proportional to the cluster and not the whole mesh
+		core::unordered_map<uint32_t,uint32_t> globalToLocal;
+		globalToLocal.reserve(clusterIndexCount);
+		core::vector<uint32_t> localToGlobal;
+		core::vector<uint32_t> localIndices(clusterIndexCount);
+		for (uint32_t i=0u; i<clusterTriangles; i++)
+		{
+			const uint32_t* tri = indices.data()+sorted[firstTriangle+i].triangle*3u;
+			for (uint32_t j=0u; j<3u; j++)
+			{
+				auto found = globalToLocal.emplace(tri[j],static_cast<uint32_t>(localToGlobal.size()));
+				if (found.second)
+					localToGlobal.push_back(tri[j]);
+				localIndices[i*3u+j] = found.first->second;
+			}
+		}
+		core::vector<core::vectorSIMDf> localPositions(localToGlobal.size());
+		for (size_t i=0u; i<localToGlobal.size(); i++)
+			localPositions[i] = positions[localToGlobal[i]];
+
+		// Forsyth first, the overdraw optimizer uses the resulting cache behaviour to form its own (much smaller) clusters
+		CForsythVertexCacheOptimizer forsyth;
+		forsyth.optimizeTriangleOrdering(localPositions.size(),clusterIndexCount,localIndices.data(),localIndices.data());
+		uint32_t* const out = clusteredIndices.data()+size_t(firstTriangle)*3u;
+		COverdrawMeshOptimizer::optimizeIndices(out,localIndices.data(),clusterIndexCount,localPositions.data(),localPositions.size(),_threshold);
+
+		// same occluder potential heuristic as the overdraw optimizer, but across clusters
+		float clusterArea = 0.f;
+		core::vectorSIMDf clusterCentroid,clusterNormal;
+		for (uint32_t i=0u; i<clusterIndexCount; i+=3u)
+		{
+			const auto& p0 = localPositions[out[i+0u]];
+			const auto& p1 = localPositions[out[i+1u]];
+			const auto& p2 = localPositions[out[i+2u]];
+
+			const core::vectorSIMDf normal = core::cross(p1-p0,p2-p0);
+			const float area = core::length(normal)[0];
+
+			clusterCentroid += (p0+p1+p2)*(area/3.f);
+			clusterNormal += normal;
+			clusterArea += area;
+		}
+		clusterCentroid *= clusterArea!=0.f ? 1.f/clusterArea:0.f;
+		sortData.cluster = cluster;
+		sortData.dot = core::dot(clusterCentroid-meshCentroid,core::normalize(clusterNormal))[0];
+
+		for (uint32_t i=0u; i<clusterIndexCount; i++)
+			out[i] = localToGlobal[out[i]];
+	});
+
+	std::stable_sort(clusterSortData.begin(),clusterSortData.end(),std::greater<ClusterSortData>());
+
+	// stitch
+	auto stitch = [&](auto* out)
+	{
+		for (const auto& sortData : clusterSortData)
+		{
+			const uint32_t firstTriangle = sortData.cluster*_trianglesPerCluster;
+			const uint32_t clusterTriangles = core::min(triangleCount-firstTriangle,_trianglesPerCluster);
+			const uint32_t* in = clusteredIndices.data()+size_t(firstTriangle)*3u;
+			for (uint32_t i=0u; i<clusterTriangles*3u; i++)
+				*(out++) = in[i];
+		}
+	};
+	if (indexType==EIT_16BIT)
+		stitch(reinterpret_cast<uint16_t*>(outIndices));
+	else
+		stitch(reinterpret_cast<uint32_t*>(outIndices));
+}
+
+IMeshManipulator::SIndexBufferStatistics CClusteredMeshOptimizer::analyze(const ICPUMeshBuffer* _meshbuffer, uint32_t _cacheSize)
+{
+	IMeshManipulator::SIndexBufferStatistics retval;
+	if (!_meshbuffer || !_meshbuffer->getPipeline() || _meshbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType!=EPT_TRIANGLE_LIST)
+		return retval;
+
+	const auto indices = gatherIndices(_meshbuffer);
+	const uint32_t triangleCount = indices.size()/3u;
+	if (triangleCount==0u)
+		return retval;
+	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_meshbuffer);
+
+	// FIFO post-transform cache simulation
+	{
+		core::vector<uint64_t> cacheTimestamps(vertexCount,0ull);
+		core::vector<bool> referenced(vertexCount,false);
+		uint64_t timestamp = _cacheSize+1ull;
+		uint64_t misses = 0ull;
+		uint32_t uniqueVertices = 0u;
+		for (const auto index : indices)
+		{
+			if (timestamp-cacheTimestamps[index]>_cacheSize)
+			{
+				cacheTimestamps[index] = timestamp++;
+				misses++;
+			}
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				uniqueVertices++;
+			}
+		}
+		retval.acmr = double(misses)/double(triangleCount);
+		retval.atvr = double(misses)/double(uniqueVertices);
+	}
+
+	// overdraw from the 6 axis-aligned orthographic views
+	{
+		const auto positions = gatherPositions(_meshbuffer,vertexCount);
+		core::vectorSIMDf boundsMin(FLT_MAX),boundsMax(-FLT_MAX);
+		for (const auto index : indices)
+		{
+			boundsMin = core::min(boundsMin,positions[index]);
+			boundsMax = core::max(boundsMax,positions[index]);
+		}
+		const core::vectorSIMDf extent = boundsMax-boundsMin;
+
+		std::array<std::pair<uint64_t,uint64_t>,6u> views;
+		std::for_each(std::execution::par,views.begin(),views.end(),[&](std::pair<uint64_t,uint64_t>& view)
+		{
+			const uint32_t viewID = std::distance(views.data(),&view);
+			view = rasterizeOverdraw(indices,positions,boundsMin,extent,viewID>>1u,viewID&0x1u);
+		});
+		uint64_t shaded = 0ull, covered = 0ull;
+		for (const auto& view : views)
+		{
+			shaded += view.first;
+			covered += view.second;
+		}
+		retval.overdraw = covered ? double(shaded)/double(covered):0.f;
+	}
+	return retval;
+}
+
+std::pair<uint64_t,uint64_t> CClusteredMeshOptimizer::rasterizeOverdraw(const core::vector<uint32_t>& _indices, const core::vector<core::vectorSIMDf>& _positions, const core::vectorSIMDf& _boundsMin, const core::vectorSIMDf& _boundsExtent, uint32_t _axis, bool _flip)
+{
+	const uint32_t uAxis = (_axis+1u)%3u;
+	const uint32_t vAxis = (_axis+2u)%3u;
+	const float uScale = _boundsExtent[uAxis]>0.f ? float(OVERDRAW_GRID_SIZE)/_boundsExtent[uAxis]:0.f;
+	const float vScale = _boundsExtent[vAxis]>0.f ? float(OVERDRAW_GRID_SIZE)/_boundsExtent[vAxis]:0.f;
+
+	core::vector<float> depthBuffer(OVERDRAW_GRID_SIZE*OVERDRAW_GRID_SIZE,FLT_MAX);
+	uint64_t shaded = 0ull;
+	for (size_t i=0u; i<_indices.size(); i+=3u)
+	{
+		float u[3],v[3],z[3];
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			const auto rel = _positions[_indices[i+j]]-_boundsMin;
+			// mirroring the image when looking from the other side keeps the winding (and therefore culling) consistent
+			u[j] = _flip ? float(OVERDRAW_GRID_SIZE)-rel[uAxis]*uScale:rel[uAxis]*uScale;
+			v[j] = rel[vAxis]*vScale;
+			z[j] = _flip ? -rel[_axis]:rel[_axis];
+		}
+
+		const float area = (u[1]-u[0])*(v[2]-v[0])-(u[2]-u[0])*(v[1]-v[0]);
+		// backface and degenerate culling
+		if (area<=0.f)
+			continue;
+		const float invArea = 1.f/area;
+
+		const int32_t minU = core::max<int32_t>(std::floor(core::min(u[0],u[1],u[2])),0);
+		const int32_t minV = core::max<int32_t>(std::floor(core::min(v[0],v[1],v[2])),0);
+		const int32_t maxU = core::min<int32_t>(std::ceil(core::max(u[0],u[1],u[2])),OVERDRAW_GRID_SIZE);
+		const int32_t maxV = core::min<int32_t>(std::ceil(core::max(v[0],v[1],v[2])),OVERDRAW_GRID_SIZE);
+		for (int32_t py=minV; py<maxV; py++)
+		for (int32_t px=minU; px<maxU; px++)
+		{
+			const float cu = float(px)+0.5f;
+			const float cv = float(py)+0.5f;
+			const float w0 = (u[2]-u[1])*(cv-v[1])-(v[2]-v[1])*(cu-u[1]);
+			const float w1 = (u[0]-u[2])*(cv-v[2])-(v[0]-v[2])*(cu-u[2]);
+			const float w2 = (u[1]-u[0])*(cv-v[0])-(v[1]-v[0])*(cu-u[0]);
+			if (w0<0.f || w1<0.f || w2<0.f)
+				continue;
+
+			const float depth = (w0*z[0]+w1*z[1]+w2*z[2])*invArea;
+			float& stored = depthBuffer[py*OVERDRAW_GRID_SIZE+px];
+			if (depth<stored)
+			{
+				stored = depth;
+				shaded++;
+			}
+		}
+	}
+
+	uint64_t covered = 0ull;
+	for (const auto depth : depthBuffer)
+	if (depth!=FLT_MAX)
+		covered++;
+	return {shaded,covered};
+}
+
+}
+}
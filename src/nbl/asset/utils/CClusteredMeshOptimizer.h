@@ -0,0 +1,62 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_CLUSTERED_MESH_OPTIMIZER_H_INCLUDED__
+#define __NBL_ASSET_C_CLUSTERED_MESH_OPTIMIZER_H_INCLUDED__
+
+#include "nbl/asset/ICPUMeshBuffer.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Parallel counterpart of the serial Forsyth + overdraw optimization pipeline, for meshes with millions of triangles.
+/** Triangles are sorted along a Morton curve of their centroids and cut into spatially coherent clusters,
+each cluster gets its own local vertex numbering and is optimized independently on a worker thread.
+*/
+class CClusteredMeshOptimizer
+{
+		// private, undefined constructor
+		CClusteredMeshOptimizer() = delete;
+
+	public:
+		//! @copydoc IMeshManipulator::optimizeIndexBufferClustered
+		static void optimize(ICPUMeshBuffer* _meshbuffer, uint32_t _trianglesPerCluster, float _threshold);
+
+		//! @copydoc IMeshManipulator::calculateIndexBufferStatistics
+		static IMeshManipulator::SIndexBufferStatistics analyze(const ICPUMeshBuffer* _meshbuffer, uint32_t _cacheSize);
+
+	private:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t OVERDRAW_GRID_SIZE = 256u;
+
+		struct SortKey
+		{
+			uint32_t morton;
+			uint32_t triangle;
+		};
+		struct ClusterSortData
+		{
+			uint32_t cluster;
+			float dot;
+
+			bool operator>(const ClusterSortData& other) const
+			{
+				// high product = possible occluder, render early
+				return dot > other.dot;
+			}
+		};
+
+		static core::vector<core::vectorSIMDf> gatherPositions(const ICPUMeshBuffer* _meshbuffer, uint32_t _vertexCount);
+		static core::vector<uint32_t> gatherIndices(const ICPUMeshBuffer* _meshbuffer);
+
+		//! returns the number of shaded and covered pixels of an orthographic view along `_axis`, looking from the positive side if `_flip`
+		static std::pair<uint64_t,uint64_t> rasterizeOverdraw(const core::vector<uint32_t>& _indices, const core::vector<core::vectorSIMDf>& _positions, const core::vectorSIMDf& _boundsMin, const core::vectorSIMDf& _boundsExtent, uint32_t _axis, bool _flip);
+};
+
+}
+}
+
+#endif
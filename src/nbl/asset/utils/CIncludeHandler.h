@@ -48,6 +48,12 @@ public:
     void addBuiltinIncludeLoader(core::smart_refctd_ptr<IBuiltinIncludeLoader>&& _inclLoader) override
     {
         static_cast<CBuiltinIncluder*>(m_includers[EII_BUILTIN].get())->addBuiltinLoader(std::move(_inclLoader));
+        m_builtinIncludeLoadersRevision++;
+    }
+
+    void clearBuiltinIncludeLoaderCaches() override
+    {
+        static_cast<CBuiltinIncluder*>(m_includers[EII_BUILTIN].get())->clearLoaderCaches();
     }
 
 private:
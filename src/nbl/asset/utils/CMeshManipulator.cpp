@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <execution>
+#include <string_view>
 
 #include "os.h"
 
@@ -16,6 +18,8 @@
 #include "nbl/asset/utils/CSmoothNormalGenerator.h"
 #include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
 #include "nbl/asset/utils/COverdrawMeshOptimizer.h"
+#include "nbl/asset/utils/CClusteredMeshOptimizer.h"
+#include "nbl/asset/utils/CQuadricMeshSimplifier.h"
 
 namespace nbl
 {
@@ -436,6 +440,105 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::calculateSmoothNormals(
 	return outbuffer;
 }
 
+//
+core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::calculateSmoothNormalsWithHardEdges(ICPUMeshBuffer* inbuffer, float hardEdgeAngle, float epsilon, uint32_t normalAttrID)
+{
+	if (!inbuffer || !inbuffer->getPipeline() || !inbuffer->isAttributeEnabled(normalAttrID))
+		return nullptr;
+	if (inbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType!=EPT_TRIANGLE_LIST)
+		return nullptr;
+
+	// split every vertex, so that each corner can receive its own normal
+	const bool indexed = inbuffer->getIndexType()!=EIT_UNKNOWN && inbuffer->getIndices();
+	auto unwelded = indexed ? createMeshBufferUniquePrimitives(inbuffer):core::smart_refctd_ptr<ICPUMeshBuffer>(inbuffer);
+	if (!unwelded)
+		return nullptr;
+	// without an index buffer `unwelded` is the input, so make sure its normals don't get overwritten
+	unwelded = calculateSmoothNormals(unwelded.get(),!indexed,epsilon,normalAttrID,createHardEdgeComparator(hardEdgeAngle));
+	if (!unwelded)
+		return nullptr;
+
+	constexpr uint32_t MAX_ATTRIBS = ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT;
+	uint32_t attrOffset[MAX_ATTRIBS];
+	uint32_t attrSize[MAX_ATTRIBS] = {};
+	uint32_t vertexSize = 0u;
+	for (uint32_t i=0u; i<MAX_ATTRIBS; i++)
+	if (unwelded->isAttributeEnabled(i) && unwelded->getAttribBoundBuffer(i).buffer)
+	{
+		attrOffset[i] = vertexSize;
+		attrSize[i] = getTexelOrBlockBytesize(unwelded->getAttribFormat(i));
+		vertexSize += attrSize[i];
+	}
+
+	// gather every corner into a packed interleaved layout
+	const uint32_t cornerCount = unwelded->getIndexCount();
+	core::vector<uint8_t> packed(size_t(cornerCount)*vertexSize);
+	{
+		core::vector<uint32_t> corners(cornerCount);
+		std::iota(corners.begin(),corners.end(),0u);
+		std::for_each(std::execution::par_unseq,corners.begin(),corners.end(),[&](const uint32_t corner)
+		{
+			for (uint32_t i=0u; i<MAX_ATTRIBS; i++)
+			if (attrSize[i])
+				memcpy(packed.data()+size_t(corner)*vertexSize+attrOffset[i],unwelded->getAttribPointer(i)+size_t(corner)*unwelded->getAttribStride(i),attrSize[i]);
+		});
+	}
+
+	// corners which came out bit-identical (all of the smooth regions) get merged again, the ones on hard edges stay split
+	auto idxbuf = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(uint32_t)*cornerCount);
+	uint32_t* const indices = reinterpret_cast<uint32_t*>(idxbuf->getPointer());
+	uint32_t uniqueCount = 0u;
+	{
+		core::unordered_map<std::string_view,uint32_t> firstOccurence;
+		firstOccurence.reserve(cornerCount/3u);
+		for (uint32_t corner=0u; corner<cornerCount; corner++)
+		{
+			const std::string_view key(reinterpret_cast<const char*>(packed.data())+size_t(corner)*vertexSize,vertexSize);
+			auto found = firstOccurence.find(key);
+			if (found!=firstOccurence.end())
+			{
+				indices[corner] = found->second;
+				continue;
+			}
+			// compact in place, only ever moves data towards the front so the keys (which point at compacted vertices) stay valid
+			uint8_t* const compacted = packed.data()+size_t(uniqueCount)*vertexSize;
+			if (uniqueCount!=corner)
+				memmove(compacted,key.data(),vertexSize);
+			firstOccurence.emplace(std::string_view(reinterpret_cast<const char*>(compacted),vertexSize),uniqueCount);
+			indices[corner] = uniqueCount++;
+		}
+	}
+
+	auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(uniqueCount)*vertexSize);
+	memcpy(vertexBuffer->getPointer(),packed.data(),vertexBuffer->getSize());
+
+	constexpr uint32_t NEW_VTX_BUF_BINDING = 0u;
+	auto pipeline = core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(unwelded->getPipeline()->clone(0u));
+	const auto oldVtxParams = unwelded->getPipeline()->getVertexInputParams();
+	auto& vtxParams = pipeline->getVertexInputParams() = {};
+	vtxParams.enabledBindingFlags = 0x1u<<NEW_VTX_BUF_BINDING;
+	vtxParams.enabledAttribFlags = oldVtxParams.enabledAttribFlags;
+	vtxParams.bindings[NEW_VTX_BUF_BINDING].inputRate = EVIR_PER_VERTEX;
+	vtxParams.bindings[NEW_VTX_BUF_BINDING].stride = vertexSize;
+	for (uint32_t i=0u; i<MAX_ATTRIBS; i++)
+	if (attrSize[i])
+	{
+		vtxParams.attributes[i].binding = NEW_VTX_BUF_BINDING;
+		vtxParams.attributes[i].format = unwelded->getAttribFormat(i);
+		vtxParams.attributes[i].relativeOffset = attrOffset[i];
+	}
+
+	auto welded = core::move_and_static_cast<ICPUMeshBuffer>(unwelded->clone(0u));
+	for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+		welded->setVertexBufferBinding({},i);
+	welded->setVertexBufferBinding({0ull,std::move(vertexBuffer)},NEW_VTX_BUF_BINDING);
+	welded->setIndexBufferBinding({0ull,std::move(idxbuf)});
+	welded->setIndexType(EIT_32BIT);
+	welded->setBaseVertex(0);
+	welded->setPipeline(std::move(pipeline));
+	return welded;
+}
+
 // Used by createMeshBufferWelded only
 static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb, size_t _vsize, const IMeshManipulator::SErrorMetric* _errMetrics)
 {
@@ -771,6 +874,61 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createOptimizedMeshBuff
 	return outbuffer;
 }
 
+IMeshManipulator::SIndexBufferStatistics IMeshManipulator::calculateIndexBufferStatistics(const ICPUMeshBuffer* meshbuffer, uint32_t cacheSize)
+{
+	return CClusteredMeshOptimizer::analyze(meshbuffer,cacheSize);
+}
+
+void IMeshManipulator::optimizeIndexBufferClustered(ICPUMeshBuffer* meshbuffer, uint32_t trianglesPerCluster, float overdrawThreshold)
+{
+	CClusteredMeshOptimizer::optimize(meshbuffer,trianglesPerCluster,overdrawThreshold);
+}
+
+core::vector<IMeshManipulator::SLoD> IMeshManipulator::createLoDChain(const ICPUMeshBuffer* inbuffer, const SLoDChainParams& params)
+{
+	return CQuadricMeshSimplifier::createLoDChain(inbuffer,params);
+}
+
+core::vector<IMeshManipulator::SMeshLoD> IMeshManipulator::createLoDChain(const ICPUMesh* mesh, const SLoDChainParams& params)
+{
+	core::vector<SMeshLoD> retval;
+	if (!mesh)
+		return retval;
+
+	const auto meshbuffers = mesh->getMeshBuffers();
+	core::vector<core::vector<SLoD>> chains(meshbuffers.size());
+	core::vector<uint32_t> ids(meshbuffers.size());
+	std::iota(ids.begin(),ids.end(),0u);
+	std::for_each(std::execution::par,ids.begin(),ids.end(),[&](const uint32_t id)
+	{
+		chains[id] = CQuadricMeshSimplifier::createLoDChain(meshbuffers.begin()[id],params);
+	});
+
+	size_t levelCount = 0u;
+	for (const auto& chain : chains)
+		levelCount = core::max(levelCount,chain.size());
+	for (size_t level=0u; level<levelCount; level++)
+	{
+		auto& lod = retval.emplace_back();
+		lod.mesh = core::make_smart_refctd_ptr<ICPUMesh>();
+		auto& outMeshbuffers = lod.mesh->getMeshBufferVector();
+		for (uint32_t id=0u; id<chains.size(); id++)
+		{
+			const auto& chain = chains[id];
+			if (chain.empty())
+			{
+				outMeshbuffers.push_back(core::move_and_static_cast<ICPUMeshBuffer>(meshbuffers.begin()[id]->clone(0u)));
+				continue;
+			}
+			const auto& mbLoD = chain[core::min(level,chain.size()-1u)];
+			outMeshbuffers.push_back(mbLoD.meshbuffer);
+			lod.error = core::max(lod.error,mbLoD.error);
+		}
+		recalculateBoundingBox(lod.mesh.get());
+	}
+	return retval;
+}
+
 void IMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const SErrorMetric* _errMetric)
 {
     constexpr uint32_t MAX_ATTRIBS = ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT;
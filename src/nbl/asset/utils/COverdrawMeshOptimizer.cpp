@@ -45,71 +45,71 @@ void COverdrawMeshOptimizer::createOptimized(asset::ICPUMeshBuffer* _outbuffer,
 	}
 
 	void* indexCopy = nullptr;
-	const uint16_t* inIndices16 = reinterpret_cast<const uint16_t*>(inIndices);
-	const uint32_t* inIndices32 = reinterpret_cast<const uint32_t*>(inIndices);
+	const void* srcIndices = inIndices;
 	// TODO: more accure check for overlap
 	if (_outbuffer->getIndexBufferBinding().buffer==_inbuffer->getIndexBufferBinding().buffer)
 	{
 		const size_t dataSize = indexSize*idxCount;
 		indexCopy = _NBL_ALIGNED_MALLOC(dataSize,indexSize);
-		memcpy(outIndices,inIndices,dataSize);
-		inIndices16 = reinterpret_cast<const uint16_t*>(dataSize);
-		inIndices32 = reinterpret_cast<const uint32_t*>(dataSize);
+		memcpy(indexCopy,inIndices,dataSize);
+		srcIndices = indexCopy;
 	}
-	uint16_t* outIndices16 = reinterpret_cast<uint16_t*>(outIndices);
-	uint32_t* outIndices32 = reinterpret_cast<uint32_t*>(outIndices);
 
 	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_inbuffer);
 	core::vector<core::vectorSIMDf> vertexPositions(vertexCount);
 	for (uint32_t i=0u; i<vertexCount; ++i)
 		_inbuffer->getAttribute(vertexPositions[i],_inbuffer->getPositionAttributeIx(),i);
 
-	uint32_t* const hardClusters = reinterpret_cast<uint32_t*>(_NBL_ALIGNED_MALLOC((idxCount/3)*sizeof(uint32_t),_NBL_SIMD_ALIGNMENT));
-	const size_t hardClusterCount = indexType == asset::EIT_16BIT ?
-		genHardBoundaries(hardClusters, inIndices16, idxCount, vertexCount) :
-		genHardBoundaries(hardClusters, inIndices32, idxCount, vertexCount);
+	if (indexType==asset::EIT_16BIT)
+		optimizeIndices(reinterpret_cast<uint16_t*>(outIndices),reinterpret_cast<const uint16_t*>(srcIndices),idxCount,vertexPositions.data(),vertexCount,_threshold);
+	else
+		optimizeIndices(reinterpret_cast<uint32_t*>(outIndices),reinterpret_cast<const uint32_t*>(srcIndices),idxCount,vertexPositions.data(),vertexCount,_threshold);
+
+	if (indexCopy)
+		_NBL_ALIGNED_FREE(indexCopy);
+}
+
+template<typename IdxT>
+void COverdrawMeshOptimizer::optimizeIndices(IdxT* _outIndices, const IdxT* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, size_t _vtxCount, float _threshold)
+{
+	if (_idxCount<3u)
+	{
+		memcpy(_outIndices,_indices,_idxCount*sizeof(IdxT));
+		return;
+	}
 
-	uint32_t* const softClusters = reinterpret_cast<uint32_t*>(_NBL_ALIGNED_MALLOC((idxCount/3+1)*sizeof(uint32_t),_NBL_SIMD_ALIGNMENT));
-	const size_t softClusterCount = indexType == asset::EIT_16BIT ?
-		genSoftBoundaries(softClusters, inIndices16, idxCount, vertexCount, hardClusters, hardClusterCount, _threshold) :
-		genSoftBoundaries(softClusters, inIndices32, idxCount, vertexCount, hardClusters, hardClusterCount, _threshold);
+	uint32_t* const hardClusters = reinterpret_cast<uint32_t*>(_NBL_ALIGNED_MALLOC((_idxCount/3)*sizeof(uint32_t),_NBL_SIMD_ALIGNMENT));
+	const size_t hardClusterCount = genHardBoundaries(hardClusters, _indices, _idxCount, _vtxCount);
+
+	uint32_t* const softClusters = reinterpret_cast<uint32_t*>(_NBL_ALIGNED_MALLOC((_idxCount/3+1)*sizeof(uint32_t),_NBL_SIMD_ALIGNMENT));
+	const size_t softClusterCount = genSoftBoundaries(softClusters, _indices, _idxCount, _vtxCount, hardClusters, hardClusterCount, _threshold);
 
 	ClusterSortData* sortedData = (ClusterSortData*)_NBL_ALIGNED_MALLOC(softClusterCount*sizeof(ClusterSortData),_NBL_SIMD_ALIGNMENT);
-	if (indexType == asset::EIT_16BIT)
-		calcSortData(sortedData, inIndices16, idxCount, vertexPositions, softClusters, softClusterCount);
-	else
-		calcSortData(sortedData, inIndices32, idxCount, vertexPositions, softClusters, softClusterCount);
+	calcSortData(sortedData, _indices, _idxCount, _positions, softClusters, softClusterCount);
 
 	std::stable_sort(sortedData, sortedData+softClusterCount, std::greater<ClusterSortData>()); // TODO: use core::radix_sort
 
-	auto reorderIndices = [&](auto* out, const auto* in)
+	for (size_t it = 0, jt = 0; it < softClusterCount; ++it)
 	{
-		for (size_t it = 0, jt = 0; it < softClusterCount; ++it)
-		{
-			const uint32_t cluster = sortedData[it].cluster;
+		const uint32_t cluster = sortedData[it].cluster;
 
-			size_t start = softClusters[cluster];
-			size_t end = (cluster+1<softClusterCount) ? softClusters[cluster+1]:idxCount/3;
+		size_t start = softClusters[cluster];
+		size_t end = (cluster+1<softClusterCount) ? softClusters[cluster+1]:_idxCount/3;
 
-			for (size_t i = start; i < end; ++i)
-			{
-				out[jt++] = in[3 * i + 0];
-				out[jt++] = in[3 * i + 1];
-				out[jt++] = in[3 * i + 2];
-			}
+		for (size_t i = start; i < end; ++i)
+		{
+			_outIndices[jt++] = _indices[3 * i + 0];
+			_outIndices[jt++] = _indices[3 * i + 1];
+			_outIndices[jt++] = _indices[3 * i + 2];
 		}
-	};
-	if (indexType==asset::EIT_16BIT)
-		reorderIndices(outIndices16,inIndices16);
-	else
-		reorderIndices(outIndices32,inIndices32);
+	}
 
-	if (indexCopy)
-		_NBL_ALIGNED_FREE(indexCopy);
 	_NBL_ALIGNED_FREE(hardClusters);
 	_NBL_ALIGNED_FREE(softClusters);
 	_NBL_ALIGNED_FREE(sortedData);
 }
+template void COverdrawMeshOptimizer::optimizeIndices<uint16_t>(uint16_t*, const uint16_t*, size_t, const core::vectorSIMDf*, size_t, float);
+template void COverdrawMeshOptimizer::optimizeIndices<uint32_t>(uint32_t*, const uint32_t*, size_t, const core::vectorSIMDf*, size_t, float);
 
 template<typename IdxT>
 size_t COverdrawMeshOptimizer::genHardBoundaries(uint32_t* _dst, const IdxT* _indices, size_t _idxCount, size_t _vtxCount)
@@ -207,7 +207,7 @@ size_t COverdrawMeshOptimizer::genSoftBoundaries(uint32_t* _dst, const IdxT* _in
 }
 
 template<typename IdxT>
-void COverdrawMeshOptimizer::calcSortData(ClusterSortData* _dst, const IdxT* _indices, size_t _idxCount, const core::vector<core::vectorSIMDf>& _positions, const uint32_t* _clusters, size_t _clusterCount)
+void COverdrawMeshOptimizer::calcSortData(ClusterSortData* _dst, const IdxT* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, const uint32_t* _clusters, size_t _clusterCount)
 {
 	core::vectorSIMDf meshCentroid;
 	for (size_t i = 0u; i < _idxCount; ++i)
@@ -42,6 +42,18 @@ class COverdrawMeshOptimizer
 		*/
 		static void createOptimized(asset::ICPUMeshBuffer* _outbuffer, const asset::ICPUMeshBuffer* _inbuffer, float _threshold = 1.05f);
 
+		//! Same as `createOptimized` but operates on raw index and position arrays, so it can be run on sub-ranges (clusters) of a mesh.
+		/**
+		@param _outIndices Output index array, cannot alias `_indices`.
+		@param _indices Input triangle list index array.
+		@param _idxCount Number of indices, must be a multiple of 3.
+		@param _positions Positions of the vertices indexed by `_indices`.
+		@param _vtxCount Upper bound of the vertex IDs in `_indices`.
+		@param _threshold @copydoc createOptimized
+		*/
+		template<typename IdxT>
+		static void optimizeIndices(IdxT* _outIndices, const IdxT* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, size_t _vtxCount, float _threshold = 1.05f);
+
 	private:
 		template<typename IdxT>
 		static size_t genHardBoundaries(uint32_t* _dst, const IdxT* _indices, size_t _idxCount, size_t _vtxCount);
@@ -49,7 +61,7 @@ class COverdrawMeshOptimizer
 		static size_t genSoftBoundaries(uint32_t* _dst, const IdxT* _indices, size_t _idxCount, size_t _vtxCount, const uint32_t* _clusters, size_t _clusterCount, float _threshold);
 
 		template<typename IdxT>
-		static void calcSortData(ClusterSortData* _dst, const IdxT* _indices, size_t _idxCount, const core::vector<core::vectorSIMDf>& _positions, const uint32_t* _clusters, size_t _clusterCount);
+		static void calcSortData(ClusterSortData* _dst, const IdxT* _indices, size_t _idxCount, const core::vectorSIMDf* _positions, const uint32_t* _clusters, size_t _clusterCount);
 
 		static size_t updateCache(uint32_t _a, uint32_t _b, uint32_t _c, size_t* _cacheTimestamps, size_t& _timestamp);
 };
@@ -0,0 +1,661 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include <algorithm>
+#include <numeric>
+#include <execution>
+
+#include "os.h"
+
+#include "nbl/asset/utils/CQuadricMeshSimplifier.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+CQuadricMeshSimplifier::SQuadric CQuadricMeshSimplifier::SQuadric::fromPlane(const core::vectorSIMDf& n, float d, float weight)
+{
+	SQuadric q;
+	q.a00 = n.x*n.x*weight;
+	q.a11 = n.y*n.y*weight;
+	q.a22 = n.z*n.z*weight;
+	q.a10 = n.y*n.x*weight;
+	q.a20 = n.z*n.x*weight;
+	q.a21 = n.z*n.y*weight;
+	q.b0 = n.x*d*weight;
+	q.b1 = n.y*d*weight;
+	q.b2 = n.z*d*weight;
+	q.c = d*d*weight;
+	q.w = weight;
+	return q;
+}
+
+CQuadricMeshSimplifier::SQuadric CQuadricMeshSimplifier::SQuadric::fromTriangle(const core::vectorSIMDf& p0, const core::vectorSIMDf& p1, const core::vectorSIMDf& p2)
+{
+	core::vectorSIMDf normal = core::cross(p1-p0,p2-p0);
+	const float area = core::length(normal)[0];
+	if (area>0.f)
+		normal /= area;
+	return fromPlane(normal,-core::dot(normal,p0)[0],area);
+}
+
+CQuadricMeshSimplifier::SQuadric CQuadricMeshSimplifier::SQuadric::fromBoundaryEdge(const core::vectorSIMDf& p0, const core::vectorSIMDf& p1, const core::vectorSIMDf& p2)
+{
+	core::vectorSIMDf edge = p1-p0;
+	const float length = core::length(edge)[0];
+	if (length>0.f)
+		edge /= length;
+	const core::vectorSIMDf p20 = p2-p0;
+	core::vectorSIMDf normal = p20-edge*core::dot(p20,edge)[0];
+	const float normalLength = core::length(normal)[0];
+	if (normalLength>0.f)
+		normal /= normalLength;
+	return fromPlane(normal,-core::dot(normal,p0)[0],length*length*BOUNDARY_WEIGHT);
+}
+
+CQuadricMeshSimplifier::SQuadric& CQuadricMeshSimplifier::SQuadric::operator+=(const SQuadric& other)
+{
+	a00 += other.a00;
+	a11 += other.a11;
+	a22 += other.a22;
+	a10 += other.a10;
+	a20 += other.a20;
+	a21 += other.a21;
+	b0 += other.b0;
+	b1 += other.b1;
+	b2 += other.b2;
+	c += other.c;
+	w += other.w;
+	return *this;
+}
+
+float CQuadricMeshSimplifier::SQuadric::error(const core::vectorSIMDf& p) const
+{
+	const float rx = a00*p.x+a10*p.y+a20*p.z;
+	const float ry = a10*p.x+a11*p.y+a21*p.z;
+	const float rz = a20*p.x+a21*p.y+a22*p.z;
+	const float r = rx*p.x+ry*p.y+rz*p.z+2.f*(b0*p.x+b1*p.y+b2*p.z)+c;
+	return w>0.f ? std::abs(r)/w:std::abs(r);
+}
+
+void CQuadricMeshSimplifier::SAdjacency::build(const core::vector<uint32_t>& _indices, uint32_t _vertexCount)
+{
+	offsets.assign(_vertexCount+1u,0u);
+	for (const uint32_t ix : _indices)
+		offsets[ix+1u]++;
+	std::inclusive_scan(offsets.begin(),offsets.end(),offsets.begin());
+
+	edges.resize(_indices.size());
+	core::vector<uint32_t> fill(offsets.begin(),offsets.end()-1u);
+	for (size_t i=0u; i<_indices.size(); i+=3u)
+	{
+		const uint32_t* tri = _indices.data()+i;
+		for (uint32_t k=0u; k<3u; k++)
+			edges[fill[tri[k]]++] = {tri[(k+1u)%3u],tri[(k+2u)%3u]};
+	}
+}
+
+bool CQuadricMeshSimplifier::SAdjacency::hasEdge(uint32_t _from, uint32_t _to) const
+{
+	for (uint32_t i=offsets[_from]; i<offsets[_from+1u]; i++)
+	if (edges[i].next==_to)
+		return true;
+	return false;
+}
+
+void CQuadricMeshSimplifier::weld(const ICPUMeshBuffer* _meshbuffer, const IMeshManipulator::SErrorMetric* _errMetrics, const core::vector<uint32_t>& _rawIndices, SState& _state)
+{
+	const auto& positions = _state.positions;
+	const uint32_t vertexCount = positions.size();
+
+	// group the vertices by position
+	core::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(),order.end(),0u);
+	std::sort(std::execution::par_unseq,order.begin(),order.end(),[&positions](uint32_t lhs, uint32_t rhs) -> bool
+	{
+		const auto& a = positions[lhs];
+		const auto& b = positions[rhs];
+		if (a.x!=b.x)
+			return a.x<b.x;
+		if (a.y!=b.y)
+			return a.y<b.y;
+		return a.z<b.z;
+	});
+	core::vector<uint32_t> groupBegin;
+	_state.positionGroup.resize(vertexCount);
+	for (uint32_t i=0u; i<vertexCount; i++)
+	{
+		if (i==0u)
+			groupBegin.push_back(i);
+		else
+		{
+			const auto& a = positions[order[i]];
+			const auto& b = positions[order[i-1u]];
+			if (a.x!=b.x || a.y!=b.y || a.z!=b.z)
+				groupBegin.push_back(i);
+		}
+		_state.positionGroup[order[i]] = groupBegin.size()-1u;
+	}
+	const uint32_t groupCount = groupBegin.size();
+	groupBegin.push_back(vertexCount);
+
+	// only per vertex attributes can form seams
+	core::vector<uint32_t> attributes;
+	{
+		const auto& vtxParams = _meshbuffer->getPipeline()->getVertexInputParams();
+		for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; i++)
+		if (i!=_meshbuffer->getPositionAttributeIx() && _meshbuffer->isAttributeEnabled(i) && vtxParams.bindings[vtxParams.attributes[i].binding].inputRate==EVIR_PER_VERTEX)
+			attributes.push_back(i);
+	}
+	auto sameAttributes = [&](uint32_t a, uint32_t b) -> bool
+	{
+		for (const uint32_t attr : attributes)
+		{
+			const E_FORMAT format = _meshbuffer->getAttribFormat(attr);
+			const uint32_t cpa = getFormatChannelCount(format);
+			if (isIntegerFormat(format) || isScaledFormat(format))
+			{
+				uint32_t values[8];
+				_meshbuffer->getAttribute(values,attr,a);
+				_meshbuffer->getAttribute(values+4,attr,b);
+				if (memcmp(values,values+4,cpa*sizeof(uint32_t)))
+					return false;
+			}
+			else
+			{
+				core::vectorSIMDf values[2];
+				_meshbuffer->getAttribute(values[0],attr,a);
+				_meshbuffer->getAttribute(values[1],attr,b);
+				if (!IMeshManipulator::compareFloatingPointAttribute(values[0],values[1],cpa,_errMetrics[attr]))
+					return false;
+			}
+		}
+		return true;
+	};
+
+	// weld within every group, vertices with different attributes stay apart
+	core::vector<uint32_t> welded(vertexCount);
+	core::vector<uint32_t> groups(groupCount);
+	std::iota(groups.begin(),groups.end(),0u);
+	std::for_each(std::execution::par,groups.begin(),groups.end(),[&](const uint32_t group)
+	{
+		core::vector<uint32_t> representatives;
+		for (uint32_t i=groupBegin[group]; i<groupBegin[group+1u]; i++)
+		{
+			const uint32_t vertex = order[i];
+			welded[vertex] = vertex;
+			for (const uint32_t rep : representatives)
+			if (sameAttributes(vertex,rep))
+			{
+				welded[vertex] = rep;
+				break;
+			}
+			if (welded[vertex]==vertex)
+				representatives.push_back(vertex);
+		}
+	});
+
+	_state.indices.clear();
+	_state.indices.reserve(_rawIndices.size());
+	for (size_t i=0u; i<_rawIndices.size(); i+=3u)
+	{
+		const uint32_t a = welded[_rawIndices[i+0u]];
+		const uint32_t b = welded[_rawIndices[i+1u]];
+		const uint32_t c = welded[_rawIndices[i+2u]];
+		const auto& group = _state.positionGroup;
+		if (group[a]==group[b] || group[b]==group[c] || group[c]==group[a])
+			continue;
+		_state.indices.push_back(a);
+		_state.indices.push_back(b);
+		_state.indices.push_back(c);
+	}
+
+	// link up the vertices which are still used at every position
+	core::vector<uint8_t> referenced(vertexCount,0u);
+	for (const uint32_t ix : _state.indices)
+		referenced[ix] = 1u;
+	_state.wedge.resize(vertexCount);
+	std::for_each(std::execution::par,groups.begin(),groups.end(),[&](const uint32_t group)
+	{
+		uint32_t first = INVALID;
+		uint32_t last = INVALID;
+		for (uint32_t i=groupBegin[group]; i<groupBegin[group+1u]; i++)
+		{
+			const uint32_t vertex = order[i];
+			_state.wedge[vertex] = vertex;
+			if (!referenced[vertex])
+				continue;
+			if (last!=INVALID)
+				_state.wedge[last] = vertex;
+			else
+				first = vertex;
+			last = vertex;
+		}
+		if (last!=INVALID)
+			_state.wedge[last] = first;
+	});
+	_state.quadrics.resize(groupCount);
+}
+
+void CQuadricMeshSimplifier::classify(const SAdjacency& _adjacency, bool _lockBorders, SState& _state)
+{
+	const uint32_t vertexCount = _state.positions.size();
+	core::vector<uint32_t> openOut(vertexCount,0u), openIn(vertexCount,0u);
+	_state.loop.assign(vertexCount,INVALID);
+	_state.loopback.assign(vertexCount,INVALID);
+	for (uint32_t v=0u; v<vertexCount; v++)
+	for (uint32_t i=_adjacency.offsets[v]; i<_adjacency.offsets[v+1u]; i++)
+	{
+		const uint32_t target = _adjacency.edges[i].next;
+		if (_adjacency.hasEdge(target,v))
+			continue;
+		openOut[v]++;
+		openIn[target]++;
+		_state.loop[v] = target;
+		_state.loopback[target] = v;
+	}
+
+	const auto& group = _state.positionGroup;
+	_state.kind.resize(vertexCount);
+	for (uint32_t v=0u; v<vertexCount; v++)
+	{
+		const uint32_t w = _state.wedge[v];
+		auto& kind = _state.kind[v];
+		if (openOut[v]==0u && openIn[v]==0u)
+			kind = w==v ? EVK_MANIFOLD:EVK_LOCKED;
+		else if (openOut[v]==1u && openIn[v]==1u)
+		{
+			if (w==v)
+				kind = _lockBorders ? EVK_LOCKED:EVK_BORDER;
+			// exactly two sides whose open edges run along each other in opposite directions
+			else if (_state.wedge[w]==v && openOut[w]==1u && openIn[w]==1u &&
+				group[_state.loop[v]]==group[_state.loopback[w]] && group[_state.loopback[v]]==group[_state.loop[w]])
+				kind = EVK_SEAM;
+			else
+				kind = EVK_LOCKED;
+		}
+		else
+			kind = EVK_LOCKED;
+	}
+}
+
+void CQuadricMeshSimplifier::computeQuadrics(const SAdjacency& _adjacency, SState& _state)
+{
+	const uint32_t vertexCount = _state.positions.size();
+	const auto& positions = _state.positions;
+
+	// every vertex gathers the quadrics of its own triangles and open edges, so no two threads write the same one
+	core::vector<SQuadric> vertexQuadrics(vertexCount);
+	core::vector<uint32_t> vertices(vertexCount);
+	std::iota(vertices.begin(),vertices.end(),0u);
+	std::for_each(std::execution::par,vertices.begin(),vertices.end(),[&](const uint32_t v)
+	{
+		SQuadric& q = vertexQuadrics[v];
+		for (uint32_t i=_adjacency.offsets[v]; i<_adjacency.offsets[v+1u]; i++)
+		{
+			const uint32_t b = _adjacency.edges[i].next;
+			const uint32_t c = _adjacency.edges[i].prev;
+			q += SQuadric::fromTriangle(positions[v],positions[b],positions[c]);
+			if (!_adjacency.hasEdge(b,v))
+				q += SQuadric::fromBoundaryEdge(positions[v],positions[b],positions[c]);
+			if (!_adjacency.hasEdge(v,c))
+				q += SQuadric::fromBoundaryEdge(positions[c],positions[v],positions[b]);
+		}
+	});
+
+	// the quadrics are per position, so the sides of a seam move the same
+	core::vector<uint32_t> groupVertex(_state.quadrics.size(),INVALID);
+	for (uint32_t v=0u; v<vertexCount; v++)
+	if (_adjacency.offsets[v+1u]!=_adjacency.offsets[v] && groupVertex[_state.positionGroup[v]]==INVALID)
+		groupVertex[_state.positionGroup[v]] = v;
+	std::for_each(std::execution::par,groupVertex.begin(),groupVertex.end(),[&](const uint32_t first)
+	{
+		if (first==INVALID)
+			return;
+		SQuadric& q = _state.quadrics[_state.positionGroup[first]];
+		q = SQuadric();
+		uint32_t v = first;
+		do
+		{
+			q += vertexQuadrics[v];
+			v = _state.wedge[v];
+		} while (v!=first);
+	});
+}
+
+uint32_t CQuadricMeshSimplifier::getSeamTarget(const SState& _state, uint32_t _wedge, uint32_t _target)
+{
+	const uint32_t group = _state.positionGroup[_target];
+	if (_state.loop[_wedge]!=INVALID && _state.positionGroup[_state.loop[_wedge]]==group)
+		return _state.loop[_wedge];
+	if (_state.loopback[_wedge]!=INVALID && _state.positionGroup[_state.loopback[_wedge]]==group)
+		return _state.loopback[_wedge];
+	return INVALID;
+}
+
+bool CQuadricMeshSimplifier::canCollapse(const SState& _state, uint32_t _from, uint32_t _to)
+{
+	switch (_state.kind[_from])
+	{
+		case EVK_MANIFOLD:
+			return true;
+		case EVK_BORDER:
+			return _state.loop[_from]==_to || _state.loopback[_from]==_to;
+		case EVK_SEAM:
+			return (_state.loop[_from]==_to || _state.loopback[_from]==_to) && getSeamTarget(_state,_state.wedge[_from],_to)!=INVALID;
+		default:
+			return false;
+	}
+}
+
+bool CQuadricMeshSimplifier::hasTriangleFlips(const SState& _state, const SAdjacency& _adjacency, uint32_t _from, uint32_t _to)
+{
+	const auto& positions = _state.positions;
+	const uint32_t toGroup = _state.positionGroup[_to];
+	for (uint32_t i=_adjacency.offsets[_from]; i<_adjacency.offsets[_from+1u]; i++)
+	{
+		const uint32_t b = _adjacency.edges[i].next;
+		const uint32_t c = _adjacency.edges[i].prev;
+		// these disappear with the collapse
+		if (_state.positionGroup[b]==toGroup || _state.positionGroup[c]==toGroup)
+			continue;
+		const core::vectorSIMDf before = core::cross(positions[b]-positions[_from],positions[c]-positions[_from]);
+		const core::vectorSIMDf after = core::cross(positions[b]-positions[_to],positions[c]-positions[_to]);
+		if (core::dot(before,after)[0]<=0.f && core::dot(before,before)[0]>0.f)
+			return true;
+	}
+	return false;
+}
+
+float CQuadricMeshSimplifier::simplify(SState& _state, uint32_t _targetTriangles, float _maxError)
+{
+	const uint32_t vertexCount = _state.positions.size();
+	const auto& group = _state.positionGroup;
+	auto& indices = _state.indices;
+
+	float retval = 0.f;
+	SAdjacency adjacency;
+	core::vector<SCollapse> candidates;
+	core::vector<uint32_t> collapseRemap(vertexCount);
+	std::iota(collapseRemap.begin(),collapseRemap.end(),0u);
+	core::vector<uint32_t> collapsed;
+	core::vector<uint32_t> oldLoop;
+	core::vector<uint8_t> touched(_state.quadrics.size());
+	while (indices.size()/3u>_targetTriangles)
+	{
+		const uint32_t triangleCount = indices.size()/3u;
+		adjacency.build(indices,vertexCount);
+
+		// every edge gets costed once, by its half-edge going to the higher vertex or by its only half-edge
+		candidates.resize(indices.size());
+		std::for_each(std::execution::par,candidates.begin(),candidates.end(),[&](SCollapse& candidate)
+		{
+			const size_t corner = std::distance(candidates.data(),&candidate);
+			const uint32_t a = indices[corner];
+			const uint32_t b = indices[corner-corner%3u+(corner+1u)%3u];
+			candidate = {INVALID,INVALID,FLT_MAX};
+			if (a>b && adjacency.hasEdge(b,a))
+				return;
+			const float errorAB = canCollapse(_state,a,b) ? _state.quadrics[group[a]].error(_state.positions[b]):FLT_MAX;
+			const float errorBA = canCollapse(_state,b,a) ? _state.quadrics[group[b]].error(_state.positions[a]):FLT_MAX;
+			if (errorAB<=errorBA && errorAB<FLT_MAX)
+				candidate = {a,b,errorAB};
+			else if (errorBA<FLT_MAX)
+				candidate = {b,a,errorBA};
+		});
+		candidates.erase(std::remove_if(candidates.begin(),candidates.end(),[](const SCollapse& candidate) -> bool {return candidate.from==INVALID;}),candidates.end());
+		if (candidates.empty())
+			break;
+		std::sort(std::execution::par_unseq,candidates.begin(),candidates.end(),[](const SCollapse& lhs, const SCollapse& rhs) -> bool {return lhs.error<rhs.error;});
+
+		// a collapse takes out two triangles, don't go much past the error of the ones which would reach the target
+		const uint32_t trianglesToRemove = triangleCount-_targetTriangles;
+		const size_t goal = core::min<size_t>(trianglesToRemove/2u+1u,candidates.size());
+		const float errorLimit = core::min(_maxError,candidates[goal-1u].error*1.5f);
+
+		std::fill(touched.begin(),touched.end(),0u);
+		uint32_t removed = 0u;
+		for (const auto& candidate : candidates)
+		{
+			if (candidate.error>errorLimit || removed>=trianglesToRemove)
+				break;
+			const uint32_t fromGroup = group[candidate.from];
+			const uint32_t toGroup = group[candidate.to];
+			if (touched[fromGroup] || touched[toGroup])
+				continue;
+
+			uint32_t seamFrom = INVALID, seamTo = INVALID;
+			if (_state.kind[candidate.from]==EVK_SEAM)
+			{
+				seamFrom = _state.wedge[candidate.from];
+				seamTo = getSeamTarget(_state,seamFrom,candidate.to);
+				if (seamTo==INVALID)
+					continue;
+			}
+			if (hasTriangleFlips(_state,adjacency,candidate.from,candidate.to) || seamFrom!=INVALID && hasTriangleFlips(_state,adjacency,seamFrom,seamTo))
+				continue;
+
+			collapseRemap[candidate.from] = candidate.to;
+			collapsed.push_back(candidate.from);
+			if (seamFrom!=INVALID)
+			{
+				collapseRemap[seamFrom] = seamTo;
+				collapsed.push_back(seamFrom);
+			}
+			_state.quadrics[toGroup] += _state.quadrics[fromGroup];
+			touched[fromGroup] = touched[toGroup] = 1u;
+			retval = core::max(retval,candidate.error);
+			removed += _state.kind[candidate.from]==EVK_BORDER ? 1u:2u;
+		}
+		if (collapsed.empty())
+			break;
+
+		// boundary loops skip over the collapsed vertices, adjacent ones can collapse in the same pass so follow the loops as they were before it
+		auto remapLoop = [&](core::vector<uint32_t>& loop) -> void
+		{
+			oldLoop = loop;
+			for (uint32_t v=0u; v<vertexCount; v++)
+			if (loop[v]!=INVALID)
+			{
+				uint32_t next = oldLoop[v];
+				for (uint32_t r; next!=INVALID && (r=collapseRemap[next])!=next;)
+				{
+					// the loop edge itself got collapsed onto this vertex
+					next = v==r ? oldLoop[next]:r;
+				}
+				loop[v] = next;
+			}
+		};
+		remapLoop(_state.loop);
+		remapLoop(_state.loopback);
+
+		size_t outIx = 0u;
+		for (size_t i=0u; i<indices.size(); i+=3u)
+		{
+			const uint32_t a = collapseRemap[indices[i+0u]];
+			const uint32_t b = collapseRemap[indices[i+1u]];
+			const uint32_t c = collapseRemap[indices[i+2u]];
+			if (group[a]==group[b] || group[b]==group[c] || group[c]==group[a])
+				continue;
+			indices[outIx++] = a;
+			indices[outIx++] = b;
+			indices[outIx++] = c;
+		}
+		indices.resize(outIx);
+
+		for (const uint32_t v : collapsed)
+			collapseRemap[v] = v;
+		collapsed.clear();
+	}
+	return retval;
+}
+
+core::smart_refctd_ptr<ICPUMeshBuffer> CQuadricMeshSimplifier::createLoDMeshBuffer(const ICPUMeshBuffer* _meshbuffer, const core::vector<uint32_t>& _indices, bool _shareVertexBuffers)
+{
+	auto out = core::move_and_static_cast<ICPUMeshBuffer>(_meshbuffer->clone(0u));
+	if (_meshbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType!=EPT_TRIANGLE_LIST)
+	{
+		auto pipeline = core::move_and_static_cast<ICPURenderpassIndependentPipeline>(_meshbuffer->getPipeline()->clone(0u));
+		pipeline->getPrimitiveAssemblyParams().primitiveType = EPT_TRIANGLE_LIST;
+		out->setPipeline(std::move(pipeline));
+	}
+
+	const core::vector<uint32_t>* indices = &_indices;
+	core::vector<uint32_t> compactIndices;
+	if (!_shareVertexBuffers)
+	{
+		// new vertex numbering in order of first use
+		const uint32_t upperBound = *std::max_element(_indices.begin(),_indices.end())+1u;
+		core::vector<uint32_t> remap(upperBound,INVALID);
+		core::vector<uint32_t> oldVertex;
+		compactIndices.resize(_indices.size());
+		for (size_t i=0u; i<_indices.size(); i++)
+		{
+			uint32_t& newVertex = remap[_indices[i]];
+			if (newVertex==INVALID)
+			{
+				newVertex = oldVertex.size();
+				oldVertex.push_back(_indices[i]);
+			}
+			compactIndices[i] = newVertex;
+		}
+		indices = &compactIndices;
+
+		const auto& vtxParams = _meshbuffer->getPipeline()->getVertexInputParams();
+		bool bindingDone[ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT] = {};
+		for (uint32_t attr=0u; attr<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; attr++)
+		{
+			if (!_meshbuffer->isAttributeEnabled(attr))
+				continue;
+			const uint32_t binding = vtxParams.attributes[attr].binding;
+			const uint32_t stride = vtxParams.bindings[binding].stride;
+			const auto& inBinding = _meshbuffer->getVertexBufferBindings()[binding];
+			if (bindingDone[binding] || vtxParams.bindings[binding].inputRate!=EVIR_PER_VERTEX || !stride || !inBinding.buffer)
+				continue;
+			bindingDone[binding] = true;
+
+			auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(oldVertex.size())*stride);
+			const uint8_t* in = reinterpret_cast<const uint8_t*>(inBinding.buffer->getPointer())+inBinding.offset+int64_t(_meshbuffer->getBaseVertex())*stride;
+			uint8_t* const outPtr = reinterpret_cast<uint8_t*>(buffer->getPointer());
+			std::for_each(std::execution::par_unseq,oldVertex.begin(),oldVertex.end(),[&](const uint32_t& vertex)
+			{
+				memcpy(outPtr+std::distance<const uint32_t*>(oldVertex.data(),&vertex)*stride,in+size_t(vertex)*stride,stride);
+			});
+			out->setVertexBufferBinding({0ull,std::move(buffer)},binding);
+		}
+		out->setBaseVertex(0);
+	}
+
+	const uint32_t maxIndex = *std::max_element(indices->begin(),indices->end());
+	core::smart_refctd_ptr<ICPUBuffer> indexBuffer;
+	if (maxIndex<0xffffu)
+	{
+		indexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(indices->size()*sizeof(uint16_t));
+		std::copy(indices->begin(),indices->end(),reinterpret_cast<uint16_t*>(indexBuffer->getPointer()));
+		out->setIndexType(EIT_16BIT);
+	}
+	else
+	{
+		indexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(indices->size()*sizeof(uint32_t));
+		std::copy(indices->begin(),indices->end(),reinterpret_cast<uint32_t*>(indexBuffer->getPointer()));
+		out->setIndexType(EIT_32BIT);
+	}
+	out->setIndexBufferBinding({0ull,std::move(indexBuffer)});
+	out->setIndexCount(indices->size());
+	// the joint AABBs would get written into the shared skin buffers, the input's bounds still hold
+	if (!out->isSkinned())
+		out->setBoundingBox(IMeshManipulator::calculateBoundingBox(out.get()));
+	return out;
+}
+
+core::vector<IMeshManipulator::SLoD> CQuadricMeshSimplifier::createLoDChain(const ICPUMeshBuffer* _meshbuffer, const IMeshManipulator::SLoDChainParams& _params)
+{
+	core::vector<IMeshManipulator::SLoD> retval;
+	if (!_meshbuffer || !_meshbuffer->getPipeline())
+		return retval;
+
+	const E_PRIMITIVE_TOPOLOGY primitiveType = _meshbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType;
+	uint32_t triangleCount = 0u;
+	if ((primitiveType!=EPT_TRIANGLE_LIST && primitiveType!=EPT_TRIANGLE_STRIP && primitiveType!=EPT_TRIANGLE_FAN) || !IMeshManipulator::getPolyCount(triangleCount,_meshbuffer) || !triangleCount)
+	{
+#ifdef _NBL_DEBUG
+		os::Printer::log("LoD chain generation: not a triangle mesh -- no levels created.");
+#endif
+		return retval;
+	}
+
+	IMeshManipulator::SErrorMetric defaultErrMetrics[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT];
+	const IMeshManipulator::SErrorMetric* errMetrics = _params.errorMetrics ? _params.errorMetrics:defaultErrMetrics;
+
+	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_meshbuffer);
+	SState state;
+	state.positions.resize(vertexCount);
+	const uint32_t posAttr = _meshbuffer->getPositionAttributeIx();
+	std::for_each(std::execution::par_unseq,state.positions.begin(),state.positions.end(),[&](core::vectorSIMDf& pos)
+	{
+		_meshbuffer->getAttribute(pos,posAttr,std::distance(state.positions.data(),&pos));
+		pos.w = 0.f;
+	});
+	core::vector<uint32_t> rawIndices(size_t(triangleCount)*3u);
+	{
+		core::vector<uint32_t> triangles(triangleCount);
+		std::iota(triangles.begin(),triangles.end(),0u);
+		std::for_each(std::execution::par_unseq,triangles.begin(),triangles.end(),[&](const uint32_t triangle)
+		{
+			const auto tri = IMeshManipulator::getTriangleIndices(_meshbuffer,triangle);
+			std::copy(tri.begin(),tri.end(),rawIndices.data()+triangle*3u);
+		});
+	}
+
+	// quadrics are much better conditioned in a unit cube
+	float scale = 1.f;
+	{
+		core::vectorSIMDf boundsMin(FLT_MAX),boundsMax(-FLT_MAX);
+		for (const auto& pos : state.positions)
+		{
+			boundsMin = core::min(boundsMin,pos);
+			boundsMax = core::max(boundsMax,pos);
+		}
+		const core::vectorSIMDf extent = boundsMax-boundsMin;
+		const float maxExtent = core::max(core::max(extent.x,extent.y),extent.z);
+		if (maxExtent>0.f)
+			scale = 1.f/maxExtent;
+		boundsMin.w = 0.f;
+		std::for_each(std::execution::par_unseq,state.positions.begin(),state.positions.end(),[&](core::vectorSIMDf& pos) {pos = (pos-boundsMin)*scale;});
+	}
+
+	weld(_meshbuffer,errMetrics,rawIndices,state);
+	{
+		SAdjacency adjacency;
+		adjacency.build(state.indices,vertexCount);
+		classify(adjacency,_params.lockBorders,state);
+		computeQuadrics(adjacency,state);
+	}
+
+	// the quadrics measure squared distances
+	const float maxError = _params.maxError*scale;
+	const float maxErrorSquared = maxError<std::sqrt(FLT_MAX) ? maxError*maxError:FLT_MAX;
+	float error = 0.f;
+	uint32_t prevTriangleCount = state.indices.size()/3u;
+	for (const float ratio : _params.triangleRatios)
+	{
+		const uint32_t target = static_cast<uint32_t>(double(triangleCount)*core::clamp(ratio,0.f,1.f));
+		error = core::max(error,simplify(state,target,maxErrorSquared));
+
+		const uint32_t levelTriangleCount = state.indices.size()/3u;
+		if (levelTriangleCount==0u || levelTriangleCount>=prevTriangleCount)
+			break;
+		prevTriangleCount = levelTriangleCount;
+
+		auto& lod = retval.emplace_back();
+		lod.meshbuffer = createLoDMeshBuffer(_meshbuffer,state.indices,_params.shareVertexBuffers);
+		lod.error = std::sqrt(error)/scale;
+		lod.triangleCount = levelTriangleCount;
+	}
+	return retval;
+}
+
+}
+}
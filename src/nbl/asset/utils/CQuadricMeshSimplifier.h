@@ -0,0 +1,121 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_QUADRIC_MESH_SIMPLIFIER_H_INCLUDED__
+#define __NBL_ASSET_C_QUADRIC_MESH_SIMPLIFIER_H_INCLUDED__
+
+#include "nbl/asset/ICPUMeshBuffer.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Edge collapse simplification driven by Garland-Heckbert quadrics, with the vertex classification and seam handling of zeux's meshoptimizer.
+/** Collapses only ever move a vertex onto a neighbouring one, so the levels can keep indexing the input's vertices.
+*/
+class CQuadricMeshSimplifier
+{
+		// private, undefined constructor
+		CQuadricMeshSimplifier() = delete;
+
+	public:
+		//! @copydoc IMeshManipulator::createLoDChain(const ICPUMeshBuffer*, const IMeshManipulator::SLoDChainParams&)
+		static core::vector<IMeshManipulator::SLoD> createLoDChain(const ICPUMeshBuffer* _meshbuffer, const IMeshManipulator::SLoDChainParams& _params);
+
+	private:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t INVALID = ~0u;
+		//! how much more than the surface the boundary and seam edges weigh in the quadrics
+		_NBL_STATIC_INLINE_CONSTEXPR float BOUNDARY_WEIGHT = 10.f;
+
+		enum E_VERTEX_KIND : uint8_t
+		{
+			//! can collapse onto any neighbour
+			EVK_MANIFOLD,
+			//! on an open boundary, can only collapse along it
+			EVK_BORDER,
+			//! one of exactly two vertices at the same position, can only collapse along the seam together with its counterpart
+			EVK_SEAM,
+			//! never moves
+			EVK_LOCKED
+		};
+
+		struct SQuadric
+		{
+			float a00 = 0.f, a11 = 0.f, a22 = 0.f;
+			float a10 = 0.f, a20 = 0.f, a21 = 0.f;
+			float b0 = 0.f, b1 = 0.f, b2 = 0.f;
+			float c = 0.f;
+			float w = 0.f;
+
+			//! plane `n.p+d=0` with a normalized `n`
+			static SQuadric fromPlane(const core::vectorSIMDf& n, float d, float weight);
+			static SQuadric fromTriangle(const core::vectorSIMDf& p0, const core::vectorSIMDf& p1, const core::vectorSIMDf& p2);
+			//! plane through the edge `p0p1` perpendicular to the triangle with `p2`
+			static SQuadric fromBoundaryEdge(const core::vectorSIMDf& p0, const core::vectorSIMDf& p1, const core::vectorSIMDf& p2);
+
+			SQuadric& operator+=(const SQuadric& other);
+			//! squared distance, averaged over the accumulated area
+			float error(const core::vectorSIMDf& p) const;
+		};
+
+		//! half-edges going out of every vertex, compressed row storage
+		struct SAdjacency
+		{
+			struct SHalfEdge
+			{
+				uint32_t next;
+				uint32_t prev;
+			};
+			core::vector<uint32_t> offsets;
+			core::vector<SHalfEdge> edges;
+
+			void build(const core::vector<uint32_t>& _indices, uint32_t _vertexCount);
+			bool hasEdge(uint32_t _from, uint32_t _to) const;
+		};
+
+		struct SCollapse
+		{
+			uint32_t from;
+			uint32_t to;
+			float error;
+		};
+
+		//! everything that stays valid between the levels of a chain
+		struct SState
+		{
+			core::vector<core::vectorSIMDf> positions;
+			//! id of the group of vertices at exactly the same position
+			core::vector<uint32_t> positionGroup;
+			//! next vertex of the same position group which is still referenced after welding, circular
+			core::vector<uint32_t> wedge;
+			core::vector<E_VERTEX_KIND> kind;
+			//! the other end of the open edge going out of / coming into a border or seam vertex
+			core::vector<uint32_t> loop;
+			core::vector<uint32_t> loopback;
+			//! per position group
+			core::vector<SQuadric> quadrics;
+			core::vector<uint32_t> indices;
+		};
+
+		//! merges vertices which differ only by less than the error metrics, fills the position groups, returns the welded triangle list
+		static void weld(const ICPUMeshBuffer* _meshbuffer, const IMeshManipulator::SErrorMetric* _errMetrics, const core::vector<uint32_t>& _rawIndices, SState& _state);
+		static void classify(const SAdjacency& _adjacency, bool _lockBorders, SState& _state);
+		static void computeQuadrics(const SAdjacency& _adjacency, SState& _state);
+		//! returns the largest error of the collapses done, reduces `_state.indices` to about `_targetTriangles`
+		static float simplify(SState& _state, uint32_t _targetTriangles, float _maxError);
+
+		//! the vertex of `_wedge`'s boundary loop at the position of `_target`
+		static uint32_t getSeamTarget(const SState& _state, uint32_t _wedge, uint32_t _target);
+		static bool canCollapse(const SState& _state, uint32_t _from, uint32_t _to);
+		static bool hasTriangleFlips(const SState& _state, const SAdjacency& _adjacency, uint32_t _from, uint32_t _to);
+
+		static core::smart_refctd_ptr<ICPUMeshBuffer> createLoDMeshBuffer(const ICPUMeshBuffer* _meshbuffer, const core::vector<uint32_t>& _indices, bool _shareVertexBuffers);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/utils/CShaderVariantCache.h"
+
+#include <algorithm>
+
+namespace nbl
+{
+namespace asset
+{
+
+void CShaderVariantCache::canonicalizeDefines(core::vector<define_t>& _defines)
+{
+	// stable, so of the definitions with equal names the last one given stays the last
+	std::stable_sort(_defines.begin(),_defines.end(),[](const define_t& lhs, const define_t& rhs) -> bool {return lhs.first<rhs.first;});
+	auto out = _defines.begin();
+	for (auto it=_defines.begin(); it!=_defines.end(); it++)
+	{
+		auto next = it+1;
+		if (next!=_defines.end() && next->first==it->first)
+			continue;
+		if (out!=it)
+			*out = std::move(*it);
+		out++;
+	}
+	_defines.erase(out,_defines.end());
+}
+
+core::smart_refctd_ptr<ICPUShader> CShaderVariantCache::getShader(const std::string& _glslTemplate, const define_t* _definesBegin, const define_t* _definesEnd, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath)
+{
+	core::vector<define_t> defines(_definesBegin,_definesEnd);
+	canonicalizeDefines(defines);
+
+	SPermutationKey key;
+	key.stage = _stage;
+	key.originFilepath = _originFilepath ? _originFilepath:"";
+	for (const auto& define : defines)
+	{
+		key.defines += define.first;
+		key.defines.push_back('\0');
+		key.defines += define.second;
+		key.defines.push_back('\0');
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.requests++;
+
+		// a template without an id can't have any cached permutations
+		auto foundTemplate = m_templates.find(_glslTemplate);
+		if (foundTemplate!=m_templates.end())
+		{
+			key.templateID = foundTemplate->second.id;
+			if (auto found=m_permutations.get(key))
+			{
+				m_stats.permutationHits++;
+				return found->shader;
+			}
+		}
+	}
+
+	std::string glsl = _glslTemplate;
+	IShader::insertGLSLDefines(glsl,defines.data(),defines.data()+defines.size());
+	SSourceKey sourceKey;
+	sourceKey.originFilepath = key.originFilepath;
+	if (m_compiler)
+	{
+		auto resolved = m_compiler->resolveIncludeDirectives(std::string(glsl),_stage,_originFilepath);
+		if (!resolved)
+			return nullptr;
+		sourceKey.preprocessed = reinterpret_cast<const char*>(resolved->getSPVorGLSL()->getPointer());
+	}
+	else
+		sourceKey.preprocessed = glsl;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto foundTemplate = m_templates.find(_glslTemplate);
+	if (foundTemplate==m_templates.end())
+		foundTemplate = m_templates.emplace(_glslTemplate,STemplate{m_nextTemplateID++,0u}).first;
+	key.templateID = foundTemplate->second.id;
+	// another thread could have finished the same permutation in the meantime
+	if (auto found=m_permutations.get(key))
+	{
+		m_stats.permutationHits++;
+		return found->shader;
+	}
+
+	auto source = m_sources.find(sourceKey);
+	if (source!=m_sources.end())
+		m_stats.sourceHits++;
+	else
+	{
+		source = m_sources.emplace(std::move(sourceKey),SSource{core::make_smart_refctd_ptr<ICPUShader>(glsl.c_str()),0u}).first;
+		m_specialized[source->second.shader.get()];
+	}
+
+	// count the new use before inserting, so the eviction it may cause can't drop what it's about to use
+	foundTemplate->second.permutationCount++;
+	source->second.permutationCount++;
+	SPermutation permutation;
+	permutation.shader = source->second.shader;
+	permutation.glslTemplate = &foundTemplate->first;
+	permutation.source = &source->first;
+	m_permutations.insert(std::move(key),SPermutation(permutation),[this](const SPermutationKey& _key, SPermutation&& _evicted) -> void
+	{
+		onPermutationEvicted(_key,std::move(_evicted));
+	});
+	return permutation.shader;
+}
+
+core::smart_refctd_ptr<ICPUSpecializedShader> CShaderVariantCache::getSpecializedShader(const std::string& _glslTemplate, const define_t* _definesBegin, const define_t* _definesEnd, ISpecializedShader::SInfo&& _info)
+{
+	auto shader = getShader(_glslTemplate,_definesBegin,_definesEnd,_info.shaderStage,_info.m_filePathHint.c_str());
+	if (!shader)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.specializedRequests++;
+	// the permutation could have been evicted since, then the specialization doesn't get cached either
+	auto specializations = m_specialized.find(shader.get());
+	if (specializations==m_specialized.end())
+		return core::make_smart_refctd_ptr<ICPUSpecializedShader>(std::move(shader),std::move(_info));
+
+	auto found = specializations->second.find(_info);
+	if (found!=specializations->second.end())
+	{
+		m_stats.specializedHits++;
+		return found->second;
+	}
+
+	auto specialized = core::make_smart_refctd_ptr<ICPUSpecializedShader>(std::move(shader),ISpecializedShader::SInfo(_info));
+	specializations->second.emplace(std::move(_info),specialized);
+	return specialized;
+}
+
+void CShaderVariantCache::onPermutationEvicted(const SPermutationKey& _key, SPermutation&& _permutation)
+{
+	m_stats.evictions++;
+
+	auto glslTemplate = m_templates.find(*_permutation.glslTemplate);
+	if (--glslTemplate->second.permutationCount==0u)
+		m_templates.erase(glslTemplate);
+
+	auto source = m_sources.find(*_permutation.source);
+	if (--source->second.permutationCount==0u)
+	{
+		m_specialized.erase(source->second.shader.get());
+		m_sources.erase(source);
+	}
+}
+
+CShaderVariantCache::SStatistics CShaderVariantCache::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	SStatistics retval = m_stats;
+	retval.uniqueShaders = m_sources.size();
+	for (const auto& specializations : m_specialized)
+		retval.uniqueSpecializedShaders += specializations.second.size();
+	return retval;
+}
+
+void CShaderVariantCache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// the evictions take the templates, sources and specializations with them
+	const uint64_t evictions = m_stats.evictions;
+	while (m_permutations.evictLeastRecentlyUsed([this](const SPermutationKey& _key, SPermutation&& _evicted) -> void {onPermutationEvicted(_key,std::move(_evicted));})) {}
+	m_stats.evictions = evictions;
+}
+
+}
+}
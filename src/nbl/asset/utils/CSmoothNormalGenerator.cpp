@@ -9,22 +9,14 @@
 #include <iostream>
 #include <algorithm>
 #include <array>
+#include <execution>
+#include <numeric>
 
 namespace nbl
 {
 namespace asset
 {
 
-static inline bool operator<(uint32_t lhs, const IMeshManipulator::SSNGVertexData& rhs)
-{
-	return lhs < rhs.hash;
-}
-
-static inline bool operator<(const IMeshManipulator::SSNGVertexData& lhs, uint32_t rhs)
-{
-	return lhs.hash < rhs;
-}
-
 static inline bool compareVertexPosition(const core::vectorSIMDf& a, const core::vectorSIMDf& b, float epsilon)
 {
 	const core::vectorSIMDf difference = core::abs(b - a);
@@ -65,8 +57,8 @@ CSmoothNormalGenerator::VertexHashMap::VertexHashMap(size_t _vertexCount, uint32
 {
 	assert((core::isPoT(hashTableMaxSize)));
 
-	vertices.reserve(_vertexCount);
-	buckets.reserve(_hashTableMaxSize + 1);
+	vertices.resize(_vertexCount);
+	bucketOffsets.resize(_hashTableMaxSize + 1);
 }
 
 uint32_t CSmoothNormalGenerator::VertexHashMap::hash(const IMeshManipulator::SSNGVertexData & vertex) const
@@ -93,10 +85,10 @@ uint32_t CSmoothNormalGenerator::VertexHashMap::hash(const core::vector3du32_SIM
 		(position.z * primeNumber3))& (hashTableMaxSize - 1);
 }
 
-void CSmoothNormalGenerator::VertexHashMap::add(IMeshManipulator::SSNGVertexData && vertex)
+void CSmoothNormalGenerator::VertexHashMap::set(size_t slot, IMeshManipulator::SSNGVertexData && vertex)
 {
 	vertex.hash = hash(vertex);
-	vertices.push_back(vertex);
+	vertices[slot] = vertex;
 }
 
 CSmoothNormalGenerator::VertexHashMap::BucketBounds CSmoothNormalGenerator::VertexHashMap::getBucketBoundsByHash(uint32_t hash)
@@ -104,18 +96,7 @@ CSmoothNormalGenerator::VertexHashMap::BucketBounds CSmoothNormalGenerator::Vert
 	if (hash == invalidHash)
 		return { vertices.end(), vertices.end() };
 
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator begin = std::lower_bound(vertices.begin(), vertices.end(), hash);
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator end = std::upper_bound(vertices.begin(), vertices.end(), hash);
-
-	//bucket missing
-	if (begin == vertices.end())
-		return { vertices.end(), vertices.end() };
-
-	//bucket missing
-	if (begin->hash != hash)
-		return { vertices.end(), vertices.end() };
-
-	return { begin, end };
+	return { vertices.begin() + bucketOffsets[hash], vertices.begin() + bucketOffsets[hash + 1] };
 }
 
 struct KeyAccessor
@@ -140,21 +121,14 @@ void CSmoothNormalGenerator::VertexHashMap::validate()
 	else
 		vertices.erase(vertices.begin()+oldSize,vertices.end());
 
-	// TODO: are `buckets` even begin USED!?
-	uint16_t prevHash = vertices[0].hash;
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator prevBegin = vertices.begin();
-	buckets.push_back(prevBegin);
-
-	while (true)
+	// the vertices are sorted by hash, so a single sweep finds where every bucket (including the empty ones) begins
+	uint32_t vertexIx = 0u;
+	const uint32_t vertexCount = vertices.size();
+	for (uint32_t bucket = 0u; bucket <= hashTableMaxSize; bucket++)
 	{
-		core::vector<IMeshManipulator::SSNGVertexData>::iterator next = std::upper_bound(prevBegin, vertices.end(), prevHash);
-		buckets.push_back(next);
-
-		if (next == vertices.end())
-			break;
-
-		prevBegin = next;
-		prevHash = next->hash;
+		while (vertexIx < vertexCount && vertices[vertexIx].hash < bucket)
+			vertexIx++;
+		bucketOffsets[bucket] = vertexIx;
 	}
 }
 
@@ -163,12 +137,16 @@ CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const as
 	const size_t idxCount = buffer->getIndexCount();
 	_NBL_DEBUG_BREAK_IF((idxCount % 3));
 
-	VertexHashMap vertices(idxCount, std::min(16u * 1024u, core::roundUpToPoT<unsigned int>(idxCount * 1.0f / 32.0f)), epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
-
-	core::vector3df_SIMD faceNormal;
+	// aim for a handful of vertices per bucket, the neighbour search cost is proportional to the bucket occupancy
+	const uint32_t hashTableSize = core::min(1u << 22u, core::max(core::roundUpToPoT<uint32_t>(idxCount / 8u), 1u));
+	VertexHashMap vertices(idxCount, hashTableSize, epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
 
-	for (uint32_t i = 0; i < idxCount; i += 3)
+	// every triangle writes its own three slots, so the output is identical to a serial pass
+	core::vector<uint32_t> triangles(idxCount / 3u);
+	std::iota(triangles.begin(), triangles.end(), 0u);
+	std::for_each(std::execution::par, triangles.begin(), triangles.end(), [buffer, &vertices](const uint32_t triangle)
 	{
+		const uint32_t i = triangle * 3u;
 		const uint32_t ix[3]{
 			buffer->getIndexValue(i),
 			buffer->getIndexValue(i + 1),
@@ -179,59 +157,62 @@ CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const as
 		core::vectorSIMDf v2 = buffer->getPosition(ix[1]);
 		core::vectorSIMDf v3 = buffer->getPosition(ix[2]);
 
-		faceNormal = core::cross(v2 - v1, v3 - v1);
+		core::vector3df_SIMD faceNormal = core::cross(v2 - v1, v3 - v1);
 		faceNormal = core::normalize(faceNormal);
 
 		//set data for vertices
 		core::vector3df_SIMD angleWages = getAngleWeight(v1, v2, v3);
 
-		vertices.add({ i,		0,	angleWages.x,	v1,		faceNormal });
-		vertices.add({ i + 1,	0,	angleWages.y,	v2,		faceNormal });
-		vertices.add({ i + 2,	0,	angleWages.z,	v3,		faceNormal });
-	}
+		vertices.set(i,		{ i,		0,	angleWages.x,	v1,		faceNormal });
+		vertices.set(i + 1,	{ i + 1,	0,	angleWages.y,	v2,		faceNormal });
+		vertices.set(i + 2,	{ i + 2,	0,	angleWages.z,	v3,		faceNormal });
+	});
 
 	vertices.validate();
 
 	return vertices;
 }
 
-void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, VertexHashMap & vertexHashMap, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp)
+void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, VertexHashMap & vertexHashMap, float epsilon, uint32_t normalAttrID, const IMeshManipulator::VxCmpFunction& vxcmp)
 {
-	for (uint32_t cell = 0; cell < vertexHashMap.getBucketCount() - 1; cell++)
+	// every corner only gathers from its neighbours, but the corners of an indexed vertex share its normal,
+	// so the normals get computed in parallel and written out serially in the same order as they used to be
+	auto& vertices = vertexHashMap.getVertices();
+	core::vector<core::vectorSIMDf> cornerNormals(vertices.size());
+	std::for_each(std::execution::par, vertices.begin(), vertices.end(), [&](const IMeshManipulator::SSNGVertexData& processedVertex)
 	{
-		VertexHashMap::BucketBounds processedBucket = vertexHashMap.getBucketBoundsById(cell);
+		std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(processedVertex);
+		core::vector3df_SIMD normal(0.f);
 
-		for (core::vector<IMeshManipulator::SSNGVertexData>::iterator processedVertex = processedBucket.begin; processedVertex != processedBucket.end; processedVertex++)
+		//iterate among all neighboring cells, the vertex itself is accumulated in sorted order too,
+		//so that coincident vertices with the same set of neighbours get bit-identical normals
+		bool selfAccumulated = false;
+		for (int i = 0; i < 8; i++)
 		{
-			std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(*processedVertex);
-			core::vector3df_SIMD normal = processedVertex->parentTriangleFaceNormal * processedVertex->wage;
-
-			//iterate among all neighboring cells
-			for (int i = 0; i < 8; i++)
+			VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
+			for (; bounds.begin != bounds.end; bounds.begin++)
 			{
-				VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
-				for (; bounds.begin != bounds.end; bounds.begin++)
+				const bool isSelf = &processedVertex == &(*bounds.begin);
+				if (isSelf || compareVertexPosition(processedVertex.position, bounds.begin->position, epsilon) &&
+					vxcmp(processedVertex, *bounds.begin, buffer))
 				{
-					if (processedVertex != bounds.begin)
-						if (compareVertexPosition(processedVertex->position, bounds.begin->position, epsilon) &&
-							vxcmp(*processedVertex, *bounds.begin, buffer))
-						{
-							//TODO: better mean calculation algorithm
-							normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
-						}
+					//TODO: better mean calculation algorithm
+					normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
+					selfAccumulated = selfAccumulated || isSelf;
 				}
 			}
-
-
-			normal = core::normalize(core::vectorSIMDf(normal));
-			buffer->setAttribute(normal, normalAttrID, buffer->getIndexValue(processedVertex->indexOffset));
 		}
-	}
+		if (!selfAccumulated)
+			normal += processedVertex.parentTriangleFaceNormal * processedVertex.wage;
 
+		cornerNormals[std::distance<const IMeshManipulator::SSNGVertexData*>(vertices.data(), &processedVertex)] = core::normalize(core::vectorSIMDf(normal));
+	});
 
+	for (size_t i = 0u; i < vertices.size(); i++)
+		buffer->setAttribute(cornerNormals[i], normalAttrID, buffer->getIndexValue(vertices[i].indexOffset));
 }
 
-std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex)
+std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex) const
 {
 	std::array<uint32_t, 8> neighbourhood;
 
@@ -23,6 +23,8 @@ namespace asset
 class CSmoothNormalGenerator
 {
 public:
+	//! Both the per-triangle weight computation and the per-vertex neighbour search run on all hardware threads, `function` must be safe to call concurrently.
+	/** Every output normal is gathered from its neighbours in the (stable) spatially sorted order, so the result does not depend on the thread count or scheduling. */
 	static core::smart_refctd_ptr<asset::ICPUMeshBuffer> calculateNormals(asset::ICPUMeshBuffer* buffer, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction function);
 
 	CSmoothNormalGenerator() = delete;
@@ -41,25 +43,24 @@ private:
 	public:
 		VertexHashMap(size_t _vertexCount, uint32_t _hashTableMaxSize, float _cellSize);
 
-		//inserts vertex into hash table
-		void add(IMeshManipulator::SSNGVertexData&& vertex);
+		//inserts vertex into hash table at the given slot, different slots can be written from different threads
+		void set(size_t slot, IMeshManipulator::SSNGVertexData&& vertex);
 
-		//sorts hashtable and sets iterators at beginnings of bucktes
+		//sorts hashtable and computes the offsets of the bucktes
 		void validate();
 
 		//
-		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex);
+		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex) const;
 
-		inline uint32_t getBucketCount() const { return buckets.size(); }
-		inline BucketBounds getBucketBoundsById(uint32_t index) { return { buckets[index], buckets[index + 1] }; }
+		inline core::vector<IMeshManipulator::SSNGVertexData>& getVertices() { return vertices; }
 		BucketBounds getBucketBoundsByHash(uint32_t hash);
 
 	private:
 		static constexpr uint32_t invalidHash = 0xFFFFFFFF;
 
 	private:
-		//holds iterators pointing to beginning of each bucket, last iterator points to vertices.end()
-		core::vector<core::vector<IMeshManipulator::SSNGVertexData>::iterator> buckets;
+		//holds offsets of the beginning of each bucket (indexed by hash) into `vertices`, last offset is vertices.size()
+		core::vector<uint32_t> bucketOffsets;
 		core::vector<IMeshManipulator::SSNGVertexData> vertices;
 		const uint32_t hashTableMaxSize;
 		const float cellSize;
@@ -72,7 +73,7 @@ private:
 
 private:
 	static VertexHashMap setupData(const asset::ICPUMeshBuffer* buffer, float epsilon);
-	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, VertexHashMap& vertices, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp);
+	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, VertexHashMap& vertices, float epsilon, uint32_t normalAttrID, const IMeshManipulator::VxCmpFunction& vxcmp);
 
 };
 
@@ -0,0 +1,372 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/utils/CStreamingMeshProcessor.h"
+
+#include <algorithm>
+#include <execution>
+#include <filesystem>
+#include <numeric>
+
+#include "nbl/asset/IAssetManager.h"
+#include "os.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+namespace
+{
+
+constexpr uint32_t FloatsPerTriangle = 9u;
+constexpr uint32_t PositionAttrID = 0u;
+constexpr uint32_t NormalAttrID = 3u;
+
+//! Triangles waiting to be appended to one chunk file
+struct SBinWriter
+{
+	std::string path;
+	core::vector<float> pending;
+	uint64_t triangleCount = 0ull;
+
+	inline bool flush(io::IFileSystem* fs)
+	{
+		if (pending.empty())
+			return true;
+		auto file = core::smart_refctd_ptr<io::IWriteFile>(fs->createAndWriteFile(path.c_str(),true),core::dont_grab);
+		if (!file)
+			return false;
+		const uint32_t byteSize = pending.size()*sizeof(float);
+		const bool success = file->write(pending.data(),byteSize)==static_cast<int32_t>(byteSize);
+		pending.clear();
+		return success;
+	}
+};
+
+bool readBin(io::IFileSystem* fs, const std::string& path, const uint64_t triangleCount, float* out)
+{
+	if (!triangleCount)
+		return true;
+	auto file = core::smart_refctd_ptr<io::IReadFile>(fs->createAndOpenFile(path.c_str()),core::dont_grab);
+	if (!file)
+		return false;
+	const size_t byteSize = triangleCount*FloatsPerTriangle*sizeof(float);
+	if (file->getSize()!=byteSize)
+		return false;
+	// the interface reads at most 4GB at once
+	for (size_t offset=0ull; offset<byteSize;)
+	{
+		const uint32_t toRead = core::min<size_t>(byteSize-offset,0x7fffffffull);
+		if (file->read(reinterpret_cast<uint8_t*>(out)+offset,toRead)!=static_cast<int32_t>(toRead))
+			return false;
+		offset += toRead;
+	}
+	return true;
+}
+
+core::smart_refctd_ptr<ICPUMeshBuffer> createChunkMeshBuffer(const float* positions, const uint32_t triangleCount)
+{
+	constexpr uint32_t VertexSize = sizeof(float)*6u;
+	const uint32_t vertexCount = triangleCount*3u;
+	auto vertexBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(vertexCount)*VertexSize);
+	{
+		float* out = reinterpret_cast<float*>(vertexBuffer->getPointer());
+		for (uint32_t i=0u; i<vertexCount; i++)
+		{
+			std::copy(positions+i*3u,positions+i*3u+3u,out+i*6u);
+			std::fill(out+i*6u+3u,out+i*6u+6u,0.f);
+		}
+	}
+
+	SVertexInputParams inputParams;
+	inputParams.enabledBindingFlags = 0x1u;
+	inputParams.bindings[0].inputRate = EVIR_PER_VERTEX;
+	inputParams.bindings[0].stride = VertexSize;
+	inputParams.enabledAttribFlags = (0x1u<<PositionAttrID)|(0x1u<<NormalAttrID);
+	inputParams.attributes[PositionAttrID].binding = 0u;
+	inputParams.attributes[PositionAttrID].format = EF_R32G32B32_SFLOAT;
+	inputParams.attributes[PositionAttrID].relativeOffset = 0u;
+	inputParams.attributes[NormalAttrID].binding = 0u;
+	inputParams.attributes[NormalAttrID].format = EF_R32G32B32_SFLOAT;
+	inputParams.attributes[NormalAttrID].relativeOffset = sizeof(float)*3u;
+	SPrimitiveAssemblyParams primitiveAssemblyParams;
+	primitiveAssemblyParams.primitiveType = EPT_TRIANGLE_LIST;
+	auto pipeline = core::make_smart_refctd_ptr<ICPURenderpassIndependentPipeline>(nullptr,nullptr,nullptr,inputParams,SBlendParams(),primitiveAssemblyParams,SRasterizationParams());
+
+	auto meshbuffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+	meshbuffer->setPipeline(std::move(pipeline));
+	meshbuffer->setVertexBufferBinding({0ull,std::move(vertexBuffer)},0u);
+	meshbuffer->setPositionAttributeIx(PositionAttrID);
+	meshbuffer->setNormalAttributeIx(NormalAttrID);
+	meshbuffer->setIndexType(EIT_UNKNOWN);
+	meshbuffer->setIndexCount(vertexCount);
+	return meshbuffer;
+}
+
+}
+
+
+CStreamingMeshProcessor::CMeshBufferSource::CMeshBufferSource(core::smart_refctd_ptr<const ICPUMeshBuffer>&& _meshbuffer) : m_meshbuffer(std::move(_meshbuffer))
+{
+	if (!m_meshbuffer || !m_meshbuffer->getPipeline())
+		return;
+	switch (m_meshbuffer->getPipeline()->getPrimitiveAssemblyParams().primitiveType)
+	{
+		case EPT_TRIANGLE_LIST:
+		case EPT_TRIANGLE_STRIP:
+		case EPT_TRIANGLE_FAN:
+			IMeshManipulator::getPolyCount(m_triangleCount,m_meshbuffer.get());
+			break;
+		default:
+			break;
+	}
+}
+
+bool CStreamingMeshProcessor::CMeshBufferSource::reset()
+{
+	m_triangleIx = 0u;
+	return m_triangleCount!=0u;
+}
+
+uint32_t CStreamingMeshProcessor::CMeshBufferSource::read(float* outPositions, uint32_t maxTriangles)
+{
+	const uint32_t count = core::min(maxTriangles,m_triangleCount-m_triangleIx);
+	for (uint32_t i=0u; i<count; i++,m_triangleIx++)
+	{
+		const auto indices = IMeshManipulator::getTriangleIndices(m_meshbuffer.get(),m_triangleIx);
+		for (uint32_t j=0u; j<3u; j++)
+		{
+			const auto pos = m_meshbuffer->getPosition(indices[j]);
+			std::copy(pos.pointer,pos.pointer+3u,outPositions+i*FloatsPerTriangle+j*3u);
+		}
+	}
+	return count;
+}
+
+void CStreamingMeshProcessor::CMeshBufferSource::release()
+{
+	m_meshbuffer = nullptr;
+}
+
+
+CStreamingMeshProcessor::SResult CStreamingMeshProcessor::process(IAssetManager* _assetManager, ITriangleSource* _source, const SParams& _params)
+{
+	SResult result;
+	if (!_assetManager || !_source)
+		return result;
+	io::IFileSystem* fs = _assetManager->getFileSystem();
+
+	core::vector<float> batch(size_t(SourceBatchTriangles)*FloatsPerTriangle);
+	auto forEachTriangle = [&](auto f) -> bool
+	{
+		if (!_source->reset())
+			return false;
+		for (uint32_t count; (count=_source->read(batch.data(),SourceBatchTriangles));)
+		for (uint32_t i=0u; i<count; i++)
+		{
+			const float* tri = batch.data()+i*FloatsPerTriangle;
+			core::aabbox3df triBounds(tri[0],tri[1],tri[2],tri[0],tri[1],tri[2]);
+			triBounds.addInternalPoint(tri[3],tri[4],tri[5]);
+			triBounds.addInternalPoint(tri[6],tri[7],tri[8]);
+			f(tri,triBounds);
+		}
+		return true;
+	};
+
+	// STEP: bounds of the mesh and of the largest triangle
+	core::aabbox3df bounds(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+	core::vector3df maxTriangleExtent(0.f);
+	if (!forEachTriangle([&](const float* tri, const core::aabbox3df& triBounds) -> void
+		{
+			bounds.addInternalBox(triBounds);
+			const auto extent = triBounds.getExtent();
+			maxTriangleExtent.set(core::max(maxTriangleExtent.X,extent.X),core::max(maxTriangleExtent.Y,extent.Y),core::max(maxTriangleExtent.Z,extent.Z));
+			result.triangleCount++;
+		}))
+		return result;
+	if (!result.triangleCount)
+		return result;
+
+	// STEP: pick the grid, so that all the hardware threads can work on a chunk each within the budget
+	const uint32_t threadCount = core::max(std::thread::hardware_concurrency(),1u);
+	const uint64_t trianglesPerChunk = core::max<uint64_t>(_params.memoryBudget/(EstimatedBytesPerTriangle*threadCount),1ull);
+	const uint64_t targetChunkCount = core::min<uint64_t>((result.triangleCount+trianglesPerChunk-1ull)/trianglesPerChunk,0x1ull<<18ull);
+	uint32_t gridSize[3] = {1u,1u,1u};
+	const core::vector3df extent = bounds.getExtent();
+	// keep splitting the axis along which the cells are the longest, works for flat scans too
+	while (uint64_t(gridSize[0])*gridSize[1]*gridSize[2]<targetChunkCount)
+	{
+		const float cellExtent[3] = {extent.X/gridSize[0],extent.Y/gridSize[1],extent.Z/gridSize[2]};
+		gridSize[std::max_element(cellExtent,cellExtent+3)-cellExtent] *= 2u;
+	}
+	const uint32_t chunkCount = gridSize[0]*gridSize[1]*gridSize[2];
+	const float cellSize[3] = {extent.X/gridSize[0],extent.Y/gridSize[1],extent.Z/gridSize[2]};
+	const float gridMin[3] = {bounds.MinEdge.X,bounds.MinEdge.Y,bounds.MinEdge.Z};
+	auto getCell = [&](const core::vector3df& point, const uint32_t axis) -> uint32_t
+	{
+		if (cellSize[axis]<=0.f)
+			return 0u;
+		const float coord = axis==0u ? point.X:(axis==1u ? point.Y:point.Z);
+		const float cell = (coord-gridMin[axis])/cellSize[axis];
+		return static_cast<uint32_t>(core::clamp(cell,0.f,float(gridSize[axis]-1u)));
+	};
+
+	// STEP: bin the triangles, every one into the chunk of its centroid and into the halos of the others it could share a vertex with
+	core::vector<SBinWriter> owned(chunkCount), halos(chunkCount);
+	const std::filesystem::path scratchDirectory(_params.scratchDirectory);
+	for (uint32_t i=0u; i<chunkCount; i++)
+	{
+		owned[i].path = (scratchDirectory/("chunk"+std::to_string(i)+".owned")).string();
+		halos[i].path = (scratchDirectory/("chunk"+std::to_string(i)+".halo")).string();
+		std::filesystem::remove(owned[i].path);
+		std::filesystem::remove(halos[i].path);
+	}
+	auto removeScratchFiles = [&]() -> void
+	{
+		for (uint32_t i=0u; i<chunkCount; i++)
+		{
+			std::error_code ec;
+			std::filesystem::remove(owned[i].path,ec);
+			std::filesystem::remove(halos[i].path,ec);
+		}
+	};
+	// nothing but the write buffers is kept around while binning, they get a quarter of the budget
+	const size_t bufferFloats = core::max<size_t>(_params.memoryBudget/(sizeof(float)*4ull*2ull*chunkCount),FloatsPerTriangle);
+	bool binningFailed = false;
+	auto append = [&](SBinWriter& writer, const float* tri) -> void
+	{
+		writer.pending.insert(writer.pending.end(),tri,tri+FloatsPerTriangle);
+		writer.triangleCount++;
+		if (writer.pending.size()>=bufferFloats)
+			binningFailed = !writer.flush(fs) || binningFailed;
+	};
+	if (!forEachTriangle([&](const float* tri, const core::aabbox3df& triBounds) -> void
+		{
+			const core::vector3df centroid((tri[0]+tri[3]+tri[6])/3.f,(tri[1]+tri[4]+tri[7])/3.f,(tri[2]+tri[5]+tri[8])/3.f);
+			const uint32_t ownCell[3] = {getCell(centroid,0u),getCell(centroid,1u),getCell(centroid,2u)};
+			append(owned[(ownCell[2]*gridSize[1]+ownCell[1])*gridSize[0]+ownCell[0]],tri);
+
+			// a vertex of a chunk's triangle is at most one triangle extent away from the chunk's cell
+			const core::vector3df haloMin = triBounds.MinEdge-maxTriangleExtent;
+			const core::vector3df haloMax = triBounds.MaxEdge+maxTriangleExtent;
+			const uint32_t minCell[3] = {getCell(haloMin,0u),getCell(haloMin,1u),getCell(haloMin,2u)};
+			const uint32_t maxCell[3] = {getCell(haloMax,0u),getCell(haloMax,1u),getCell(haloMax,2u)};
+			for (uint32_t z=minCell[2]; z<=maxCell[2]; z++)
+			for (uint32_t y=minCell[1]; y<=maxCell[1]; y++)
+			for (uint32_t x=minCell[0]; x<=maxCell[0]; x++)
+			if (x!=ownCell[0] || y!=ownCell[1] || z!=ownCell[2])
+				append(halos[(z*gridSize[1]+y)*gridSize[0]+x],tri);
+		}))
+		binningFailed = true;
+	_source->release();
+	for (uint32_t i=0u; i<chunkCount; i++)
+	{
+		binningFailed = !owned[i].flush(fs) || binningFailed;
+		binningFailed = !halos[i].flush(fs) || binningFailed;
+		core::vector<float>().swap(owned[i].pending);
+		core::vector<float>().swap(halos[i].pending);
+	}
+	if (binningFailed)
+	{
+		os::Printer::log("CStreamingMeshProcessor: Could not write the chunks to "+_params.scratchDirectory,ELL_ERROR);
+		removeScratchFiles();
+		return result;
+	}
+
+	// STEP: process the chunks, biggest first so the long ones don't end up last
+	core::vector<uint32_t> chunkIxs;
+	for (uint32_t i=0u; i<chunkCount; i++)
+	if (owned[i].triangleCount)
+		chunkIxs.push_back(i);
+	std::sort(chunkIxs.begin(),chunkIxs.end(),[&](const uint32_t lhs, const uint32_t rhs) -> bool
+	{
+		return owned[lhs].triangleCount+halos[lhs].triangleCount>owned[rhs].triangleCount+halos[rhs].triangleCount;
+	});
+
+	IMeshManipulator::SErrorMetric defaultErrorMetrics[ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT];
+	defaultErrorMetrics[NormalAttrID].method = IMeshManipulator::EEM_ANGLES;
+	const IMeshManipulator::SErrorMetric* errorMetrics = _params.errorMetrics ? _params.errorMetrics:defaultErrorMetrics;
+
+	auto getFootprint = [&](const uint32_t i) -> size_t
+	{
+		return (owned[i].triangleCount+halos[i].triangleCount)*EstimatedBytesPerTriangle;
+	};
+	core::vector<SChunk> chunks(chunkCount);
+	auto processChunk = [&](const uint32_t i) -> void
+	{
+		const uint64_t ownedCount = owned[i].triangleCount;
+		const uint64_t totalCount = ownedCount+halos[i].triangleCount;
+
+		SChunk& chunk = chunks[i];
+		chunk.filename = _params.outputPrefix+std::to_string(i)+_params.outputExtension;
+		chunk.triangleCount = ownedCount;
+		chunk.bounds = core::aabbox3df(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+		[&]() -> void
+		{
+			if (totalCount*3ull>0xffffffffull)
+			{
+				os::Printer::log("CStreamingMeshProcessor: Chunk "+std::to_string(i)+" has too many triangles, lower the memory budget",ELL_ERROR);
+				return;
+			}
+
+			// the chunk's own triangles go first so that the halo can be cut off the end of the index buffer
+			core::vector<float> positions(totalCount*FloatsPerTriangle);
+			if (!readBin(fs,owned[i].path,ownedCount,positions.data()) || !readBin(fs,halos[i].path,halos[i].triangleCount,positions.data()+ownedCount*FloatsPerTriangle))
+				return;
+			auto meshbuffer = createChunkMeshBuffer(positions.data(),totalCount);
+			core::vector<float>().swap(positions);
+
+			// corners keep their order while the vertices get split and merged again
+			meshbuffer = IMeshManipulator::calculateSmoothNormalsWithHardEdges(meshbuffer.get(),_params.hardEdgeAngle,1.525e-5f,NormalAttrID);
+			if (!meshbuffer)
+				return;
+			meshbuffer->setIndexCount(ownedCount*3ull);
+			meshbuffer = IMeshManipulator::createOptimizedMeshBuffer(meshbuffer.get(),errorMetrics);
+			if (!meshbuffer)
+				return;
+			IMeshManipulator::recalculateBoundingBox(meshbuffer.get());
+			chunk.bounds = meshbuffer->getBoundingBox();
+
+			auto mesh = core::make_smart_refctd_ptr<ICPUMesh>();
+			mesh->getMeshBufferVector().push_back(std::move(meshbuffer));
+			IMeshManipulator::recalculateBoundingBox(mesh.get());
+			chunk.written = _assetManager->writeAsset(chunk.filename,IAssetWriter::SAssetWriteParams(mesh.get(),EWF_BINARY));
+			if (!chunk.written)
+				os::Printer::log("CStreamingMeshProcessor: Could not write "+chunk.filename,ELL_ERROR);
+		}();
+
+		std::error_code ec;
+		std::filesystem::remove(owned[i].path,ec);
+		std::filesystem::remove(halos[i].path,ec);
+	};
+	// the budget gets enforced between the parallel loops, blocking inside one could starve the parallel algorithms the chunks run themselves
+	core::vector<uint32_t> wave;
+	for (auto it=chunkIxs.begin(); it!=chunkIxs.end();)
+	{
+		size_t waveFootprint = 0ull;
+		wave.clear();
+		// a chunk which doesn't fit even on its own gets a wave to itself
+		for (; it!=chunkIxs.end() && (wave.empty() || waveFootprint+getFootprint(*it)<=_params.memoryBudget); it++)
+		{
+			wave.push_back(*it);
+			waveFootprint += getFootprint(*it);
+		}
+		result.peakMemoryEstimate = core::max(result.peakMemoryEstimate,waveFootprint);
+		std::for_each(std::execution::par,wave.begin(),wave.end(),processChunk);
+	}
+	removeScratchFiles();
+
+	result.success = true;
+	for (uint32_t i=0u; i<chunkCount; i++)
+	if (owned[i].triangleCount)
+	{
+		result.success = result.success && chunks[i].written;
+		result.chunks.push_back(std::move(chunks[i]));
+	}
+	return result;
+}
+
+}
+}
@@ -0,0 +1,685 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/utils/CStreamingMeshProcessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+
+#include "os.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+namespace
+{
+
+constexpr uint32_t FloatsPerTriangle = 9u;
+//! Read buffers of the indexed sources, taken out of their cache budget
+constexpr size_t ReadBufferSize = 0x1ull<<20ull;
+
+template<typename T>
+inline T readScalar(const uint8_t* src, const bool bigEndian)
+{
+	uint8_t bytes[sizeof(T)];
+	if (bigEndian)
+		std::reverse_copy(src,src+sizeof(T),bytes);
+	else
+		std::copy(src,src+sizeof(T),bytes);
+	T retval;
+	memcpy(&retval,bytes,sizeof(T));
+	return retval;
+}
+
+//! Out of range for anything the sources index with when the size isn't one of an index
+inline uint32_t readIndex(const uint8_t* src, const uint8_t size, const bool bigEndian)
+{
+	switch (size)
+	{
+		case 1u:
+			return *src;
+		case 2u:
+			return readScalar<uint16_t>(src,bigEndian);
+		case 4u:
+			return readScalar<uint32_t>(src,bigEndian);
+		default:
+			return ~0u;
+	}
+}
+
+inline const char* skipWhitespace(const char* begin, const char* end)
+{
+	while (begin<end && std::isspace(static_cast<unsigned char>(*begin)))
+		begin++;
+	return begin;
+}
+
+//! Whether the line is a `_keyword` statement, skips past the keyword if so
+inline bool isStatement(const char*& begin, const char* end, const char _keyword)
+{
+	if (end-begin<2 || begin[0]!=_keyword || !std::isspace(static_cast<unsigned char>(begin[1])))
+		return false;
+	begin += 2;
+	return true;
+}
+
+//! Pushes the corner triangles of `polygon`'s fan to `outPositions` until either runs out, triangles with corners which can't be looked up get skipped
+template<class PositionCache>
+inline uint32_t emitFan(PositionCache& positions, const core::vector<uint32_t>& polygon, uint32_t& nextFanTriangle, float* outPositions, const uint32_t maxTriangles)
+{
+	uint32_t count = 0u;
+	for (; count<maxTriangles && nextFanTriangle+2u<polygon.size(); nextFanTriangle++)
+	{
+		float* out = outPositions+count*FloatsPerTriangle;
+		if (positions.get(polygon[0],out) && positions.get(polygon[nextFanTriangle+1u],out+3u) && positions.get(polygon[nextFanTriangle+2u],out+6u))
+			count++;
+	}
+	return count;
+}
+
+}
+
+
+void CStreamingMeshProcessor::CBufferedReader::init(io::IReadFile* _file, const size_t _offset, const size_t _bufferSize)
+{
+	m_file = _file;
+	m_fileOffset = _offset;
+	m_bufferSize = core::max<size_t>(_bufferSize,1ull);
+	m_buffer.resize(m_bufferSize+1ull);
+	m_begin = m_end = 0ull;
+	m_buffer[0] = 0u;
+}
+
+size_t CStreamingMeshProcessor::CBufferedReader::ensure(const size_t _bytes)
+{
+	const size_t available = m_end-m_begin;
+	if (available>=_bytes || !m_file)
+		return available;
+
+	// a record or line which doesn't fit grows the buffer
+	if (_bytes>m_bufferSize)
+		m_bufferSize = core::max<size_t>(_bytes,m_bufferSize*2ull);
+	if (m_buffer.size()<m_bufferSize+1ull)
+	{
+		core::vector<uint8_t> buffer(m_bufferSize+1ull);
+		std::copy(m_buffer.begin()+m_begin,m_buffer.begin()+m_end,buffer.begin());
+		m_buffer.swap(buffer);
+	}
+	else
+		std::copy(m_buffer.begin()+m_begin,m_buffer.begin()+m_end,m_buffer.begin());
+	m_begin = 0ull;
+	m_end = available;
+
+	const size_t fileSize = m_file->getSize();
+	const size_t toRead = core::min<size_t>(m_bufferSize-m_end,fileSize>m_fileOffset ? (fileSize-m_fileOffset):0ull);
+	if (toRead && m_file->seek(m_fileOffset))
+	{
+		const int32_t bytesRead = m_file->read(m_buffer.data()+m_end,static_cast<uint32_t>(toRead));
+		if (bytesRead>0)
+		{
+			m_end += bytesRead;
+			m_fileOffset += bytesRead;
+		}
+	}
+	m_buffer[m_end] = 0u;
+	return m_end-m_begin;
+}
+
+bool CStreamingMeshProcessor::CBufferedReader::readLine(const char*& outBegin, const char*& outEnd)
+{
+	size_t available = ensure(1ull);
+	if (!available)
+		return false;
+	for (;;)
+	{
+		const uint8_t* begin = data();
+		const uint8_t* end = begin+available;
+		const uint8_t* newline = std::find(begin,end,'\n');
+		if (newline==end)
+		{
+			// the line goes on past the buffer, unless the file ends there
+			const size_t more = ensure(available+1ull);
+			if (more>available)
+			{
+				available = more;
+				continue;
+			}
+		}
+
+		outBegin = reinterpret_cast<const char*>(begin);
+		outEnd = reinterpret_cast<const char*>(newline);
+		consume(newline-begin+(newline!=end ? 1ull:0ull));
+		if (outEnd!=outBegin && outEnd[-1]=='\r')
+			outEnd--;
+		return true;
+	}
+}
+
+void CStreamingMeshProcessor::CBufferedReader::release()
+{
+	core::vector<uint8_t>().swap(m_buffer);
+	m_begin = m_end = 0ull;
+}
+
+
+void CStreamingMeshProcessor::CPositionPageCache::init(io::IReadFile* _file, const SLayout& _layout, const size_t _byteBudget)
+{
+	m_file = _file;
+	m_layout = _layout;
+
+	constexpr size_t PageByteSize = sizeof(float)*3ull*VerticesPerPage;
+	const uint32_t pageCount = (m_layout.vertexCount+VerticesPerPage-1u)/VerticesPerPage;
+	m_slotCount = core::min<size_t>(core::max<size_t>(_byteBudget/PageByteSize,1ull),core::max(pageCount,1u));
+	m_positions.resize(size_t(m_slotCount)*VerticesPerPage*3ull);
+	m_slotPages.assign(m_slotCount,InvalidPage);
+	m_slotLastUse.assign(m_slotCount,0ull);
+	m_pageSlots.clear();
+	m_useCounter = 0ull;
+	m_lastSlot = 0u;
+}
+
+bool CStreamingMeshProcessor::CPositionPageCache::get(const uint32_t _vertex, float* _outPosition)
+{
+	if (_vertex>=m_layout.vertexCount || !m_slotCount)
+		return false;
+
+	const uint32_t page = _vertex/VerticesPerPage;
+	uint32_t slot = m_lastSlot;
+	if (m_slotPages[slot]!=page)
+	{
+		auto found = m_pageSlots.find(page);
+		if (found!=m_pageSlots.end())
+			slot = found->second;
+		else
+		{
+			// unused slots were last used at 0, so they go first
+			slot = std::min_element(m_slotLastUse.begin(),m_slotLastUse.end())-m_slotLastUse.begin();
+			if (m_slotPages[slot]!=InvalidPage)
+				m_pageSlots.erase(m_slotPages[slot]);
+			m_slotPages[slot] = InvalidPage;
+			m_slotLastUse[slot] = 0ull;
+
+			const uint32_t firstVertex = page*VerticesPerPage;
+			const uint32_t vertexCount = core::min(VerticesPerPage,m_layout.vertexCount-firstVertex);
+			const size_t byteSize = size_t(vertexCount)*m_layout.stride;
+			m_scratch.resize(byteSize);
+			if (!m_file->seek(m_layout.offset+size_t(firstVertex)*m_layout.stride) || m_file->read(m_scratch.data(),byteSize)!=static_cast<int32_t>(byteSize))
+				return false;
+
+			float* out = m_positions.data()+size_t(slot)*VerticesPerPage*3ull;
+			for (uint32_t i=0u; i<vertexCount; i++)
+			for (uint32_t j=0u; j<3u; j++)
+			{
+				const uint8_t* src = m_scratch.data()+size_t(i)*m_layout.stride+m_layout.componentOffsets[j];
+				out[i*3u+j] = m_layout.doublePrecision ? static_cast<float>(readScalar<double>(src,m_layout.bigEndian)):readScalar<float>(src,m_layout.bigEndian);
+			}
+			m_slotPages[slot] = page;
+			m_pageSlots[page] = slot;
+		}
+		m_lastSlot = slot;
+	}
+	m_slotLastUse[slot] = ++m_useCounter;
+
+	const float* position = m_positions.data()+(size_t(slot)*VerticesPerPage+_vertex%VerticesPerPage)*3ull;
+	std::copy(position,position+3u,_outPosition);
+	return true;
+}
+
+void CStreamingMeshProcessor::CPositionPageCache::release()
+{
+	core::vector<float>().swap(m_positions);
+	core::vector<uint32_t>().swap(m_slotPages);
+	core::vector<uint64_t>().swap(m_slotLastUse);
+	core::unordered_map<uint32_t,uint32_t>().swap(m_pageSlots);
+	core::vector<uint8_t>().swap(m_scratch);
+	m_slotCount = 0u;
+}
+
+
+CStreamingMeshProcessor::CBinarySTLSource::CBinarySTLSource(core::smart_refctd_ptr<io::IReadFile>&& _file) : m_file(std::move(_file))
+{
+	constexpr size_t HeaderSize = 80ull+sizeof(uint32_t);
+	if (!m_file || m_file->getSize()<HeaderSize)
+		return;
+
+	uint32_t triangleCount = 0u;
+	m_file->seek(80ull);
+	m_file->read(&triangleCount,sizeof(uint32_t));
+	// ASCII files (and binary ones starting with "solid") don't match the size implied by the count
+	if (m_file->getSize()!=HeaderSize+size_t(triangleCount)*50ull)
+		return;
+	m_triangleCount = triangleCount;
+	reset();
+}
+
+bool CStreamingMeshProcessor::CBinarySTLSource::reset()
+{
+	m_trianglesRead = 0u;
+	return isValid() && m_file->seek(80ull+sizeof(uint32_t));
+}
+
+uint32_t CStreamingMeshProcessor::CBinarySTLSource::read(float* outPositions, uint32_t maxTriangles)
+{
+	// normal, 3 positions and the attribute byte count
+	constexpr uint32_t TriangleSize = 50u;
+	const uint32_t count = core::min(maxTriangles,m_triangleCount-m_trianglesRead);
+	if (!count)
+		return 0u;
+
+	m_scratch.resize(size_t(count)*TriangleSize);
+	if (m_file->read(m_scratch.data(),m_scratch.size())!=static_cast<int32_t>(m_scratch.size()))
+		return 0u;
+	for (uint32_t i=0u; i<count; i++)
+		memcpy(outPositions+i*FloatsPerTriangle,m_scratch.data()+i*TriangleSize+sizeof(float)*3u,sizeof(float)*FloatsPerTriangle);
+	m_trianglesRead += count;
+	return count;
+}
+
+void CStreamingMeshProcessor::CBinarySTLSource::release()
+{
+	core::vector<uint8_t>().swap(m_scratch);
+}
+
+
+CStreamingMeshProcessor::CBinaryPLYSource::CBinaryPLYSource(core::smart_refctd_ptr<io::IReadFile>&& _file, const size_t _cacheByteSize) : m_file(std::move(_file)), m_cacheByteSize(_cacheByteSize)
+{
+	if (!m_file)
+		return;
+
+	struct SElement
+	{
+		std::string name;
+		uint32_t count;
+		//! of a record, if it has no lists
+		size_t size = 0ull;
+		bool hasLists = false;
+	};
+	core::vector<SElement> elements;
+	bool binary = false;
+	// whether x, y and z are float (1) or double (2)
+	uint32_t componentTypes[3] = {0u,0u,0u};
+	auto getTypeSize = [](const std::string& type) -> uint8_t
+	{
+		if (type=="char" || type=="int8" || type=="uchar" || type=="uint8")
+			return 1u;
+		if (type=="short" || type=="int16" || type=="ushort" || type=="uint16")
+			return 2u;
+		if (type=="int" || type=="int32" || type=="uint" || type=="uint32" || type=="float" || type=="float32")
+			return 4u;
+		if (type=="double" || type=="float64")
+			return 8u;
+		return 0u;
+	};
+
+	m_reader.init(m_file.get(),0ull,0x1ull<<12ull);
+	const char* begin;
+	const char* end;
+	if (!m_reader.readLine(begin,end) || std::string(begin,end)!="ply")
+		return;
+	size_t headerSize = 0ull;
+	while (!headerSize && m_reader.readLine(begin,end))
+	{
+		core::vector<std::string> tokens;
+		for (begin=skipWhitespace(begin,end); begin<end; begin=skipWhitespace(begin,end))
+		{
+			const char* tokenEnd = begin;
+			while (tokenEnd<end && !std::isspace(static_cast<unsigned char>(*tokenEnd)))
+				tokenEnd++;
+			tokens.emplace_back(begin,tokenEnd);
+			begin = tokenEnd;
+		}
+		if (tokens.empty())
+			continue;
+
+		if (tokens[0]=="format" && tokens.size()>1u)
+		{
+			binary = tokens[1]=="binary_little_endian" || tokens[1]=="binary_big_endian";
+			m_vertexLayout.bigEndian = tokens[1]=="binary_big_endian";
+		}
+		else if (tokens[0]=="element" && tokens.size()>2u)
+		{
+			elements.emplace_back();
+			elements.back().name = tokens[1];
+			elements.back().count = std::strtoul(tokens[2].c_str(),nullptr,10);
+		}
+		else if (tokens[0]=="property" && tokens.size()>2u)
+		{
+			if (elements.empty())
+				return;
+			SElement& element = elements.back();
+			if (tokens[1]=="list")
+			{
+				if (tokens.size()<5u)
+					return;
+				const SFaceProperty property = {getTypeSize(tokens[2]),getTypeSize(tokens[3]),tokens[4]=="vertex_indices" || tokens[4]=="vertex_index"};
+				if (!property.size || !property.itemSize)
+					return;
+				element.hasLists = true;
+				if (element.name=="face")
+					m_faceProperties.push_back(property);
+			}
+			else
+			{
+				const uint8_t size = getTypeSize(tokens[1]);
+				if (!size)
+					return;
+				if (element.name=="vertex" && tokens[2].size()==1u && tokens[2][0]>='x' && tokens[2][0]<='z')
+				{
+					const uint32_t component = tokens[2][0]-'x';
+					m_vertexLayout.componentOffsets[component] = element.size;
+					if (tokens[1]=="float" || tokens[1]=="float32")
+						componentTypes[component] = 1u;
+					else if (tokens[1]=="double" || tokens[1]=="float64")
+						componentTypes[component] = 2u;
+				}
+				if (element.name=="face")
+					m_faceProperties.push_back({size,0u,false});
+				element.size += size;
+			}
+		}
+		else if (tokens[0]=="end_header")
+			headerSize = m_reader.tell();
+	}
+	if (!headerSize || !binary)
+		return;
+	if (componentTypes[0]==0u || componentTypes[1]!=componentTypes[0] || componentTypes[2]!=componentTypes[0])
+		return;
+	m_vertexLayout.doublePrecision = componentTypes[0]==2u;
+	if (std::find_if(m_faceProperties.begin(),m_faceProperties.end(),[](const SFaceProperty& p) {return p.isVertexIndices;})==m_faceProperties.end())
+		return;
+
+	// the offsets of the vertices and faces can only be worked out if nothing in front of them has lists
+	size_t offset = headerSize;
+	bool foundVertices = false;
+	uint32_t faceCount = 0u;
+	for (const auto& element : elements)
+	{
+		if (element.name=="vertex")
+		{
+			if (element.hasLists)
+				return;
+			m_vertexLayout.offset = offset;
+			m_vertexLayout.vertexCount = element.count;
+			m_vertexLayout.stride = element.size;
+			foundVertices = true;
+		}
+		else if (element.name=="face")
+		{
+			m_faceOffset = offset;
+			faceCount = element.count;
+			break;
+		}
+		if (element.hasLists)
+			return;
+		offset += element.size*element.count;
+	}
+	if (!foundVertices || m_vertexLayout.offset+size_t(m_vertexLayout.vertexCount)*m_vertexLayout.stride>m_file->getSize())
+		return;
+
+	m_faceCount = faceCount;
+	reset();
+}
+
+bool CStreamingMeshProcessor::CBinaryPLYSource::reset()
+{
+	m_facesRead = 0u;
+	m_polygon.clear();
+	m_nextFanTriangle = 0u;
+	if (!isValid())
+		return false;
+	const size_t readBufferSize = core::min<size_t>(ReadBufferSize,m_cacheByteSize/4ull);
+	m_reader.init(m_file.get(),m_faceOffset,readBufferSize);
+	m_positions.init(m_file.get(),m_vertexLayout,m_cacheByteSize-readBufferSize);
+	return true;
+}
+
+bool CStreamingMeshProcessor::CBinaryPLYSource::readFace()
+{
+	m_polygon.clear();
+	for (const auto& property : m_faceProperties)
+	{
+		if (m_reader.ensure(property.size)<property.size)
+			return false;
+		if (!property.itemSize)
+		{
+			m_reader.consume(property.size);
+			continue;
+		}
+
+		const uint32_t count = readIndex(m_reader.data(),property.size,m_vertexLayout.bigEndian);
+		m_reader.consume(property.size);
+		const size_t listSize = size_t(count)*property.itemSize;
+		if (m_reader.ensure(listSize)<listSize)
+			return false;
+		if (property.isVertexIndices)
+		for (uint32_t i=0u; i<count; i++)
+			m_polygon.push_back(readIndex(m_reader.data()+i*property.itemSize,property.itemSize,m_vertexLayout.bigEndian));
+		m_reader.consume(listSize);
+	}
+	return true;
+}
+
+uint32_t CStreamingMeshProcessor::CBinaryPLYSource::read(float* outPositions, uint32_t maxTriangles)
+{
+	uint32_t count = 0u;
+	while (count<maxTriangles)
+	{
+		count += emitFan(m_positions,m_polygon,m_nextFanTriangle,outPositions+count*FloatsPerTriangle,maxTriangles-count);
+		if (count==maxTriangles || m_facesRead>=m_faceCount)
+			break;
+		if (!readFace())
+		{
+			os::Printer::log("CStreamingMeshProcessor: Binary PLY file "+std::string(m_file->getFileName().c_str())+" ends in the middle of its faces",ELL_ERROR);
+			m_polygon.clear();
+			m_facesRead = m_faceCount;
+			break;
+		}
+		m_facesRead++;
+		m_nextFanTriangle = 0u;
+	}
+	return count;
+}
+
+void CStreamingMeshProcessor::CBinaryPLYSource::release()
+{
+	m_reader.release();
+	m_positions.release();
+	core::vector<uint32_t>().swap(m_polygon);
+}
+
+
+CStreamingMeshProcessor::COBJSource::COBJSource(io::IFileSystem* _fs, core::smart_refctd_ptr<io::IReadFile>&& _file, const std::string& _scratchFilename, const size_t _cacheByteSize)
+	: m_file(std::move(_file)), m_scratchFilename(_scratchFilename), m_cacheByteSize(_cacheByteSize)
+{
+	if (!_fs || !m_file)
+		return;
+
+	// the positions get copied out first, so the faces can look them up by index without parsing the text again
+	{
+		auto positionsFile = core::smart_refctd_ptr<io::IWriteFile>(_fs->createAndWriteFile(m_scratchFilename.c_str()),core::dont_grab);
+		if (!positionsFile)
+			return;
+
+		constexpr size_t BatchFloats = (ReadBufferSize/sizeof(float))/3ull*3ull;
+		core::vector<float> pending;
+		pending.reserve(BatchFloats);
+		bool failed = false;
+		auto flush = [&]() -> void
+		{
+			const uint32_t byteSize = pending.size()*sizeof(float);
+			failed = failed || positionsFile->write(pending.data(),byteSize)!=static_cast<int32_t>(byteSize);
+			pending.clear();
+		};
+
+		m_reader.init(m_file.get(),0ull,ReadBufferSize);
+		for (const char *begin,*end; !failed && m_reader.readLine(begin,end);)
+		{
+			begin = skipWhitespace(begin,end);
+			if (!isStatement(begin,end,'v'))
+				continue;
+
+			for (uint32_t i=0u; i<3u; i++)
+			{
+				char* next;
+				const float component = std::strtof(begin,&next);
+				// a missing component would get parsed off the next line
+				if (next==begin || next>end)
+				{
+					os::Printer::log("CStreamingMeshProcessor: Malformed vertex position in "+std::string(m_file->getFileName().c_str()),ELL_ERROR);
+					failed = true;
+					break;
+				}
+				pending.push_back(component);
+				begin = next;
+			}
+			m_vertexCount++;
+			if (pending.size()>=BatchFloats)
+				flush();
+		}
+		if (!failed)
+			flush();
+		m_reader.release();
+		if (failed || !m_vertexCount)
+		{
+			positionsFile = nullptr;
+			std::error_code ec;
+			std::filesystem::remove(m_scratchFilename,ec);
+			return;
+		}
+	}
+
+	m_positionsFile = core::smart_refctd_ptr<io::IReadFile>(_fs->createAndOpenFile(m_scratchFilename.c_str()),core::dont_grab);
+	if (!m_positionsFile)
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_scratchFilename,ec);
+		return;
+	}
+	reset();
+}
+
+CStreamingMeshProcessor::COBJSource::~COBJSource()
+{
+	if (!m_positionsFile)
+		return;
+	m_positionsFile = nullptr;
+	std::error_code ec;
+	std::filesystem::remove(m_scratchFilename,ec);
+}
+
+bool CStreamingMeshProcessor::COBJSource::reset()
+{
+	m_verticesSeen = 0u;
+	m_polygon.clear();
+	m_nextFanTriangle = 0u;
+	if (!isValid())
+		return false;
+
+	CPositionPageCache::SLayout layout;
+	layout.vertexCount = m_vertexCount;
+	const size_t readBufferSize = core::min<size_t>(ReadBufferSize,m_cacheByteSize/4ull);
+	m_reader.init(m_file.get(),0ull,readBufferSize);
+	m_positions.init(m_positionsFile.get(),layout,m_cacheByteSize-readBufferSize);
+	return true;
+}
+
+bool CStreamingMeshProcessor::COBJSource::parseFace(const char* begin, const char* end)
+{
+	m_polygon.clear();
+	for (begin=skipWhitespace(begin,end); begin<end; begin=skipWhitespace(begin,end))
+	{
+		char* next;
+		const long index = std::strtol(begin,&next,10);
+		if (next==begin || next>end || index==0l)
+		{
+			m_polygon.clear();
+			return false;
+		}
+		// negative indices count back from the last position before the face
+		const int64_t vertex = index<0l ? int64_t(m_verticesSeen)+index:int64_t(index)-1ll;
+		if (vertex<0ll || vertex>=m_vertexCount)
+		{
+			m_polygon.clear();
+			return false;
+		}
+		m_polygon.push_back(vertex);
+
+		// skip the texture coordinate and normal indices
+		for (begin=next; begin<end && !std::isspace(static_cast<unsigned char>(*begin));)
+			begin++;
+	}
+	return true;
+}
+
+uint32_t CStreamingMeshProcessor::COBJSource::read(float* outPositions, uint32_t maxTriangles)
+{
+	uint32_t count = 0u;
+	while (count<maxTriangles)
+	{
+		count += emitFan(m_positions,m_polygon,m_nextFanTriangle,outPositions+count*FloatsPerTriangle,maxTriangles-count);
+		if (count==maxTriangles)
+			break;
+
+		const char* begin;
+		const char* end;
+		if (!m_reader.readLine(begin,end))
+			break;
+		begin = skipWhitespace(begin,end);
+		if (isStatement(begin,end,'v'))
+			m_verticesSeen++;
+		else if (isStatement(begin,end,'f'))
+		{
+			if (!parseFace(begin,end))
+				os::Printer::log("CStreamingMeshProcessor: Skipping a malformed face in "+std::string(m_file->getFileName().c_str()),ELL_WARNING);
+			m_nextFanTriangle = 0u;
+		}
+	}
+	return count;
+}
+
+void CStreamingMeshProcessor::COBJSource::release()
+{
+	m_reader.release();
+	m_positions.release();
+	core::vector<uint32_t>().swap(m_polygon);
+}
+
+
+std::unique_ptr<CStreamingMeshProcessor::ITriangleSource> CStreamingMeshProcessor::createFileSource(io::IFileSystem* _fs, const io::path& _filename, const std::string& _scratchDirectory, const size_t _cacheByteSize)
+{
+	if (!_fs)
+		return nullptr;
+	auto file = core::smart_refctd_ptr<io::IReadFile>(_fs->createAndOpenFile(_filename),core::dont_grab);
+	if (!file)
+		return nullptr;
+
+	if (core::hasFileExtension(_filename,"stl"))
+	{
+		auto source = std::make_unique<CBinarySTLSource>(std::move(file));
+		if (source->isValid())
+			return source;
+	}
+	else if (core::hasFileExtension(_filename,"ply"))
+	{
+		auto source = std::make_unique<CBinaryPLYSource>(std::move(file),_cacheByteSize);
+		if (source->isValid())
+			return source;
+	}
+	else if (core::hasFileExtension(_filename,"obj"))
+	{
+		const std::string name = std::filesystem::path(_filename.c_str()).filename().string();
+		const std::string scratchFilename = (std::filesystem::path(_scratchDirectory)/(name+".positions")).string();
+		auto source = std::make_unique<COBJSource>(_fs,std::move(file),scratchFilename,_cacheByteSize);
+		if (source->isValid())
+			return source;
+	}
+	return nullptr;
+}
+
+}
+}
@@ -5,10 +5,13 @@
 #include <sstream>
 #include <regex>
 #include <iterator>
+#include <execution>
+#include <numeric>
 
 #include "nbl/asset/utils/IGLSLCompiler.h"
 #include "nbl/asset/utils/shadercUtils.h"
 #include "nbl/asset/utils/CIncludeHandler.h"
+#include "nbl/asset/utils/CShaderIntrospector.h"
 
 #include "nbl/asset/utils/CGLSLVirtualTexturingBuiltinIncludeLoader.h"
 
@@ -21,7 +24,8 @@ namespace asset
 
 static constexpr shaderc_spirv_version TARGET_SPIRV_VERSION = shaderc_spirv_version_1_5;
 
-IGLSLCompiler::IGLSLCompiler(io::IFileSystem* _fs) : m_inclHandler(core::make_smart_refctd_ptr<CIncludeHandler>(_fs)), m_fs(_fs)
+IGLSLCompiler::IGLSLCompiler(io::IFileSystem* _fs) : m_inclHandler(core::make_smart_refctd_ptr<CIncludeHandler>(_fs)), m_fs(_fs),
+    m_resolvedIncludesCache(ResolvedIncludesCacheCapacity,ResolvedIncludesCacheByteCapacity)
 {
     m_inclHandler->addBuiltinIncludeLoader(core::make_smart_refctd_ptr<asset::CGLSLVirtualTexturingBuiltinIncludeLoader>(_fs));
 }
@@ -80,6 +84,138 @@ core::smart_refctd_ptr<ICPUShader> IGLSLCompiler::createSPIRVFromGLSL(io::IReadF
     return createSPIRVFromGLSL(glsl.c_str(), _stage, _entryPoint, _compilationId, _opt, _outAssembly);
 }
 
+core::vector<core::smart_refctd_ptr<ICPUShader>> IGLSLCompiler::createSPIRVFromGLSLBatch(const SBatchInput* _begin, const SBatchInput* _end, const ISPIRVOptimizer* _opt, CShaderIntrospector* _introspector, SBatchTimings* _outTimings) const
+{
+    using clock_t = std::chrono::steady_clock;
+    const auto batchStart = clock_t::now();
+
+    struct SUniqueInput
+    {
+        const SBatchInput* input;
+        std::string glsl;
+        core::smart_refctd_ptr<ICPUShader> shader;
+        std::chrono::nanoseconds preprocess, compile, optimize;
+    };
+    const uint32_t inputCount = std::distance(_begin,_end);
+    core::vector<SUniqueInput> uniqueInputs;
+    core::vector<uint32_t> inputToUnique(inputCount);
+    {
+        // everything which can change the SPIR-V, the compilation id is also the origin of relative `#include`s so it always counts
+        struct SKey
+        {
+            std::string_view glsl;
+            ISpecializedShader::E_SHADER_STAGE stage;
+            std::string_view entryPoint;
+            std::string_view compilationId;
+            bool genDebugInfo;
+
+            inline bool operator==(const SKey& other) const
+            {
+                return stage==other.stage && genDebugInfo==other.genDebugInfo && entryPoint==other.entryPoint && compilationId==other.compilationId && glsl==other.glsl;
+            }
+        };
+        struct SKeyHash
+        {
+            inline size_t operator()(const SKey& key) const
+            {
+                std::hash<std::string_view> hasher;
+                size_t retval = hasher(key.glsl);
+                retval ^= hasher(key.entryPoint)+0x9e3779b9ull+(retval<<6)+(retval>>2);
+                retval ^= hasher(key.compilationId)+0x9e3779b9ull+(retval<<6)+(retval>>2);
+                return retval^((static_cast<size_t>(key.stage)<<1ull)|key.genDebugInfo);
+            }
+        };
+
+        // the defines go into the source first, so that differently spelled but identical sources still match
+        uniqueInputs.reserve(inputCount);
+        core::vector<std::string> sources(inputCount);
+        core::unordered_map<SKey,uint32_t,SKeyHash> keyToUnique;
+        for (uint32_t i=0u; i<inputCount; i++)
+        {
+            const SBatchInput& input = _begin[i];
+            sources[i] = input.glslCode;
+            IShader::insertGLSLDefines(sources[i],input.defines.data(),input.defines.data()+input.defines.size());
+
+            const SKey key = {sources[i],input.stage,input.entryPoint,input.compilationId,input.genDebugInfo};
+            auto found = keyToUnique.find(key);
+            if (found!=keyToUnique.end())
+            {
+                inputToUnique[i] = found->second;
+                continue;
+            }
+            inputToUnique[i] = uniqueInputs.size();
+            keyToUnique.emplace(key,uniqueInputs.size());
+            uniqueInputs.push_back({&input,{},nullptr,{},{},{}});
+        }
+        // `sources` and the keys viewing them die here, so move them over only after the deduplication is done
+        for (uint32_t i=0u; i<inputCount; i++)
+        if (uniqueInputs[inputToUnique[i]].input==_begin+i)
+            uniqueInputs[inputToUnique[i]].glsl = std::move(sources[i]);
+    }
+
+    core::vector<uint32_t> uniqueIxs(uniqueInputs.size());
+    std::iota(uniqueIxs.begin(),uniqueIxs.end(),0u);
+    std::for_each(std::execution::par,uniqueIxs.begin(),uniqueIxs.end(),[&](const uint32_t i) -> void
+    {
+        auto& unique = uniqueInputs[i];
+        const SBatchInput& input = *unique.input;
+
+        auto start = clock_t::now();
+        auto resolved = resolveIncludeDirectives(std::move(unique.glsl),input.stage,input.compilationId.c_str());
+        auto end = clock_t::now();
+        unique.preprocess = end-start;
+        if (!resolved)
+            return;
+
+        start = end;
+        const char* glsl = reinterpret_cast<const char*>(resolved->getSPVorGLSL()->getPointer());
+        auto spirv = compileSPIRVFromGLSL(glsl,input.stage,input.entryPoint.c_str(),input.compilationId.c_str(),input.genDebugInfo);
+        end = clock_t::now();
+        unique.compile = end-start;
+        if (!spirv)
+            return;
+
+        if (_opt)
+        {
+            start = end;
+            spirv = _opt->optimize(spirv.get());
+            unique.optimize = clock_t::now()-start;
+            if (!spirv)
+                return;
+        }
+        unique.shader = core::make_smart_refctd_ptr<ICPUShader>(std::move(spirv));
+    });
+
+    SBatchTimings timings;
+    timings.inputCount = inputCount;
+    timings.uniqueCount = uniqueInputs.size();
+    for (const auto& unique : uniqueInputs)
+    {
+        timings.preprocess += unique.preprocess;
+        timings.compile += unique.compile;
+        timings.optimize += unique.optimize;
+    }
+
+    // the introspector's cache isn't safe to use from many threads
+    if (_introspector)
+    {
+        const auto start = clock_t::now();
+        for (const auto& unique : uniqueInputs)
+        if (unique.shader)
+            _introspector->introspect(unique.shader.get(),{unique.input->stage,unique.input->entryPoint,nullptr,unique.input->compilationId});
+        timings.introspect = clock_t::now()-start;
+    }
+
+    core::vector<core::smart_refctd_ptr<ICPUShader>> retval(inputCount);
+    for (uint32_t i=0u; i<inputCount; i++)
+        retval[i] = uniqueInputs[inputToUnique[i]].shader;
+
+    timings.total = clock_t::now()-batchStart;
+    if (_outTimings)
+        *_outTimings = timings;
+    return retval;
+}
+
 namespace impl
 {
     //string to be replaced with all "#" except those in "#include"
@@ -92,21 +228,22 @@ namespace impl
     static void disableAllDirectivesExceptIncludes(std::string& _glslCode)
     {
         // TODO: replace this with a proper-ish proprocessor and includer one day
-        std::regex directive("#(?!(include|version|pragma shader_stage|line))");//all # not followed by "include" nor "version" nor "pragma shader_stage"
+        // compiled once, this runs for every included file
+        static const std::regex directive("#(?!(include|version|pragma shader_stage|line))");//all # not followed by "include" nor "version" nor "pragma shader_stage"
         //`#pragma shader_stage(...)` is needed for determining shader stage when `_stage` param of IGLSLCompiler functions is set to ESS_UNKNOWN
         auto result = std::regex_replace(_glslCode,directive,PREPROC_DIRECTIVE_DISABLER);
-        std::regex glMacro("[ \t\r\n\v\f]GL_");
+        static const std::regex glMacro("[ \t\r\n\v\f]GL_");
         result = std::regex_replace(result, glMacro, PREPROC_GL__DISABLER);
-        std::regex lineContinuation("\\\\[ \t\r\n\v\f]*\n");
+        static const std::regex lineContinuation("\\\\[ \t\r\n\v\f]*\n");
         _glslCode = std::regex_replace(result, lineContinuation, PREPROC_LINE_CONTINUATION_DISABLER);
     }
     static void reenableDirectives(std::string& _glslCode)
     {
-        std::regex lineContinuation(PREPROC_LINE_CONTINUATION_ENABLER);
+        static const std::regex lineContinuation(PREPROC_LINE_CONTINUATION_ENABLER);
         auto result = std::regex_replace(_glslCode, lineContinuation, " \\");
-        std::regex glMacro(PREPROC_GL__ENABLER);
+        static const std::regex glMacro(PREPROC_GL__ENABLER);
         result = std::regex_replace(result,glMacro," GL_");
-        std::regex directive(PREPROC_DIRECTIVE_ENABLER);
+        static const std::regex directive(PREPROC_DIRECTIVE_ENABLER);
         _glslCode = std::regex_replace(result, directive, "#");
     }
     static std::string encloseWithinExtraInclGuards(std::string&& _glslCode, uint32_t _maxInclusions, const char* _identifier)
@@ -156,10 +293,14 @@ namespace impl
         const asset::IIncludeHandler* m_inclHandler;
         const io::IFileSystem* m_fs;
         const uint32_t m_maxInclCnt;
+        bool m_includedFromFilesystem = false;
 
     public:
         Includer(const asset::IIncludeHandler* _inclhndlr, const io::IFileSystem* _fs, uint32_t _maxInclCnt) : m_inclHandler(_inclhndlr), m_fs(_fs), m_maxInclCnt{_maxInclCnt} {}
 
+        //! whether anything got (or failed to get) included from outside of the builtins
+        bool includedFromFilesystem() const { return m_includedFromFilesystem; }
+
         //_requesting_source in top level #include's is what shaderc::Compiler's compiling functions get as `input_file_name` parameter
         //so in order for properly working relative #include's (""-type) `input_file_name` has to be path to file from which the GLSL source really come from
         //or at least path to not necessarily existing file whose directory will be base for ""-type #include's resolution
@@ -186,7 +327,10 @@ namespace impl
 
             io::path name = (_type == shaderc_include_type_relative) ? (relDir + _requested_source) : (_requested_source);
             if (!reqBuiltin)
+            {
                 name = m_fs->getAbsolutePath(name);
+                m_includedFromFilesystem = true;
+            }
 
             if (_type == shaderc_include_type_relative)
                 res_str = m_inclHandler->getIncludeRelative(_requested_source, relDir.c_str());
@@ -230,13 +374,30 @@ namespace impl
 
 core::smart_refctd_ptr<ICPUShader> IGLSLCompiler::resolveIncludeDirectives(std::string&& glslCode, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath, uint32_t _maxSelfInclusionCnt) const
 {
-    impl::disableAllDirectivesExceptIncludes(glslCode);//all "#", except those in "#include"/"#version"/"#pragma shader_stage(...)", replaced with `PREPROC_DIRECTIVE_DISABLER`
+    SResolvedIncludesKey key = {std::move(glslCode),_originFilepath ? _originFilepath:"",_stage,_maxSelfInclusionCnt};
+    // results from before a builtin include loader got added might resolve differently now
+    const uint32_t revision = m_inclHandler->getBuiltinIncludeLoadersRevision();
+    {
+        core::smart_refctd_ptr<ICPUShader> cached;
+        m_resolvedIncludesCache.apply(key,[&cached,revision](const SResolvedIncludes& resolved) -> void
+        {
+            if (resolved.builtinIncludeLoadersRevision==revision)
+                cached = core::make_smart_refctd_ptr<ICPUShader>(resolved.glslCode.c_str());
+        });
+        if (cached)
+            return cached;
+    }
+
+    std::string glsl = key.glslCode;
+    impl::disableAllDirectivesExceptIncludes(glsl);//all "#", except those in "#include"/"#version"/"#pragma shader_stage(...)", replaced with `PREPROC_DIRECTIVE_DISABLER`
     shaderc::Compiler comp;
     shaderc::CompileOptions options;
     options.SetTargetSpirv(TARGET_SPIRV_VERSION);
-    options.SetIncluder(std::make_unique<impl::Includer>(m_inclHandler.get(), m_fs, _maxSelfInclusionCnt+1u));//custom #include handler
+    auto includer = std::make_unique<impl::Includer>(m_inclHandler.get(), m_fs, _maxSelfInclusionCnt+1u);
+    const impl::Includer* includerPtr = includer.get();
+    options.SetIncluder(std::move(includer));//custom #include handler
     const shaderc_shader_kind stage = _stage==ISpecializedShader::ESS_UNKNOWN ? shaderc_glsl_infer_from_source : ESStoShadercEnum(_stage);
-    auto res = comp.PreprocessGlsl(glslCode, stage, _originFilepath, options);
+    auto res = comp.PreprocessGlsl(glsl, stage, _originFilepath, options);
 
     if (res.GetCompilationStatus() != shaderc_compilation_status_success) {
         os::Printer::log(res.GetErrorMessage(), ELL_ERROR);
@@ -246,7 +407,13 @@ core::smart_refctd_ptr<ICPUShader> IGLSLCompiler::resolveIncludeDirectives(std::
     std::string res_str(res.cbegin(), std::distance(res.cbegin(),res.cend()));
     impl::reenableDirectives(res_str);
 
-    return core::make_smart_refctd_ptr<ICPUShader>(res_str.c_str());
+    auto retval = core::make_smart_refctd_ptr<ICPUShader>(res_str.c_str());
+    if (!includerPtr->includedFromFilesystem())
+    {
+        const size_t byteSize = key.glslCode.size()+key.originFilepath.size()+res_str.size();
+        m_resolvedIncludesCache.insert(std::move(key),SResolvedIncludes{std::move(res_str),revision},byteSize);
+    }
+    return retval;
 }
 
 core::smart_refctd_ptr<ICPUShader> IGLSLCompiler::resolveIncludeDirectives(io::IReadFile* _sourcefile, ISpecializedShader::E_SHADER_STAGE _stage, const char* _originFilepath, uint32_t _maxSelfInclusionCnt) const
@@ -0,0 +1,212 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/core.h"
+#include "nbl/core/math/matrixSIMDBatch.h"
+
+#include "matrixSIMDBatchKernels.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <atomic>
+
+using namespace nbl;
+using namespace core;
+
+namespace nbl
+{
+namespace core
+{
+namespace impl
+{
+namespace
+{
+
+struct SSELane
+{
+	using type = __m128;
+	using mask_t = __m128;
+	static constexpr size_t width = 4ull;
+
+	static inline type load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void store(float* p, type v) { _mm_storeu_ps(p,v); }
+	static inline type set1(float f) { return _mm_set1_ps(f); }
+	static inline type zero() { return _mm_setzero_ps(); }
+	static inline type add(type a, type b) { return _mm_add_ps(a,b); }
+	static inline type sub(type a, type b) { return _mm_sub_ps(a,b); }
+	static inline type mul(type a, type b) { return _mm_mul_ps(a,b); }
+	static inline type fmadd(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a,b),c); }
+	static inline type div(type a, type b) { return _mm_div_ps(a,b); }
+	static inline type sqrt(type a) { return _mm_sqrt_ps(a); }
+	static inline type abs(type a) { return _mm_andnot_ps(_mm_set1_ps(-0.f),a); }
+	static inline mask_t greater(type a, type b) { return _mm_cmpgt_ps(a,b); }
+	static inline type select(mask_t m, type a, type b) { return _mm_or_ps(_mm_and_ps(m,a),_mm_andnot_ps(m,b)); }
+	static inline uint32_t bits(mask_t m) { return _mm_movemask_ps(m); }
+};
+
+}
+
+const SMatrixBatchKernelTable matrixBatchKernelsSSE = Kernels<SSELane>::getTable();
+
+}
+}
+}
+
+
+static matrixSIMDBatch::E_ISA detectISA()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info,0);
+	if (info[0]<7)
+		return matrixSIMDBatch::EI_SSE;
+
+	__cpuid(info,1);
+	const bool osxsave = info[2]&(0x1<<27);
+	const bool avx = info[2]&(0x1<<28);
+	const bool fma = info[2]&(0x1<<12);
+	if (!osxsave || !avx)
+		return matrixSIMDBatch::EI_SSE;
+	// OS has to save the YMM (and ZMM) state on context switch
+	const uint64_t xcr0 = _xgetbv(0);
+	if ((xcr0&0x6ull)!=0x6ull)
+		return matrixSIMDBatch::EI_SSE;
+
+	__cpuidex(info,7,0);
+	const bool avx2 = info[1]&(0x1<<5);
+	const bool avx512f = info[1]&(0x1<<16);
+	if (avx512f && (xcr0&0xe6ull)==0xe6ull)
+		return matrixSIMDBatch::EI_AVX512;
+	if (avx2 && fma)
+		return matrixSIMDBatch::EI_AVX2;
+#elif defined(__GNUC__) || defined(__clang__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return matrixSIMDBatch::EI_AVX512;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return matrixSIMDBatch::EI_AVX2;
+#endif
+	return matrixSIMDBatch::EI_SSE;
+}
+
+// function local statics so that the batch functions are safe to use during static initialization
+static std::atomic<matrixSIMDBatch::E_ISA>& currentISA()
+{
+	static std::atomic<matrixSIMDBatch::E_ISA> isa(matrixSIMDBatch::getSupportedISA());
+	return isa;
+}
+
+static const core::impl::SMatrixBatchKernelTable& getKernels()
+{
+	switch (currentISA().load(std::memory_order_relaxed))
+	{
+		case matrixSIMDBatch::EI_AVX512:
+			return core::impl::matrixBatchKernelsAVX512;
+		case matrixSIMDBatch::EI_AVX2:
+			return core::impl::matrixBatchKernelsAVX2;
+		default:
+			break;
+	}
+	return core::impl::matrixBatchKernelsSSE;
+}
+
+
+matrixSIMDBatch::E_ISA matrixSIMDBatch::getSupportedISA()
+{
+	static const E_ISA supported = detectISA();
+	return supported;
+}
+
+matrixSIMDBatch::E_ISA matrixSIMDBatch::getISA()
+{
+	return currentISA().load(std::memory_order_relaxed);
+}
+
+matrixSIMDBatch::E_ISA matrixSIMDBatch::setISA(E_ISA _isa)
+{
+	const E_ISA isa = _isa<getSupportedISA() ? _isa:getSupportedISA();
+	currentISA().store(isa,std::memory_order_relaxed);
+	return isa;
+}
+
+
+void matrixSIMDBatch::transformPoints(const matrix3x4SIMD& _mtx, points_t _out, const_points_t _in, size_t _count)
+{
+	getKernels().transformPoints(_mtx.pointer(),_out.comp,_in.comp,_count);
+}
+
+void matrixSIMDBatch::transformNormals(const matrix3x4SIMD& _mtx, points_t _out, const_points_t _in, size_t _count, bool _renormalize)
+{
+	matrix3x4SIMD normalMatrix;
+	if (!_mtx.getSub3x3InverseTranspose(normalMatrix))
+		normalMatrix = _mtx.getSub3x3TransposeCofactors();
+	getKernels().transformVectors(normalMatrix.pointer(),_out.comp,_in.comp,_count,_renormalize);
+}
+
+void matrixSIMDBatch::transformBoxes(const matrix3x4SIMD& _mtx, boxes_t _out, const_boxes_t _in, size_t _count)
+{
+	getKernels().transformBoxes(_mtx.pointer(),_out.comp,_in.comp,_count);
+}
+
+void matrixSIMDBatch::transformPoints(const matrix4SIMD& _mtx, homogeneous_points_t _out, const_points_t _in, size_t _count)
+{
+	getKernels().transformPointsProjective(_mtx.pointer(),_out.comp,_in.comp,_count);
+}
+
+void matrixSIMDBatch::concatenateBFollowedByA(affine_matrices_t _out, const_affine_matrices_t _a, const_affine_matrices_t _b, size_t _count)
+{
+	getKernels().concatenateAffine(_out.comp,_a.comp,_b.comp,_count);
+}
+
+void matrixSIMDBatch::concatenateBFollowedByA(matrices_t _out, const_matrices_t _a, const_matrices_t _b, size_t _count)
+{
+	getKernels().concatenateProjective(_out.comp,_a.comp,_b.comp,_count);
+}
+
+size_t matrixSIMDBatch::getInverse(affine_matrices_t _out, uint8_t* _valid, const_affine_matrices_t _in, size_t _count)
+{
+	return getKernels().invertAffine(_out.comp,_valid,_in.comp,_count);
+}
+
+
+void matrixSIMDBatch::toSoA(affine_matrices_t _out, const matrix3x4SIMD* _in, size_t _count)
+{
+	for (size_t n=0ull; n<_count; n++)
+	{
+		const float* src = _in[n].pointer();
+		for (uint32_t c=0u; c<affine_matrices_t::Components; c++)
+			_out.comp[c][n] = src[c];
+	}
+}
+
+void matrixSIMDBatch::fromSoA(matrix3x4SIMD* _out, const_affine_matrices_t _in, size_t _count)
+{
+	for (size_t n=0ull; n<_count; n++)
+	{
+		float* dst = _out[n].pointer();
+		for (uint32_t c=0u; c<const_affine_matrices_t::Components; c++)
+			dst[c] = _in.comp[c][n];
+	}
+}
+
+void matrixSIMDBatch::toSoA(matrices_t _out, const matrix4SIMD* _in, size_t _count)
+{
+	for (size_t n=0ull; n<_count; n++)
+	{
+		const float* src = _in[n].pointer();
+		for (uint32_t c=0u; c<matrices_t::Components; c++)
+			_out.comp[c][n] = src[c];
+	}
+}
+
+void matrixSIMDBatch::fromSoA(matrix4SIMD* _out, const_matrices_t _in, size_t _count)
+{
+	for (size_t n=0ull; n<_count; n++)
+	{
+		float* dst = _out[n].pointer();
+		for (uint32_t c=0u; c<const_matrices_t::Components; c++)
+			dst[c] = _in.comp[c][n];
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Compiled with AVX2 and FMA enabled, only ever called after a runtime CPU check, do not include engine headers here!
+#include <immintrin.h>
+
+#include "matrixSIMDBatchKernels.h"
+
+namespace nbl
+{
+namespace core
+{
+namespace impl
+{
+namespace
+{
+
+struct AVX2Lane
+{
+	using type = __m256;
+	using mask_t = __m256;
+	static constexpr size_t width = 8ull;
+
+	static inline type load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void store(float* p, type v) { _mm256_storeu_ps(p,v); }
+	static inline type set1(float f) { return _mm256_set1_ps(f); }
+	static inline type zero() { return _mm256_setzero_ps(); }
+	static inline type add(type a, type b) { return _mm256_add_ps(a,b); }
+	static inline type sub(type a, type b) { return _mm256_sub_ps(a,b); }
+	static inline type mul(type a, type b) { return _mm256_mul_ps(a,b); }
+	static inline type fmadd(type a, type b, type c) { return _mm256_fmadd_ps(a,b,c); }
+	static inline type div(type a, type b) { return _mm256_div_ps(a,b); }
+	static inline type sqrt(type a) { return _mm256_sqrt_ps(a); }
+	static inline type abs(type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f),a); }
+	static inline mask_t greater(type a, type b) { return _mm256_cmp_ps(a,b,_CMP_GT_OQ); }
+	static inline type select(mask_t m, type a, type b) { return _mm256_blendv_ps(b,a,m); }
+	static inline uint32_t bits(mask_t m) { return _mm256_movemask_ps(m); }
+};
+
+}
+
+const SMatrixBatchKernelTable matrixBatchKernelsAVX2 = Kernels<AVX2Lane>::getTable();
+
+}
+}
+}
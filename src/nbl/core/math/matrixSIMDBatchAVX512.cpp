@@ -0,0 +1,47 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Compiled with AVX-512F enabled, only ever called after a runtime CPU check, do not include engine headers here!
+#include <immintrin.h>
+
+#include "matrixSIMDBatchKernels.h"
+
+namespace nbl
+{
+namespace core
+{
+namespace impl
+{
+namespace
+{
+
+struct AVX512Lane
+{
+	using type = __m512;
+	using mask_t = __mmask16;
+	static constexpr size_t width = 16ull;
+
+	static inline type load(const float* p) { return _mm512_loadu_ps(p); }
+	static inline void store(float* p, type v) { _mm512_storeu_ps(p,v); }
+	static inline type set1(float f) { return _mm512_set1_ps(f); }
+	static inline type zero() { return _mm512_setzero_ps(); }
+	static inline type add(type a, type b) { return _mm512_add_ps(a,b); }
+	static inline type sub(type a, type b) { return _mm512_sub_ps(a,b); }
+	static inline type mul(type a, type b) { return _mm512_mul_ps(a,b); }
+	static inline type fmadd(type a, type b, type c) { return _mm512_fmadd_ps(a,b,c); }
+	static inline type div(type a, type b) { return _mm512_div_ps(a,b); }
+	static inline type sqrt(type a) { return _mm512_sqrt_ps(a); }
+	static inline type abs(type a) { return _mm512_abs_ps(a); }
+	static inline mask_t greater(type a, type b) { return _mm512_cmp_ps_mask(a,b,_CMP_GT_OQ); }
+	static inline type select(mask_t m, type a, type b) { return _mm512_mask_blend_ps(m,b,a); }
+	static inline uint32_t bits(mask_t m) { return m; }
+};
+
+}
+
+const SMatrixBatchKernelTable matrixBatchKernelsAVX512 = Kernels<AVX512Lane>::getTable();
+
+}
+}
+}
@@ -0,0 +1,344 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_MATRIX_SIMD_BATCH_KERNELS_H_INCLUDED__
+#define __NBL_CORE_MATRIX_SIMD_BATCH_KERNELS_H_INCLUDED__
+
+// This header gets compiled with different instruction set flags per translation unit,
+// so it must never pull in any engine header with inline functions (ODR would let the linker pick an AVX-512 copy for everyone).
+#include <cstddef>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+
+namespace nbl
+{
+namespace core
+{
+namespace impl
+{
+
+struct SMatrixBatchKernelTable
+{
+	void (*transformPoints)(const float* _mtx, float* const* _out, const float* const* _in, size_t _count);
+	void (*transformVectors)(const float* _mtx, float* const* _out, const float* const* _in, size_t _count, bool _renormalize);
+	void (*transformBoxes)(const float* _mtx, float* const* _out, const float* const* _in, size_t _count);
+	void (*transformPointsProjective)(const float* _mtx, float* const* _out, const float* const* _in, size_t _count);
+	void (*concatenateAffine)(float* const* _out, const float* const* _a, const float* const* _b, size_t _count);
+	void (*concatenateProjective)(float* const* _out, const float* const* _a, const float* const* _b, size_t _count);
+	size_t (*invertAffine)(float* const* _out, uint8_t* _valid, const float* const* _in, size_t _count);
+};
+
+extern const SMatrixBatchKernelTable matrixBatchKernelsSSE;
+extern const SMatrixBatchKernelTable matrixBatchKernelsAVX2;
+extern const SMatrixBatchKernelTable matrixBatchKernelsAVX512;
+
+// Everything below has internal linkage, every TU gets its own copy compiled for its own ISA.
+namespace
+{
+
+/*
+	A Lane type provides:
+		`type`, `mask_t`, `width`,
+		`load`, `store`, `set1`, `zero`,
+		`add`, `sub`, `mul`, `fmadd` (a*b+c), `div`, `sqrt`, `abs`,
+		`greater`, `select` (m ? a:b), `bits` (one bit per lane).
+*/
+struct ScalarLane
+{
+	using type = float;
+	using mask_t = bool;
+	static constexpr size_t width = 1ull;
+
+	static inline type load(const float* p) { return *p; }
+	static inline void store(float* p, type v) { *p = v; }
+	static inline type set1(float f) { return f; }
+	static inline type zero() { return 0.f; }
+	static inline type add(type a, type b) { return a+b; }
+	static inline type sub(type a, type b) { return a-b; }
+	static inline type mul(type a, type b) { return a*b; }
+	static inline type fmadd(type a, type b, type c) { return a*b+c; }
+	static inline type div(type a, type b) { return a/b; }
+	static inline type sqrt(type a) { return std::sqrt(a); }
+	static inline type abs(type a) { return a<0.f ? (-a):a; }
+	static inline mask_t greater(type a, type b) { return a>b; }
+	static inline type select(mask_t m, type a, type b) { return m ? a:b; }
+	static inline uint32_t bits(mask_t m) { return m ? 1u:0u; }
+};
+
+template<class L>
+struct Kernels
+{
+	using T = typename L::type;
+
+	// each `*_impl` processes whole `L::width` blocks starting at `_begin` and returns where it stopped
+
+	static inline size_t transformPoints_impl(const float* _mtx, float* const* _out, const float* const* _in, size_t _begin, size_t _count)
+	{
+		T m[12];
+		for (auto i=0u; i<12u; i++)
+			m[i] = L::set1(_mtx[i]);
+
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			const T x = L::load(_in[0]+n);
+			const T y = L::load(_in[1]+n);
+			const T z = L::load(_in[2]+n);
+			for (auto r=0u; r<3u; r++)
+				L::store(_out[r]+n,L::fmadd(m[r*4u+0u],x,L::fmadd(m[r*4u+1u],y,L::fmadd(m[r*4u+2u],z,m[r*4u+3u]))));
+		}
+		return n;
+	}
+
+	static inline size_t transformVectors_impl(const float* _mtx, float* const* _out, const float* const* _in, size_t _begin, size_t _count, bool _renormalize)
+	{
+		T m[9];
+		for (auto r=0u; r<3u; r++)
+		for (auto c=0u; c<3u; c++)
+			m[r*3u+c] = L::set1(_mtx[r*4u+c]);
+
+		const T zero = L::zero();
+		const T one = L::set1(1.f);
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			const T x = L::load(_in[0]+n);
+			const T y = L::load(_in[1]+n);
+			const T z = L::load(_in[2]+n);
+			T res[3];
+			for (auto r=0u; r<3u; r++)
+				res[r] = L::fmadd(m[r*3u+0u],x,L::fmadd(m[r*3u+1u],y,L::mul(m[r*3u+2u],z)));
+			if (_renormalize)
+			{
+				const T lenSq = L::fmadd(res[0],res[0],L::fmadd(res[1],res[1],L::mul(res[2],res[2])));
+				// leave zero length vectors alone
+				const T rcpLen = L::select(L::greater(lenSq,zero),L::div(one,L::sqrt(lenSq)),zero);
+				for (auto r=0u; r<3u; r++)
+					res[r] = L::mul(res[r],rcpLen);
+			}
+			for (auto r=0u; r<3u; r++)
+				L::store(_out[r]+n,res[r]);
+		}
+		return n;
+	}
+
+	static inline size_t transformBoxes_impl(const float* _mtx, float* const* _out, const float* const* _in, size_t _begin, size_t _count)
+	{
+		// center-extent form, the extent transforms by the absolute value of the matrix
+		T m[12], absM[9];
+		for (auto r=0u; r<3u; r++)
+		for (auto c=0u; c<4u; c++)
+		{
+			m[r*4u+c] = L::set1(_mtx[r*4u+c]);
+			if (c<3u)
+				absM[r*3u+c] = L::set1(ScalarLane::abs(_mtx[r*4u+c]));
+		}
+
+		const T half = L::set1(0.5f);
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			T center[3], extent[3];
+			for (auto c=0u; c<3u; c++)
+			{
+				const T minV = L::load(_in[c]+n);
+				const T maxV = L::load(_in[c+3u]+n);
+				center[c] = L::mul(L::add(minV,maxV),half);
+				extent[c] = L::mul(L::sub(maxV,minV),half);
+			}
+			T newCenter[3], newExtent[3];
+			for (auto r=0u; r<3u; r++)
+			{
+				newCenter[r] = L::fmadd(m[r*4u+0u],center[0],L::fmadd(m[r*4u+1u],center[1],L::fmadd(m[r*4u+2u],center[2],m[r*4u+3u])));
+				newExtent[r] = L::fmadd(absM[r*3u+0u],extent[0],L::fmadd(absM[r*3u+1u],extent[1],L::mul(absM[r*3u+2u],extent[2])));
+			}
+			for (auto r=0u; r<3u; r++)
+			{
+				L::store(_out[r]+n,L::sub(newCenter[r],newExtent[r]));
+				L::store(_out[r+3u]+n,L::add(newCenter[r],newExtent[r]));
+			}
+		}
+		return n;
+	}
+
+	static inline size_t transformPointsProjective_impl(const float* _mtx, float* const* _out, const float* const* _in, size_t _begin, size_t _count)
+	{
+		T m[16];
+		for (auto i=0u; i<16u; i++)
+			m[i] = L::set1(_mtx[i]);
+
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			const T x = L::load(_in[0]+n);
+			const T y = L::load(_in[1]+n);
+			const T z = L::load(_in[2]+n);
+			for (auto r=0u; r<4u; r++)
+				L::store(_out[r]+n,L::fmadd(m[r*4u+0u],x,L::fmadd(m[r*4u+1u],y,L::fmadd(m[r*4u+2u],z,m[r*4u+3u]))));
+		}
+		return n;
+	}
+
+	static inline size_t concatenateAffine_impl(float* const* _out, const float* const* _a, const float* const* _b, size_t _begin, size_t _count)
+	{
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			T a[12], b[12];
+			for (auto i=0u; i<12u; i++)
+			{
+				a[i] = L::load(_a[i]+n);
+				b[i] = L::load(_b[i]+n);
+			}
+			// implicit last row of (0,0,0,1)
+			for (auto r=0u; r<3u; r++)
+			for (auto c=0u; c<4u; c++)
+			{
+				T res = L::fmadd(a[r*4u+0u],b[c],L::fmadd(a[r*4u+1u],b[4u+c],L::mul(a[r*4u+2u],b[8u+c])));
+				if (c==3u)
+					res = L::add(res,a[r*4u+3u]);
+				L::store(_out[r*4u+c]+n,res);
+			}
+		}
+		return n;
+	}
+
+	static inline size_t concatenateProjective_impl(float* const* _out, const float* const* _a, const float* const* _b, size_t _begin, size_t _count)
+	{
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			// need all inputs in registers before any store in case of aliasing, too many for one go so do it row by row of `a`
+			T b[16];
+			for (auto i=0u; i<16u; i++)
+				b[i] = L::load(_b[i]+n);
+			T res[16];
+			for (auto r=0u; r<4u; r++)
+			{
+				const T a0 = L::load(_a[r*4u+0u]+n);
+				const T a1 = L::load(_a[r*4u+1u]+n);
+				const T a2 = L::load(_a[r*4u+2u]+n);
+				const T a3 = L::load(_a[r*4u+3u]+n);
+				for (auto c=0u; c<4u; c++)
+					res[r*4u+c] = L::fmadd(a0,b[c],L::fmadd(a1,b[4u+c],L::fmadd(a2,b[8u+c],L::mul(a3,b[12u+c]))));
+			}
+			for (auto i=0u; i<16u; i++)
+				L::store(_out[i]+n,res[i]);
+		}
+		return n;
+	}
+
+	static inline size_t invertAffine_impl(float* const* _out, uint8_t* _valid, const float* const* _in, size_t _begin, size_t _count, size_t& _validCount)
+	{
+		const T zero = L::zero();
+		const T one = L::set1(1.f);
+		const T minDet = L::set1(FLT_MIN);
+		size_t n = _begin;
+		for (; n+L::width<=_count; n+=L::width)
+		{
+			T m[12];
+			for (auto i=0u; i<12u; i++)
+				m[i] = L::load(_in[i]+n);
+			// rows of the transposed cofactor matrix, same as `matrix3x4SIMD::getSub3x3TransposeCofactors`
+			auto cross = [&](uint32_t r0, uint32_t r1, T* out)
+			{
+				out[0] = L::sub(L::mul(m[r0*4u+1u],m[r1*4u+2u]),L::mul(m[r0*4u+2u],m[r1*4u+1u]));
+				out[1] = L::sub(L::mul(m[r0*4u+2u],m[r1*4u+0u]),L::mul(m[r0*4u+0u],m[r1*4u+2u]));
+				out[2] = L::sub(L::mul(m[r0*4u+0u],m[r1*4u+1u]),L::mul(m[r0*4u+1u],m[r1*4u+0u]));
+			};
+			T cof[3][3];
+			cross(1u,2u,cof[0]);
+			cross(2u,0u,cof[1]);
+			cross(0u,1u,cof[2]);
+			const T det = L::fmadd(m[0],cof[0][0],L::fmadd(m[1],cof[0][1],L::mul(m[2],cof[0][2])));
+			const auto valid = L::greater(L::abs(det),minDet);
+			// singular matrices come out as zero
+			const T rcpDet = L::select(valid,L::div(one,det),zero);
+
+			const uint32_t validBits = L::bits(valid);
+			for (size_t i=0u; i<L::width; i++)
+			{
+				const uint8_t isValid = (validBits>>i)&0x1u;
+				_validCount += isValid;
+				if (_valid)
+					_valid[n+i] = isValid;
+			}
+
+			// inverse of the 3x3 is the transpose of the cofactors
+			T inv[12];
+			for (auto r=0u; r<3u; r++)
+			{
+				for (auto c=0u; c<3u; c++)
+					inv[r*4u+c] = L::mul(cof[c][r],rcpDet);
+				// inverse post-translation
+				inv[r*4u+3u] = L::sub(zero,L::fmadd(inv[r*4u+0u],m[3],L::fmadd(inv[r*4u+1u],m[7],L::mul(inv[r*4u+2u],m[11]))));
+			}
+			for (auto i=0u; i<12u; i++)
+				L::store(_out[i]+n,inv[i]);
+		}
+		return n;
+	}
+
+	// entry points, finish off the remainder one element at a time
+
+	static void transformPoints(const float* _mtx, float* const* _out, const float* const* _in, size_t _count)
+	{
+		const size_t done = transformPoints_impl(_mtx,_out,_in,0ull,_count);
+		Kernels<ScalarLane>::transformPoints_impl(_mtx,_out,_in,done,_count);
+	}
+	static void transformVectors(const float* _mtx, float* const* _out, const float* const* _in, size_t _count, bool _renormalize)
+	{
+		const size_t done = transformVectors_impl(_mtx,_out,_in,0ull,_count,_renormalize);
+		Kernels<ScalarLane>::transformVectors_impl(_mtx,_out,_in,done,_count,_renormalize);
+	}
+	static void transformBoxes(const float* _mtx, float* const* _out, const float* const* _in, size_t _count)
+	{
+		const size_t done = transformBoxes_impl(_mtx,_out,_in,0ull,_count);
+		Kernels<ScalarLane>::transformBoxes_impl(_mtx,_out,_in,done,_count);
+	}
+	static void transformPointsProjective(const float* _mtx, float* const* _out, const float* const* _in, size_t _count)
+	{
+		const size_t done = transformPointsProjective_impl(_mtx,_out,_in,0ull,_count);
+		Kernels<ScalarLane>::transformPointsProjective_impl(_mtx,_out,_in,done,_count);
+	}
+	static void concatenateAffine(float* const* _out, const float* const* _a, const float* const* _b, size_t _count)
+	{
+		const size_t done = concatenateAffine_impl(_out,_a,_b,0ull,_count);
+		Kernels<ScalarLane>::concatenateAffine_impl(_out,_a,_b,done,_count);
+	}
+	static void concatenateProjective(float* const* _out, const float* const* _a, const float* const* _b, size_t _count)
+	{
+		const size_t done = concatenateProjective_impl(_out,_a,_b,0ull,_count);
+		Kernels<ScalarLane>::concatenateProjective_impl(_out,_a,_b,done,_count);
+	}
+	static size_t invertAffine(float* const* _out, uint8_t* _valid, const float* const* _in, size_t _count)
+	{
+		size_t validCount = 0ull;
+		const size_t done = invertAffine_impl(_out,_valid,_in,0ull,_count,validCount);
+		Kernels<ScalarLane>::invertAffine_impl(_out,_valid,_in,done,_count,validCount);
+		return validCount;
+	}
+
+	static constexpr SMatrixBatchKernelTable getTable()
+	{
+		return {
+			&transformPoints,
+			&transformVectors,
+			&transformBoxes,
+			&transformPointsProjective,
+			&concatenateAffine,
+			&concatenateProjective,
+			&invertAffine
+		};
+	}
+};
+
+}
+
+}
+}
+}
+
+#endif
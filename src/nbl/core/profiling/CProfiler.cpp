@@ -0,0 +1,198 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/profiling/CProfiler.h"
+
+#include <fstream>
+
+namespace nbl
+{
+namespace core
+{
+namespace profiling
+{
+
+//! Single producer ring, the owning thread only ever bumps `head` after the event is in place
+class CProfiler::CThreadBuffer
+{
+	public:
+		CThreadBuffer(uint32_t _threadIx) : events(EventsPerThread), head(0ull), tail(0ull), name(nullptr), threadIx(_threadIx) {}
+
+		core::vector<SEvent> events;
+		std::atomic<uint64_t> head;
+		//! events before this got dropped by `reset`
+		std::atomic<uint64_t> tail;
+		std::atomic<const char*> name;
+		const uint32_t threadIx;
+};
+
+namespace
+{
+
+void writeEscaped(std::ostream& _out, const char* _str)
+{
+	for (; *_str; _str++)
+	{
+		const char c = *_str;
+		if (c=='"' || c=='\\')
+			_out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20u)
+		{
+			const char* hex = "0123456789abcdef";
+			_out << "\\u00" << hex[c>>4] << hex[c&0xf];
+		}
+		else
+			_out << c;
+	}
+}
+
+//! the format wants microseconds, fractions are allowed
+void writeMicroseconds(std::ostream& _out, uint64_t _ns)
+{
+	const uint64_t fraction = _ns%1000ull;
+	_out << _ns/1000ull << '.' << char('0'+fraction/100ull) << char('0'+(fraction/10ull)%10ull) << char('0'+fraction%10ull);
+}
+
+}
+
+
+CProfiler& CProfiler::get()
+{
+	// never destroyed, threads may still record during static destruction
+	static CProfiler* profiler = new CProfiler();
+	return *profiler;
+}
+
+CProfiler::CProfiler() : start(std::chrono::steady_clock::now()), enabled(true)
+{
+	for (auto& counter : counters)
+		counter.store(0ull);
+}
+
+CProfiler::~CProfiler()
+{
+}
+
+CProfiler::CThreadBuffer* CProfiler::getThreadBuffer()
+{
+	static thread_local CThreadBuffer* buffer = nullptr;
+	if (!buffer)
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		buffers.push_back(std::make_unique<CThreadBuffer>(buffers.size()));
+		buffer = buffers.back().get();
+	}
+	return buffer;
+}
+
+void CProfiler::record(const SEvent& _event)
+{
+	CThreadBuffer* buffer = getThreadBuffer();
+	const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	buffer->events[head&(EventsPerThread-1u)] = _event;
+	buffer->head.store(head+1ull,std::memory_order_release);
+}
+
+const char* CProfiler::getCounterName(E_COUNTER _counter)
+{
+	switch (_counter)
+	{
+		case EC_BYTES_DECODED:
+			return "bytes decoded";
+		case EC_TEXELS_FILTERED:
+			return "texels filtered";
+		case EC_BLOBS_DECOMPRESSED:
+			return "blobs decompressed";
+		default:
+			return "unknown";
+	}
+}
+
+void CProfiler::setThreadName(const char* _name)
+{
+	getThreadBuffer()->name.store(_name,std::memory_order_relaxed);
+}
+
+void CProfiler::reset()
+{
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	for (auto& buffer : buffers)
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire),std::memory_order_relaxed);
+	for (auto& counter : counters)
+		counter.store(0ull,std::memory_order_relaxed);
+}
+
+void CProfiler::writeChromeTrace(std::ostream& _out) const
+{
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	_out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	auto beginEvent = [&]() -> std::ostream&
+	{
+		if (!first)
+			_out << ",";
+		first = false;
+		return _out << "\n";
+	};
+
+	core::vector<SEvent> snapshot;
+	for (const auto& buffer : buffers)
+	{
+		beginEvent() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIx << ",\"args\":{\"name\":\"";
+		if (const char* name = buffer->name.load(std::memory_order_relaxed))
+			writeEscaped(_out,name);
+		else
+			_out << "thread " << buffer->threadIx;
+		_out << "\"}}";
+
+		const uint64_t head = buffer->head.load(std::memory_order_acquire);
+		const uint64_t oldest = head>EventsPerThread ? (head-EventsPerThread):0ull;
+		const uint64_t firstIx = core::max(buffer->tail.load(std::memory_order_relaxed),oldest);
+		snapshot.clear();
+		for (uint64_t i=firstIx; i<head; i++)
+			snapshot.push_back(buffer->events[i&(EventsPerThread-1u)]);
+		// anything the owning thread wrapped around onto while we copied could be torn
+		const uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+		const uint64_t skip = newHead>EventsPerThread ? core::min(core::max(newHead-EventsPerThread,firstIx)-firstIx,uint64_t(snapshot.size())):0ull;
+
+		for (auto it=snapshot.begin()+skip; it!=snapshot.end(); it++)
+		{
+			beginEvent() << "{\"name\":\"";
+			writeEscaped(_out,it->name);
+			_out << "\",\"cat\":\"";
+			writeEscaped(_out,it->category);
+			_out << "\",\"pid\":0,\"tid\":" << buffer->threadIx << ",\"ts\":";
+			writeMicroseconds(_out,it->begin);
+			if (it->type==SEvent::ET_COUNTER)
+				_out << ",\"ph\":\"C\",\"args\":{\"value\":" << it->end << "}}";
+			else
+			{
+				_out << ",\"ph\":\"X\",\"dur\":";
+				writeMicroseconds(_out,it->end-it->begin);
+				if (it->detail[0])
+				{
+					_out << ",\"args\":{\"detail\":\"";
+					writeEscaped(_out,it->detail);
+					_out << "\"}";
+				}
+				_out << "}";
+			}
+		}
+	}
+	_out << "\n]}\n";
+}
+
+bool CProfiler::writeChromeTrace(const std::string& _filename) const
+{
+	std::ofstream file(_filename,std::ios::out|std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	writeChromeTrace(file);
+	return file.good();
+}
+
+} // end namespace profiling
+} // end namespace core
+} // end namespace nbl
@@ -6,6 +6,8 @@
 #include "os.h"
 
 #include <cwchar>
+#include <execution>
+#include <numeric>
 
 #include "nbl/ext/MitsubaLoader/CMitsubaLoader.h"
 #include "nbl/ext/MitsubaLoader/ParserUtil.h"
@@ -214,7 +216,7 @@ static core::smart_refctd_ptr<asset::ICPUSpecializedShader> createAndCacheVertex
 
 	return vs;
 }
-static core::smart_refctd_ptr<asset::ICPUSpecializedShader> createFragmentShader(const asset::material_compiler::CMaterialCompilerGLSLBackendCommon::result_t& _mcRes, size_t _VTstorageViewCount)
+static core::smart_refctd_ptr<asset::ICPUSpecializedShader> createFragmentShader(asset::IAssetManager* _manager, const asset::material_compiler::CMaterialCompilerGLSLBackendCommon::result_t& _mcRes, size_t _VTstorageViewCount)
 {
 	std::string source = 
 		FRAGMENT_SHADER_PROLOGUE +
@@ -225,7 +227,9 @@ static core::smart_refctd_ptr<asset::ICPUSpecializedShader> createFragmentShader
 		_mcRes.fragmentShaderSource +
 		FRAGMENT_SHADER_IMPL;
 
-	return createSpecShader(source.c_str(), asset::ISpecializedShader::ESS_FRAGMENT);
+	// scenes compiling to the same material streams get the same shader
+	asset::ICPUSpecializedShader::SInfo info(nullptr, nullptr, "main", asset::ISpecializedShader::ESS_FRAGMENT);
+	return _manager->getShaderVariantCache()->getSpecializedShader(source, nullptr, nullptr, std::move(info));
 }
 static core::smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline> createPipeline(core::smart_refctd_ptr<asset::ICPUPipelineLayout>&& _layout, core::smart_refctd_ptr<asset::ICPUSpecializedShader>&& _vertshader, core::smart_refctd_ptr<asset::ICPUSpecializedShader>&& _fragshader)
 {
@@ -388,7 +392,8 @@ core::smart_refctd_ptr<asset::ICPUPipelineLayout> CMitsubaLoader::createPipeline
 	return core::make_smart_refctd_ptr<asset::ICPUPipelineLayout>(nullptr, nullptr, std::move(ds0layout), std::move(ds1layout), nullptr, nullptr);
 }
 
-CMitsubaLoader::CMitsubaLoader(asset::IAssetManager* _manager, io::IFileSystem* _fs) : asset::IRenderpassIndependentPipelineLoader(_manager), m_filesystem(_fs)
+CMitsubaLoader::CMitsubaLoader(asset::IAssetManager* _manager, io::IFileSystem* _fs) : asset::IRenderpassIndependentPipelineLoader(_manager), m_filesystem(_fs),
+	m_serializedLoader(core::make_smart_refctd_ptr<CSerializedLoader>(_manager))
 {
 #ifdef _NBL_DEBUG
 	setDebugName("CMitsubaLoader");
@@ -398,6 +403,7 @@ CMitsubaLoader::CMitsubaLoader(asset::IAssetManager* _manager, io::IFileSystem*
 void CMitsubaLoader::initialize()
 {
 	IRenderpassIndependentPipelineLoader::initialize();
+	m_serializedLoader->initialize();
 
 	auto* glslc = m_assetMgr->getGLSLCompiler();
 
@@ -487,22 +493,36 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 			createAndCacheVertexShader(m_assetMgr, DUMMY_VERTEX_SHADER);
 		}
 
-		core::map<core::smart_refctd_ptr<asset::ICPUMesh>,std::pair<std::string,CElementShape::Type>> meshes;
-		for (auto& shapepair : parserManager.shapegroups)
+		// files get loaded first and then the shapes using them, both on the worker pool,
+		// the BSDFs get compiled and the instances added serially afterwards because the material compiler's IR decides on an order
+		core::vector<SContext::SShapeInstance> shapeInstances;
+		for (uint32_t i=0u; i<parserManager.shapegroups.size(); i++)
 		{
-			auto* shapedef = shapepair.first;
+			auto* shapedef = parserManager.shapegroups[i].first;
 			if (shapedef->type == CElementShape::Type::SHAPEGROUP)
 				continue;
 
-			auto lowermeshes = getMesh(ctx, _hierarchyLevel, shapedef);
-			for (auto& mesh : lowermeshes)
+			gatherShapeInstances(shapeInstances, shapedef, i);
+		}
+		prefetchFiles(ctx, _hierarchyLevel, shapeInstances);
+		loadShapes(ctx, _hierarchyLevel, shapeInstances);
+
+		// in order of first appearance in the scene, so the instance data doesn't depend on which shapes finished loading first
+		core::vector<std::pair<core::smart_refctd_ptr<asset::ICPUMesh>,std::pair<std::string,CElementShape::Type>>> meshes;
+		{
+			core::unordered_set<const asset::ICPUMesh*> addedMeshes;
+			for (const auto& instance : shapeInstances)
 			{
+				auto mesh = ctx.shapeCache.find(instance.shape);
 				if (!mesh)
 					continue;
 
-				auto found = meshes.find(mesh);
-				if (found == meshes.end())
-					meshes.emplace(std::move(mesh),std::pair<std::string,CElementShape::Type>(std::move(shapepair.second),shapedef->type));
+				addInstance(ctx, instance, mesh);
+				if (addedMeshes.insert(mesh.get()).second)
+				{
+					const auto& shapepair = parserManager.shapegroups[instance.topLevelIx];
+					meshes.emplace_back(std::move(mesh),std::pair<std::string,CElementShape::Type>(shapepair.second,shapepair.first->type));
+				}
 			}
 		}
 
@@ -520,7 +540,7 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 		auto compResult = ctx.backend.compile(&ctx.backend_ctx, ctx.ir.get());
 		ctx.backend_ctx.vt.commitAll();
 		auto pipelineLayout = createPipelineLayout(m_assetMgr, ctx.backend_ctx.vt.vt.get());
-		auto fragShader = createFragmentShader(compResult, ctx.backend_ctx.vt.vt->getFloatViews().size());
+		auto fragShader = createFragmentShader(m_assetMgr, compResult, ctx.backend_ctx.vt.vt->getFloatViews().size());
 		auto ds0 = createDS0(ctx, pipelineLayout.get(), compResult, meshes.begin(), meshes.end());
 		auto basePipeline = createPipeline(
 			std::move(pipelineLayout),
@@ -570,38 +590,31 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(io::IReadFile* _file, const asset:
 	}
 }
 
-core::vector<SContext::shape_ass_type> CMitsubaLoader::getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape)
+void CMitsubaLoader::gatherShapeInstances(core::vector<SContext::SShapeInstance>& out, CElementShape* shape, uint32_t topLevelIx)
 {
 	if (!shape)
-		return {};
+		return;
 
 	if (shape->type!=CElementShape::Type::INSTANCE)
-		return {loadBasicShape(ctx, hierarchyLevel, shape, core::matrix3x4SIMD())};
+		out.push_back({shape, core::matrix3x4SIMD(), topLevelIx});
 	else
 	{
 		core::matrix3x4SIMD relTform = shape->getAbsoluteTransform();
 		// get group reference
 		const CElementShape* parent = shape->instance.parent;
 		if (!parent)
-			return {};
+			return;
 		assert(parent->type==CElementShape::Type::SHAPEGROUP);
 		const CElementShape::ShapeGroup* shapegroup = &parent->shapegroup;
 		
-		return loadShapeGroup(ctx, hierarchyLevel, shapegroup, relTform);
+		gatherShapeGroup(out, shapegroup, relTform, topLevelIx);
 	}
 }
 
-core::vector<SContext::shape_ass_type> CMitsubaLoader::loadShapeGroup(SContext& ctx, uint32_t hierarchyLevel, const CElementShape::ShapeGroup* shapegroup, const core::matrix3x4SIMD& relTform)
+void CMitsubaLoader::gatherShapeGroup(core::vector<SContext::SShapeInstance>& out, const CElementShape::ShapeGroup* shapegroup, const core::matrix3x4SIMD& relTform, uint32_t topLevelIx)
 {
-	// @Crisspl why no group cache?
-	// find group
-	//auto found = ctx.groupCache.find(shapegroup);
-	//if (found != ctx.groupCache.end())
-	//	return found->second;
-
 	const auto children = shapegroup->children;
 
-	core::vector<SContext::shape_ass_type> meshes;
 	for (auto i=0u; i<shapegroup->childCount; i++)
 	{
 		auto child = children[i];
@@ -609,18 +622,312 @@ core::vector<SContext::shape_ass_type> CMitsubaLoader::loadShapeGroup(SContext&
 			continue;
 
 		assert(child->type!=CElementShape::Type::INSTANCE);
-		if (child->type != CElementShape::Type::SHAPEGROUP) {
-			auto lowermesh = loadBasicShape(ctx, hierarchyLevel, child, relTform);
-			meshes.push_back(std::move(lowermesh));
+		if (child->type != CElementShape::Type::SHAPEGROUP)
+			out.push_back({child, relTform, topLevelIx});
+		else
+			gatherShapeGroup(out, &child->shapegroup, relTform, topLevelIx);
+	}
+}
+
+static IAssetLoader::SAssetLoadParams getModelLoadParams(const SContext& ctx)
+{
+	auto loadParams = ctx.inner.params;
+	loadParams.loaderFlags = static_cast<IAssetLoader::E_LOADER_PARAMETER_FLAGS>(loadParams.loaderFlags | IAssetLoader::ELPF_RIGHT_HANDED_MESHES);
+	return loadParams;
+}
+
+static std::string getBitmapViewCacheKey(const CElementTexture* tex)
+{
+	std::string cacheKey = SContext::imageViewCacheKey(tex->bitmap.filename.svalue);
+	switch (tex->bitmap.channel)
+	{
+		case CElementTexture::Bitmap::CHANNEL::R:
+			cacheKey += "?r";
+			break;
+		case CElementTexture::Bitmap::CHANNEL::G:
+			cacheKey += "?g";
+			break;
+		case CElementTexture::Bitmap::CHANNEL::B:
+			cacheKey += "?b";
+			break;
+		case CElementTexture::Bitmap::CHANNEL::A:
+			cacheKey += "?a";
+			break;
+		default:
+			break;
+	}
+	return cacheKey;
+}
+
+static const CElementTexture* unrollScales(const CElementTexture* tex)
+{
+	while (tex->type == CElementTexture::SCALE)
+		tex = tex->scale.texture;
+	return tex;
+}
+
+//! calls `f(bsdf,texture)` for every texture used by a BSDF in the tree, in the order `genBSDFtreeTraversal` caches them in
+template<typename F>
+static void forEachBSDFTexture(const CElementBSDF* _bsdf, F&& f)
+{
+	core::stack<const CElementBSDF*> stack;
+	stack.push(_bsdf);
+
+	while (!stack.empty())
+	{
+		auto* bsdf = stack.top();
+		stack.pop();
+		switch (bsdf->type)
+		{
+		case CElementBSDF::COATING:
+		case CElementBSDF::ROUGHCOATING:
+		case CElementBSDF::BUMPMAP:
+		case CElementBSDF::BLEND_BSDF:
+		case CElementBSDF::MIXTURE_BSDF:
+		case CElementBSDF::MASK:
+		case CElementBSDF::TWO_SIDED:
+			for (uint32_t i = 0u; i < bsdf->meta_common.childCount; ++i)
+				stack.push(bsdf->meta_common.bsdf[i]);
+		default: break;
+		}
+
+		auto propertyTexture = [&](const auto& const_or_tex) {
+			if (const_or_tex.value.type == SPropertyElementData::INVALID)
+				f(bsdf, const_or_tex.texture);
+		};
+		switch (bsdf->type)
+		{
+		case CElementBSDF::DIFFUSE:
+		case CElementBSDF::ROUGHDIFFUSE:
+			propertyTexture(bsdf->diffuse.reflectance);
+			propertyTexture(bsdf->diffuse.alpha);
+			break;
+		case CElementBSDF::DIFFUSE_TRANSMITTER:
+			propertyTexture(bsdf->difftrans.transmittance);
+			break;
+		case CElementBSDF::DIELECTRIC:
+		case CElementBSDF::THINDIELECTRIC:
+		case CElementBSDF::ROUGHDIELECTRIC:
+			propertyTexture(bsdf->dielectric.alphaU);
+			if (bsdf->dielectric.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->dielectric.alphaV);
+			break;
+		case CElementBSDF::CONDUCTOR:
+			propertyTexture(bsdf->conductor.alphaU);
+			if (bsdf->conductor.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->conductor.alphaV);
+			break;
+		case CElementBSDF::PLASTIC:
+		case CElementBSDF::ROUGHPLASTIC:
+			propertyTexture(bsdf->plastic.diffuseReflectance);
+			propertyTexture(bsdf->plastic.alphaU);
+			if (bsdf->plastic.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
+				propertyTexture(bsdf->plastic.alphaV);
+			break;
+		case CElementBSDF::BUMPMAP:
+			f(bsdf, bsdf->bumpmap.texture);
+			break;
+		case CElementBSDF::BLEND_BSDF:
+			propertyTexture(bsdf->blendbsdf.weight);
+			break;
+		case CElementBSDF::MASK:
+			propertyTexture(bsdf->mask.opacity);
+			break;
+		default: break;
 		}
-		else {
-			auto lowermeshes = loadShapeGroup(ctx, hierarchyLevel, &child->shapegroup, relTform);
-			meshes.insert(meshes.begin(), std::make_move_iterator(lowermeshes.begin()), std::make_move_iterator(lowermeshes.end()));
+	}
+}
+
+void CMitsubaLoader::prefetchFiles(SContext& ctx, uint32_t hierarchyLevel, const core::vector<SContext::SShapeInstance>& instances)
+{
+	struct SFile
+	{
+		enum E_TYPE : uint8_t
+		{
+			ET_MODEL,
+			ET_SERIALIZED,
+			ET_BITMAP,
+			ET_COUNT
+		};
+
+		E_TYPE type;
+		std::string filename;
+		core::vector<uint32_t> meshIndices;
+		asset::SAssetBundle bundle;
+	};
+	core::vector<SFile> files;
+	{
+		core::unordered_map<std::string,uint32_t> fileIxs[SFile::ET_COUNT];
+		auto addFile = [&](SFile::E_TYPE type, const std::string& filename) -> SFile&
+		{
+			auto found = fileIxs[type].find(filename);
+			if (found!=fileIxs[type].end())
+				return files[found->second];
+			fileIxs[type].emplace(filename,files.size());
+			files.push_back({type,filename,{},{}});
+			return files.back();
+		};
+
+		core::unordered_set<const CElementShape*> visitedShapes;
+		core::unordered_set<const CElementBSDF*> visitedBSDFs;
+		for (const auto& instance : instances)
+		{
+			auto* shape = instance.shape;
+			if (!visitedShapes.insert(shape).second)
+				continue;
+
+			switch (shape->type)
+			{
+				case CElementShape::Type::OBJ:
+					addFile(SFile::ET_MODEL, shape->obj.filename.svalue);
+					break;
+				case CElementShape::Type::PLY:
+					addFile(SFile::ET_MODEL, shape->ply.filename.svalue);
+					break;
+				case CElementShape::Type::SERIALIZED:
+					if (shape->serialized.shapeIndex>=0)
+						addFile(SFile::ET_SERIALIZED, shape->serialized.filename.svalue).meshIndices.push_back(shape->serialized.shapeIndex);
+					else
+						addFile(SFile::ET_MODEL, shape->serialized.filename.svalue);
+					break;
+				default:
+					break;
+			}
+
+			if (!shape->bsdf || !visitedBSDFs.insert(shape->bsdf).second)
+				continue;
+			forEachBSDFTexture(shape->bsdf, [&](const CElementBSDF* bsdf, const CElementTexture* texture) -> void
+			{
+				texture = unrollScales(texture);
+				if (texture->type != CElementTexture::Type::BITMAP)
+					return;
+				// no point in loading the image if a view of it is still cached from an earlier load
+				const asset::IAsset::E_TYPE types[]{ asset::IAsset::ET_IMAGE_VIEW, static_cast<asset::IAsset::E_TYPE>(0) };
+				if (!ctx.override_->findCachedAsset(getBitmapViewCacheKey(texture), types, ctx.inner, 0u).getContents().empty())
+					return;
+				addFile(SFile::ET_BITMAP, texture->bitmap.filename.svalue);
+			});
 		}
 	}
 
-	//ctx.groupCache.insert({shapegroup,meshes});
-	return meshes;
+	// same parameters as `loadBasicShape` and `cacheTexture` would use
+	const auto modelLoadParams = getModelLoadParams(ctx);
+	core::vector<uint32_t> fileIxs(files.size());
+	std::iota(fileIxs.begin(), fileIxs.end(), 0u);
+	std::for_each(std::execution::par, fileIxs.begin(), fileIxs.end(), [&](const uint32_t i) -> void
+	{
+		auto& file = files[i];
+		switch (file.type)
+		{
+			case SFile::ET_SERIALIZED:
+				file.bundle = loadSerializedMeshes(ctx, hierarchyLevel, file.filename, file.meshIndices);
+				if (!file.bundle.getContents().empty())
+					break;
+				[[fallthrough]];
+			case SFile::ET_MODEL:
+				file.bundle = interm_getAssetInHierarchy(m_assetMgr, file.filename, modelLoadParams, hierarchyLevel/*+ICPUScene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override_);
+				break;
+			case SFile::ET_BITMAP:
+				file.bundle = interm_getAssetInHierarchy(m_assetMgr, file.filename, ctx.inner.params, 0u, ctx.override_);
+				break;
+			default:
+				assert(false);
+				break;
+		}
+	});
+
+	for (auto& file : files)
+	{
+		auto& prefetched = file.type==SFile::ET_BITMAP ? ctx.prefetched.bitmaps:(file.type==SFile::ET_SERIALIZED ? ctx.prefetched.serialized:ctx.prefetched.models);
+		prefetched.emplace(std::move(file.filename), std::move(file.bundle));
+	}
+}
+
+asset::SAssetBundle CMitsubaLoader::loadSerializedMeshes(SContext& ctx, uint32_t hierarchyLevel, const std::string& filename, const core::vector<uint32_t>& meshIndices)
+{
+	const auto loadParams = getModelLoadParams(ctx);
+	asset::SAssetBundle retval;
+	// only decode the meshes we need out of a `.serialized` file, instead of the whole file
+	std::string path = filename;
+	ctx.override_->getLoadFilename(path,IAssetLoader::SAssetLoadContext(loadParams,nullptr),hierarchyLevel);
+	if (io::IReadFile* file = m_filesystem->createAndOpenFile(path.c_str()))
+	{
+		if (m_serializedLoader->isALoadableFileFormat(file))
+			retval = m_serializedLoader->loadMeshes(file,{meshIndices.data(),meshIndices.data()+meshIndices.size()},loadParams,ctx.override_,hierarchyLevel);
+		file->drop();
+	}
+	return retval;
+}
+
+//! meshbuffers of a mesh loaded from a file are shared between all the shapes using it
+static std::string getShapeSourceKey(const CElementShape* shape)
+{
+	switch (shape->type)
+	{
+		case CElementShape::Type::OBJ:
+			return shape->obj.filename.svalue;
+		case CElementShape::Type::PLY:
+			return shape->ply.filename.svalue;
+		case CElementShape::Type::SERIALIZED:
+			return std::string(shape->serialized.filename.svalue)+"?"+std::to_string(shape->serialized.shapeIndex);
+		default:
+			return {};
+	}
+}
+
+void CMitsubaLoader::loadShapes(SContext& ctx, uint32_t hierarchyLevel, const core::vector<SContext::SShapeInstance>& instances)
+{
+	// shapes which share a mesh from a file get processed one after another by the same task, because that alters the meshbuffers in place
+	core::vector<core::vector<CElementShape*>> tasks;
+	{
+		core::unordered_set<const CElementShape*> visitedShapes;
+		core::unordered_map<std::string,uint32_t> sourceToTask;
+		for (const auto& instance : instances)
+		{
+			auto* shape = instance.shape;
+			if (!visitedShapes.insert(shape).second)
+				continue;
+
+			const std::string source = getShapeSourceKey(shape);
+			if (!source.empty())
+			{
+				auto found = sourceToTask.find(source);
+				if (found!=sourceToTask.end())
+				{
+					tasks[found->second].push_back(shape);
+					continue;
+				}
+				sourceToTask.emplace(source,tasks.size());
+			}
+			tasks.push_back({shape});
+		}
+	}
+
+	core::vector<uint32_t> taskIxs(tasks.size());
+	std::iota(taskIxs.begin(), taskIxs.end(), 0u);
+	std::for_each(std::execution::par, taskIxs.begin(), taskIxs.end(), [&](const uint32_t i) -> void
+	{
+		for (auto* shape : tasks[i])
+		if (auto mesh = loadBasicShape(ctx, hierarchyLevel, shape))
+			ctx.shapeCache.insert(shape, std::move(mesh));
+	});
+}
+
+void CMitsubaLoader::addInstance(SContext& ctx, const SContext::SShapeInstance& instance, const SContext::shape_ass_type& mesh)
+{
+	const auto* shape = instance.shape;
+	auto bsdf = getBSDFtreeTraversal(ctx, shape->bsdf);
+	core::matrix3x4SIMD tform = core::concatenateBFollowedByA(instance.relTform, shape->getAbsoluteTransform());
+	SContext::SInstanceData instanceData(
+		tform,
+		bsdf,
+#if defined(_NBL_DEBUG) || defined(_NBL_RELWITHDEBINFO)
+		shape->bsdf ? shape->bsdf->id:"",
+#endif
+		shape->obtainEmitter(),
+		CElementEmitter{} // TODO: does enabling a twosided BRDF make the emitter twosided?
+	);
+	ctx.mapMesh2instanceData.insert({ mesh.get(), instanceData });
 }
 
 static core::smart_refctd_ptr<ICPUMesh> createMeshFromGeomCreatorReturnType(IGeometryCreator::return_type&& _data, asset::IAssetManager* _manager)
@@ -649,53 +956,43 @@ static core::smart_refctd_ptr<ICPUMesh> createMeshFromGeomCreatorReturnType(IGeo
 	return mesh;
 }
 
-SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape, const core::matrix3x4SIMD& relTform)
+SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape)
 {
 	constexpr uint32_t UV_ATTRIB_ID = 2U;
 
-	auto addInstance = [shape,&ctx,&relTform,this](SContext::shape_ass_type& mesh)
-	{
-		auto bsdf = getBSDFtreeTraversal(ctx, shape->bsdf);
-		core::matrix3x4SIMD tform = core::concatenateBFollowedByA(relTform, shape->getAbsoluteTransform());
-		SContext::SInstanceData instance(
-			tform,
-			bsdf,
-#if defined(_NBL_DEBUG) || defined(_NBL_RELWITHDEBINFO)
-			shape->bsdf ? shape->bsdf->id:"",
-#endif
-			shape->obtainEmitter(),
-			CElementEmitter{} // TODO: does enabling a twosided BRDF make the emitter twosided?
-		);
-		ctx.mapMesh2instanceData.insert({ mesh.get(), instance });
-	};
-
-	auto found = ctx.shapeCache.find(shape);
-	if (found != ctx.shapeCache.end()) {
-		addInstance(found->second);
-
-		return found->second;
-	}
-
 	auto loadModel = [&](const ext::MitsubaLoader::SPropertyElementData& filename, int64_t index=-1) -> core::smart_refctd_ptr<asset::ICPUMesh>
 	{
 		assert(filename.type==ext::MitsubaLoader::SPropertyElementData::Type::STRING);
-		auto loadParams = ctx.inner.params;
-		loadParams.loaderFlags = static_cast<IAssetLoader::E_LOADER_PARAMETER_FLAGS>(loadParams.loaderFlags | IAssetLoader::ELPF_RIGHT_HANDED_MESHES);
-		auto retval = interm_getAssetInHierarchy(m_assetMgr, filename.svalue, loadParams, hierarchyLevel/*+ICPUScene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override_);
+		asset::SAssetBundle retval;
+		const auto& prefetched = index>=0ll ? ctx.prefetched.serialized:ctx.prefetched.models;
+		auto found = prefetched.find(filename.svalue);
+		if (found!=prefetched.end())
+			retval = found->second;
+		else
+		{
+			if (index>=0ll)
+				retval = loadSerializedMeshes(ctx,hierarchyLevel,filename.svalue,{static_cast<uint32_t>(index)});
+			if (retval.getContents().empty())
+				retval = interm_getAssetInHierarchy(m_assetMgr, filename.svalue, getModelLoadParams(ctx), hierarchyLevel/*+ICPUScene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override_);
+		}
 		if (retval.getAssetType()!=asset::IAsset::ET_MESH)
 			return nullptr;
 		auto contentRange = retval.getContents();
-		auto serializedMeta = retval.getMetadata()->selfCast<CMitsubaSerializedMetadata>();
+		auto serializedMeta = retval.getMetadata() ? retval.getMetadata()->selfCast<CMitsubaSerializedMetadata>():nullptr;
 		//
 		uint32_t actualIndex = 0;
 		if (index>=0ll && serializedMeta)
-		for (auto it=contentRange.begin(); it!=contentRange.end(); it++)
 		{
-			auto meshMeta = static_cast<const CMitsubaSerializedMetadata::CMesh*>(serializedMeta->getAssetSpecificMetadata(IAsset::castDown<ICPUMesh>(*it).get()));
-			if (meshMeta->m_id!=static_cast<uint32_t>(index))
-				continue;
-			actualIndex = it-contentRange.begin();
-			break;
+			// the bundle holds more meshes of the file than just ours
+			actualIndex = contentRange.size();
+			for (auto it=contentRange.begin(); it!=contentRange.end(); it++)
+			{
+				auto meshMeta = static_cast<const CMitsubaSerializedMetadata::CMesh*>(serializedMeta->getAssetSpecificMetadata(IAsset::castDown<ICPUMesh>(*it).get()));
+				if (meshMeta->m_id!=static_cast<uint32_t>(index))
+					continue;
+				actualIndex = it-contentRange.begin();
+				break;
+			}
 		}
 		//
 		if (contentRange.begin()+actualIndex < contentRange.end())
@@ -883,12 +1180,7 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 		newMesh->getMeshBufferVector().push_back(std::move(newMeshBuffer));
 	}
 	IMeshManipulator::recalculateBoundingBox(newMesh.get());
-	mesh = std::move(newMesh);
-
-	addInstance(mesh);
-	// cache and return
-	ctx.shapeCache.insert({ shape,mesh });
-	return mesh;
+	return newMesh;
 }
 
 SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hierarchyLevel, const CElementTexture* tex, bool _restore)
@@ -917,24 +1209,7 @@ SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hier
 	{
 		case CElementTexture::Type::BITMAP:
 		{
-				std::string cacheKey = ctx.imageViewCacheKey(tex->bitmap.filename.svalue);
-				switch (tex->bitmap.channel)
-				{
-				case CElementTexture::Bitmap::CHANNEL::R:
-					cacheKey += "?r";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::G:
-					cacheKey += "?g";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::B:
-					cacheKey += "?b";
-					break;
-				case CElementTexture::Bitmap::CHANNEL::A:
-					cacheKey += "?a";
-					break;
-				default:
-					break;
-				}
+				const std::string cacheKey = getBitmapViewCacheKey(tex);
 
 				core::smart_refctd_ptr<asset::ICPUImageView> view;
 				{
@@ -968,10 +1243,18 @@ SContext::tex_ass_type CMitsubaLoader::cacheTexture(SContext& ctx, uint32_t hier
 				core::smart_refctd_ptr<asset::ICPUImage> img;
 				if (!view)
 				{
-					const uint32_t restoreLevels = _restore ? 2u : 0u;
-					auto loadParams = ctx.inner.params;
-					loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + restoreLevels);
-					asset::SAssetBundle imgBundle = interm_getAssetInHierarchy(m_assetMgr,tex->bitmap.filename.svalue,loadParams,hierarchyLevel,ctx.override_);
+					asset::SAssetBundle imgBundle;
+					// `prefetchFiles` loaded the images with the parameters of a non-restoring call at the top level
+					auto prefetched = ctx.prefetched.bitmaps.find(tex->bitmap.filename.svalue);
+					if (!_restore && hierarchyLevel==0u && prefetched!=ctx.prefetched.bitmaps.end())
+						imgBundle = prefetched->second;
+					else
+					{
+						const uint32_t restoreLevels = _restore ? 2u : 0u;
+						auto loadParams = ctx.inner.params;
+						loadParams.restoreLevels = std::max(loadParams.restoreLevels, hierarchyLevel + restoreLevels);
+						imgBundle = interm_getAssetInHierarchy(m_assetMgr,tex->bitmap.filename.svalue,loadParams,hierarchyLevel,ctx.override_);
+					}
 					auto contentRange = imgBundle.getContents();
 					if (contentRange.begin() < contentRange.end())
 					{
@@ -1185,77 +1468,13 @@ auto CMitsubaLoader::getBSDFtreeTraversal(SContext& ctx, const CElementBSDF* bsd
 
 auto CMitsubaLoader::genBSDFtreeTraversal(SContext& ctx, const CElementBSDF* _bsdf) -> SContext::bsdf_type
 {
+	forEachBSDFTexture(_bsdf, [&](const CElementBSDF* bsdf, const CElementTexture* texture) -> void
 	{
-		auto cachePropertyTexture = [&](const auto& const_or_tex, SContext::tex_ass_type& out_img) {
-			bool is_tex = (const_or_tex.value.type == SPropertyElementData::INVALID);
-			if (const_or_tex.value.type == SPropertyElementData::INVALID)
-				out_img = cacheTexture(ctx, 0u, const_or_tex.texture);
-
-			return is_tex;
-		};
-		auto unrollScales = [](CElementTexture* tex)
-		{
-			while (tex->type == CElementTexture::SCALE)
-				tex = tex->scale.texture;
-			return tex;
-		};
-
-		core::stack<const CElementBSDF*> stack;
-		stack.push(_bsdf);
-
-		while (!stack.empty())
+		switch (bsdf->type)
 		{
-			auto* bsdf = stack.top();
-			stack.pop();
-			switch (bsdf->type)
-			{
-			case CElementBSDF::COATING:
-			case CElementBSDF::ROUGHCOATING:
-			case CElementBSDF::BUMPMAP:
-			case CElementBSDF::BLEND_BSDF:
-			case CElementBSDF::MIXTURE_BSDF:
-			case CElementBSDF::MASK:
-			case CElementBSDF::TWO_SIDED:
-				for (uint32_t i = 0u; i < bsdf->meta_common.childCount; ++i)
-					stack.push(bsdf->meta_common.bsdf[i]);
-			default: break;
-			}
-
-			SContext::tex_ass_type tex;
-			switch (bsdf->type)
-			{
-			case CElementBSDF::DIFFUSE:
-			case CElementBSDF::ROUGHDIFFUSE:
-				cachePropertyTexture(bsdf->diffuse.reflectance, tex);
-				cachePropertyTexture(bsdf->diffuse.alpha, tex);
-				break;
-			case CElementBSDF::DIFFUSE_TRANSMITTER:
-				cachePropertyTexture(bsdf->difftrans.transmittance, tex);
-				break;
-			case CElementBSDF::DIELECTRIC:
-			case CElementBSDF::THINDIELECTRIC:
-			case CElementBSDF::ROUGHDIELECTRIC:
-				cachePropertyTexture(bsdf->dielectric.alphaU, tex);
-				if (bsdf->dielectric.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->dielectric.alphaV, tex);
-				break;
-			case CElementBSDF::CONDUCTOR:
-				cachePropertyTexture(bsdf->conductor.alphaU, tex);
-				if (bsdf->conductor.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->conductor.alphaV, tex);
-				break;
-			case CElementBSDF::PLASTIC:
-			case CElementBSDF::ROUGHPLASTIC:
-				cachePropertyTexture(bsdf->plastic.diffuseReflectance, tex);
-				cachePropertyTexture(bsdf->plastic.alphaU, tex);
-				if (bsdf->plastic.distribution == CElementBSDF::RoughSpecularBase::ASHIKHMIN_SHIRLEY)
-					cachePropertyTexture(bsdf->plastic.alphaV, tex);
-				break;
 			case CElementBSDF::BUMPMAP:
 			{
-				using namespace std::string_literals;
-
-				auto* bumpmap_element = unrollScales(bsdf->bumpmap.texture);
+				auto* bumpmap_element = unrollScales(texture);
 				auto bm = cacheTexture(ctx, 0u, bumpmap_element);
 				// TODO check and restore if dummy (image and sampler)
 				auto bumpmap = std::get<0>(bm)->getCreationParameters().image;
@@ -1274,31 +1493,29 @@ auto CMitsubaLoader::genBSDFtreeTraversal(SContext& ctx, const CElementBSDF* _bs
 			}
 				break;
 			case CElementBSDF::BLEND_BSDF:
-				if (cachePropertyTexture(bsdf->blendbsdf.weight, tex))
+			{
+				auto tex = cacheTexture(ctx, 0u, texture);
+				auto* weight_element = unrollScales(texture);
+				const std::string key = ctx.blendWeightImageCacheKey(weight_element);
+
+				if (!getBuiltinAsset<asset::ICPUImage, asset::IAsset::ET_IMAGE>(key.c_str(), m_assetMgr))
 				{
-					auto* weight_element = unrollScales(bsdf->blendbsdf.weight.texture);
-					const std::string key = ctx.blendWeightImageCacheKey(weight_element);
+					auto img = std::get<0>(tex)->getCreationParameters().image;
 
-					if (!getBuiltinAsset<asset::ICPUImage, asset::IAsset::ET_IMAGE>(key.c_str(), m_assetMgr))
-					{
-						auto img = std::get<0>(tex)->getCreationParameters().image;
-
-						auto blendweight = createBlendWeightImage(img.get());
-						asset::SAssetBundle imgBundle(nullptr,{ blendweight });
-						ctx.override_->insertAssetIntoCache(std::move(imgBundle), key, ctx.inner, 0u);
-						auto blendweight_view = createImageView(std::move(blendweight));
-						asset::SAssetBundle viewBundle(nullptr,{ blendweight_view });
-						ctx.override_->insertAssetIntoCache(std::move(viewBundle), ctx.imageViewCacheKey(key), ctx.inner, 0u);
-					}
+					auto blendweight = createBlendWeightImage(img.get());
+					asset::SAssetBundle imgBundle(nullptr,{ blendweight });
+					ctx.override_->insertAssetIntoCache(std::move(imgBundle), key, ctx.inner, 0u);
+					auto blendweight_view = createImageView(std::move(blendweight));
+					asset::SAssetBundle viewBundle(nullptr,{ blendweight_view });
+					ctx.override_->insertAssetIntoCache(std::move(viewBundle), ctx.imageViewCacheKey(key), ctx.inner, 0u);
 				}
+			}
 				break;
-			case CElementBSDF::MASK:
-				cachePropertyTexture(bsdf->mask.opacity, tex);
+			default:
+				cacheTexture(ctx, 0u, texture);
 				break;
-			default: break;
-			}
 		}
-	}
+	});
 
 	return ctx.frontend.compileToIRTree(ctx.ir.get(), _bsdf);
 }
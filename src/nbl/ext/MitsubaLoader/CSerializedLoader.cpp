@@ -16,6 +16,8 @@
 #endif
 #include "zlib/zlib.h"
 
+#include <execution>
+
 namespace nbl
 {
 
@@ -61,329 +63,458 @@ asset::SAssetBundle CSerializedLoader::loadAsset(io::IReadFile* _file, const ass
 		0,
 		nullptr
 	};
-	size_t maxSize = 0u;
+	if (!readOffsetTable(ctx))
+		return {};
+
+	core::vector<uint32_t> meshIndices(ctx.meshCount);
+	std::iota(meshIndices.begin(),meshIndices.end(),0u);
+	return createBundle(decodeMeshes(ctx,meshIndices,findDefaultAssets(ctx,_override,_hierarchyLevel)));
+}
+
+asset::SAssetBundle CSerializedLoader::loadMeshes(io::IReadFile* _file, const core::SRange<const uint32_t>& _meshIndices, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+        return {};
+
+	SContext ctx = {
+		IAssetLoader::SAssetLoadContext(_params,_file),
+		0,
+		nullptr
+	};
+	if (!readOffsetTable(ctx))
+		return {};
+
+	// sorted so the file gets read front to back
+	core::vector<uint32_t> meshIndices(_meshIndices.begin(),_meshIndices.end());
+	std::sort(meshIndices.begin(),meshIndices.end());
+	meshIndices.erase(std::unique(meshIndices.begin(),meshIndices.end()),meshIndices.end());
+
+	const std::string filename = _file->getFileName().c_str();
+	const size_t fileSize = _file->getSize();
+	core::vector<SDecodedMesh> decoded;
+	core::vector<uint32_t> missingIndices;
+	for (const auto meshIndex : meshIndices)
 	{
-		FileHeader header;
-		ctx.inner.mainFile->seek(0u);
-		ctx.inner.mainFile->read(&header, sizeof(header));
-		if (header!=FileHeader())
+		if (meshIndex>=ctx.meshCount)
 		{
-			os::Printer::log("Not a valid `.serialized` file", ctx.inner.mainFile->getFileName().c_str(), ELL_ERROR);
-			return {};
+			os::Printer::log("Mesh index "+std::to_string(meshIndex)+" out of range in",filename,ELL_ERROR);
+			continue;
 		}
 
-		size_t backPos = ctx.inner.mainFile->getSize() - sizeof(uint32_t);
-		ctx.inner.mainFile->seek(backPos);
-		ctx.inner.mainFile->read(&ctx.meshCount,sizeof(uint32_t));
-		if (ctx.meshCount==0u)
-			return {};
-
-		ctx.meshOffsets = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<uint64_t> >(ctx.meshCount*2u);
-		backPos -= sizeof(uint64_t)*ctx.meshCount;
-		ctx.inner.mainFile->seek(backPos);
-		ctx.inner.mainFile->read(ctx.meshOffsets->data(),sizeof(uint64_t)*ctx.meshCount);
-		for (uint32_t i=0; i<ctx.meshCount; i++)
+		SDecodedMesh cached;
+		if (m_meshCache.get(SMeshCacheKey{filename,fileSize,meshIndex},cached))
+			decoded.push_back(copyDecodedMesh(cached));
+		else
+			missingIndices.push_back(meshIndex);
+	}
+
+	if (!missingIndices.empty())
+	{
+		// two calls missing the same mesh at the same time will both decode it, that's cheaper than making one wait on the other
+		for (auto& mesh : decodeMeshes(ctx,missingIndices,findDefaultAssets(ctx,_override,_hierarchyLevel)))
 		{
-			size_t localSize;
-			if (i == ctx.meshCount-1u)
-				localSize = backPos;
-			else
-				localSize = ctx.meshOffsets->operator[](i+1u);
-			localSize -= ctx.meshOffsets->operator[](i);
-			ctx.meshOffsets->operator[](i+ctx.meshCount) = localSize;
-			if (localSize > maxSize)
-				maxSize = localSize;
+			if (!mesh.mesh)
+				continue;
+			// vertices and indices share a buffer
+			const size_t byteSize = mesh.mesh->getMeshBufferVector().front()->getIndexBufferBinding().buffer->getSize();
+			decoded.push_back(copyDecodedMesh(mesh));
+			m_meshCache.insert(SMeshCacheKey{filename,fileSize,mesh.index},std::move(mesh),byteSize);
 		}
+		std::sort(decoded.begin(),decoded.end(),[](const SDecodedMesh& lhs, const SDecodedMesh& rhs) -> bool {return lhs.index<rhs.index;});
 	}
-	if (maxSize==0u)
-		return {};
+	return createBundle(decoded);
+}
 
-	auto meta = core::make_smart_refctd_ptr<CMitsubaSerializedMetadata>(ctx.meshCount,core::smart_refctd_ptr(IRenderpassIndependentPipelineLoader::m_basicViewParamsSemantics));
-	core::vector<core::smart_refctd_ptr<ICPUMesh>> meshes; meshes.reserve(ctx.meshCount);
+bool CSerializedLoader::readOffsetTable(SContext& ctx) const
+{
+	FileHeader header;
+	ctx.inner.mainFile->seek(0u);
+	ctx.inner.mainFile->read(&header, sizeof(header));
+	if (header!=FileHeader())
+	{
+		os::Printer::log("Not a valid `.serialized` file", ctx.inner.mainFile->getFileName().c_str(), ELL_ERROR);
+		return false;
+	}
 
-	uint8_t* data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(maxSize,alignof(double)));
-	constexpr size_t CHUNK = 256ull*1024ull;
-	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
+	size_t backPos = ctx.inner.mainFile->getSize() - sizeof(uint32_t);
+	ctx.inner.mainFile->seek(backPos);
+	ctx.inner.mainFile->read(&ctx.meshCount,sizeof(uint32_t));
+	if (ctx.meshCount==0u || sizeof(uint64_t)*ctx.meshCount>backPos)
+		return false;
+
+	ctx.meshOffsets = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<uint64_t> >(ctx.meshCount*2u);
+	backPos -= sizeof(uint64_t)*ctx.meshCount;
+	ctx.inner.mainFile->seek(backPos);
+	ctx.inner.mainFile->read(ctx.meshOffsets->data(),sizeof(uint64_t)*ctx.meshCount);
+	size_t maxSize = 0u;
 	for (uint32_t i=0; i<ctx.meshCount; i++)
 	{
-		auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
-		ctx.inner.mainFile->seek(sizeof(FileHeader)+ctx.meshOffsets->operator[](i));
-		ctx.inner.mainFile->read(data,localSize);
-		// decompress
-		size_t decompressSize;
+		size_t localSize;
+		if (i == ctx.meshCount-1u)
+			localSize = backPos;
+		else
+			localSize = ctx.meshOffsets->operator[](i+1u);
+		// corrupt offsets make for a mesh which fails to decode
+		const size_t offset = ctx.meshOffsets->operator[](i);
+		localSize = localSize>offset && localSize<=backPos ? (localSize-offset):0u;
+		ctx.meshOffsets->operator[](i+ctx.meshCount) = localSize;
+		if (localSize > maxSize)
+			maxSize = localSize;
+	}
+	return maxSize!=0u;
+}
+
+CSerializedLoader::SDefaultAssets CSerializedLoader::findDefaultAssets(SContext& ctx, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel) const
+{
+	SDefaultAssets retval;
+	const IAsset::E_TYPE types[]{ IAsset::E_TYPE::ET_SPECIALIZED_SHADER, IAsset::E_TYPE::ET_SPECIALIZED_SHADER, static_cast<IAsset::E_TYPE>(0u) };
+	// same order as `COLOR_ATTRIBUTE`, `UV_ATTRIBUTE` and `NORMAL_ATTRIBUTE` get picked in `decodeMesh`
+	const char* basepaths[] = {
+		"nbl/builtin/material/debug/vertex_color/specialized_shader",
+		"nbl/builtin/material/debug/vertex_uv/specialized_shader",
+		"nbl/builtin/material/debug/vertex_normal/specialized_shader"
+	};
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		const std::string basepath = basepaths[i];
+		auto bundle = m_assetMgr->findAssets(basepath+".vert", types);
+		retval.vertexShaders[i] = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+		bundle = m_assetMgr->findAssets(basepath+".frag", types);
+		retval.fragmentShaders[i] = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+	}
+	retval.pipelineLayout = _override->findDefaultAsset<ICPUPipelineLayout>("nbl/builtin/material/lambertian/no_texture/pipeline_layout",ctx.inner,_hierarchyLevel+ICPUMesh::PIPELINE_LAYOUT_HIERARCHYLEVELS_BELOW).first;
+	return retval;
+}
+
+core::vector<CSerializedLoader::SDecodedMesh> CSerializedLoader::decodeMeshes(SContext& ctx, const core::vector<uint32_t>& meshIndices, const SDefaultAssets& defaults) const
+{
+	core::vector<SDecodedMesh> retval(meshIndices.size());
+	core::vector<core::vector<uint8_t>> compressed(meshIndices.size());
+	for (uint32_t batchBegin=0u; batchBegin<meshIndices.size();)
+	{
+		// the file can only be read from one thread, so read a batch up front
+		uint32_t batchEnd = batchBegin;
+		for (size_t batchSize=0ull; batchEnd<meshIndices.size() && (batchEnd==batchBegin || batchSize<CompressedBatchSize); batchEnd++)
 		{
-			// Setup the inflate stream.
-			z_stream stream;
-			stream.next_in = (Bytef*)data;
-			stream.avail_in = (uInt)localSize;
-			stream.total_in = 0;
-			stream.next_out = (Bytef*)decompressed.data();
-			stream.avail_out = CHUNK;
-			stream.total_out = 0u;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			int32_t err = inflateInit(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				while (err == Z_OK && err != Z_STREAM_END)
-				{
-					err = inflate(&stream, Z_SYNC_FLUSH);
-					if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
-						continue;
-
-					if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
-						decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
-					stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
-					stream.avail_out = CHUNK;
-				}
-			}
-			decompressSize = stream.total_out;
-			int32_t err2 = inflateEnd(&stream);
+			const uint32_t meshIndex = meshIndices[batchEnd];
+			const size_t localSize = ctx.meshOffsets->operator[](meshIndex+ctx.meshCount);
+			compressed[batchEnd].resize(localSize);
+			ctx.inner.mainFile->seek(sizeof(FileHeader)+ctx.meshOffsets->operator[](meshIndex));
+			ctx.inner.mainFile->read(compressed[batchEnd].data(),localSize);
+			batchSize += localSize;
+		}
+
+		core::vector<uint32_t> batch(batchEnd-batchBegin);
+		std::iota(batch.begin(),batch.end(),batchBegin);
+		std::for_each(std::execution::par,batch.begin(),batch.end(),[&](const uint32_t i) -> void
+		{
+			retval[i] = decodeMesh(compressed[i].data(),compressed[i].size(),meshIndices[i],defaults);
+			compressed[i] = {};
+		});
+		batchBegin = batchEnd;
+	}
+	return retval;
+}
+
+CSerializedLoader::SDecodedMesh CSerializedLoader::decodeMesh(const uint8_t* compressed, const size_t compressedSize, const uint32_t meshIndex, const SDefaultAssets& defaults) const
+{
+	SDecodedMesh retval = {nullptr,"",meshIndex};
+	if (compressedSize==0u)
+		return retval;
 
-			if (err == Z_OK || err == Z_STREAM_END)
-				err = err2;
-			if (err != Z_OK)
+	constexpr size_t CHUNK = 256ull*1024ull;
+	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
+	// decompress
+	size_t decompressSize;
+	{
+		// Setup the inflate stream.
+		z_stream stream;
+		stream.next_in = (Bytef*)compressed;
+		stream.avail_in = (uInt)compressedSize;
+		stream.total_in = 0;
+		stream.next_out = (Bytef*)decompressed.data();
+		stream.avail_out = CHUNK;
+		stream.total_out = 0u;
+		stream.zalloc = (alloc_func)0;
+		stream.zfree = (free_func)0;
+
+		int32_t err = inflateInit(&stream, -MAX_WBITS);
+		if (err == Z_OK)
+		{
+			while (err == Z_OK && err != Z_STREAM_END)
 			{
-				std::wstring msg(L"Error decompressing mesh ix ");
-				msg += std::to_wstring(i);
-				os::Printer::log(msg, ELL_ERROR);
-				continue;
+				err = inflate(&stream, Z_SYNC_FLUSH);
+				if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
+					continue;
+
+				if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
+					decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
+				stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
+				stream.avail_out = CHUNK;
 			}
 		}
-		// too small to hold anything
-		if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
-			continue;
+		decompressSize = stream.total_out;
+		int32_t err2 = inflateEnd(&stream);
 
-		// some tracking
-		uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
-		uint8_t* streamEnd = ptr+decompressSize;
-		// vertex size determination
-		auto flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
-		size_t typeSize;
-		size_t vertexAttributeCount = 3u;
-		size_t vertexSize;
+		if (err == Z_OK || err == Z_STREAM_END)
+			err = err2;
+		if (err != Z_OK)
 		{
-			if (flags & MF_SINGLE_FLOAT)
-				typeSize = sizeof(float);
-			else if (flags & MF_DOUBLE_FLOAT)
-				typeSize = sizeof(double);
-			else
-				continue;
-
-			if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-				vertexAttributeCount += 3ull;
-			if (flags & MF_TEXTURE_COORDINATES)
-				vertexAttributeCount += 2ull;
-			if (flags & MF_VERTEX_COLORS)
-				vertexAttributeCount += 3ull;
-
-			vertexSize = vertexAttributeCount*typeSize;
+			std::wstring msg(L"Error decompressing mesh ix ");
+			msg += std::to_wstring(meshIndex);
+			os::Printer::log(msg, ELL_ERROR);
+			return retval;
 		}
+	}
+	// too small to hold anything
+	if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
+		return retval;
+
+	// some tracking
+	uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
+	uint8_t* streamEnd = ptr+decompressSize;
+	// vertex size determination
+	auto flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
+	size_t typeSize;
+	size_t vertexAttributeCount = 3u;
+	size_t vertexSize;
+	{
+		if (flags & MF_SINGLE_FLOAT)
+			typeSize = sizeof(float);
+		else if (flags & MF_DOUBLE_FLOAT)
+			typeSize = sizeof(double);
+		else
+			return retval;
 
-		// get name
-		char* stringPtr = reinterpret_cast<char*>(ptr);
-		while (ptr < streamEnd)
-		if (! *(ptr++))
-				break;
-		// name too long
-		size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
-		if (ptr+sizeof(uint64_t)*2ull > streamEnd)
-			continue;
+		if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
+			vertexAttributeCount += 3ull;
+		if (flags & MF_TEXTURE_COORDINATES)
+			vertexAttributeCount += 2ull;
+		if (flags & MF_VERTEX_COLORS)
+			vertexAttributeCount += 3ull;
 
-		// 
-		uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
-			continue;
-		uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (triangleCount<1ull)
-			continue;
-		size_t vertexDataSize = vertexCount*vertexSize;
-		if (ptr+vertexDataSize > streamEnd)
-			continue;
-		size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
-		size_t totalDataSize = vertexDataSize+indexDataSize;
-		if (ptr+totalDataSize > streamEnd)
-			continue;
+		vertexSize = vertexAttributeCount*typeSize;
+	}
 
-		auto buf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(totalDataSize);
-		void* outPtr = buf->getPointer();
-		auto readAttributes = [&](auto* outPtr, size_t attrOffset, auto* &inPtr, uint32_t attrCount, core::aabbox3df* aabb=nullptr) -> void
+	// get name
+	char* stringPtr = reinterpret_cast<char*>(ptr);
+	while (ptr < streamEnd)
+	if (! *(ptr++))
+			break;
+	// name too long
+	size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
+	if (ptr+sizeof(uint64_t)*2ull > streamEnd)
+		return retval;
+
+	// 
+	uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
+		return retval;
+	uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (triangleCount<1ull)
+		return retval;
+	size_t vertexDataSize = vertexCount*vertexSize;
+	if (ptr+vertexDataSize > streamEnd)
+		return retval;
+	size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
+	size_t totalDataSize = vertexDataSize+indexDataSize;
+	if (ptr+totalDataSize > streamEnd)
+		return retval;
+
+	auto buf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(totalDataSize);
+	void* outPtr = buf->getPointer();
+	auto readAttributes = [&](auto* outPtr, size_t attrOffset, auto* &inPtr, uint32_t attrCount, core::aabbox3df* aabb=nullptr) -> void
+	{
+		for (uint64_t j=0ull; j<vertexCount; j++)
 		{
-			for (uint64_t j=0ull; j<vertexCount; j++)
+			if (aabb)
 			{
-				if (aabb)
-				{
-					if (j)
-						aabb->addInternalPoint(inPtr[0],inPtr[1],inPtr[2]);
-					else
-						aabb->reset(inPtr[0],inPtr[1],inPtr[2]);
-				}
-				for (auto k=0u; k<attrCount; k++)
-					outPtr[j*vertexAttributeCount+attrOffset+k] = *(inPtr++);
+				if (j)
+					aabb->addInternalPoint(inPtr[0],inPtr[1],inPtr[2]);
+				else
+					aabb->reset(inPtr[0],inPtr[1],inPtr[2]);
 			}
-		};
+			for (auto k=0u; k<attrCount; k++)
+				outPtr[j*vertexAttributeCount+attrOffset+k] = *(inPtr++);
+		}
+	};
 
-		auto meshBuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
-		meshBuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
+	auto meshBuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
+	meshBuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
 
-		auto makeAvailableAttributesVector = [&]()
-		{
-			core::vector<uint8_t> vec;
-			vec.reserve(4);
-
-			vec.push_back(POSITION_ATTRIBUTE);
-			if (flags & MF_VERTEX_COLORS)
-				vec.push_back(COLOR_ATTRIBUTE);
-			if (flags & MF_TEXTURE_COORDINATES)
-				vec.push_back(UV_ATTRIBUTE);
-			if (flags & MF_PER_VERTEX_NORMALS)
-				vec.push_back(NORMAL_ATTRIBUTE);
-			return vec;
-		};
-
-		const auto availableAttributes = makeAvailableAttributesVector();
-
-		auto chooseShaderPath = [&]() -> std::string
-		{
-			constexpr std::array<std::pair<uint8_t, std::string_view>, 3> avaiableOptionsForShaders
-			{
-				std::make_pair(COLOR_ATTRIBUTE, "nbl/builtin/material/debug/vertex_color/specialized_shader"),
-				std::make_pair(UV_ATTRIBUTE, "nbl/builtin/material/debug/vertex_uv/specialized_shader"),
-				std::make_pair(NORMAL_ATTRIBUTE, "nbl/builtin/material/debug/vertex_normal/specialized_shader")
-			};
+	auto makeAvailableAttributesVector = [&]()
+	{
+		core::vector<uint8_t> vec;
+		vec.reserve(4);
+
+		vec.push_back(POSITION_ATTRIBUTE);
+		if (flags & MF_VERTEX_COLORS)
+			vec.push_back(COLOR_ATTRIBUTE);
+		if (flags & MF_TEXTURE_COORDINATES)
+			vec.push_back(UV_ATTRIBUTE);
+		if (flags & MF_PER_VERTEX_NORMALS)
+			vec.push_back(NORMAL_ATTRIBUTE);
+		return vec;
+	};
 
-			for (auto& it : avaiableOptionsForShaders)
-			{
-				auto found = std::find(availableAttributes.begin(), availableAttributes.end(), it.first);
-				if (found != availableAttributes.end())
-					return it.second.data();
-			}
+	const auto availableAttributes = makeAvailableAttributesVector();
 
-			return avaiableOptionsForShaders[0].second.data(); // if only positions are present, shaders with debug vertex colors are assumed
-		};
-		
-		core::smart_refctd_ptr<ICPUSpecializedShader> mbVertexShader;
-		core::smart_refctd_ptr<ICPUSpecializedShader> mbFragmentShader;
+	// if only positions are present, shaders with debug vertex colors are assumed
+	uint32_t shaderIx = 0u;
+	{
+		constexpr uint8_t shaderAttributes[] = {COLOR_ATTRIBUTE,UV_ATTRIBUTE,NORMAL_ATTRIBUTE};
+		for (uint32_t j=0u; j<3u; j++)
+		if (std::find(availableAttributes.begin(),availableAttributes.end(),shaderAttributes[j])!=availableAttributes.end())
 		{
-			const IAsset::E_TYPE types[]{ IAsset::E_TYPE::ET_SPECIALIZED_SHADER, IAsset::E_TYPE::ET_SPECIALIZED_SHADER, static_cast<IAsset::E_TYPE>(0u) };
-			const std::string basepath = chooseShaderPath();
-
-			auto bundle = m_assetMgr->findAssets(basepath+".vert", types);
-			mbVertexShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
-			bundle = m_assetMgr->findAssets(basepath+".frag", types);
-			mbFragmentShader = core::smart_refctd_ptr_static_cast<ICPUSpecializedShader>(bundle->begin()->getContents().begin()[0]);
+			shaderIx = j;
+			break;
+		}
+	}
+	auto mbVertexShader = defaults.vertexShaders[shaderIx];
+	auto mbFragmentShader = defaults.fragmentShaders[shaderIx];
+	auto mbPipelineLayout = defaults.pipelineLayout;
+
+	asset::SBlendParams blendParams;
+	asset::SRasterizationParams rastarizationParams;
+	asset::SPrimitiveAssemblyParams primitiveAssemblyParams;
+	asset::SVertexInputParams inputParams;
+
+	primitiveAssemblyParams.primitiveType = asset::EPT_TRIANGLE_LIST;
+	inputParams.enabledBindingFlags |= core::createBitmask({ 0 });
+	inputParams.bindings[0].inputRate = asset::EVIR_PER_VERTEX;
+	inputParams.bindings[0].stride = vertexSize;
+
+	size_t attrOffset = 0ull;
+	auto readAttributeDispatch = [&](auto attrId, size_t attrCount, core::aabbox3df* aabb, bool read = true) -> void
+	{
+		asset::E_FORMAT format = asset::EF_UNKNOWN;
+		switch (attrCount)
+		{
+			case 2ull:
+				format = typeSize==sizeof(double) ? asset::EF_R64G64_SFLOAT:asset::EF_R32G32_SFLOAT;
+				break;
+			case 3ull:
+				format = typeSize==sizeof(double) ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT;
+				break;
+			default:
+				assert(false);
+				break;
 		}
-		auto mbPipelineLayout = _override->findDefaultAsset<ICPUPipelineLayout>("nbl/builtin/material/lambertian/no_texture/pipeline_layout",ctx.inner,_hierarchyLevel+ICPUMesh::PIPELINE_LAYOUT_HIERARCHYLEVELS_BELOW).first;
-
-		asset::SBlendParams blendParams;
-		asset::SRasterizationParams rastarizationParams;
-		asset::SPrimitiveAssemblyParams primitiveAssemblyParams;
-		asset::SVertexInputParams inputParams;
 
-		primitiveAssemblyParams.primitiveType = asset::EPT_TRIANGLE_LIST;
-		inputParams.enabledBindingFlags |= core::createBitmask({ 0 });
-		inputParams.bindings[0].inputRate = asset::EVIR_PER_VERTEX;
-		inputParams.bindings[0].stride = vertexSize;
+		inputParams.enabledAttribFlags |= core::createBitmask({ attrId });
+		inputParams.attributes[attrId].binding = 0;
+		inputParams.attributes[attrId].format = format;
+		inputParams.attributes[attrId].relativeOffset = attrOffset * typeSize;
+		meshBuffer->setVertexBufferBinding({ 0, buf }, 0);
 
-		size_t attrOffset = 0ull;
-		auto readAttributeDispatch = [&](auto attrId, size_t attrCount, core::aabbox3df* aabb, bool read = true) -> void
+		if (read)
 		{
-			asset::E_FORMAT format = asset::EF_UNKNOWN;
-			switch (attrCount)
-			{
-				case 2ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64_SFLOAT:asset::EF_R32G32_SFLOAT;
-					break;
-				case 3ull:
-					format = typeSize==sizeof(double) ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT;
-					break;
-				default:
-					assert(false);
-					break;
-			}
+			if (flags & MF_SINGLE_FLOAT)
+				readAttributes(reinterpret_cast<float*>(outPtr), attrOffset, reinterpret_cast<float*&>(ptr), attrCount, aabb);
+			else if (flags & MF_DOUBLE_FLOAT)
+				readAttributes(reinterpret_cast<double*>(outPtr), attrOffset, reinterpret_cast<double*&>(ptr), attrCount, aabb);
+		}
+		attrOffset += attrCount;
+	};
 
-			inputParams.enabledAttribFlags |= core::createBitmask({ attrId });
-			inputParams.attributes[attrId].binding = 0;
-			inputParams.attributes[attrId].format = format;
-			inputParams.attributes[attrId].relativeOffset = attrOffset * typeSize;
-			meshBuffer->setVertexBufferBinding({ 0, buf }, 0);
-	
-			if (read)
+	core::aabbox3df aabb;
+	readAttributeDispatch(POSITION_ATTRIBUTE, 3ull, &aabb);
+	meshBuffer->setBoundingBox(aabb);
+	if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
+		readAttributeDispatch(NORMAL_ATTRIBUTE, 3ull, nullptr, flags&MF_PER_VERTEX_NORMALS); // TODO: normal quantization and optimization
+	if (flags & MF_TEXTURE_COORDINATES) // TODO: UV quantization and optimization
+		readAttributeDispatch(UV_ATTRIBUTE, 2ull, nullptr);
+	if (flags & MF_VERTEX_COLORS) // TODO: quantize to 32bit format like RGB9E5
+		readAttributeDispatch(COLOR_ATTRIBUTE, 3ull, nullptr);
+
+	auto mbPipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(std::move(mbPipelineLayout), nullptr, nullptr, inputParams, blendParams, primitiveAssemblyParams, rastarizationParams);
+	mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_VERTEX, mbVertexShader.get());
+	mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_FRAGMENT, mbFragmentShader.get());
+
+	meshBuffer->setIndexBufferBinding({ vertexDataSize, std::move(buf) });
+	meshBuffer->setIndexCount(triangleCount * 3u);
+	meshBuffer->setIndexType(asset::EIT_32BIT);
+
+	// read indices and possibly create per-face normals
+	auto readIndices = [&]() -> bool
+	{
+		uint32_t* indexPtr = reinterpret_cast<uint32_t*>(outPtr)+vertexDataSize/sizeof(uint32_t);
+		for (uint64_t j=0ull; j<triangleCount; j++)
+		{
+			uint32_t* triangleIndices = indexPtr;
+			for (uint64_t k=0ull; k<3ull; k++)
 			{
-				if (flags & MF_SINGLE_FLOAT)
-					readAttributes(reinterpret_cast<float*>(outPtr), attrOffset, reinterpret_cast<float*&>(ptr), attrCount, aabb);
-				else if (flags & MF_DOUBLE_FLOAT)
-					readAttributes(reinterpret_cast<double*>(outPtr), attrOffset, reinterpret_cast<double*&>(ptr), attrCount, aabb);
+				triangleIndices[k] = *(reinterpret_cast<uint32_t*&>(ptr)++);
+				if (triangleIndices[k] >= static_cast<uint32_t>(vertexCount))
+					return false;
 			}
-			attrOffset += attrCount;
-		};
+			indexPtr += 3u;
 
-		core::aabbox3df aabb;
-		readAttributeDispatch(POSITION_ATTRIBUTE, 3ull, &aabb);
-		meshBuffer->setBoundingBox(aabb);
-		if ((flags & MF_PER_VERTEX_NORMALS) || (flags & MF_FACE_NORMALS))
-			readAttributeDispatch(NORMAL_ATTRIBUTE, 3ull, nullptr, flags&MF_PER_VERTEX_NORMALS); // TODO: normal quantization and optimization
-		if (flags & MF_TEXTURE_COORDINATES) // TODO: UV quantization and optimization
-			readAttributeDispatch(UV_ATTRIBUTE, 2ull, nullptr);
-		if (flags & MF_VERTEX_COLORS) // TODO: quantize to 32bit format like RGB9E5
-			readAttributeDispatch(COLOR_ATTRIBUTE, 3ull, nullptr);
-
-		auto mbPipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(std::move(mbPipelineLayout), nullptr, nullptr, inputParams, blendParams, primitiveAssemblyParams, rastarizationParams);
-		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_VERTEX, mbVertexShader.get());
-		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_FRAGMENT, mbFragmentShader.get());
-
-		meshBuffer->setIndexBufferBinding({ vertexDataSize, std::move(buf) });
-		meshBuffer->setIndexCount(triangleCount * 3u);
-		meshBuffer->setIndexType(asset::EIT_32BIT);
-
-		// read indices and possibly create per-face normals
-		auto readIndices = [&]() -> bool
-		{
-			uint32_t* indexPtr = reinterpret_cast<uint32_t*>(outPtr)+vertexDataSize/sizeof(uint32_t);
-			for (uint64_t j=0ull; j<triangleCount; j++)
+			if (flags & MF_FACE_NORMALS)
 			{
-				uint32_t* triangleIndices = indexPtr;
+				core::vectorSIMDf pos[3];
 				for (uint64_t k=0ull; k<3ull; k++)
-				{
-					triangleIndices[k] = *(reinterpret_cast<uint32_t*&>(ptr)++);
-					if (triangleIndices[k] >= static_cast<uint32_t>(vertexCount))
-						return false;
-				}
-				indexPtr += 3u;
-
-				if (flags & MF_FACE_NORMALS)
-				{
-					core::vectorSIMDf pos[3];
-					for (uint64_t k=0ull; k<3ull; k++)
-						pos[k] = meshBuffer->getPosition(triangleIndices[k]);
-					auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
-					for (uint64_t k=0ull; k<3ull; k++)
-						meshBuffer->setAttribute(normal,NORMAL_ATTRIBUTE,k);
-				}
+					pos[k] = meshBuffer->getPosition(triangleIndices[k]);
+				auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
+				for (uint64_t k=0ull; k<3ull; k++)
+					meshBuffer->setAttribute(normal,NORMAL_ATTRIBUTE,k);
 			}
-			return true;
-		};
-		if (!readIndices())
-			continue;
+		}
+		return true;
+	};
+	if (!readIndices())
+		return retval;
 
 
-		auto mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
 
-		meta->placeMeta(meshes.size(),mbPipeline.get(),mesh.get(),{std::string(stringPtr,stringLen),i});
+	retval.mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
+	retval.name = std::string(stringPtr,stringLen);
 
-		meshBuffer->setPipeline(std::move(mbPipeline));
+	meshBuffer->setPipeline(std::move(mbPipeline));
 
-		mesh->setBoundingBox(meshBuffer->getBoundingBox());
-		mesh->getMeshBufferVector().emplace_back(std::move(meshBuffer));
-		meshes.push_back(std::move(mesh));
+	retval.mesh->setBoundingBox(meshBuffer->getBoundingBox());
+	retval.mesh->getMeshBufferVector().emplace_back(std::move(meshBuffer));
+	return retval;
+}
+
+CSerializedLoader::SDecodedMesh CSerializedLoader::copyDecodedMesh(const SDecodedMesh& decoded)
+{
+	SDecodedMesh retval = {core::make_smart_refctd_ptr<asset::ICPUMesh>(),decoded.name,decoded.index};
+	for (const auto* meshBuffer : decoded.mesh->getMeshBuffers())
+	{
+		auto copy = core::smart_refctd_ptr_static_cast<asset::ICPUMeshBuffer>(meshBuffer->clone(0u));
+		// vertices and indices share a buffer, so it only gets copied once
+		const auto& indexBinding = meshBuffer->getIndexBufferBinding();
+		auto buf = core::smart_refctd_ptr_static_cast<asset::ICPUBuffer>(indexBinding.buffer->clone(0u));
+		copy->setVertexBufferBinding({meshBuffer->getVertexBufferBindings()[0].offset,core::smart_refctd_ptr(buf)},0);
+		copy->setIndexBufferBinding({indexBinding.offset,std::move(buf)});
+		copy->setPipeline(core::smart_refctd_ptr_static_cast<asset::ICPURenderpassIndependentPipeline>(meshBuffer->getPipeline()->clone(0u)));
+		retval.mesh->getMeshBufferVector().emplace_back(std::move(copy));
 	}
-	_NBL_ALIGNED_FREE(data);
+	retval.mesh->setBoundingBox(decoded.mesh->getBoundingBox());
+	return retval;
+}
 
+asset::SAssetBundle CSerializedLoader::createBundle(const core::vector<SDecodedMesh>& decoded) const
+{
+	uint32_t meshCount = 0u;
+	for (const auto& mesh : decoded)
+	if (mesh.mesh)
+		meshCount++;
+
+	auto meta = core::make_smart_refctd_ptr<CMitsubaSerializedMetadata>(meshCount,core::smart_refctd_ptr(IRenderpassIndependentPipelineLoader::m_basicViewParamsSemantics));
+	core::vector<core::smart_refctd_ptr<ICPUMesh>> meshes; meshes.reserve(meshCount);
+	for (const auto& mesh : decoded)
+	{
+		if (!mesh.mesh)
+			continue;
+		const auto* pipeline = mesh.mesh->getMeshBufferVector().front()->getPipeline();
+		meta->placeMeta(meshes.size(),pipeline,mesh.mesh.get(),{std::string(mesh.name),mesh.index});
+		meshes.push_back(mesh.mesh);
+	}
 	return SAssetBundle(std::move(meta),std::move(meshes));
 }
 
-
 }
 }
 }
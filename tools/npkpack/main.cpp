@@ -0,0 +1,122 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <nabla.h>
+#include <iostream>
+#include <filesystem>
+
+#include "../../source/Nabla/CNpkWriter.h"
+
+// Usage: npkpack -o <archive.npk> [-codec raw|lz4|lzma|auto] [-st] [list of input files or directories delimited with spaces]
+// Options:
+// -o <path>
+//	Output archive.
+// -codec <codec>
+//	Codec used for all entries, defaults to auto (LZ4-HC unless it saves less than 10%, then stored raw).
+// -st
+//	Compress on a single thread.
+// Files get stored under their path relative to the current directory, directories get packed recursively.
+
+//Example:
+//	npkpack -o media.npk -codec lzma ../media/shaders ../media/cube.obj
+
+using namespace nbl;
+
+int main(int _optCnt, char** _options)
+{
+	--_optCnt;
+	++_options;
+
+	io::path output;
+	io::CNpkWriter::E_CODEC_SELECTION codec = io::CNpkWriter::ECS_AUTO;
+	io::CNpkWriter::SParameters params;
+	core::vector<std::filesystem::path> inputPaths;
+	for (int i=0; i<_optCnt; i++)
+	{
+		const std::string option = _options[i];
+		if (option == "-o" && i+1<_optCnt)
+			output = _options[++i];
+		else if (option == "-codec" && i+1<_optCnt)
+		{
+			const std::string name = _options[++i];
+			if (name == "raw")
+				codec = io::CNpkWriter::ECS_RAW;
+			else if (name == "lz4")
+				codec = io::CNpkWriter::ECS_LZ4;
+			else if (name == "lzma")
+				codec = io::CNpkWriter::ECS_LZMA;
+			else if (name == "auto")
+				codec = io::CNpkWriter::ECS_AUTO;
+			else
+			{
+				std::cerr << "Unknown codec " << name << "\n";
+				return 1;
+			}
+		}
+		else if (option == "-st")
+			params.parallel = false;
+		else
+			inputPaths.push_back(option);
+	}
+	if (output.size() == 0u || inputPaths.empty())
+	{
+		std::cerr << "Usage: npkpack -o <archive.npk> [-codec raw|lz4|lzma|auto] [-st] inputs...\n";
+		return 1;
+	}
+
+	nbl::SIrrlichtCreationParameters deviceParams;
+	deviceParams.DriverType = video::EDT_NULL;
+	auto device = createDeviceEx(deviceParams);
+	if (!device)
+		return 1;
+	io::IFileSystem* const fs = device->getFileSystem();
+
+	core::vector<io::CNpkWriter::SInput> inputs;
+	auto addInput = [&](const std::filesystem::path& path) -> void
+	{
+		io::CNpkWriter::SInput input;
+		input.sourcePath = path.generic_string().c_str();
+		input.name = std::filesystem::relative(path).generic_string().c_str();
+		input.codec = codec;
+		inputs.push_back(std::move(input));
+	};
+	for (const auto& path : inputPaths)
+	{
+		if (std::filesystem::is_directory(path))
+		{
+			// sorted so that the same directory always produces the same archive
+			core::vector<std::filesystem::path> files;
+			for (const auto& it : std::filesystem::recursive_directory_iterator(path))
+			if (it.is_regular_file())
+				files.push_back(it.path());
+			std::sort(files.begin(), files.end());
+			for (const auto& file : files)
+				addInput(file);
+		}
+		else
+			addInput(path);
+	}
+
+	io::IWriteFile* file = fs->createAndWriteFile(output);
+	if (!file)
+	{
+		std::cerr << "Could not open " << output.c_str() << " for writing\n";
+		return 1;
+	}
+	io::CNpkWriter::SReport report;
+	const bool success = io::CNpkWriter::write(fs, file, inputs, params, &report);
+	file->drop();
+	if (!success)
+	{
+		std::cerr << "Failed to write " << output.c_str() << "\n";
+		return 1;
+	}
+
+	std::cout << "Packed " << report.entryCount << " files, " << report.inputSize << " bytes into " << report.storedSize << " bytes"
+		<< " (raw: " << report.codecCounts[io::SNPKFileEntry::EC_RAW]
+		<< ", lz4: " << report.codecCounts[io::SNPKFileEntry::EC_LZ4]
+		<< ", lzma: " << report.codecCounts[io::SNPKFileEntry::EC_LZMA] << ")\n";
+	return 0;
+}